@@ -0,0 +1,981 @@
+#include <QtTest/QtTest>
+#include <QApplication>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QXmlStreamReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSqlQuery>
+#include <QTimeZone>
+#include <QDebug>
+#include <climits>
+#include <memory>
+
+#include "bench_dataset.h"
+#include "src/database/databasemanager.h"
+#include "src/database/databaseservice.h"
+#include "src/database/maintenancescheduler.h"
+#include "src/database/inventoryledger.h"
+#include "src/features/materials/materialmodel.h"
+#include "src/features/materials/materialcsvimporter.h"
+#include "src/features/materials/stockalertmonitor.h"
+#include "src/features/projects/projetmanager.h"
+#include "src/features/contracts/contract.h"
+#include "src/features/contracts/contractdatabasemanager.h"
+#include "src/features/contracts/contractexportmanager.h"
+#include "src/features/invoices/invoice.h"
+#include "src/features/invoices/invoicedatabasemanager.h"
+#include "src/features/invoices/invoicepdfgenerator.h"
+#include "src/features/clients/client.h"
+#include "src/features/clients/clientdatabasemanager.h"
+#include "src/features/employees/employee.h"
+#include "src/features/employees/employeedatabasemanager.h"
+
+/**
+ * @brief Benchmarks of the module managers on a generated dataset
+ *
+ * Fills every module database with BenchDataset at the requested scale and
+ * times the manager calls the widgets rely on: full loads, pages, searches,
+ * statistics, bulk inserts, exports and PDF generation.
+ *
+ * Usage: archiflow_bench [--scale 10k|100k|1M] [--seed N] [--json FILE] [QtTest options]
+ *
+ * The results are printed as usual and written to FILE as JSON
+ * (archiflow_bench_<scale>.json by default).
+ */
+class BenchArchiflow : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchArchiflow(int scale, quint32 seed);
+
+    BenchDataset::Counts counts() const { return m_counts; }
+    QString sqliteVersion() const { return m_sqliteVersion; }
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Materials and projects (main database)
+    void benchMaterialsLoad();
+    void benchMaterialsLazyOpen();
+    void benchMaterialsPage();
+    void benchMaterialsEditRow();
+    void benchMaterialsFilterTyping();
+    void benchMaterialsModelStats();
+    void benchMaterialsStockAlerts();
+    void benchMaterialsPaintRows();
+    void benchMaterialsSearch();
+    void benchMaterialsDashboardStats();
+    void benchMaterialsInventoryAnalysis();
+    void benchMaterialsCategoryStats();
+    void benchMaterialsStockHistory();
+    void benchMaterialsBulkInsert();
+    void benchMaterialsCsvImport();
+    void benchMaterialsExportCsv();
+    void benchMaterialsExportJson();
+    void benchProjetsLoad();
+    void benchProjetsSearch();
+    void benchProjetsStatistics();
+
+    // Contracts
+    void benchContractsLoad();
+    void benchContractsPage();
+    void benchContractsSearch();
+    void benchContractsStatistics();
+    void benchContractsMonthlyCounts();
+    void benchContractsExpiring();
+    void benchContractsBulkInsert();
+    void benchContractsExportCsv();
+    void benchContractsExportJson();
+    void benchContractsExportPdf();
+
+    // Invoices
+    void benchInvoicesLoad();
+    void benchInvoicesPage();
+    void benchInvoicesSearch();
+    void benchInvoicesRevenue();
+    void benchInvoicesOverdue();
+    void benchInvoicePdf();
+
+    // Clients
+    void benchClientsLoad();
+    void benchClientsPage();
+    void benchClientsSearch();
+    void benchClientsByLocation();
+    void benchClientsCities();
+    void benchClientsBulkInsert();
+
+    // Employees
+    void benchEmployeesLoad();
+    void benchEmployeesPage();
+    void benchEmployeesSearch();
+    void benchEmployeesDepartments();
+    void benchEmployeesBulkInsert();
+
+private:
+    static const int BULK_ROWS;
+    static const int EXPORT_PAGE_SIZE;
+
+    QString dataPath(const QString &fileName) const;
+
+    int m_scale;
+    quint32 m_seed;
+    BenchDataset::Counts m_counts;
+    QString m_sqliteVersion;
+    int m_bulkRun;
+
+    QTemporaryDir m_dataDir;
+    std::unique_ptr<DatabaseManager> m_databaseManager;
+    std::unique_ptr<DatabaseService> m_databaseService;
+    std::unique_ptr<MaterialModel> m_materialModel;
+    std::unique_ptr<ProjetManager> m_projetManager;
+    std::unique_ptr<ContractDatabaseManager> m_contractManager;
+    std::unique_ptr<InvoiceDatabaseManager> m_invoiceManager;
+    std::unique_ptr<ClientDatabaseManager> m_clientManager;
+    std::unique_ptr<EmployeeDatabaseManager> m_employeeManager;
+};
+
+const int BenchArchiflow::BULK_ROWS = 1000;
+const int BenchArchiflow::EXPORT_PAGE_SIZE = 100;
+
+BenchArchiflow::BenchArchiflow(int scale, quint32 seed)
+    : m_scale(scale)
+    , m_seed(seed)
+    , m_counts(BenchDataset::countsForScale(scale))
+    , m_bulkRun(0)
+{
+}
+
+QString BenchArchiflow::dataPath(const QString &fileName) const
+{
+    return m_dataDir.filePath(fileName);
+}
+
+void BenchArchiflow::initTestCase()
+{
+    QVERIFY(m_dataDir.isValid());
+
+    // Idle-time maintenance would run in the middle of the measurements
+    MaintenanceScheduler::instance()->setIdleThreshold(INT_MAX);
+
+    // The managers create their schemas; the generator fills them afterwards
+    m_databaseManager = std::make_unique<DatabaseManager>();
+    QVERIFY2(m_databaseManager->initialize(dataPath("archiflow.db")), qPrintable(m_databaseManager->lastError()));
+    m_projetManager = std::make_unique<ProjetManager>(m_databaseManager.get());
+    QVERIFY(m_projetManager->createTables());
+
+    m_contractManager = std::make_unique<ContractDatabaseManager>();
+    QVERIFY2(m_contractManager->initialize(dataPath("contracts.db")), qPrintable(m_contractManager->getLastError()));
+    m_contractManager->enableCaching(false);
+
+    m_invoiceManager = std::make_unique<InvoiceDatabaseManager>();
+    QVERIFY2(m_invoiceManager->initialize(dataPath("invoices.db")), qPrintable(m_invoiceManager->lastError()));
+    m_clientManager = std::make_unique<ClientDatabaseManager>();
+    QVERIFY2(m_clientManager->initialize(dataPath("clients.db")), qPrintable(m_clientManager->lastError()));
+    m_employeeManager = std::make_unique<EmployeeDatabaseManager>();
+    QVERIFY2(m_employeeManager->initialize(dataPath("employees.db")), qPrintable(m_employeeManager->lastError()));
+
+    QElapsedTimer timer;
+    timer.start();
+    BenchDataset dataset(m_seed);
+    QVERIFY2(dataset.populateMaterials(dataPath("archiflow.db"), m_counts), qPrintable(dataset.lastError()));
+    QVERIFY2(dataset.populateContracts(dataPath("contracts.db"), m_counts), qPrintable(dataset.lastError()));
+    QVERIFY2(dataset.populateInvoices(dataPath("invoices.db"), m_counts), qPrintable(dataset.lastError()));
+    QVERIFY2(dataset.populateClients(dataPath("clients.db"), m_counts), qPrintable(dataset.lastError()));
+    QVERIFY2(dataset.populateEmployees(dataPath("employees.db"), m_counts), qPrintable(dataset.lastError()));
+    qDebug() << "Generated dataset for scale" << m_scale << "in" << timer.elapsed() << "ms";
+
+    QSqlQuery version(m_databaseManager->database());
+    if (version.exec("SELECT sqlite_version()") && version.next()) {
+        m_sqliteVersion = version.value(0).toString();
+    }
+
+    m_databaseService = std::make_unique<DatabaseService>();
+    m_databaseService->setDatabaseManager(m_databaseManager.get());
+    m_materialModel = std::make_unique<MaterialModel>();
+    m_materialModel->setDatabaseManager(m_databaseManager.get());
+    // The model benchmarks need every row loaded, at any scale
+    m_materialModel->setLazyLoading(false);
+    QTRY_VERIFY_WITH_TIMEOUT(!m_materialModel->isLoading(), 10 * 60 * 1000);
+}
+
+void BenchArchiflow::cleanupTestCase()
+{
+    m_materialModel.reset();
+    m_databaseService.reset();
+    m_projetManager.reset();
+    m_employeeManager.reset();
+    m_clientManager.reset();
+    m_invoiceManager.reset();
+    m_contractManager.reset();
+    m_databaseManager.reset();
+    MaintenanceScheduler::instance()->shutdown();
+}
+
+// Materials and projects
+
+void BenchArchiflow::benchMaterialsLoad()
+{
+    bool ok = false;
+    QBENCHMARK {
+        ok = m_materialModel->loadMaterialsFromDatabase();
+    }
+    QVERIFY(ok);
+    QVERIFY(m_materialModel->rowCount() >= m_counts.materials);
+}
+
+void BenchArchiflow::benchMaterialsLazyOpen()
+{
+    MaterialModel model;
+    model.setDatabaseManager(m_databaseManager.get());
+    model.setLazyLoading(true);
+    QVERIFY(model.isLazyLoading());
+
+    QBENCHMARK {
+        // Count and first chunk, then a few screens of scrolling
+        model.refresh();
+        for (int i = 0; i < 4 && model.canFetchMore(QModelIndex()); ++i) {
+            model.fetchMore(QModelIndex());
+        }
+    }
+    QVERIFY(model.matchingCount() >= m_counts.materials);
+    QVERIFY(model.rowCount() <= 5 * MaterialModel::LAZY_CHUNK_SIZE);
+}
+
+void BenchArchiflow::benchMaterialsPage()
+{
+    Page<Material> page;
+    QBENCHMARK {
+        page = m_materialModel->fetchMaterialsPage(PageRequest{"price", Qt::DescendingOrder, EXPORT_PAGE_SIZE, QString()});
+    }
+    QVERIFY2(page.isValid(), qPrintable(page.error));
+    QCOMPARE(page.items.size(), EXPORT_PAGE_SIZE);
+}
+
+void BenchArchiflow::benchMaterialsEditRow()
+{
+    QVERIFY(m_materialModel->rowCount() > 0);
+    const int row = m_materialModel->rowCount() / 2;
+    Material material = m_materialModel->getMaterial(row);
+    bool ok = true;
+    QBENCHMARK {
+        // One UPDATE and one dataChanged; the rest of the model is untouched
+        ++material.quantity;
+        ok = ok && m_materialModel->updateMaterial(row, material);
+    }
+    QVERIFY(ok);
+    QCOMPARE(m_materialModel->getMaterial(row).quantity, material.quantity);
+}
+
+void BenchArchiflow::benchMaterialsFilterTyping()
+{
+    const QStringList keystrokes = {"s", "st", "ste", "stee", "steel", "stee", "ste", "st", "s", ""};
+    QBENCHMARK {
+        // Each extension narrows the rows already shown; deleting rescans
+        for (const QString &text : keystrokes) {
+            m_materialModel->setFilter(text);
+        }
+    }
+    QCOMPARE(m_materialModel->rowCount(), m_materialModel->getTotalMaterials());
+}
+
+void BenchArchiflow::benchMaterialsModelStats()
+{
+    int lowStock = 0;
+    double totalValue = 0.0;
+    QStringList categories;
+    QBENCHMARK {
+        // Scans of the numeric columns, not of the Material structs; the
+        // low stock count is kept by the alert monitor
+        lowStock = m_materialModel->getLowStockCount();
+        totalValue = m_materialModel->getTotalValue();
+        categories = m_materialModel->getCategories();
+    }
+    QVERIFY(lowStock <= m_materialModel->getTotalMaterials());
+    QVERIFY(totalValue > 0.0);
+    QVERIFY(!categories.isEmpty());
+}
+
+void BenchArchiflow::benchMaterialsStockAlerts()
+{
+    StockAlertMonitor *alerts = m_materialModel->stockAlerts();
+    QVERIFY(alerts->isWatchingDatabase());
+    const int row = m_materialModel->rowCount() / 3;
+    Material material = m_materialModel->getMaterial(row);
+
+    int raised = 0;
+    const QMetaObject::Connection connection = connect(alerts, &StockAlertMonitor::alertRaised, this,
+                                                       [&raised]() { ++raised; });
+    bool ok = true;
+    QBENCHMARK {
+        // Out of stock and restocked; each commit reaches the alert set
+        // through ChangeNotifier on the next event loop turn
+        material.quantity = 0;
+        ok = ok && m_materialModel->updateMaterial(row, material);
+        QCoreApplication::processEvents();
+        ok = ok && alerts->isLowStock(material.id);
+
+        material.quantity = material.reorderPoint + 1;
+        ok = ok && m_materialModel->updateMaterial(row, material);
+        QCoreApplication::processEvents();
+        ok = ok && !alerts->isLowStock(material.id);
+    }
+    disconnect(connection);
+    QVERIFY(ok);
+    QVERIFY(raised > 0);
+}
+
+void BenchArchiflow::benchMaterialsPaintRows()
+{
+    // The roles a view asks for on each repaint of one screen of rows
+    const QList<int> roles = {Qt::DisplayRole, Qt::BackgroundRole, Qt::ForegroundRole, Qt::DecorationRole};
+    const int rows = qMin(m_materialModel->rowCount(), EXPORT_PAGE_SIZE);
+    int cells = 0;
+    QBENCHMARK {
+        for (int row = 0; row < rows; ++row) {
+            for (int column = 0; column < MaterialModel::ColumnCount; ++column) {
+                const QModelIndex index = m_materialModel->index(row, column);
+                for (int role : roles) {
+                    cells += m_materialModel->data(index, role).isValid() ? 1 : 0;
+                }
+            }
+        }
+    }
+    QVERIFY(cells > 0);
+}
+
+void BenchArchiflow::benchMaterialsSearch()
+{
+    QJsonArray results;
+    QBENCHMARK {
+        results = m_databaseService->searchMaterials("steel");
+    }
+    QVERIFY(!results.isEmpty());
+}
+
+void BenchArchiflow::benchMaterialsDashboardStats()
+{
+    QJsonObject stats;
+    QBENCHMARK {
+        stats = m_databaseService->getDashboardStats();
+    }
+    QVERIFY(!stats.isEmpty());
+}
+
+void BenchArchiflow::benchMaterialsInventoryAnalysis()
+{
+    QJsonObject analysis;
+    QBENCHMARK {
+        analysis = m_databaseService->getInventoryAnalysis();
+    }
+    QVERIFY(!analysis.isEmpty());
+}
+
+void BenchArchiflow::benchMaterialsCategoryStats()
+{
+    QJsonArray categories;
+    QBENCHMARK {
+        categories = m_databaseService->getCategoryStats();
+    }
+    QVERIFY(!categories.isEmpty());
+}
+
+void BenchArchiflow::benchMaterialsStockHistory()
+{
+    // A year of movements on one material, one every ten minutes
+    QSqlQuery idQuery = m_databaseManager->executeQuery("SELECT MIN(id) FROM materials");
+    QVERIFY(idQuery.next());
+    const int materialId = idQuery.value(0).toInt();
+    idQuery.finish();
+
+    const int movements = BULK_ROWS * 50;
+    const QDateTime start(QDate(2020, 1, 1), QTime(0, 0), QTimeZone::utc());
+    QList<QVariantList> values(5);
+    for (int i = 0; i < movements; ++i) {
+        values[0] << materialId;
+        values[1] << (i % 3 == 0 ? "out" : "in");
+        values[2] << 1 + i % 7;
+        values[3] << "archiflow_bench";
+        values[4] << InventoryLedger::sqlTime(start.addSecs(600LL * i));
+    }
+    const BatchResult batch = m_databaseManager->executeBatch(
+        "INSERT INTO material_movements (material_id, movement_type, quantity, reference, movement_date) "
+        "VALUES (?, ?, ?, ?, ?)", values);
+    QVERIFY2(batch.isValid() && batch.failedRows.isEmpty(), qPrintable(batch.error));
+
+    InventoryLedger ledger(m_databaseManager.get());
+    QVERIFY2(ledger.updateCheckpoints(materialId), qPrintable(ledger.lastError()));
+
+    bool ok = true;
+    qint64 consumed = 0;
+    QBENCHMARK {
+        // Each month is two checkpoint lookups and short range scans
+        consumed = 0;
+        for (int month = 0; month < 12; ++month) {
+            bool monthOk = false;
+            consumed += ledger.flowBetween(materialId, start.addMonths(month), start.addMonths(month + 1),
+                                           &monthOk).consumed;
+            ok = ok && monthOk;
+        }
+    }
+    QVERIFY2(ok, qPrintable(ledger.lastError()));
+    QVERIFY(consumed > 0);
+
+    // The checkpoints agree with a full replay
+    QSqlQuery replay = m_databaseManager->executeQuery(
+        "SELECT SUM(CASE movement_type WHEN 'out' THEN -quantity ELSE quantity END) "
+        "FROM material_movements WHERE material_id = ?", {materialId});
+    QVERIFY(replay.next());
+    const int replayed = replay.value(0).toInt();
+    replay.finish();
+    QCOMPARE(ledger.stockAt(materialId, QDateTime::currentDateTimeUtc().addYears(100)), replayed);
+}
+
+void BenchArchiflow::benchMaterialsBulkInsert()
+{
+    // No barcodes, so the same rows can be inserted on every iteration
+    QJsonArray materials;
+    for (int i = 0; i < BULK_ROWS; ++i) {
+        QJsonObject material;
+        material["name"] = QString("Bulk Material %1").arg(i + 1);
+        material["description"] = "Inserted by archiflow_bench";
+        material["category"] = "Other";
+        material["quantity"] = i % 500;
+        material["unit"] = "pcs";
+        material["price"] = 1.5 + i;
+        material["minimumStock"] = 10;
+        material["maximumStock"] = 1000;
+        material["reorderPoint"] = 20;
+        material["status"] = "active";
+        materials.append(material);
+    }
+
+    bool ok = false;
+    QBENCHMARK {
+        ok = m_databaseService->addMultipleMaterials(materials);
+    }
+    QVERIFY2(ok, qPrintable(m_databaseService->lastBatchResult().error));
+}
+
+void BenchArchiflow::benchMaterialsCsvImport()
+{
+    // Quoted fields with separators and line breaks; no barcodes, so the
+    // same file imports on every iteration
+    const int rows = BULK_ROWS * 10;
+    QFile file(dataPath("materials_import.csv"));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("Name,Description,Category,Quantity,Unit,Price,Location,Minimum Stock\r\n");
+    for (int i = 0; i < rows; ++i) {
+        file.write(QString("\"Imported Material %1\",\"Supplier sheet, line %1\nsecond line\",Other,%2,pcs,%3,\"Depot \"\"A\"\"\",10\r\n")
+                       .arg(i + 1).arg(i % 500).arg(1.5 + i, 0, 'f', 2).toUtf8());
+    }
+    file.close();
+
+    MaterialImportResult result;
+    QBENCHMARK {
+        MaterialCsvImporter importer(m_databaseManager.get());
+        result = importer.importFile(file.fileName());
+    }
+    QVERIFY2(result.isValid(), qPrintable(result.error));
+    QCOMPARE(result.importedRows, rows);
+    QCOMPARE(result.failedRows, 0);
+}
+
+void BenchArchiflow::benchMaterialsExportCsv()
+{
+    QFile file(dataPath("materials_export.csv"));
+    bool ok = false;
+    QBENCHMARK {
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        ok = m_databaseService->exportMaterialsToCsv(&file);
+        file.close();
+    }
+    QVERIFY(ok);
+    QVERIFY(m_databaseService->lastExportRowCount() >= m_counts.materials);
+}
+
+void BenchArchiflow::benchMaterialsExportJson()
+{
+    QFile file(dataPath("materials_export.json"));
+    bool ok = false;
+    QBENCHMARK {
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        ok = m_databaseService->exportMaterialsToJson(&file);
+        file.close();
+    }
+    QVERIFY(ok);
+    QVERIFY(m_databaseService->lastExportRowCount() >= m_counts.materials);
+}
+
+void BenchArchiflow::benchProjetsLoad()
+{
+    QList<Projet> projets;
+    QBENCHMARK {
+        projets = m_projetManager->getAllProjets();
+    }
+    QVERIFY(projets.size() >= m_counts.projets);
+}
+
+void BenchArchiflow::benchProjetsSearch()
+{
+    QList<Projet> projets;
+    QBENCHMARK {
+        projets = m_projetManager->rechercherProjets("Tunis");
+    }
+    QVERIFY(!projets.isEmpty());
+}
+
+void BenchArchiflow::benchProjetsStatistics()
+{
+    QVariantMap statistics;
+    QBENCHMARK {
+        statistics = m_projetManager->getStatistiques();
+    }
+    QVERIFY(!statistics.isEmpty());
+}
+
+// Contracts
+
+void BenchArchiflow::benchContractsLoad()
+{
+    int count = 0;
+    QBENCHMARK {
+        QList<Contract*> contracts = m_contractManager->getAllContracts();
+        count = contracts.size();
+        qDeleteAll(contracts);
+    }
+    QVERIFY(count >= m_counts.contracts);
+}
+
+void BenchArchiflow::benchContractsPage()
+{
+    int count = 0;
+    QBENCHMARK {
+        Page<Contract*> page = m_contractManager->getContractsPage(
+            PageRequest{"value", Qt::DescendingOrder, EXPORT_PAGE_SIZE, QString()});
+        count = page.items.size();
+        qDeleteAll(page.items);
+    }
+    QCOMPARE(count, EXPORT_PAGE_SIZE);
+}
+
+void BenchArchiflow::benchContractsSearch()
+{
+    int count = 0;
+    QBENCHMARK {
+        QList<Contract*> contracts = m_contractManager->searchContracts("Carthage");
+        count = contracts.size();
+        qDeleteAll(contracts);
+    }
+    QVERIFY(count > 0);
+}
+
+void BenchArchiflow::benchContractsStatistics()
+{
+    QJsonObject statistics;
+    QBENCHMARK {
+        statistics = m_contractManager->getContractStatistics();
+    }
+    QVERIFY(!statistics.isEmpty());
+}
+
+void BenchArchiflow::benchContractsMonthlyCounts()
+{
+    QJsonArray months;
+    QBENCHMARK {
+        months = m_contractManager->getMonthlyContractCounts();
+    }
+    QVERIFY(!months.isEmpty());
+}
+
+void BenchArchiflow::benchContractsExpiring()
+{
+    QBENCHMARK {
+        QList<Contract*> contracts = m_contractManager->getExpiringContracts(30);
+        qDeleteAll(contracts);
+    }
+}
+
+void BenchArchiflow::benchContractsBulkInsert()
+{
+    bool ok = false;
+    QString errorMessage;
+    QBENCHMARK {
+        // Ids must be new on every iteration
+        const int run = ++m_bulkRun;
+        QList<Contract*> contracts;
+        for (int i = 0; i < BULK_ROWS; ++i) {
+            const QDate start = BenchDataset::referenceTime().date().addDays(i % 365);
+            contracts << new Contract(QString("BULK-%1-%2").arg(run).arg(i + 1), "Bulk Client",
+                                      start, start.addYears(1), 1000.0 + i, "Draft",
+                                      "Inserted by archiflow_bench");
+        }
+        QStringList addedIds;
+        ok = m_contractManager->addContracts(contracts, addedIds, errorMessage);
+        qDeleteAll(contracts);
+    }
+    QVERIFY2(ok, qPrintable(errorMessage));
+}
+
+void BenchArchiflow::benchContractsExportCsv()
+{
+    const QList<Contract*> contracts = m_contractManager->getAllContracts();
+    ContractExportManager exporter;
+    exporter.setContracts(contracts);
+    const QString filePath = dataPath("contracts_export.csv");
+
+    bool ok = false;
+    QBENCHMARK {
+        ok = exporter.exportContracts(filePath, IContractExporter::CSV);
+    }
+    qDeleteAll(contracts);
+    QVERIFY2(ok, qPrintable(exporter.getLastError()));
+}
+
+void BenchArchiflow::benchContractsExportJson()
+{
+    const QList<Contract*> contracts = m_contractManager->getAllContracts();
+    ContractExportManager exporter;
+    exporter.setContracts(contracts);
+    const QString filePath = dataPath("contracts_export.json");
+
+    bool ok = false;
+    QBENCHMARK {
+        ok = exporter.exportContracts(filePath, IContractExporter::JSON);
+    }
+    qDeleteAll(contracts);
+    QVERIFY2(ok, qPrintable(exporter.getLastError()));
+}
+
+void BenchArchiflow::benchContractsExportPdf()
+{
+    // A PDF of everything is not a realistic report; one page of the listing is
+    Page<Contract*> page = m_contractManager->getContractsPage(PageRequest{QString(), Qt::AscendingOrder, EXPORT_PAGE_SIZE, QString()});
+    ContractExportManager exporter;
+    exporter.setContracts(page.items);
+    const QString filePath = dataPath("contracts_export.pdf");
+
+    bool ok = false;
+    QBENCHMARK {
+        ok = exporter.exportContracts(filePath, IContractExporter::PDF);
+    }
+    qDeleteAll(page.items);
+    QVERIFY2(ok, qPrintable(exporter.getLastError()));
+}
+
+// Invoices
+
+void BenchArchiflow::benchInvoicesLoad()
+{
+    int count = 0;
+    QBENCHMARK {
+        QList<Invoice*> invoices = m_invoiceManager->getAllInvoices();
+        count = invoices.size();
+        qDeleteAll(invoices);
+    }
+    QVERIFY(count >= m_counts.invoices);
+}
+
+void BenchArchiflow::benchInvoicesPage()
+{
+    int count = 0;
+    QBENCHMARK {
+        Page<Invoice*> page = m_invoiceManager->getInvoicesPage(
+            PageRequest{"total_amount", Qt::DescendingOrder, EXPORT_PAGE_SIZE, QString()});
+        count = page.items.size();
+        qDeleteAll(page.items);
+    }
+    QCOMPARE(count, EXPORT_PAGE_SIZE);
+}
+
+void BenchArchiflow::benchInvoicesSearch()
+{
+    int count = 0;
+    QBENCHMARK {
+        QList<Invoice*> invoices = m_invoiceManager->searchInvoices("Horizon");
+        count = invoices.size();
+        qDeleteAll(invoices);
+    }
+    QVERIFY(count > 0);
+}
+
+void BenchArchiflow::benchInvoicesRevenue()
+{
+    double revenue = 0.0;
+    QBENCHMARK {
+        revenue = m_invoiceManager->getTotalRevenue();
+        revenue += m_invoiceManager->getTotalRevenueByPeriod(QDate(2024, 1, 1), QDate(2024, 12, 31));
+    }
+    QVERIFY(revenue > 0.0);
+}
+
+void BenchArchiflow::benchInvoicesOverdue()
+{
+    QBENCHMARK {
+        QList<Invoice*> invoices = m_invoiceManager->getOverdueInvoices();
+        qDeleteAll(invoices);
+    }
+}
+
+void BenchArchiflow::benchInvoicePdf()
+{
+    std::unique_ptr<Invoice> invoice(m_invoiceManager->getInvoice("BENCH-I00000001"));
+    QVERIFY(invoice);
+    InvoicePDFGenerator generator;
+    const QString filePath = dataPath("invoice.pdf");
+
+    bool ok = false;
+    QBENCHMARK {
+        ok = generator.generatePDF(invoice.get(), filePath);
+    }
+    QVERIFY2(ok, qPrintable(generator.getLastError()));
+}
+
+// Clients
+
+void BenchArchiflow::benchClientsLoad()
+{
+    int count = 0;
+    QBENCHMARK {
+        QList<ClientContact*> clients = m_clientManager->getAllClients();
+        count = clients.size();
+        qDeleteAll(clients);
+    }
+    QVERIFY(count >= m_counts.clients);
+}
+
+void BenchArchiflow::benchClientsPage()
+{
+    int count = 0;
+    QBENCHMARK {
+        Page<ClientContact*> page = m_clientManager->getClientsPage(PageRequest{"company_name", Qt::AscendingOrder, EXPORT_PAGE_SIZE, QString()});
+        count = page.items.size();
+        qDeleteAll(page.items);
+    }
+    QCOMPARE(count, EXPORT_PAGE_SIZE);
+}
+
+void BenchArchiflow::benchClientsSearch()
+{
+    int count = 0;
+    QBENCHMARK {
+        QList<ClientContact*> clients = m_clientManager->searchClients("Medina");
+        count = clients.size();
+        qDeleteAll(clients);
+    }
+    QVERIFY(count > 0);
+}
+
+void BenchArchiflow::benchClientsByLocation()
+{
+    int count = 0;
+    QBENCHMARK {
+        // Within 10 km of central Tunis
+        QList<ClientContact*> clients = m_clientManager->getClientsByLocation(36.8065, 10.1815, 10.0);
+        count = clients.size();
+        qDeleteAll(clients);
+    }
+    QVERIFY(count > 0);
+}
+
+void BenchArchiflow::benchClientsCities()
+{
+    QStringList cities;
+    QBENCHMARK {
+        cities = m_clientManager->getAllCities();
+    }
+    QVERIFY(!cities.isEmpty());
+}
+
+void BenchArchiflow::benchClientsBulkInsert()
+{
+    bool ok = true;
+    QBENCHMARK {
+        const int run = ++m_bulkRun;
+        for (int i = 0; i < BULK_ROWS / 10 && ok; ++i) {
+            ClientContact client;
+            client.setId(QString("BULK-%1-%2").arg(run).arg(i + 1));
+            client.setName(QString("Bulk Client %1").arg(i + 1));
+            client.setEmail(QString("bulk%1.%2@client.example").arg(run).arg(i));
+            client.setAddressCity("Tunis");
+            client.setAddressCountry("Tunisia");
+            client.setLatitude(36.8 + i / 10000.0);
+            client.setLongitude(10.18);
+            ok = m_clientManager->addClient(&client);
+        }
+    }
+    QVERIFY2(ok, qPrintable(m_clientManager->lastError()));
+}
+
+// Employees
+
+void BenchArchiflow::benchEmployeesLoad()
+{
+    int count = 0;
+    QBENCHMARK {
+        QList<Employee*> employees = m_employeeManager->getAllEmployees();
+        count = employees.size();
+        qDeleteAll(employees);
+    }
+    QVERIFY(count >= m_counts.employees);
+}
+
+void BenchArchiflow::benchEmployeesPage()
+{
+    int count = 0;
+    QBENCHMARK {
+        Page<Employee*> page = m_employeeManager->getEmployeesPage(PageRequest{"hire_date", Qt::DescendingOrder, 10, QString()});
+        count = page.items.size();
+        qDeleteAll(page.items);
+    }
+    QCOMPARE(count, 10);
+}
+
+void BenchArchiflow::benchEmployeesSearch()
+{
+    int count = 0;
+    QBENCHMARK {
+        QList<Employee*> employees = m_employeeManager->searchEmployees("Trabelsi");
+        count = employees.size();
+        qDeleteAll(employees);
+    }
+    QVERIFY(count > 0);
+}
+
+void BenchArchiflow::benchEmployeesDepartments()
+{
+    QStringList departments;
+    int active = 0;
+    QBENCHMARK {
+        departments = m_employeeManager->getAllDepartments();
+        active = m_employeeManager->getActiveEmployeeCount();
+    }
+    QVERIFY(!departments.isEmpty());
+    QVERIFY(active > 0);
+}
+
+void BenchArchiflow::benchEmployeesBulkInsert()
+{
+    bool ok = true;
+    QBENCHMARK {
+        const int run = ++m_bulkRun;
+        for (int i = 0; i < BULK_ROWS / 10 && ok; ++i) {
+            Employee employee(QString("9%1%2").arg(run, 3, 10, QChar('0')).arg(i, 4, 10, QChar('0')),
+                              "Bulk", QString("Employee %1").arg(i + 1));
+            employee.setEmail(QString("bulk%1.%2@archiflow.example").arg(run).arg(i));
+            employee.setDepartment("Engineering");
+            employee.setHireDate(BenchDataset::referenceTime());
+            ok = m_employeeManager->addEmployee(employee);
+        }
+    }
+    QVERIFY2(ok, qPrintable(m_employeeManager->lastError()));
+}
+
+namespace {
+
+// Turns the BenchmarkResult entries of a QtTest XML log into JSON
+QJsonArray benchmarkResults(const QString &xmlPath)
+{
+    QJsonArray results;
+    QFile file(xmlPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return results;
+    }
+
+    QXmlStreamReader xml(&file);
+    QString function;
+    while (!xml.atEnd()) {
+        if (!xml.readNextStartElement()) {
+            continue;
+        }
+        if (xml.name() == QLatin1String("TestFunction")) {
+            function = xml.attributes().value("name").toString();
+        } else if (xml.name() == QLatin1String("BenchmarkResult")) {
+            const QXmlStreamAttributes attributes = xml.attributes();
+            QJsonObject result;
+            result["name"] = function;
+            result["tag"] = attributes.value("tag").toString();
+            result["metric"] = attributes.value("metric").toString();
+            result["value"] = attributes.value("value").toDouble();  // Per iteration
+            result["iterations"] = attributes.value("iterations").toInt();
+            results.append(result);
+        }
+    }
+    return results;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Exports and PDF generation need a GUI application, not a display
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    QString scaleText = qEnvironmentVariable("ARCHIFLOW_BENCH_SCALE", "10k");
+    quint32 seed = BenchDataset::DEFAULT_SEED;
+    QString jsonPath;
+    QStringList testArguments = {app.arguments().value(0)};
+
+    const QStringList arguments = app.arguments();
+    for (int i = 1; i < arguments.size(); ++i) {
+        const QString &argument = arguments.at(i);
+        if (argument == "--scale" && i + 1 < arguments.size()) {
+            scaleText = arguments.at(++i);
+        } else if (argument == "--seed" && i + 1 < arguments.size()) {
+            seed = arguments.at(++i).toUInt();
+        } else if (argument == "--json" && i + 1 < arguments.size()) {
+            jsonPath = arguments.at(++i);
+        } else {
+            testArguments << argument;
+        }
+    }
+
+    const int scale = BenchDataset::parseScale(scaleText);
+    if (scale <= 0) {
+        qCritical() << "Invalid scale" << scaleText << "- expected e.g. 10k, 100k or 1M";
+        return 2;
+    }
+    if (jsonPath.isEmpty()) {
+        jsonPath = QString("archiflow_bench_%1.json").arg(scaleText.toLower());
+    }
+
+    QTemporaryFile xmlLog;
+    if (!xmlLog.open()) {
+        qCritical() << "Cannot create the benchmark log file";
+        return 2;
+    }
+    xmlLog.close();
+    testArguments << "-o" << xmlLog.fileName() + ",xml" << "-o" << "-,txt";
+
+    BenchArchiflow bench(scale, seed);
+    const int status = QTest::qExec(&bench, testArguments);
+
+    QJsonObject report;
+    report["scale"] = scale;
+    report["seed"] = qint64(seed);
+    report["dataset"] = bench.counts().toJson();
+    report["qtVersion"] = QString::fromLatin1(qVersion());
+    report["sqliteVersion"] = bench.sqliteVersion();
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["failed"] = status;
+    report["results"] = benchmarkResults(xmlLog.fileName());
+
+    QFile json(jsonPath);
+    if (!json.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCritical() << "Cannot write" << jsonPath << "-" << json.errorString();
+        return status ? status : 2;
+    }
+    json.write(QJsonDocument(report).toJson());
+    qInfo() << "Benchmark results written to" << QFileInfo(jsonPath).absoluteFilePath();
+    return status;
+}
+
+#include "bench_archiflow.moc"
@@ -0,0 +1,595 @@
+#include "bench_dataset.h"
+#include <QRandomGenerator>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTimeZone>
+#include <QVector>
+#include <QDebug>
+
+const quint32 BenchDataset::DEFAULT_SEED = 20240601;
+const int BenchDataset::DEFAULT_SCALE = 10000;
+
+namespace {
+
+// Rows bound per execBatch call
+const int BATCH_SIZE = 5000;
+
+// Separate streams per table, so filling one table never shifts another
+enum TableSalt : quint32 {
+    MaterialsSalt = 1,
+    SuppliersSalt,
+    MovementsSalt,
+    ProjetsSalt,
+    ContractsSalt,
+    InvoiceClientsSalt,
+    InvoicesSalt,
+    ClientsSalt,
+    EmployeesSalt,
+    EventsSalt
+};
+
+const QStringList MATERIAL_KINDS = {
+    "Concrete Block", "Steel Beam", "Pine Plank", "Copper Pipe", "PVC Pipe", "Glass Panel",
+    "Roof Tile", "Insulation Roll", "Floor Tile", "Cable Spool", "Drywall Sheet", "Brick"
+};
+const QStringList MATERIAL_GRADES = {"Standard", "Premium", "Heavy Duty", "Light", "Reinforced", "Treated"};
+const QStringList MATERIAL_CATEGORIES = {
+    "Construction", "Electrical", "Plumbing", "HVAC", "Flooring", "Roofing",
+    "Insulation", "Hardware", "Tools", "Safety", "Concrete", "Steel", "Wood", "Other"
+};
+const QStringList MATERIAL_UNITS = {"pcs", "kg", "m", "l", "box", "roll", "bag", "ton"};
+const QStringList MOVEMENT_TYPES = {"in", "out", "adjustment"};
+
+const QStringList FIRST_NAMES = {
+    "Amine", "Sarra", "Youssef", "Ines", "Mehdi", "Leila", "Karim", "Nour", "Omar", "Rania",
+    "John", "Maria", "David", "Emma", "Lucas", "Chloe", "Hugo", "Lina", "Adam", "Sofia"
+};
+const QStringList LAST_NAMES = {
+    "Ben Ali", "Trabelsi", "Gharbi", "Jaziri", "Mansour", "Haddad", "Smith", "Garcia",
+    "Wilson", "Martin", "Bernard", "Dubois", "Moreau", "Laurent", "Rossi", "Müller"
+};
+const QStringList COMPANY_WORDS = {
+    "Atlas", "Horizon", "Medina", "Carthage", "Nova", "Delta", "Summit", "Cedar", "Azure", "Granite"
+};
+const QStringList COMPANY_SUFFIXES = {"Construction", "Holdings", "Développement", "Immobilier", "Group", "Partners"};
+
+struct City {
+    const char *name;
+    const char *country;
+    double latitude;
+    double longitude;
+};
+
+const City CITIES[] = {
+    {"Tunis", "Tunisia", 36.8065, 10.1815},
+    {"Sfax", "Tunisia", 34.7406, 10.7603},
+    {"Sousse", "Tunisia", 35.8256, 10.6084},
+    {"Paris", "France", 48.8566, 2.3522},
+    {"Lyon", "France", 45.7640, 4.8357},
+    {"Marseille", "France", 43.2965, 5.3698},
+    {"Milan", "Italy", 45.4642, 9.1900},
+    {"Chicago", "USA", 41.8781, -87.6298}
+};
+const int CITY_COUNT = int(sizeof(CITIES) / sizeof(CITIES[0]));
+
+const QStringList PROJET_CATEGORIES = {"residentiel", "commercial", "industriel", "institutionnel", "renovation"};
+const QStringList PROJET_STATUSES = {"en_cours", "termine", "en_attente", "annule", "suspendu"};
+const QStringList CONTRACT_STATUSES = {"Draft", "Active", "Completed", "Cancelled", "Expired"};
+const QStringList INVOICE_STATUSES = {"Draft", "Sent", "Paid", "Overdue", "Cancelled"};
+const QStringList DEPARTMENTS = {"Design", "Engineering", "Site Management", "Administration", "Procurement", "Finance"};
+const QStringList POSITIONS = {"Architect", "Structural Engineer", "Site Supervisor", "Draftsman", "Project Manager", "Accountant"};
+const QStringList EVENT_TYPES = {"check_in", "check_out", "meeting", "site_visit", "leave"};
+
+QRandomGenerator tableRandom(quint32 seed, TableSalt salt)
+{
+    return QRandomGenerator(seed * 2654435761u + salt);
+}
+
+const QString &pick(QRandomGenerator &random, const QStringList &values)
+{
+    return values.at(random.bounded(values.size()));
+}
+
+QString personName(QRandomGenerator &random)
+{
+    return pick(random, FIRST_NAMES) + " " + pick(random, LAST_NAMES);
+}
+
+QString companyName(int index)
+{
+    // Unique and reproducible without a random draw
+    return QString("%1 %2 %3")
+        .arg(COMPANY_WORDS.at(index % COMPANY_WORDS.size()),
+             COMPANY_SUFFIXES.at((index / COMPANY_WORDS.size()) % COMPANY_SUFFIXES.size()))
+        .arg(index + 1);
+}
+
+double money(QRandomGenerator &random, int minimum, int maximum)
+{
+    return (minimum * 100 + random.bounded((maximum - minimum) * 100)) / 100.0;
+}
+
+QDateTime pastTime(QRandomGenerator &random, int maxDays)
+{
+    return BenchDataset::referenceTime().addSecs(-qint64(random.bounded(maxDays * 24 * 3600)));
+}
+
+QString sqlTime(const QDateTime &time)
+{
+    return time.toString("yyyy-MM-dd hh:mm:ss");
+}
+
+} // namespace
+
+QJsonObject BenchDataset::Counts::toJson() const
+{
+    QJsonObject json;
+    json["materials"] = materials;
+    json["suppliers"] = suppliers;
+    json["material_movements"] = movements;
+    json["projets"] = projets;
+    json["contracts"] = contracts;
+    json["invoice_clients"] = invoiceClients;
+    json["invoices"] = invoices;
+    json["invoice_items"] = invoices * itemsPerInvoice;
+    json["clients"] = clients;
+    json["employees"] = employees;
+    json["employee_events"] = employees * eventsPerEmployee;
+    return json;
+}
+
+int BenchDataset::parseScale(const QString &text)
+{
+    QString value = text.trimmed().toLower();
+    int multiplier = 1;
+    if (value.endsWith('k')) {
+        multiplier = 1000;
+        value.chop(1);
+    } else if (value.endsWith('m')) {
+        multiplier = 1000000;
+        value.chop(1);
+    }
+
+    bool ok = false;
+    const int number = value.toInt(&ok);
+    if (!ok || number <= 0 || number > 100000000 / multiplier) {
+        return 0;
+    }
+    return number * multiplier;
+}
+
+BenchDataset::Counts BenchDataset::countsForScale(int scale)
+{
+    Counts counts;
+    counts.materials = scale;
+    counts.suppliers = qMax(10, scale / 100);
+    counts.movements = scale;
+    counts.projets = qMax(10, scale / 10);
+    counts.contracts = scale;
+    counts.invoiceClients = qMax(10, scale / 100);
+    counts.invoices = qMax(10, scale / 10);
+    counts.itemsPerInvoice = 5;
+    counts.clients = qMax(10, scale / 10);
+    counts.employees = qMax(10, scale / 100);
+    counts.eventsPerEmployee = 20;
+    return counts;
+}
+
+BenchDataset::BenchDataset(quint32 seed)
+    : m_seed(seed)
+    , m_connectionName("bench_dataset_connection")
+{
+}
+
+QString BenchDataset::lastError() const
+{
+    return m_lastError;
+}
+
+QDateTime BenchDataset::referenceTime()
+{
+    return QDateTime(QDate(2025, 1, 1), QTime(12, 0), QTimeZone::UTC);
+}
+
+bool BenchDataset::populateMaterials(const QString &databasePath, const Counts &counts)
+{
+    if (!open(databasePath)) {
+        return false;
+    }
+
+    // Seeded rows from the migrations come first; generated ids follow them
+    const qint64 firstSupplier = maxId("suppliers") + 1;
+    QRandomGenerator suppliers = tableRandom(m_seed, SuppliersSalt);
+    bool ok = insertRows(
+        "INSERT INTO suppliers (name, contact_person, email, phone, address, city, country, rating, status, created_at) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", 10, counts.suppliers,
+        [&](int row, QVariantList &values) {
+            const City &city = CITIES[suppliers.bounded(CITY_COUNT)];
+            values << QString("%1 Supply").arg(companyName(row))
+                   << personName(suppliers)
+                   << QString("orders%1@supplier.example").arg(row)
+                   << QString("+216-%1").arg(70000000 + row)
+                   << QString("%1 Industrial Zone").arg(1 + suppliers.bounded(200))
+                   << city.name << city.country
+                   << suppliers.bounded(6)
+                   << (suppliers.bounded(10) == 0 ? "inactive" : "active")
+                   << sqlTime(pastTime(suppliers, 1500));
+        });
+
+    const qint64 firstMaterial = maxId("materials") + 1;
+    QRandomGenerator materials = tableRandom(m_seed, MaterialsSalt);
+    ok = ok && insertRows(
+        "INSERT INTO materials (name, description, category, quantity, unit, price, supplier_id, barcode, "
+        "location, minimum_stock, maximum_stock, reorder_point, status, created_at, updated_at, created_by) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", 16, counts.materials,
+        [&](int row, QVariantList &values) {
+            const QString kind = pick(materials, MATERIAL_KINDS);
+            const QString grade = pick(materials, MATERIAL_GRADES);
+            const int minimum = 5 + materials.bounded(45);
+            const QDateTime created = pastTime(materials, 1000);
+            const int roll = materials.bounded(100);
+            values << QString("%1 %2 %3").arg(grade, kind).arg(row + 1)
+                   << QString("%1 grade %2 for general site use").arg(grade, kind.toLower())
+                   << pick(materials, MATERIAL_CATEGORIES)
+                   // About one in ten is below its minimum stock
+                   << (roll < 10 ? materials.bounded(minimum) : minimum + materials.bounded(1000))
+                   << pick(materials, MATERIAL_UNITS)
+                   << money(materials, 1, 2000)
+                   << firstSupplier + materials.bounded(counts.suppliers)
+                   << QString("BENCH%1").arg(row + 1, 9, 10, QChar('0'))
+                   << QString("Warehouse %1, Aisle %2").arg(QChar('A' + materials.bounded(6))).arg(1 + materials.bounded(40))
+                   << minimum
+                   << minimum * 20
+                   << minimum * 2
+                   << (roll >= 97 ? "discontinued" : roll >= 94 ? "inactive" : "active")
+                   << sqlTime(created)
+                   << sqlTime(created.addSecs(materials.bounded(90 * 24 * 3600)))
+                   << "bench";
+        });
+
+    QRandomGenerator movements = tableRandom(m_seed, MovementsSalt);
+    ok = ok && insertRows(
+        "INSERT INTO material_movements (material_id, movement_type, quantity, reference, notes, performed_by, movement_date) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?)", 7, counts.movements,
+        [&](int row, QVariantList &values) {
+            const QString type = pick(movements, MOVEMENT_TYPES);
+            values << firstMaterial + movements.bounded(counts.materials)
+                   << type
+                   << (type == "adjustment" ? movements.bounded(-20, 21) : 1 + movements.bounded(200))
+                   << QString("MV-%1").arg(row + 1, 8, 10, QChar('0'))
+                   << QVariant()
+                   << personName(movements)
+                   << sqlTime(pastTime(movements, 730));
+        });
+
+    QRandomGenerator projets = tableRandom(m_seed, ProjetsSalt);
+    ok = ok && insertRows(
+        "INSERT INTO projets (nom, description, categorie, statut, latitude, longitude, adresse, date_creation, "
+        "date_modification, date_debut, date_fin_estimee, budget, client, architecte, surface, etage, "
+        "materiau_principal, progression) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+        18, counts.projets,
+        [&](int row, QVariantList &values) {
+            const City &city = CITIES[projets.bounded(CITY_COUNT)];
+            const QDateTime created = pastTime(projets, 1500);
+            const QDate start = created.date().addDays(projets.bounded(90));
+            values << QString("Projet %1 %2").arg(city.name).arg(row + 1)
+                   << QString("Programme de %1 logements").arg(4 + projets.bounded(120))
+                   << pick(projets, PROJET_CATEGORIES)
+                   << pick(projets, PROJET_STATUSES)
+                   << city.latitude + (projets.bounded(2000) - 1000) / 10000.0
+                   << city.longitude + (projets.bounded(2000) - 1000) / 10000.0
+                   << QString("%1 Avenue %2, %3").arg(1 + projets.bounded(300)).arg(pick(projets, LAST_NAMES), city.name)
+                   << sqlTime(created)
+                   << sqlTime(created.addDays(projets.bounded(60)))
+                   << start
+                   << start.addDays(180 + projets.bounded(900))
+                   << money(projets, 50000, 20000000)
+                   << companyName(projets.bounded(counts.clients))
+                   << personName(projets)
+                   << 80.0 + projets.bounded(20000)
+                   << projets.bounded(15)
+                   << pick(projets, MATERIAL_KINDS)
+                   << projets.bounded(101);
+        });
+
+    return finish(ok);
+}
+
+bool BenchDataset::populateContracts(const QString &databasePath, const Counts &counts)
+{
+    if (!open(databasePath)) {
+        return false;
+    }
+
+    QRandomGenerator contracts = tableRandom(m_seed, ContractsSalt);
+    const bool ok = insertRows(
+        "INSERT INTO contracts (id, client_name, start_date, end_date, value, status, description, "
+        "payment_terms, has_non_compete_clause, created_at, updated_at) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+        11, counts.contracts,
+        [&](int row, QVariantList &values) {
+            const QDateTime created = pastTime(contracts, 1500);
+            const QDate start = created.date().addDays(contracts.bounded(60));
+            values << QString("BENCH-C%1").arg(row + 1, 8, 10, QChar('0'))
+                   << companyName(contracts.bounded(counts.clients))
+                   << start.toJulianDay()
+                   << start.addDays(30 + contracts.bounded(1100)).toJulianDay()
+                   << money(contracts, 1000, 2000000)
+                   << pick(contracts, CONTRACT_STATUSES)
+                   << QString("Architectural services for %1 project phase %2")
+                          .arg(pick(contracts, PROJET_CATEGORIES)).arg(1 + contracts.bounded(5))
+                   << 15 * (1 + contracts.bounded(6))
+                   << (contracts.bounded(4) == 0)
+                   << sqlTime(created)
+                   << sqlTime(created.addDays(contracts.bounded(30)));
+        });
+
+    return finish(ok);
+}
+
+bool BenchDataset::populateInvoices(const QString &databasePath, const Counts &counts)
+{
+    if (!open(databasePath)) {
+        return false;
+    }
+
+    auto clientId = [](int index) { return QString("BENCH-IC%1").arg(index + 1, 7, 10, QChar('0')); };
+    auto invoiceId = [](int index) { return QString("BENCH-I%1").arg(index + 1, 8, 10, QChar('0')); };
+
+    QRandomGenerator clients = tableRandom(m_seed, InvoiceClientsSalt);
+    bool ok = insertRows(
+        "INSERT INTO invoice_clients (id, name, company, address, email, phone, tax_id) VALUES (?, ?, ?, ?, ?, ?, ?)",
+        7, counts.invoiceClients,
+        [&](int row, QVariantList &values) {
+            const City &city = CITIES[clients.bounded(CITY_COUNT)];
+            values << clientId(row)
+                   << personName(clients)
+                   << companyName(row)
+                   << QString("%1 Rue %2, %3").arg(1 + clients.bounded(300)).arg(pick(clients, LAST_NAMES), city.name)
+                   << QString("billing%1@client.example").arg(row)
+                   << QString("+216-%1").arg(71000000 + row)
+                   << QString("TN%1").arg(1000000 + row);
+        });
+
+    // Item lines come from their own stream per invoice, so the invoice
+    // totals and the items agree without keeping the lines in memory
+    auto itemLine = [this](int invoice, int item, int *quantity, double *unitPrice) {
+        QRandomGenerator line(m_seed ^ (quint32(invoice) * 16777619u + quint32(item)));
+        *quantity = 1 + line.bounded(50);
+        *unitPrice = money(line, 5, 5000);
+    };
+
+    QRandomGenerator invoices = tableRandom(m_seed, InvoicesSalt);
+    ok = ok && insertRows(
+        "INSERT INTO invoices (id, invoice_number, client_id, client_name, client_address, client_email, client_phone, "
+        "invoice_date, due_date, subtotal, tax_rate, tax_amount, total_amount, status, notes, currency) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", 16, counts.invoices,
+        [&](int row, QVariantList &values) {
+            double subtotal = 0.0;
+            for (int item = 0; item < counts.itemsPerInvoice; ++item) {
+                int quantity = 0;
+                double unitPrice = 0.0;
+                itemLine(row, item, &quantity, &unitPrice);
+                subtotal += quantity * unitPrice;
+            }
+            const int client = invoices.bounded(counts.invoiceClients);
+            const QDate date = pastTime(invoices, 1100).date();
+            const double taxRate = 19.0;
+            const double tax = subtotal * taxRate / 100.0;
+            values << invoiceId(row)
+                   << QString("INV-%1-%2").arg(date.year()).arg(row + 1, 8, 10, QChar('0'))
+                   << clientId(client)
+                   << companyName(client)
+                   << QVariant() << QString("billing%1@client.example").arg(client) << QVariant()
+                   << date
+                   << date.addDays(30)
+                   << subtotal << taxRate << tax << subtotal + tax
+                   << pick(invoices, INVOICE_STATUSES)
+                   << QVariant()
+                   << (invoices.bounded(5) == 0 ? "EUR" : "TND");
+        });
+
+    ok = ok && insertRows(
+        "INSERT INTO invoice_items (id, invoice_id, description, quantity, unit, unit_price, total_price) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?)", 7, counts.invoices * counts.itemsPerInvoice,
+        [&](int row, QVariantList &values) {
+            const int invoice = row / counts.itemsPerInvoice;
+            const int item = row % counts.itemsPerInvoice;
+            int quantity = 0;
+            double unitPrice = 0.0;
+            itemLine(invoice, item, &quantity, &unitPrice);
+            values << QString("%1-%2").arg(invoiceId(invoice)).arg(item + 1)
+                   << invoiceId(invoice)
+                   << MATERIAL_KINDS.at((invoice + item) % MATERIAL_KINDS.size())
+                   << quantity
+                   << MATERIAL_UNITS.at(item % MATERIAL_UNITS.size())
+                   << unitPrice
+                   << quantity * unitPrice;
+        });
+
+    return finish(ok);
+}
+
+bool BenchDataset::populateClients(const QString &databasePath, const Counts &counts)
+{
+    if (!open(databasePath)) {
+        return false;
+    }
+
+    QRandomGenerator clients = tableRandom(m_seed, ClientsSalt);
+    const bool ok = insertRows(
+        "INSERT INTO clients (id, name, company_name, email, phone_number, address_street, address_city, "
+        "address_state, address_zipcode, address_country, latitude, longitude, notes, created_at, updated_at) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", 15, counts.clients,
+        [&](int row, QVariantList &values) {
+            const City &city = CITIES[clients.bounded(CITY_COUNT)];
+            const QDateTime created = pastTime(clients, 1500);
+            // Spread within roughly 20 km of the city centre
+            values << QString("BENCH-CL%1").arg(row + 1, 8, 10, QChar('0'))
+                   << personName(clients)
+                   << companyName(row)
+                   << QString("contact%1@client.example").arg(row)
+                   << QString("+216-%1").arg(72000000 + row)
+                   << QString("%1 Avenue %2").arg(1 + clients.bounded(300)).arg(pick(clients, LAST_NAMES))
+                   << city.name
+                   << QVariant()
+                   << QString::number(1000 + clients.bounded(9000))
+                   << city.country
+                   << city.latitude + (clients.bounded(3600) - 1800) / 10000.0
+                   << city.longitude + (clients.bounded(3600) - 1800) / 10000.0
+                   << QVariant()
+                   << sqlTime(created)
+                   << sqlTime(created.addDays(clients.bounded(120)));
+        });
+
+    return finish(ok);
+}
+
+bool BenchDataset::populateEmployees(const QString &databasePath, const Counts &counts)
+{
+    if (!open(databasePath)) {
+        return false;
+    }
+
+    auto cin = [](int index) { return QString("%1").arg(10000000 + index); };
+
+    QRandomGenerator employees = tableRandom(m_seed, EmployeesSalt);
+    bool ok = insertRows(
+        "INSERT INTO employees (cin, first_name, last_name, email, phone_number, position, role, hire_date, "
+        "status, is_present, salary, department, address, emergency_contact, emergency_phone, notes, "
+        "created_at, updated_at) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+        18, counts.employees,
+        [&](int row, QVariantList &values) {
+            const QDateTime hired = pastTime(employees, 3650);
+            values << cin(row)
+                   << pick(employees, FIRST_NAMES)
+                   << pick(employees, LAST_NAMES)
+                   << QString("employee%1@archiflow.example").arg(row)
+                   << QString("+216-%1").arg(20000000 + row)
+                   << pick(employees, POSITIONS)
+                   << employees.bounded(7)
+                   << hired.toString(Qt::ISODate)
+                   << (employees.bounded(10) == 0 ? employees.bounded(1, 4) : 0)
+                   << (employees.bounded(3) != 0)
+                   << money(employees, 1200, 9000)
+                   << pick(employees, DEPARTMENTS)
+                   << QString("%1 Rue %2").arg(1 + employees.bounded(300)).arg(pick(employees, LAST_NAMES))
+                   << personName(employees)
+                   << QString("+216-%1").arg(50000000 + row)
+                   << QVariant()
+                   << hired.toString(Qt::ISODate)
+                   << hired.toString(Qt::ISODate);
+        });
+
+    QRandomGenerator events = tableRandom(m_seed, EventsSalt);
+    ok = ok && insertRows(
+        "INSERT INTO employee_events (id, employee_cin, event_type, start_time, end_time, description, created_at) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?)", 7, counts.employees * counts.eventsPerEmployee,
+        [&](int row, QVariantList &values) {
+            const QDateTime start = pastTime(events, 365);
+            values << QString("BENCH-E%1").arg(row + 1, 9, 10, QChar('0'))
+                   << cin(row / counts.eventsPerEmployee)
+                   << pick(events, EVENT_TYPES)
+                   << start.toString(Qt::ISODate)
+                   << start.addSecs(1800 + events.bounded(8 * 3600)).toString(Qt::ISODate)
+                   << QVariant()
+                   << start.toString(Qt::ISODate);
+        });
+
+    return finish(ok);
+}
+
+bool BenchDataset::open(const QString &databasePath)
+{
+    close();
+    m_database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    m_database.setDatabaseName(databasePath);
+    if (!m_database.open()) {
+        m_lastError = QString("Failed to open %1: %2").arg(databasePath, m_database.lastError().text());
+        return false;
+    }
+
+    // The managers may hold their connections open; wait rather than fail
+    QSqlQuery pragma(m_database);
+    pragma.exec("PRAGMA busy_timeout = 10000");
+    return true;
+}
+
+bool BenchDataset::finish(bool ok)
+{
+    // Fresh statistics, as a maintained database would have them
+    if (ok) {
+        QSqlQuery analyze(m_database);
+        if (!analyze.exec("ANALYZE")) {
+            m_lastError = "Failed to analyze: " + analyze.lastError().text();
+            ok = false;
+        }
+    }
+    close();
+    return ok;
+}
+
+void BenchDataset::close()
+{
+    if (!QSqlDatabase::contains(m_connectionName)) {
+        return;
+    }
+    m_database.close();
+    m_database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+bool BenchDataset::insertRows(const QString &sql, int columnCount, int rowCount, const RowGenerator &generator)
+{
+    if (!m_database.transaction()) {
+        m_lastError = "Failed to begin transaction: " + m_database.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(m_database);
+    if (!query.prepare(sql)) {
+        m_lastError = QString("Failed to prepare %1: %2").arg(sql, query.lastError().text());
+        m_database.rollback();
+        return false;
+    }
+
+    QVariantList row;
+    for (int start = 0; start < rowCount; start += BATCH_SIZE) {
+        const int end = qMin(rowCount, start + BATCH_SIZE);
+        QVector<QVariantList> columns(columnCount);
+        for (int i = start; i < end; ++i) {
+            row.clear();
+            generator(i, row);
+            Q_ASSERT(row.size() == columnCount);
+            for (int column = 0; column < columnCount; ++column) {
+                columns[column].append(row.value(column));
+            }
+        }
+
+        for (const QVariantList &column : std::as_const(columns)) {
+            query.addBindValue(column);
+        }
+        if (!query.execBatch()) {
+            m_lastError = QString("Failed to insert rows: %1").arg(query.lastError().text());
+            query.finish();
+            m_database.rollback();
+            return false;
+        }
+    }
+    query.finish();
+
+    if (!m_database.commit()) {
+        m_lastError = "Failed to commit rows: " + m_database.lastError().text();
+        m_database.rollback();
+        return false;
+    }
+    return true;
+}
+
+qint64 BenchDataset::maxId(const QString &table)
+{
+    QSqlQuery query(m_database);
+    if (query.exec(QString("SELECT COALESCE(MAX(id), 0) FROM %1").arg(table)) && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#ifndef BENCH_DATASET_H
+#define BENCH_DATASET_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QSqlDatabase>
+#include <QJsonObject>
+#include <QDateTime>
+#include <functional>
+
+/**
+ * @brief The BenchDataset class - Deterministic synthetic data for archiflow_bench
+ *
+ * Fills the module databases with generated rows at a given scale. The same
+ * seed and scale always produce the same rows, independent of the order the
+ * tables are filled in, so benchmark runs can be compared across changes.
+ *
+ * The schemas are created by the module managers; the generator only writes
+ * rows, through a connection of its own, in large batched transactions.
+ */
+class BenchDataset
+{
+public:
+    // Row counts derived from the scale (the number of materials)
+    struct Counts {
+        int materials = 0;
+        int suppliers = 0;
+        int movements = 0;
+        int projets = 0;
+        int contracts = 0;
+        int invoiceClients = 0;
+        int invoices = 0;
+        int itemsPerInvoice = 0;
+        int clients = 0;
+        int employees = 0;
+        int eventsPerEmployee = 0;
+
+        QJsonObject toJson() const;
+    };
+
+    static const quint32 DEFAULT_SEED;
+    static const int DEFAULT_SCALE;
+
+    // "10k", "100k", "1M" or a plain number; returns 0 when invalid
+    static int parseScale(const QString &text);
+    static Counts countsForScale(int scale);
+
+    explicit BenchDataset(quint32 seed = DEFAULT_SEED);
+
+    // One file per module, as the application keeps them
+    bool populateMaterials(const QString &databasePath, const Counts &counts);  // materials, suppliers, movements, projets
+    bool populateContracts(const QString &databasePath, const Counts &counts);
+    bool populateInvoices(const QString &databasePath, const Counts &counts);   // clients, invoices with items
+    bool populateClients(const QString &databasePath, const Counts &counts);
+    bool populateEmployees(const QString &databasePath, const Counts &counts);  // employees with events
+
+    QString lastError() const;
+
+    // Fixed reference time; generated timestamps never depend on the clock
+    static QDateTime referenceTime();
+
+private:
+    using RowGenerator = std::function<void(int row, QVariantList &values)>;
+
+    bool open(const QString &databasePath);
+    bool finish(bool ok);
+    void close();
+    bool insertRows(const QString &sql, int columnCount, int rowCount, const RowGenerator &generator);
+    qint64 maxId(const QString &table);
+
+    quint32 m_seed;
+    QString m_connectionName;
+    QSqlDatabase m_database;
+    QString m_lastError;
+};
+
+#endif // BENCH_DATASET_H
@@ -1,6 +1,10 @@
 #include "application.h"
 #include "modulemanager.h"
 #include "database/databasemanager.h"
+#include "database/backupservice.h"
+#include "database/queryprofiler.h"
+#include "database/auditlogger.h"
+#include "database/maintenancescheduler.h"
 #include "utils/environmentloader.h"
 #include <QDir>
 #include <QStandardPaths>
@@ -80,7 +84,12 @@ void Application::shutdown()
     emit applicationShuttingDown();
 
     // Shutdown in reverse order
+    m_backupService.reset();
     m_moduleManager.reset();
+    // Writes the audit entries collected from the module databases
+    AuditLogger::instance()->setTarget(nullptr);
+    // Finishes the running maintenance pass before the files close
+    MaintenanceScheduler::instance()->shutdown();
     m_databaseManager.reset();
     m_settings.reset();
 
@@ -97,6 +106,11 @@ ModuleManager* Application::moduleManager() const
     return m_moduleManager.get();
 }
 
+BackupService* Application::backupService() const
+{
+    return m_backupService.get();
+}
+
 QSettings* Application::settings() const
 {
     return m_settings.get();
@@ -174,7 +188,24 @@ bool Application::setupDatabase()
     connect(m_databaseManager.get(), &DatabaseManager::error,
             this, &Application::onDatabaseError);
 
-    return m_databaseManager->initialize(databasePath());
+    // Profiling is opt-in from the Database settings page
+    QSettings userSettings;
+    QueryProfiler::instance()->setSlowQueryThreshold(
+        userSettings.value("database/slowQueryThreshold", QueryProfiler::DEFAULT_SLOW_THRESHOLD_MS).toInt());
+    QueryProfiler::instance()->setEnabled(userSettings.value("database/profilerEnabled", false).toBool());
+
+    // Every module database lives in the application data directory
+    m_backupService = std::make_unique<BackupService>(this);
+    m_backupService->addDefaultDatabases(applicationDataPath());
+
+    if (!m_databaseManager->initialize(databasePath())) {
+        return false;
+    }
+
+    // Modules attach their own tables once they have created them
+    AuditLogger::instance()->setTarget(m_databaseManager.get());
+    AuditLogger::instance()->attach(m_databaseManager->database(), "archiflow", {"materials", "suppliers"});
+    return true;
 }
 
 bool Application::setupModules()
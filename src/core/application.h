@@ -7,6 +7,7 @@
 
 class DatabaseManager;
 class ModuleManager;
+class BackupService;
 
 /**
  * @brief The Application class - Core application singleton
@@ -28,6 +29,7 @@ public:
     // Core services
     DatabaseManager* databaseManager() const;
     ModuleManager* moduleManager() const;
+    BackupService* backupService() const;
     QSettings* settings() const;
 
     // Application lifecycle
@@ -55,6 +57,7 @@ private:
 
     std::unique_ptr<DatabaseManager> m_databaseManager;
     std::unique_ptr<ModuleManager> m_moduleManager;
+    std::unique_ptr<BackupService> m_backupService;
     std::unique_ptr<QSettings> m_settings;
     
     static Application* s_instance;
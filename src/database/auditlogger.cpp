@@ -0,0 +1,569 @@
+#include "auditlogger.h"
+#include "databasemanager.h"
+#include "sqlitenative.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+#include <QDateTime>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QMutexLocker>
+#include <QtConcurrent>
+#include <QDebug>
+
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+#include <sqlite3.h>
+#endif
+
+const int AuditLogger::DEFAULT_FLUSH_INTERVAL_MS = 2000;
+const int AuditLogger::DEFAULT_RETENTION_MONTHS = 2;
+
+namespace {
+
+// json_object() takes at most 127 arguments by default
+const int MAX_JSON_COLUMNS = 60;
+
+const char *CREATE_BUFFER_SQL = R"(
+    CREATE TEMP TABLE IF NOT EXISTS audit_buffer (
+        id INTEGER PRIMARY KEY,
+        table_name TEXT NOT NULL,
+        record_id INTEGER,
+        action TEXT NOT NULL,
+        old_values TEXT,
+        new_values TEXT,
+        timestamp DATETIME DEFAULT CURRENT_TIMESTAMP
+    )
+)";
+
+const char *INSERT_AUDIT_SQL =
+    "INSERT INTO audit_log (table_name, record_id, action, old_values, new_values, timestamp) "
+    "VALUES (?, ?, ?, ?, ?, ?)";
+
+QString quoted(const QString &text, QChar quote)
+{
+    QString escaped = text;
+    escaped.replace(quote, QString(2, quote));
+    return quote + escaped + quote;
+}
+
+bool inTransaction(const QSqlDatabase &database)
+{
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    if (sqlite3 *handle = SqliteNative::handle(database)) {
+        return sqlite3_get_autocommit(handle) == 0;
+    }
+#else
+    Q_UNUSED(database)
+#endif
+    return false;
+}
+
+} // namespace
+
+AuditLogger *AuditLogger::instance()
+{
+    static AuditLogger logger;
+    return &logger;
+}
+
+AuditLogger::AuditLogger(QObject *parent)
+    : QObject(parent)
+    , m_target(nullptr)
+    , m_writeScheduled(false)
+    , m_retentionMonths(DEFAULT_RETENTION_MONTHS)
+    , m_flushTimer(new QTimer(this))
+{
+    // One writer keeps audit_log inserts in order and its connection warm
+    m_writerPool.setMaxThreadCount(1);
+    m_writerPool.setExpiryTimeout(-1);
+
+    m_flushTimer->setInterval(DEFAULT_FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &AuditLogger::flush);
+
+    // The timer collects GUI-thread connections
+    if (QCoreApplication::instance()) {
+        moveToThread(QCoreApplication::instance()->thread());
+    }
+}
+
+AuditLogger::~AuditLogger()
+{
+    m_writerPool.waitForDone();
+}
+
+void AuditLogger::setTarget(DatabaseManager *target)
+{
+    if (target == this->target()) {
+        return;
+    }
+
+    if (this->target()) {
+        // Write out what the previous target still owes
+        flush();
+        waitForWrites();
+        m_flushTimer->stop();
+
+        QMutexLocker locker(&m_mutex);
+        m_target = nullptr;
+        m_connections.clear();
+        m_auditedTables.clear();
+    }
+
+    if (!target) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_target = target;
+    }
+
+    m_flushTimer->start();
+    archiveOldEntries();
+}
+
+DatabaseManager *AuditLogger::target() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_target;
+}
+
+bool AuditLogger::attach(const QSqlDatabase &database, const QString &databaseName, const QStringList &tables)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_target || !database.isOpen()) {
+        return false;
+    }
+
+    QStringList &audited = m_auditedTables[databaseName];
+    for (const QString &table : tables) {
+        if (!audited.contains(table)) {
+            audited.append(table);
+        }
+    }
+
+    const QString connectionName = database.connectionName();
+    if (!m_connections.contains(connectionName)) {
+        QSqlQuery query(database);
+        // The buffer lives in memory and relies on JSON1 for row images
+        if (!query.exec("SELECT json_object('check', 1)")) {
+            qWarning() << "AuditLogger: JSON functions unavailable, not auditing" << connectionName;
+            return false;
+        }
+        query.exec("PRAGMA temp_store = MEMORY");
+        if (!query.exec(CREATE_BUFFER_SQL)) {
+            qWarning() << "AuditLogger: failed to create buffer:" << query.lastError().text();
+            return false;
+        }
+        m_connections.insert(connectionName, {databaseName, QThread::currentThread(), {}});
+    }
+
+    ConnectionState &state = m_connections[connectionName];
+    if (!installTriggers(database, state, audited)) {
+        return false;
+    }
+
+    for (const QString &table : tables) {
+        if (!state.installedTables.contains(table)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AuditLogger::detach(const QString &connectionName)
+{
+    QThread *owner = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_connections.constFind(connectionName);
+        if (it == m_connections.constEnd()) {
+            return;
+        }
+        owner = it->thread;
+    }
+
+    // Entries left in the buffer go with the connection otherwise
+    if (owner == QThread::currentThread()) {
+        QSqlDatabase database = QSqlDatabase::database(connectionName, false);
+        if (database.isOpen()) {
+            collect(database);
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_connections.remove(connectionName);
+    }
+    scheduleWrite();
+}
+
+bool AuditLogger::isAttached(const QString &connectionName) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_connections.contains(connectionName);
+}
+
+int AuditLogger::collect(const QSqlDatabase &database)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_connections.find(database.connectionName());
+        if (it == m_connections.end() || it->thread != QThread::currentThread()) {
+            return 0;
+        }
+
+        // Tables registered after this connection was attached
+        installTriggers(database, *it, m_auditedTables.value(it->databaseName));
+    }
+
+    if (inTransaction(database)) {
+        return 0;
+    }
+
+    QSqlQuery query(database);
+    if (!query.exec("SELECT id, table_name, record_id, action, old_values, new_values, timestamp "
+                    "FROM temp.audit_buffer ORDER BY id")) {
+        qWarning() << "AuditLogger: failed to read buffer:" << query.lastError().text();
+        return 0;
+    }
+
+    QList<Entry> entries;
+    qint64 lastId = 0;
+    while (query.next()) {
+        lastId = query.value(0).toLongLong();
+        entries.append({query.value(1).toString(), query.value(2).toLongLong(), query.value(3).toString(),
+                        query.value(4).toString(), query.value(5).toString(), query.value(6).toString()});
+    }
+    query.finish();
+
+    if (entries.isEmpty()) {
+        return 0;
+    }
+
+    // Only hand entries over once they are gone from the buffer, so a
+    // failure here can never write them twice
+    QSqlQuery clear(database);
+    clear.prepare("DELETE FROM temp.audit_buffer WHERE id <= ?");
+    clear.addBindValue(lastId);
+    if (!clear.exec()) {
+        qWarning() << "AuditLogger: failed to clear buffer:" << clear.lastError().text();
+        return 0;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending.append(entries);
+    }
+    scheduleWrite();
+    return entries.size();
+}
+
+void AuditLogger::flush()
+{
+    QStringList connectionNames;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_connections.cbegin(); it != m_connections.cend(); ++it) {
+            if (it->thread == QThread::currentThread()) {
+                connectionNames.append(it.key());
+            }
+        }
+    }
+
+    for (const QString &connectionName : connectionNames) {
+        QSqlDatabase database = QSqlDatabase::database(connectionName, false);
+        if (database.isOpen()) {
+            collect(database);
+        }
+    }
+
+    scheduleWrite();
+}
+
+void AuditLogger::waitForWrites()
+{
+    m_writerPool.waitForDone();
+}
+
+int AuditLogger::pendingCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pending.size();
+}
+
+void AuditLogger::setFlushInterval(int milliseconds)
+{
+    m_flushTimer->setInterval(qMax(100, milliseconds));
+}
+
+int AuditLogger::flushInterval() const
+{
+    return m_flushTimer->interval();
+}
+
+void AuditLogger::setRetentionMonths(int months)
+{
+    QMutexLocker locker(&m_mutex);
+    m_retentionMonths = qMax(1, months);
+}
+
+int AuditLogger::retentionMonths() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_retentionMonths;
+}
+
+QFuture<int> AuditLogger::archiveOldEntries()
+{
+    return QtConcurrent::run(&m_writerPool, [this]() {
+        const QDate today = QDateTime::currentDateTimeUtc().date();
+        const QDate month(today.year(), today.month(), 1);
+        {
+            QMutexLocker locker(&m_mutex);
+            m_archivedMonth = month;
+        }
+        return archiveEntries(archiveCutoff(month));
+    });
+}
+
+QDate AuditLogger::archiveCutoff(const QDate &currentMonth) const
+{
+    // The current month counts as the first one kept
+    return currentMonth.addMonths(1 - retentionMonths());
+}
+
+QString AuditLogger::archiveTableName(const QDate &month)
+{
+    return QString("audit_log_%1").arg(month.toString("yyyyMM"));
+}
+
+bool AuditLogger::installTriggers(const QSqlDatabase &database, ConnectionState &state, const QStringList &tables)
+{
+    bool success = true;
+
+    for (const QString &table : tables) {
+        if (state.installedTables.contains(table)) {
+            continue;
+        }
+
+        const QString newValues = rowJson(database, table, "new");
+        const QString oldValues = rowJson(database, table, "old");
+        if (newValues.isEmpty()) {
+            // Not created yet; collect() retries once it exists
+            success = false;
+            continue;
+        }
+
+        const QString name = quoted(table, '\'');
+        const QString trigger = QString("CREATE TEMP TRIGGER IF NOT EXISTS audit_%1_%2 AFTER %3 ON main.%4 BEGIN "
+                                        "INSERT INTO audit_buffer (table_name, record_id, action, old_values, new_values) "
+                                        "VALUES (%5, %6.rowid, '%3', %7, %8); END");
+        const QStringList statements = {
+            trigger.arg(table, "ai", "INSERT", quoted(table, '"'), name, "new", "NULL", newValues),
+            trigger.arg(table, "au", "UPDATE", quoted(table, '"'), name, "new", oldValues, newValues),
+            trigger.arg(table, "ad", "DELETE", quoted(table, '"'), name, "old", oldValues, "NULL")
+        };
+
+        QSqlQuery query(database);
+        bool installed = true;
+        for (const QString &statement : statements) {
+            if (!query.exec(statement)) {
+                qWarning() << "AuditLogger: failed to audit" << table << query.lastError().text();
+                installed = false;
+                break;
+            }
+        }
+
+        if (installed) {
+            state.installedTables.insert(table);
+        }
+        success = success && installed;
+    }
+
+    return success;
+}
+
+QString AuditLogger::rowJson(const QSqlDatabase &database, const QString &table, const QString &row)
+{
+    QSqlQuery query(database);
+    if (!query.exec(QString("PRAGMA main.table_info(%1)").arg(quoted(table, '"')))) {
+        return QString();
+    }
+
+    QStringList objects;
+    QStringList arguments;
+    while (query.next()) {
+        const QString column = query.value(1).toString();
+        const QString type = query.value(2).toString().toUpper();
+        QString value = QString("%1.%2").arg(row, quoted(column, '"'));
+
+        // json_object() rejects BLOBs, which would abort the audited write
+        if (type.isEmpty() || type.contains("BLOB")) {
+            value = QString("CASE typeof(%1) WHEN 'blob' THEN hex(%1) ELSE %1 END").arg(value);
+        }
+        arguments << quoted(column, '\'') << value;
+
+        if (arguments.size() == MAX_JSON_COLUMNS * 2) {
+            objects << QString("json_object(%1)").arg(arguments.join(", "));
+            arguments.clear();
+        }
+    }
+
+    if (!arguments.isEmpty()) {
+        objects << QString("json_object(%1)").arg(arguments.join(", "));
+    }
+
+    if (objects.isEmpty()) {
+        return QString();
+    }
+
+    QString json = objects.takeFirst();
+    for (const QString &object : objects) {
+        json = QString("json_patch(%1, %2)").arg(json, object);
+    }
+    return json;
+}
+
+void AuditLogger::scheduleWrite()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_target || m_pending.isEmpty() || m_writeScheduled) {
+        return;
+    }
+    m_writeScheduled = true;
+    locker.unlock();
+
+    m_writerPool.start([this]() {
+        writePending();
+    });
+}
+
+void AuditLogger::writePending()
+{
+    // Runs on the writer thread; loops until the queue is drained
+    forever {
+        QList<Entry> batch;
+        DatabaseManager *target = nullptr;
+        {
+            QMutexLocker locker(&m_mutex);
+            target = m_target;
+            if (!target || m_pending.isEmpty()) {
+                m_writeScheduled = false;
+                return;
+            }
+            batch.swap(m_pending);
+        }
+
+        QList<QVariantList> columns(6);
+        for (const Entry &entry : batch) {
+            columns[0] << entry.tableName;
+            columns[1] << entry.recordId;
+            columns[2] << entry.action;
+            columns[3] << (entry.oldValues.isEmpty() ? QVariant() : QVariant(entry.oldValues));
+            columns[4] << (entry.newValues.isEmpty() ? QVariant() : QVariant(entry.newValues));
+            columns[5] << entry.timestamp;
+        }
+
+        const BatchResult result = target->executeBatch(INSERT_AUDIT_SQL, columns);
+        if (!result.isValid()) {
+            // Keep the entries, ahead of anything collected meanwhile
+            {
+                QMutexLocker locker(&m_mutex);
+                m_pending = batch + m_pending;
+                m_writeScheduled = false;
+            }
+            qWarning() << "AuditLogger: failed to write" << batch.size() << "entries:" << result.error;
+            emit writeFailed(result.error);
+            return;
+        }
+
+        if (result.hasFailures()) {
+            qWarning() << "AuditLogger: dropped" << result.failedRows.size() << "malformed entries";
+        }
+        emit entriesWritten(result.succeededRows);
+
+        const QDate today = QDateTime::currentDateTimeUtc().date();
+        const QDate month(today.year(), today.month(), 1);
+        bool archiveDue = false;
+        {
+            QMutexLocker locker(&m_mutex);
+            archiveDue = m_archivedMonth != month;
+            m_archivedMonth = month;
+        }
+        if (archiveDue) {
+            archiveEntries(archiveCutoff(month));
+        }
+    }
+}
+
+int AuditLogger::archiveEntries(const QDate &cutoff)
+{
+    DatabaseManager *target = this->target();
+    if (!target) {
+        return 0;
+    }
+
+    // Served by idx_audit_log_timestamp
+    const DatabaseRowSet months = target->fetchRows(
+        "SELECT DISTINCT substr(timestamp, 1, 7) FROM audit_log WHERE timestamp < ?",
+        {cutoff.toString("yyyy-MM-dd")});
+    if (!months.isValid() || months.rowCount() == 0) {
+        return 0;
+    }
+
+    if (!target->beginTransaction()) {
+        return 0;
+    }
+
+    int archived = 0;
+    for (const QVariantList &row : months.rows) {
+        const QDate month = QDate::fromString(row.value(0).toString() + "-01", "yyyy-MM-dd");
+        if (!month.isValid()) {
+            continue;
+        }
+
+        const QString archive = archiveTableName(month);
+        const QVariantList range = {month.toString("yyyy-MM-dd"), month.addMonths(1).toString("yyyy-MM-dd")};
+
+        const bool created = target->executeNonQuery(QString(R"(
+            CREATE TABLE IF NOT EXISTS %1 (
+                id INTEGER PRIMARY KEY,
+                table_name TEXT NOT NULL,
+                record_id INTEGER,
+                action TEXT NOT NULL,
+                old_values TEXT,
+                new_values TEXT,
+                user_id INTEGER,
+                timestamp DATETIME
+            ))").arg(archive))
+            && target->executeNonQuery(QString("CREATE INDEX IF NOT EXISTS idx_%1_table_record ON %1(table_name, record_id)")
+                                           .arg(archive));
+
+        const DatabaseRowSet moved = created
+            ? target->fetchRows(QString("INSERT INTO %1 SELECT id, table_name, record_id, action, old_values, "
+                                        "new_values, user_id, timestamp FROM audit_log "
+                                        "WHERE timestamp >= ? AND timestamp < ?").arg(archive), range)
+            : DatabaseRowSet();
+
+        if (!created || !moved.isValid()
+            || !target->executeNonQuery("DELETE FROM audit_log WHERE timestamp >= ? AND timestamp < ?", range)) {
+            qWarning() << "AuditLogger: failed to archive into" << archive << target->lastError();
+            target->rollbackTransaction();
+            return 0;
+        }
+
+        archived += qMax(0, moved.numRowsAffected);
+    }
+
+    if (!target->commitTransaction()) {
+        target->rollbackTransaction();
+        return 0;
+    }
+
+    if (archived > 0) {
+        qDebug() << "AuditLogger: archived" << archived << "entries older than" << cutoff;
+        emit entriesArchived(archived);
+    }
+    return archived;
+}
@@ -0,0 +1,131 @@
+#ifndef AUDITLOGGER_H
+#define AUDITLOGGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QDate>
+#include <QMutex>
+#include <QThreadPool>
+#include <QFuture>
+#include <QSqlDatabase>
+
+class DatabaseManager;
+class QThread;
+class QTimer;
+
+/**
+ * @brief The AuditLogger class - Asynchronous audit trail for business tables
+ *
+ * attach() installs TEMP triggers on a connection that copy every inserted,
+ * updated and deleted row (old and new values as JSON) into an in-memory
+ * audit_buffer table of that connection. The trigger writes join the
+ * caller's transaction, so rolled back changes are never audited, and no
+ * extra page of any database file is written while saving.
+ *
+ * The buffers are collected periodically on the GUI thread; pooled
+ * connections are collected after each asynchronous DatabaseManager write
+ * and batch, and before their thread releases them. Collected entries
+ * are written to audit_log in archiflow.db in batched transactions on a
+ * dedicated writer thread. Entries that could not be written are kept and
+ * retried with the next flush.
+ *
+ * Entries older than the retention period move into monthly archive tables
+ * (audit_log_YYYYMM), checked once at start-up and again whenever the month
+ * changes, so audit_log only holds recent history.
+ *
+ * Nothing is captured until setTarget() names the database that receives the
+ * trail. A buffer collected while its connection holds an open transaction
+ * would include uncommitted rows, so callers keep transactions within one
+ * event-loop turn, as every module manager does.
+ */
+class AuditLogger : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry {
+        QString tableName;
+        qint64 recordId;        // rowid of the audited row
+        QString action;         // INSERT, UPDATE or DELETE
+        QString oldValues;      // JSON object, empty for inserts
+        QString newValues;      // JSON object, empty for deletes
+        QString timestamp;      // UTC, as CURRENT_TIMESTAMP
+    };
+
+    static const int DEFAULT_FLUSH_INTERVAL_MS;
+    static const int DEFAULT_RETENTION_MONTHS;
+
+    static AuditLogger *instance();
+
+    // Database receiving audit_log; nullptr writes what is pending and stops capture
+    void setTarget(DatabaseManager *target);
+    DatabaseManager *target() const;
+
+    // Audits the given tables of the connection's main database. Tables listed
+    // for a databaseName are remembered, so attaching another connection to
+    // the same database (e.g. a pooled one) may pass an empty list. Returns
+    // false when a listed table could not be audited; call from the
+    // connection's thread.
+    bool attach(const QSqlDatabase &database, const QString &databaseName,
+                const QStringList &tables = QStringList());
+    void detach(const QString &connectionName);
+    bool isAttached(const QString &connectionName) const;
+
+    // Moves a connection's buffered entries into the write queue; call from
+    // the connection's thread outside a transaction. Returns the entry count.
+    int collect(const QSqlDatabase &database);
+
+    // Collects the GUI-thread connections and starts a background write
+    void flush();
+    void waitForWrites();
+    int pendingCount() const;
+
+    void setFlushInterval(int milliseconds);
+    int flushInterval() const;
+
+    // Archiving - full months older than the retention period leave audit_log.
+    // The period counts the current month, so the default keeps it and the previous one.
+    void setRetentionMonths(int months);
+    int retentionMonths() const;
+    QFuture<int> archiveOldEntries();
+    static QString archiveTableName(const QDate &month);
+
+signals:
+    void entriesWritten(int count);
+    void entriesArchived(int count);
+    void writeFailed(const QString &errorMessage);
+
+private:
+    struct ConnectionState {
+        QString databaseName;
+        QThread *thread;
+        QSet<QString> installedTables;
+    };
+
+    explicit AuditLogger(QObject *parent = nullptr);
+    ~AuditLogger();
+
+    bool installTriggers(const QSqlDatabase &database, ConnectionState &state, const QStringList &tables);
+    static QString rowJson(const QSqlDatabase &database, const QString &table, const QString &row);
+    void scheduleWrite();
+    void writePending();
+    int archiveEntries(const QDate &cutoff);
+    QDate archiveCutoff(const QDate &currentMonth) const;
+
+    mutable QMutex m_mutex;
+    QHash<QString, ConnectionState> m_connections;
+    QHash<QString, QStringList> m_auditedTables; // databaseName -> tables
+    QList<Entry> m_pending;
+    DatabaseManager *m_target;
+    bool m_writeScheduled;
+    int m_retentionMonths;
+    QDate m_archivedMonth;  // Month whose archive run already happened
+    QThreadPool m_writerPool;
+    QTimer *m_flushTimer;
+};
+
+#endif // AUDITLOGGER_H
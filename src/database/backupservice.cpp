@@ -0,0 +1,155 @@
+#include "backupservice.h"
+#include "sqlitebackup.h"
+#include <QtConcurrent>
+#include <QPromise>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QDir>
+#include <QMutexLocker>
+#include <QDebug>
+
+BackupService::BackupService(QObject *parent)
+    : QObject(parent)
+    , m_pagesPerStep(SqliteBackup::DEFAULT_PAGES_PER_STEP)
+    , m_stepDelayMs(SqliteBackup::DEFAULT_STEP_DELAY_MS)
+{
+}
+
+BackupService::~BackupService()
+{
+    m_currentBackup.cancel();
+    m_currentBackup.waitForFinished();
+}
+
+void BackupService::addDatabase(const QString &name, const QString &filePath)
+{
+    QMutexLocker locker(&m_mutex);
+    m_databases.append({name, filePath});
+}
+
+void BackupService::addDefaultDatabases(const QString &dataDirectory)
+{
+    const QDir directory(dataDirectory);
+    addDatabase("archiflow", directory.filePath("archiflow.db"));
+    addDatabase("contracts", directory.filePath("archiflow_contracts.db"));
+    addDatabase("invoices", directory.filePath("invoices.db"));
+    addDatabase("clients", directory.filePath("clients.db"));
+    addDatabase("employees", directory.filePath("employees.db"));
+}
+
+void BackupService::clearDatabases()
+{
+    QMutexLocker locker(&m_mutex);
+    m_databases.clear();
+}
+
+QList<BackupService::DatabaseFile> BackupService::databases() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_databases;
+}
+
+void BackupService::setPagesPerStep(int pages)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pagesPerStep = qMax(1, pages);
+}
+
+int BackupService::pagesPerStep() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pagesPerStep;
+}
+
+void BackupService::setStepDelay(int milliseconds)
+{
+    QMutexLocker locker(&m_mutex);
+    m_stepDelayMs = qMax(0, milliseconds);
+}
+
+int BackupService::stepDelay() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stepDelayMs;
+}
+
+QFuture<bool> BackupService::backupAll(const QString &destinationDirectory)
+{
+    const QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+    const QDir directory(destinationDirectory);
+
+    QList<DatabaseFile> databaseFiles;
+    QStringList destinationPaths;
+    for (const DatabaseFile &database : databases()) {
+        // Modules that were never opened have no file yet
+        if (!QFileInfo::exists(database.filePath)) {
+            continue;
+        }
+        databaseFiles.append(database);
+        destinationPaths.append(directory.filePath(QString("%1_%2.db").arg(database.name, timestamp)));
+    }
+
+    return startBackup(databaseFiles, destinationPaths);
+}
+
+QFuture<bool> BackupService::backupDatabase(const QString &name, const QString &destinationPath)
+{
+    for (const DatabaseFile &database : databases()) {
+        if (database.name == name) {
+            return startBackup({database}, {destinationPath});
+        }
+    }
+
+    qWarning() << "BackupService: unknown database" << name;
+    return QtFuture::makeReadyFuture(false);
+}
+
+bool BackupService::isRunning() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_currentBackup.isRunning();
+}
+
+QFuture<bool> BackupService::startBackup(const QList<DatabaseFile> &databases, const QStringList &destinationPaths)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_currentBackup.isRunning()) {
+        qWarning() << "BackupService: a backup is already running";
+        return QtFuture::makeReadyFuture(false);
+    }
+
+    const int pagesPerStep = m_pagesPerStep;
+    const int stepDelayMs = m_stepDelayMs;
+
+    // Signals emitted from the worker are queued to this object's thread
+    m_currentBackup = QtConcurrent::run([this, databases, destinationPaths, pagesPerStep, stepDelayMs](QPromise<bool> &promise) {
+        bool allSucceeded = true;
+
+        for (int i = 0; i < databases.size() && !promise.isCanceled(); ++i) {
+            const DatabaseFile &database = databases.at(i);
+            emit backupStarted(database.name);
+
+            QString errorMessage;
+            const bool success = SqliteBackup::copy(database.filePath, destinationPaths.at(i), &errorMessage,
+                [this, &promise, &database](int pagesCopied, int totalPages) {
+                    emit backupProgress(database.name, pagesCopied, totalPages);
+                    return !promise.isCanceled();
+                },
+                pagesPerStep, stepDelayMs);
+
+            if (success) {
+                qDebug() << "Backed up" << database.name << "to" << destinationPaths.at(i);
+                emit backupCompleted(database.name, destinationPaths.at(i));
+            } else {
+                allSucceeded = false;
+                emit backupFailed(database.name, errorMessage);
+            }
+        }
+
+        allSucceeded = allSucceeded && !promise.isCanceled();
+        emit allBackupsFinished(allSucceeded);
+        promise.addResult(allSucceeded);
+    });
+
+    return m_currentBackup;
+}
@@ -0,0 +1,66 @@
+#ifndef BACKUPSERVICE_H
+#define BACKUPSERVICE_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QFuture>
+#include <QMutex>
+
+/**
+ * @brief The BackupService class - Snapshots every ArchiFlow database in the background
+ *
+ * Runs SqliteBackup for each registered database file on a worker thread
+ * and reports progress through signals, which arrive on the thread that
+ * owns the service. The application keeps reading and writing all
+ * databases while a backup is in progress.
+ */
+class BackupService : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct DatabaseFile {
+        QString name;
+        QString filePath;
+    };
+
+    explicit BackupService(QObject *parent = nullptr);
+    ~BackupService();
+
+    // Databases included in backupAll()
+    void addDatabase(const QString &name, const QString &filePath);
+    void addDefaultDatabases(const QString &dataDirectory);
+    void clearDatabases();
+    QList<DatabaseFile> databases() const;
+
+    // Tuning
+    void setPagesPerStep(int pages);
+    int pagesPerStep() const;
+    void setStepDelay(int milliseconds);
+    int stepDelay() const;
+
+    // Writes <name>_<timestamp>.db for every database into destinationDirectory.
+    // Cancel the returned future to stop after the current step.
+    QFuture<bool> backupAll(const QString &destinationDirectory);
+    QFuture<bool> backupDatabase(const QString &name, const QString &destinationPath);
+    bool isRunning() const;
+
+signals:
+    void backupStarted(const QString &databaseName);
+    void backupProgress(const QString &databaseName, int pagesCopied, int totalPages);
+    void backupCompleted(const QString &databaseName, const QString &backupPath);
+    void backupFailed(const QString &databaseName, const QString &errorMessage);
+    void allBackupsFinished(bool success);
+
+private:
+    QFuture<bool> startBackup(const QList<DatabaseFile> &databases, const QStringList &destinationPaths);
+
+    QList<DatabaseFile> m_databases;
+    int m_pagesPerStep;
+    int m_stepDelayMs;
+    QFuture<bool> m_currentBackup;
+    mutable QMutex m_mutex;
+};
+
+#endif // BACKUPSERVICE_H
@@ -0,0 +1,279 @@
+#include "changenotifier.h"
+#include "sqlitenative.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QRegularExpression>
+#include <QMutexLocker>
+#include <QDebug>
+
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+#include <sqlite3.h>
+#endif
+
+// SQLite callbacks; they run on the thread executing the statement
+struct ChangeNotifierHooks
+{
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    static void update(void *context, int operation, const char *, const char *table, sqlite3_int64 rowId)
+    {
+        auto *state = static_cast<ChangeNotifier::ConnectionState *>(context);
+        const ChangeNotifier::Operation op = operation == SQLITE_INSERT ? ChangeNotifier::Insert
+                                           : operation == SQLITE_DELETE ? ChangeNotifier::Delete
+                                                                        : ChangeNotifier::Update;
+        ChangeNotifier::instance()->recordRow(state, QString::fromUtf8(table), rowId, op);
+    }
+
+    static int commit(void *context)
+    {
+        ChangeNotifier::instance()->commitState(static_cast<ChangeNotifier::ConnectionState *>(context));
+        return 0; // Never veto the commit
+    }
+
+    static void rollback(void *context)
+    {
+        ChangeNotifier::instance()->rollbackState(static_cast<ChangeNotifier::ConnectionState *>(context));
+    }
+#endif
+};
+
+ChangeNotifier *ChangeNotifier::instance()
+{
+    static ChangeNotifier notifier;
+    return &notifier;
+}
+
+ChangeNotifier::ChangeNotifier(QObject *parent)
+    : QObject(parent)
+    , m_flushScheduled(false)
+{
+    qRegisterMetaType<ChangeNotifier::RowChange>();
+    qRegisterMetaType<ChangeNotifier::TableChange>();
+
+    // Deliver on the GUI thread no matter who asked first
+    if (QCoreApplication::instance()) {
+        moveToThread(QCoreApplication::instance()->thread());
+    }
+}
+
+ChangeNotifier::~ChangeNotifier()
+{
+    qDeleteAll(m_connections);
+}
+
+bool ChangeNotifier::attach(const QSqlDatabase &database, const QString &databaseName)
+{
+    const QString connectionName = database.connectionName();
+
+    QMutexLocker locker(&m_mutex);
+    ConnectionState *state = m_connections.value(connectionName);
+    if (!state) {
+        state = new ConnectionState;
+        state->connectionName = connectionName;
+        m_connections.insert(connectionName, state);
+    }
+    state->databaseName = databaseName;
+    state->pending.clear();
+    state->attached = true;
+    locker.unlock();
+
+    const bool nativeHooks = installHooks(database, state);
+
+    locker.relock();
+    state->nativeHooks = nativeHooks;
+    return nativeHooks;
+}
+
+void ChangeNotifier::detach(const QString &connectionName)
+{
+    QMutexLocker locker(&m_mutex);
+    if (ConnectionState *state = m_connections.value(connectionName)) {
+        // The state stays allocated; a closed connection no longer calls its hooks
+        state->attached = false;
+        state->pending.clear();
+    }
+}
+
+bool ChangeNotifier::hasNativeHooks(const QString &connectionName) const
+{
+    QMutexLocker locker(&m_mutex);
+    const ConnectionState *state = m_connections.value(connectionName);
+    return state && state->attached && state->nativeHooks;
+}
+
+void ChangeNotifier::recordStatement(const QString &connectionName, const QString &sql,
+                                     const QVariant &lastInsertId, int rowsAffected)
+{
+    static const QRegularExpression writePattern(
+        "^\\s*(INSERT|REPLACE|UPDATE|DELETE)\\s+(?:OR\\s+\\w+\\s+)?(?:INTO\\s+|FROM\\s+)?[\"'`\\[]?(\\w+)",
+        QRegularExpression::CaseInsensitiveOption);
+
+    if (rowsAffected == 0) {
+        return;
+    }
+
+    ConnectionState *state = manualState(connectionName);
+    if (!state) {
+        return;
+    }
+
+    const QRegularExpressionMatch match = writePattern.match(sql);
+    if (!match.hasMatch()) {
+        return;
+    }
+
+    const QString verb = match.captured(1).toUpper();
+    const QString table = match.captured(2);
+
+    // Only a single-row insert tells us which row changed
+    if ((verb == "INSERT" || verb == "REPLACE") && rowsAffected == 1 && lastInsertId.isValid()) {
+        recordRow(state, table, lastInsertId.toLongLong(), verb == "INSERT" ? Insert : Update);
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    state->pending[table].allRows = true;
+}
+
+void ChangeNotifier::commit(const QString &connectionName)
+{
+    if (ConnectionState *state = manualState(connectionName)) {
+        commitState(state);
+    }
+}
+
+void ChangeNotifier::rollback(const QString &connectionName)
+{
+    if (ConnectionState *state = manualState(connectionName)) {
+        rollbackState(state);
+    }
+}
+
+void ChangeNotifier::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    const QHash<QString, QHash<QString, PendingTable>> committed = std::move(m_committed);
+    m_committed.clear();
+    m_flushScheduled = false;
+    locker.unlock();
+
+    QList<TableChange> changes;
+    for (auto database = committed.cbegin(); database != committed.cend(); ++database) {
+        for (auto table = database->cbegin(); table != database->cend(); ++table) {
+            TableChange change;
+            change.databaseName = database.key();
+            change.table = table.key();
+            change.allRows = table->allRows;
+            for (auto row = table->rows.cbegin(); row != table->rows.cend(); ++row) {
+                change.rows.append({row.key(), row.value()});
+            }
+
+            // An insert that was deleted again leaves nothing to report
+            if (change.allRows || !change.rows.isEmpty()) {
+                changes.append(change);
+            }
+        }
+    }
+
+    if (changes.isEmpty()) {
+        return;
+    }
+
+    for (const TableChange &change : std::as_const(changes)) {
+        emit tableChanged(change.databaseName, change.table, change.rows, change.allRows);
+    }
+    emit changesCommitted(changes);
+}
+
+void ChangeNotifier::mergeTable(PendingTable &target, const PendingTable &source)
+{
+    target.allRows = target.allRows || source.allRows;
+    for (auto row = source.rows.cbegin(); row != source.rows.cend(); ++row) {
+        mergeOperation(target.rows, row.key(), row.value());
+    }
+}
+
+void ChangeNotifier::mergeOperation(QHash<qint64, Operation> &rows, qint64 rowId, Operation operation)
+{
+    auto existing = rows.find(rowId);
+    if (existing == rows.end()) {
+        rows.insert(rowId, operation);
+        return;
+    }
+
+    // Net effect of the earlier change followed by this one
+    if (existing.value() == Insert) {
+        if (operation == Delete) {
+            rows.erase(existing);
+        }
+        return; // Insert + Update is still an insert
+    }
+
+    if (existing.value() == Delete && operation == Insert) {
+        existing.value() = Update; // Row id reused
+        return;
+    }
+
+    existing.value() = operation;
+}
+
+ChangeNotifier::ConnectionState *ChangeNotifier::manualState(const QString &connectionName) const
+{
+    QMutexLocker locker(&m_mutex);
+    ConnectionState *state = m_connections.value(connectionName);
+    return state && state->attached && !state->nativeHooks ? state : nullptr;
+}
+
+void ChangeNotifier::recordRow(ConnectionState *state, const QString &table, qint64 rowId, Operation operation)
+{
+    QMutexLocker locker(&m_mutex);
+    if (state->attached) {
+        mergeOperation(state->pending[table].rows, rowId, operation);
+    }
+}
+
+void ChangeNotifier::commitState(ConnectionState *state)
+{
+    QMutexLocker locker(&m_mutex);
+    if (state->pending.isEmpty()) {
+        return;
+    }
+
+    QHash<QString, PendingTable> &committed = m_committed[state->databaseName];
+    for (auto table = state->pending.cbegin(); table != state->pending.cend(); ++table) {
+        mergeTable(committed[table.key()], table.value());
+    }
+    state->pending.clear();
+
+    // Everything committed before the event loop gets to flush() goes out together
+    if (!m_flushScheduled) {
+        m_flushScheduled = true;
+        QMetaObject::invokeMethod(this, &ChangeNotifier::flush, Qt::QueuedConnection);
+    }
+}
+
+void ChangeNotifier::rollbackState(ConnectionState *state)
+{
+    QMutexLocker locker(&m_mutex);
+    state->pending.clear();
+}
+
+bool ChangeNotifier::installHooks(const QSqlDatabase &database, ConnectionState *state)
+{
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    QString errorMessage;
+    sqlite3 *handle = SqliteNative::handle(database, &errorMessage);
+    if (!handle) {
+        qDebug() << "ChangeNotifier: no native hooks for" << database.connectionName() << "-" << errorMessage;
+        return false;
+    }
+
+    sqlite3_update_hook(handle, &ChangeNotifierHooks::update, state);
+    sqlite3_commit_hook(handle, &ChangeNotifierHooks::commit, state);
+    sqlite3_rollback_hook(handle, &ChangeNotifierHooks::rollback, state);
+    return true;
+#else
+    Q_UNUSED(database)
+    Q_UNUSED(state)
+    return false;
+#endif
+}
@@ -0,0 +1,115 @@
+#ifndef CHANGENOTIFIER_H
+#define CHANGENOTIFIER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <QMutex>
+#include <QSqlDatabase>
+
+/**
+ * @brief The ChangeNotifier class - Publishes committed row changes per table
+ *
+ * Collects (table, rowid, operation) events for every attached connection
+ * and publishes them once the surrounding transaction commits; rolled back
+ * changes are dropped. Repeated changes to the same row are coalesced, e.g.
+ * an insert followed by an update is reported as one insert, and all
+ * commits that land in the same event-loop turn are delivered together.
+ *
+ * Connections attached with attach() report through SQLite's update, commit
+ * and rollback hooks when the native API is usable (see SqliteNative).
+ * Otherwise the owner of the connection reports through recordStatement(),
+ * commit() and rollback(); UPDATE and DELETE statements are then reported
+ * as whole-table changes because their rowids are unknown.
+ *
+ * Changes undone by ROLLBACK TO a savepoint are still reported, so
+ * consumers may see rows that did not change but never miss one that did.
+ * Signals are emitted on the notifier's thread, the GUI thread.
+ */
+class ChangeNotifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Operation {
+        Insert,
+        Update,
+        Delete
+    };
+    Q_ENUM(Operation)
+
+    struct RowChange {
+        qint64 rowId;
+        Operation operation;
+    };
+
+    struct TableChange {
+        QString databaseName;
+        QString table;
+        QList<RowChange> rows;
+        bool allRows = false;   // Row ids unknown; treat the whole table as changed
+    };
+
+    static ChangeNotifier *instance();
+
+    // Registers a connection under the logical database name (e.g. "contracts").
+    // Returns true when native hooks were installed; call from the connection's thread.
+    bool attach(const QSqlDatabase &database, const QString &databaseName);
+    void detach(const QString &connectionName);
+    bool hasNativeHooks(const QString &connectionName) const;
+
+    // Manual reporting for connections without native hooks; ignored otherwise
+    void recordStatement(const QString &connectionName, const QString &sql,
+                         const QVariant &lastInsertId, int rowsAffected);
+    void commit(const QString &connectionName);
+    void rollback(const QString &connectionName);
+
+signals:
+    void changesCommitted(const QList<ChangeNotifier::TableChange> &changes);
+    void tableChanged(const QString &databaseName, const QString &table,
+                      const QList<ChangeNotifier::RowChange> &rows, bool allRows);
+
+private slots:
+    void flush();
+
+private:
+    struct PendingTable {
+        QHash<qint64, Operation> rows;
+        bool allRows = false;
+    };
+
+    struct ConnectionState {
+        QString connectionName;
+        QString databaseName;
+        bool nativeHooks = false;
+        bool attached = false;
+        QHash<QString, PendingTable> pending;
+    };
+
+    friend struct ChangeNotifierHooks;
+
+    explicit ChangeNotifier(QObject *parent = nullptr);
+    ~ChangeNotifier();
+
+    static void mergeTable(PendingTable &target, const PendingTable &source);
+    static void mergeOperation(QHash<qint64, Operation> &rows, qint64 rowId, Operation operation);
+
+    ConnectionState *manualState(const QString &connectionName) const;
+    void recordRow(ConnectionState *state, const QString &table, qint64 rowId, Operation operation);
+    void commitState(ConnectionState *state);
+    void rollbackState(ConnectionState *state);
+    bool installHooks(const QSqlDatabase &database, ConnectionState *state);
+
+    mutable QMutex m_mutex;
+    QHash<QString, ConnectionState *> m_connections; // Kept until destruction; hooks hold pointers
+    QHash<QString, QHash<QString, PendingTable>> m_committed; // databaseName -> table -> changes
+    bool m_flushScheduled;
+};
+
+Q_DECLARE_METATYPE(ChangeNotifier::RowChange)
+Q_DECLARE_METATYPE(ChangeNotifier::TableChange)
+
+#endif // CHANGENOTIFIER_H
@@ -0,0 +1,304 @@
+#include "connectionpool.h"
+#include "statementcache.h"
+#include "auditlogger.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QThread>
+#include <QMutexLocker>
+#include <QDebug>
+
+const int ConnectionPool::DEFAULT_BUSY_TIMEOUT_MS = 5000;
+const int ConnectionPool::MAX_IDLE_READERS = 2;
+
+ConnectionPool::ConnectionPool(const QString &connectionPrefix, QObject *parent)
+    : QObject(parent)
+    , m_connectionPrefix(connectionPrefix)
+    , m_nextConnectionId(0)
+    , m_nextReaderId(0)
+    , m_cacheGeneration(0)
+    , m_retiredCacheHits(0)
+    , m_retiredCacheMisses(0)
+{
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    closeAll();
+}
+
+void ConnectionPool::setDatabasePath(const QString &databasePath)
+{
+    QMutexLocker locker(&m_mutex);
+    m_databasePath = databasePath;
+}
+
+QString ConnectionPool::databasePath() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_databasePath;
+}
+
+QSqlDatabase ConnectionPool::connectionForCurrentThread()
+{
+    ThreadConnection *connection = threadConnection();
+    if (!connection) {
+        return QSqlDatabase();
+    }
+    return QSqlDatabase::database(connection->name, false);
+}
+
+StatementCache *ConnectionPool::statementCacheForCurrentThread()
+{
+    ThreadConnection *connection = threadConnection();
+    if (!connection) {
+        return nullptr;
+    }
+
+    // Only the owning thread touches its cache, so invalidation is applied here
+    const int generation = m_cacheGeneration.load();
+    if (connection->cacheGeneration != generation) {
+        connection->statementCache->clear();
+        connection->cacheGeneration = generation;
+    }
+    return connection->statementCache;
+}
+
+quint64 ConnectionPool::statementCacheHits() const
+{
+    QMutexLocker locker(&m_mutex);
+    quint64 hits = m_retiredCacheHits;
+    for (const ThreadConnection *connection : m_connections) {
+        hits += connection->statementCache->hits();
+    }
+    return hits;
+}
+
+quint64 ConnectionPool::statementCacheMisses() const
+{
+    QMutexLocker locker(&m_mutex);
+    quint64 misses = m_retiredCacheMisses;
+    for (const ThreadConnection *connection : m_connections) {
+        misses += connection->statementCache->misses();
+    }
+    return misses;
+}
+
+void ConnectionPool::invalidateStatementCaches()
+{
+    ++m_cacheGeneration;
+}
+
+int ConnectionPool::connectionCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_connections.size();
+}
+
+void ConnectionPool::closeAll()
+{
+    // Only safe once worker threads have stopped using their connections
+    QMutexLocker locker(&m_mutex);
+    for (ThreadConnection *connection : std::as_const(m_connections)) {
+        retireConnection(connection);
+    }
+    m_connections.clear();
+
+    for (const ReaderConnection &reader : std::as_const(m_readers)) {
+        if (reader.inUse) {
+            qWarning() << "ConnectionPool: closing reader" << reader.name << "while a session uses it";
+        }
+        removeConnection(reader.name);
+    }
+    m_readers.clear();
+}
+
+QSqlDatabase ConnectionPool::acquireReader()
+{
+    QThread *thread = QThread::currentThread();
+
+    QMutexLocker locker(&m_mutex);
+    for (ReaderConnection &reader : m_readers) {
+        if (reader.thread == thread && !reader.inUse) {
+            reader.inUse = true;
+            return QSqlDatabase::database(reader.name, false);
+        }
+    }
+
+    if (m_databasePath.isEmpty()) {
+        qWarning() << "ConnectionPool: database path not set";
+        return QSqlDatabase();
+    }
+
+    const QString name = QString("%1_reader_%2").arg(m_connectionPrefix).arg(++m_nextReaderId);
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", name);
+    database.setDatabaseName(m_databasePath);
+
+    if (!database.open()) {
+        const QString errorMessage = database.lastError().text();
+        database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+        locker.unlock();
+        qWarning() << "ConnectionPool: failed to open reader connection:" << errorMessage;
+        emit connectionError(errorMessage);
+        return QSqlDatabase();
+    }
+
+    // The journal mode is a property of the file, set by the writers
+    QSqlQuery pragma(database);
+    pragma.exec(QString("PRAGMA busy_timeout = %1").arg(DEFAULT_BUSY_TIMEOUT_MS));
+    pragma.exec("PRAGMA query_only = ON");
+
+    m_readers.append(ReaderConnection{name, thread, true});
+    watchThread(thread);
+
+    qDebug() << "ConnectionPool: opened reader" << name << "for thread" << thread;
+    return database;
+}
+
+void ConnectionPool::releaseReader(const QString &connectionName)
+{
+    QMutexLocker locker(&m_mutex);
+    int idleReaders = 0;
+    for (const ReaderConnection &reader : std::as_const(m_readers)) {
+        if (!reader.inUse) {
+            ++idleReaders;
+        }
+    }
+
+    for (int i = 0; i < m_readers.size(); ++i) {
+        ReaderConnection &reader = m_readers[i];
+        if (reader.name != connectionName) {
+            continue;
+        }
+
+        if (idleReaders < MAX_IDLE_READERS) {
+            reader.inUse = false;
+        } else {
+            m_readers.removeAt(i);
+            removeConnection(connectionName);
+        }
+        return;
+    }
+}
+
+int ConnectionPool::readerCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_readers.size();
+}
+
+QRecursiveMutex *ConnectionPool::writeMutex()
+{
+    return &m_writeMutex;
+}
+
+void ConnectionPool::configureConnection(QSqlDatabase &database, int busyTimeoutMs)
+{
+    QSqlQuery pragma(database);
+    // Only takes effect on a file without tables yet, so it must come first;
+    // lets maintenance free pages in small steps instead of a full VACUUM
+    pragma.exec("PRAGMA auto_vacuum = INCREMENTAL");
+    pragma.exec("PRAGMA foreign_keys = ON");
+    pragma.exec("PRAGMA journal_mode = WAL");
+    pragma.exec("PRAGMA synchronous = NORMAL");
+    pragma.exec(QString("PRAGMA busy_timeout = %1").arg(busyTimeoutMs));
+}
+
+ConnectionPool::ThreadConnection *ConnectionPool::threadConnection()
+{
+    QThread *thread = QThread::currentThread();
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_connections.constFind(thread);
+    if (it != m_connections.constEnd()) {
+        return it.value();
+    }
+
+    if (m_databasePath.isEmpty()) {
+        qWarning() << "ConnectionPool: database path not set";
+        return nullptr;
+    }
+
+    const QString name = QString("%1_pool_%2").arg(m_connectionPrefix).arg(++m_nextConnectionId);
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", name);
+    database.setDatabaseName(m_databasePath);
+
+    if (!database.open()) {
+        const QString errorMessage = database.lastError().text();
+        database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+        locker.unlock();
+        qWarning() << "ConnectionPool: failed to open worker connection:" << errorMessage;
+        emit connectionError(errorMessage);
+        return nullptr;
+    }
+
+    configureConnection(database);
+
+    ThreadConnection *connection = new ThreadConnection{name, new StatementCache(), m_cacheGeneration.load()};
+    m_connections.insert(thread, connection);
+    watchThread(thread);
+
+    locker.unlock();
+    qDebug() << "ConnectionPool: opened" << name << "for thread" << thread;
+    emit connectionOpened(name);
+    return connection;
+}
+
+void ConnectionPool::releaseThread(QThread *thread)
+{
+    QMutexLocker locker(&m_mutex);
+    m_watchedThreads.remove(thread);
+
+    for (int i = m_readers.size() - 1; i >= 0; --i) {
+        if (m_readers.at(i).thread == thread) {
+            removeConnection(m_readers.takeAt(i).name);
+        }
+    }
+
+    ThreadConnection *connection = m_connections.take(thread);
+    if (!connection) {
+        return;
+    }
+
+    // Audit entries its writes buffered would go down with the connection
+    AuditLogger::instance()->collect(QSqlDatabase::database(connection->name, false));
+
+    retireConnection(connection);
+}
+
+void ConnectionPool::retireConnection(ThreadConnection *connection)
+{
+    // Called with m_mutex held; the statistics outlive the connection
+    m_retiredCacheHits += connection->statementCache->hits();
+    m_retiredCacheMisses += connection->statementCache->misses();
+    delete connection->statementCache;
+    removeConnection(connection->name);
+    delete connection;
+}
+
+void ConnectionPool::watchThread(QThread *thread)
+{
+    // Called with m_mutex held
+    if (m_watchedThreads.contains(thread)) {
+        return;
+    }
+    m_watchedThreads.insert(thread);
+
+    // finished() is emitted from the exiting thread itself, which is the only
+    // thread allowed to tear its connections down.
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        releaseThread(thread);
+    }, Qt::DirectConnection);
+}
+
+void ConnectionPool::removeConnection(const QString &name)
+{
+    {
+        QSqlDatabase database = QSqlDatabase::database(name, false);
+        if (database.isOpen()) {
+            database.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(name);
+}
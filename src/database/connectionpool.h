@@ -0,0 +1,110 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QMutex>
+#include <QRecursiveMutex>
+#include <QString>
+#include <atomic>
+
+class QThread;
+class StatementCache;
+
+/**
+ * @brief The ConnectionPool class - Per-thread SQLite connections to one database file
+ *
+ * Each worker thread that touches the database gets its own QSqlDatabase
+ * connection (Qt connections may only be used from the thread that created
+ * them). Connections are opened lazily, configured for WAL with a busy
+ * timeout, and removed automatically when their thread finishes.
+ *
+ * WAL lets any number of readers run alongside one writer; the shared write
+ * mutex keeps write transactions from different threads strictly serialized
+ * so a deferred transaction never has to be upgraded against a newer snapshot.
+ *
+ * Reader connections are separate, query_only connections handed out one at
+ * a time (see ReportSession) so a long read transaction never shares a
+ * connection with the thread's regular statements. Released readers stay
+ * open for reuse by their thread, up to MAX_IDLE_READERS per pool.
+ */
+class ConnectionPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int DEFAULT_BUSY_TIMEOUT_MS;
+    static const int MAX_IDLE_READERS;
+
+    explicit ConnectionPool(const QString &connectionPrefix, QObject *parent = nullptr);
+    ~ConnectionPool();
+
+    // Configuration
+    void setDatabasePath(const QString &databasePath);
+    QString databasePath() const;
+
+    // Connection for the calling thread, opened on first use
+    QSqlDatabase connectionForCurrentThread();
+    StatementCache *statementCacheForCurrentThread();
+    int connectionCount() const;
+    void closeAll();
+
+    // Prepared statements of every thread's connection. Counters include
+    // connections already closed; invalidated caches are emptied by their
+    // own thread the next time it asks for its cache.
+    quint64 statementCacheHits() const;
+    quint64 statementCacheMisses() const;
+    void invalidateStatementCaches();
+
+    // Dedicated read-only connections, used by the calling thread only
+    QSqlDatabase acquireReader();
+    void releaseReader(const QString &connectionName);
+    int readerCount() const;
+
+    // Write serialization across threads
+    QRecursiveMutex *writeMutex();
+
+    // Applies the pragmas every ArchiFlow connection is expected to run with
+    static void configureConnection(QSqlDatabase &database, int busyTimeoutMs = DEFAULT_BUSY_TIMEOUT_MS);
+
+signals:
+    void connectionOpened(const QString &connectionName);
+    void connectionError(const QString &errorMessage);
+
+private:
+    struct ThreadConnection {
+        QString name;
+        StatementCache *statementCache;
+        int cacheGeneration;    // m_cacheGeneration the cache was last valid for
+    };
+
+    struct ReaderConnection {
+        QString name;
+        QThread *thread;
+        bool inUse;
+    };
+
+    ThreadConnection *threadConnection();
+    void releaseThread(QThread *thread);
+    void watchThread(QThread *thread);
+    void retireConnection(ThreadConnection *connection);
+    static void removeConnection(const QString &name);
+
+    QString m_connectionPrefix;
+    QString m_databasePath;
+    QHash<QThread*, ThreadConnection*> m_connections;
+    QList<ReaderConnection> m_readers;
+    QSet<QThread*> m_watchedThreads;
+    mutable QMutex m_mutex;
+    QRecursiveMutex m_writeMutex;
+    int m_nextConnectionId;
+    int m_nextReaderId;
+    std::atomic<int> m_cacheGeneration;
+    quint64 m_retiredCacheHits;
+    quint64 m_retiredCacheMisses;
+};
+
+#endif // CONNECTIONPOOL_H
@@ -0,0 +1,150 @@
+#include "csvreader.h"
+#include <QIODevice>
+
+namespace {
+
+// Bytes read from the device at a time
+const int READ_BUFFER_SIZE = 64 * 1024;
+
+const char UTF8_BOM[] = "\xEF\xBB\xBF";
+
+} // namespace
+
+CsvReader::CsvReader(QIODevice *device)
+    : m_device(device)
+    , m_position(0)
+    , m_bufferOffset(0)
+    , m_line(1)
+    , m_recordLine(0)
+    , m_started(false)
+{
+}
+
+bool CsvReader::readRecord(QStringList *fields)
+{
+    fields->clear();
+    if (hasError()) {
+        return false;
+    }
+
+    // Separators, quotes and line ends are ASCII and never part of a UTF-8
+    // sequence, so fields are split as bytes and decoded once complete
+    QByteArray field;
+    bool inQuotes = false;
+    bool fieldQuoted = false;
+    bool empty = true;
+    m_recordLine = m_line;
+
+    while (true) {
+        if (m_position >= m_buffer.size() && !fill()) {
+            if (inQuotes) {
+                m_errorString = QString("Unterminated quoted field in the record on line %1").arg(m_recordLine);
+                return false;
+            }
+            if (empty) {
+                return false;
+            }
+            fields->append(QString::fromUtf8(field));
+            return true;
+        }
+
+        const char c = m_buffer.at(m_position++);
+        empty = false;
+
+        if (inQuotes) {
+            if (c == '"') {
+                if (peek() == '"') {
+                    field += '"';
+                    ++m_position;
+                } else {
+                    inQuotes = false;
+                }
+            } else {
+                if (c == '\n') {
+                    ++m_line;
+                }
+                field += c;
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            // A quote opens a field only at its start; elsewhere it is kept as is
+            if (field.isEmpty() && !fieldQuoted) {
+                inQuotes = true;
+                fieldQuoted = true;
+            } else {
+                field += c;
+            }
+            break;
+        case ',':
+            fields->append(QString::fromUtf8(field));
+            field.clear();
+            fieldQuoted = false;
+            break;
+        case '\r':
+            if (peek() == '\n') {
+                ++m_position;
+            }
+            Q_FALLTHROUGH();
+        case '\n':
+            ++m_line;
+            fields->append(QString::fromUtf8(field));
+            return true;
+        default:
+            field += c;
+            break;
+        }
+    }
+}
+
+qint64 CsvReader::lineNumber() const
+{
+    return m_recordLine;
+}
+
+qint64 CsvReader::bytesRead() const
+{
+    return m_bufferOffset + m_position;
+}
+
+bool CsvReader::hasError() const
+{
+    return !m_errorString.isEmpty();
+}
+
+QString CsvReader::errorString() const
+{
+    return m_errorString;
+}
+
+bool CsvReader::fill()
+{
+    if (!m_device || !m_device->isReadable()) {
+        if (m_errorString.isEmpty()) {
+            m_errorString = "CSV device is not readable";
+        }
+        return false;
+    }
+
+    m_bufferOffset += m_buffer.size();
+    m_buffer = m_device->read(READ_BUFFER_SIZE);
+    m_position = 0;
+
+    if (!m_started && !m_buffer.isEmpty()) {
+        m_started = true;
+        if (m_buffer.startsWith(UTF8_BOM)) {
+            m_position = 3;
+        }
+    }
+    return !m_buffer.isEmpty();
+}
+
+int CsvReader::peek()
+{
+    if (m_position >= m_buffer.size() && !fill()) {
+        return -1;
+    }
+    return static_cast<unsigned char>(m_buffer.at(m_position));
+}
@@ -0,0 +1,47 @@
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class QIODevice;
+
+/**
+ * @brief The CsvReader class - Reads RFC 4180 CSV records from a device one at a time
+ *
+ * The counterpart of RowStreamWriter's CSV output: fields may be quoted,
+ * and quoted fields may hold separators, doubled quotes and line breaks.
+ * Lines may end in CRLF or LF, and a leading UTF-8 byte order mark is
+ * skipped. The device is read through a small buffer, so a file of any
+ * size costs the memory of one record.
+ */
+class CsvReader
+{
+public:
+    explicit CsvReader(QIODevice *device);
+
+    // Reads the next record into fields. False at the end of the input or
+    // on a malformed record; hasError() tells them apart.
+    bool readRecord(QStringList *fields);
+
+    qint64 lineNumber() const;  // line the last record started on, from 1
+    qint64 bytesRead() const;
+    bool hasError() const;
+    QString errorString() const;
+
+private:
+    bool fill();
+    int peek();
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    int m_position;
+    qint64 m_bufferOffset;      // bytes of the device before m_buffer
+    qint64 m_line;
+    qint64 m_recordLine;
+    bool m_started;
+    QString m_errorString;
+};
+
+#endif // CSVREADER_H
@@ -1,18 +1,67 @@
 #include "databasemanager.h"
 #include "migrations.h"
+#include "queryprofiler.h"
+#include "changenotifier.h"
+#include "fulltextsearch.h"
+#include "auditlogger.h"
+#include "connectionpool.h"
+#include "reportsession.h"
+#include "maintenancescheduler.h"
+#include "inventoryledger.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
 #include <QFileInfo>
 #include <QDir>
+#include <QThread>
+#include <QMutexLocker>
+#include <QSqlRecord>
+#include <QPromise>
+#include <QtConcurrent>
 
 const QString DatabaseManager::CONNECTION_NAME = "ArchiFlowDB";
+std::atomic<int> DatabaseManager::s_instanceCount(0);
+const int DatabaseManager::DEFAULT_BATCH_CHUNK_SIZE = 500;
 
 DatabaseManager::DatabaseManager(QObject *parent)
     : QObject(parent)
+    , m_connectionPool(nullptr)
     , m_connected(false)
 {
+    // The first manager keeps the historical connection name; further
+    // instances (tools, tests) get their own so they can be open side by side
+    const int instance = ++s_instanceCount;
+    m_connectionName = instance == 1 ? CONNECTION_NAME
+                                     : QString("%1_%2").arg(CONNECTION_NAME).arg(instance);
+    m_connectionPool = new ConnectionPool(m_connectionName, this);
+    
     m_migrations = std::make_unique<Migrations>(this);
+    
+    // One long-lived worker keeps its pooled connection and prepared
+    // statements warm between asynchronous calls
+    m_workerPool.setMaxThreadCount(1);
+    m_workerPool.setExpiryTimeout(-1);
+    
+    connect(m_connectionPool, &ConnectionPool::connectionError,
+            this, &DatabaseManager::error);
+    // Emitted on the worker thread that owns the new connection
+    connect(m_connectionPool, &ConnectionPool::connectionOpened, this, [](const QString &name) {
+        ChangeNotifier::instance()->attach(QSqlDatabase::database(name, false), "archiflow");
+        AuditLogger::instance()->attach(QSqlDatabase::database(name, false), "archiflow");
+    }, Qt::DirectConnection);
+    
+    // Stock checkpoints of movements logged by triggers (edits, batches,
+    // imports) are caught up in idle time, so ledger reads never write
+    connect(MaintenanceScheduler::instance(), &MaintenanceScheduler::maintenanceFinished,
+            this, [this](const MaintenanceScheduler::Report &report) {
+        if (!m_connected || report.connectionName != m_connectionName) {
+            return;
+        }
+        InventoryLedger ledger(this);
+        if (!ledger.rebuildCheckpoints()) {
+            qWarning() << "Failed to update stock checkpoints:" << ledger.lastError();
+        }
+    });
 }
 
 DatabaseManager::~DatabaseManager()
@@ -38,12 +87,32 @@ bool DatabaseManager::initialize(const QString &databasePath)
     if (!setupConnection(databasePath)) {
         return false;
     }
+    
+    // Worker threads open their own connections to the same file
+    m_connectionPool->setDatabasePath(databasePath);
 
     if (!createSchemaVersionTable()) {
         return false;
     }    if (!runMigrations()) {
         return false;
     }
+    
+    // Migration 4 leaves the index out when SQLite lacks FTS5; build it
+    // once a later SQLite has it
+    const FullTextSearch::IndexDefinition &searchIndex = Migrations::materialsSearchIndex();
+    bool hasSearchIndex = FullTextSearch::hasIndex(m_database, searchIndex);
+    if (!hasSearchIndex && FullTextSearch::isAvailable(m_database)) {
+        hasSearchIndex = FullTextSearch::createIndex(m_database, searchIndex);
+    }
+    if (hasSearchIndex) {
+        FullTextSearch::instance()->registerIndex(m_connectionName, searchIndex);
+    }
+    
+    MaintenanceScheduler::instance()->registerDatabase({
+        m_connectionName, databasePath, "archiflow",
+        {Migrations::materialsSearchIndex()},
+        Migrations::materialsPagination().planQueries()
+    });
 
     // Ensure default data is present after migrations
     if (!ensureDefaultData()) {
@@ -65,11 +134,24 @@ void DatabaseManager::close()
 
     qDebug() << "Closing database connection";
     
+    clearStatementCache();
+    ChangeNotifier::instance()->detach(m_connectionName);
+    FullTextSearch::instance()->unregisterConnection(m_connectionName);
+    AuditLogger::instance()->detach(m_connectionName);
+    MaintenanceScheduler::instance()->unregisterDatabase(m_connectionName);
+    
+    // Let queued asynchronous work finish; the worker thread exits and
+    // closes its own connection
+    m_workerPool.waitForDone();
+    m_connectionPool->closeAll();
+    
     if (m_database.isOpen()) {
         m_database.close();
     }
     
-    QSqlDatabase::removeDatabase(CONNECTION_NAME);
+    // Drop our handle first so the connection is no longer in use
+    m_database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
     m_connected = false;
     
     emit disconnected();
@@ -82,67 +164,380 @@ bool DatabaseManager::isConnected() const
 
 QSqlDatabase DatabaseManager::database() const
 {
-    return m_database;
+    if (isOwnerThread()) {
+        return m_database;
+    }
+    return m_connectionPool->connectionForCurrentThread();
+}
+
+int DatabaseManager::pooledConnectionCount() const
+{
+    return m_connectionPool->connectionCount();
 }
 
 QSqlQuery DatabaseManager::executeQuery(const QString &query, const QVariantList &params)
 {
-    QSqlQuery sqlQuery(m_database);
-    sqlQuery.prepare(query);
+    // Handed over to the caller for good; the statement is prepared again next time
+    return runStatement(query, params, nullptr);
+}
+
+CachedQuery DatabaseManager::executeCached(const QString &query, const QVariantList &params)
+{
+    bool reusable = false;
+    QSqlQuery sqlQuery = runStatement(query, params, &reusable);
+    return CachedQuery(this, query, std::move(sqlQuery), reusable);
+}
+
+QSqlQuery DatabaseManager::runStatement(const QString &query, const QVariantList &params, bool *reusable)
+{
+    if (reusable) {
+        *reusable = false;
+    }
     
-    for (const QVariant &param : params) {
-        sqlQuery.addBindValue(param);
+    QSqlDatabase connection = database();
+    StatementCache *statementCache = statementCacheForCurrentThread();
+    if (!connection.isOpen() || !statementCache) {
+        setLastError("No database connection available for this thread");
+        qWarning() << "Query:" << query;
+        return QSqlQuery(connection);
     }
     
-    if (!sqlQuery.exec()) {
-        m_lastError = sqlQuery.lastError().text();
-        qWarning() << "Query execution failed:" << m_lastError;
+    bool prepared = false;
+    QSqlQuery sqlQuery = statementCache->acquire(connection, query, &prepared);
+    
+    if (!prepared) {
+        setLastError(sqlQuery.lastError().text());
         qWarning() << "Query:" << query;
-        emit error(m_lastError);
+        return sqlQuery;
+    }
+    
+    // Bind by position so a reused statement never accumulates stale values
+    for (int i = 0; i < params.size(); ++i) {
+        sqlQuery.bindValue(i, params.at(i));
     }
     
+    if (!QueryProfiler::instance()->execute(sqlQuery, connection, "archiflow")) {
+        setLastError(sqlQuery.lastError().text());
+        qWarning() << "Query:" << query;
+    } else if (!sqlQuery.isSelect()) {
+        // Connections without native hooks report their writes by hand
+        ChangeNotifier *notifier = ChangeNotifier::instance();
+        notifier->recordStatement(connection.connectionName(), query,
+                                  sqlQuery.lastInsertId(), sqlQuery.numRowsAffected());
+        if (!inTransaction()) {
+            notifier->commit(connection.connectionName());
+        }
+    }
+    
+    if (reusable) {
+        *reusable = true;
+    }
+    return sqlQuery;
+}
+
+void DatabaseManager::releaseStatement(const QString &query, QSqlQuery &&sqlQuery, bool reusable)
+{
+    // The thread's pooled connection may be gone by now
+    StatementCache *statementCache = reusable ? statementCacheForCurrentThread() : nullptr;
+    if (statementCache) {
+        statementCache->release(query, std::move(sqlQuery));
+    } else {
+        sqlQuery.finish();
+    }
+}
+
+CachedQuery::CachedQuery(DatabaseManager *manager, const QString &sql, QSqlQuery &&query, bool reusable)
+    : m_manager(manager)
+    , m_sql(sql)
+    , m_query(std::move(query))
+    , m_reusable(reusable)
+{
+}
+
+CachedQuery::CachedQuery(CachedQuery &&other) noexcept
+    : m_manager(other.m_manager)
+    , m_sql(std::move(other.m_sql))
+    , m_query(std::move(other.m_query))
+    , m_reusable(other.m_reusable)
+{
+    other.m_manager = nullptr;
+}
+
+CachedQuery::~CachedQuery()
+{
+    if (m_manager) {
+        m_manager->releaseStatement(m_sql, std::move(m_query), m_reusable);
+    }
+}
+
+QSqlQuery DatabaseManager::executeForwardOnly(const QString &query, const QVariantList &params)
+{
+    QSqlDatabase connection = database();
+    QSqlQuery sqlQuery(connection);
+    if (!connection.isOpen()) {
+        setLastError("No database connection available for this thread");
+        return sqlQuery;
+    }
+    
+    sqlQuery.setForwardOnly(true);
+    if (!sqlQuery.prepare(query)) {
+        setLastError(sqlQuery.lastError().text());
+        qWarning() << "Query:" << query;
+        return sqlQuery;
+    }
+    
+    for (int i = 0; i < params.size(); ++i) {
+        sqlQuery.bindValue(i, params.at(i));
+    }
+    
+    if (!QueryProfiler::instance()->execute(sqlQuery, connection, "archiflow")) {
+        setLastError(sqlQuery.lastError().text());
+        qWarning() << "Query:" << query;
+    }
     return sqlQuery;
 }
 
 bool DatabaseManager::executeNonQuery(const QString &query, const QVariantList &params)
 {
-    QSqlQuery result = executeQuery(query, params);
-    return !result.lastError().isValid();
+    bool reusable = false;
+    QSqlQuery result = runStatement(query, params, &reusable);
+    // A statement that never ran, e.g. without a connection, carries no error
+    const bool success = result.isActive();
+    releaseStatement(query, std::move(result), reusable);
+    return success;
+}
+
+DatabaseRowSet DatabaseManager::fetchRows(const QString &query, const QVariantList &params)
+{
+    bool reusable = false;
+    QSqlQuery sqlQuery = runStatement(query, params, &reusable);
+    DatabaseRowSet rowSet = readRows(sqlQuery);
+    releaseStatement(query, std::move(sqlQuery), reusable);
+    return rowSet;
+}
+
+QFuture<DatabaseRowSet> DatabaseManager::executeQueryAsync(const QString &query, const QVariantList &params)
+{
+    return QtConcurrent::run(&m_workerPool, [this, query, params](QPromise<DatabaseRowSet> &promise) {
+        if (promise.isCanceled()) {
+            return;
+        }
+        
+        bool reusable = false;
+        QSqlQuery sqlQuery = runStatement(query, params, &reusable);
+        DatabaseRowSet rowSet = readRows(sqlQuery, [&promise]() {
+            return promise.isCanceled();
+        });
+        releaseStatement(query, std::move(sqlQuery), reusable);
+        
+        if (!promise.isCanceled()) {
+            promise.addResult(rowSet);
+        }
+    });
+}
+
+QFuture<bool> DatabaseManager::executeNonQueryAsync(const QString &query, const QVariantList &params)
+{
+    return QtConcurrent::run(&m_workerPool, [this, query, params]() {
+        const bool success = executeNonQuery(query, params);
+        // The worker's connection is only reachable from this thread
+        AuditLogger::instance()->collect(database());
+        return success;
+    });
+}
+
+BatchResult DatabaseManager::executeBatch(const QString &query, const QList<QVariantList> &columns, int chunkSize)
+{
+    BatchResult result;
+    
+    if (columns.isEmpty()) {
+        result.error = "Batch has no bound columns";
+        setLastError(result.error);
+        return result;
+    }
+    
+    result.totalRows = columns.first().size();
+    for (const QVariantList &column : columns) {
+        if (column.size() != result.totalRows) {
+            result.error = "Batch columns differ in length";
+            setLastError(result.error);
+            return result;
+        }
+    }
+    
+    if (result.totalRows == 0) {
+        return result;
+    }
+    
+    chunkSize = chunkSize > 0 ? chunkSize : DEFAULT_BATCH_CHUNK_SIZE;
+    
+    if (!beginTransaction()) {
+        result.error = lastError();
+        return result;
+    }
+    
+    QSqlQuery batchQuery(database());
+    if (!batchQuery.prepare(query)) {
+        result.error = batchQuery.lastError().text();
+        rollbackTransaction();
+        setLastError(result.error);
+        return result;
+    }
+    
+    for (int start = 0; start < result.totalRows; start += chunkSize) {
+        const int count = qMin(chunkSize, result.totalRows - start);
+        
+        // A failed execBatch leaves the rows before the failure applied,
+        // so each chunk can be undone on its own and replayed row by row
+        if (!executeNonQuery("SAVEPOINT batch_chunk")) {
+            result.error = lastError();
+            break;
+        }
+        
+        for (int i = 0; i < columns.size(); ++i) {
+            batchQuery.bindValue(i, columns.at(i).mid(start, count));
+        }
+        
+        if (batchQuery.execBatch()) {
+            result.succeededRows += count;
+            executeNonQuery("RELEASE SAVEPOINT batch_chunk");
+            continue;
+        }
+        
+        executeNonQuery("ROLLBACK TO SAVEPOINT batch_chunk");
+        
+        // Isolate the offending rows; a failed statement only undoes itself
+        for (int row = start; row < start + count; ++row) {
+            for (int i = 0; i < columns.size(); ++i) {
+                batchQuery.bindValue(i, columns.at(i).at(row));
+            }
+            
+            if (batchQuery.exec()) {
+                ++result.succeededRows;
+            } else {
+                result.failedRows.insert(row, batchQuery.lastError().text());
+            }
+        }
+        
+        executeNonQuery("RELEASE SAVEPOINT batch_chunk");
+    }
+    batchQuery.finish();
+    
+    if (!result.isValid()) {
+        rollbackTransaction();
+        result.succeededRows = 0;
+        return result;
+    }
+    
+    ChangeNotifier::instance()->recordStatement(database().connectionName(), query,
+                                                QVariant(), result.succeededRows);
+    
+    if (!commitTransaction()) {
+        result.error = lastError();
+        rollbackTransaction();
+        result.succeededRows = 0;
+        return result;
+    }
+    
+    // A pooled connection's audit buffer is otherwise only read when its thread ends
+    AuditLogger::instance()->collect(database());
+    
+    if (result.hasFailures()) {
+        qWarning() << "Batch completed with" << result.failedRows.size() << "failed rows out of" << result.totalRows;
+    }
+    
+    MaintenanceScheduler::instance()->noteBulkWrite(m_connectionName, result.succeededRows);
+    return result;
+}
+
+std::shared_ptr<ReportSession> DatabaseManager::beginReportSession()
+{
+    // Leaves m_lastError alone: worker threads begin sessions too, and the
+    // session carries its own error
+    return ReportSession::begin(m_connectionPool, "archiflow");
 }
 
 bool DatabaseManager::beginTransaction()
 {
-    if (!m_database.transaction()) {
-        m_lastError = m_database.lastError().text();
-        qWarning() << "Failed to begin transaction:" << m_lastError;
-        emit error(m_lastError);
+    // Held until commit or rollback so only one thread writes at a time
+    m_connectionPool->writeMutex()->lock();
+    
+    QSqlDatabase connection = database();
+    if (!connection.transaction()) {
+        m_connectionPool->writeMutex()->unlock();
+        qWarning() << "Failed to begin transaction";
+        setLastError(connection.lastError().text());
         return false;
     }
+    
+    QMutexLocker locker(&m_stateMutex);
+    ++m_writeLockDepth[QThread::currentThread()];
     return true;
 }
 
 bool DatabaseManager::commitTransaction()
 {
-    if (!m_database.commit()) {
-        m_lastError = m_database.lastError().text();
-        qWarning() << "Failed to commit transaction:" << m_lastError;
-        emit error(m_lastError);
+    QSqlDatabase connection = database();
+    if (!connection.commit()) {
+        // The transaction is still open; the caller is expected to roll back
+        qWarning() << "Failed to commit transaction";
+        setLastError(connection.lastError().text());
         return false;
     }
+    
+    releaseWriteLock();
+    ChangeNotifier::instance()->commit(connection.connectionName());
     return true;
 }
 
 bool DatabaseManager::rollbackTransaction()
 {
-    if (!m_database.rollback()) {
-        m_lastError = m_database.lastError().text();
-        qWarning() << "Failed to rollback transaction:" << m_lastError;
-        emit error(m_lastError);
+    QSqlDatabase connection = database();
+    const bool rolledBack = connection.rollback();
+    releaseWriteLock();
+    ChangeNotifier::instance()->rollback(connection.connectionName());
+    
+    if (!rolledBack) {
+        qWarning() << "Failed to rollback transaction";
+        setLastError(connection.lastError().text());
         return false;
     }
     return true;
 }
 
+bool DatabaseManager::inTransaction() const
+{
+    QMutexLocker locker(&m_stateMutex);
+    return m_writeLockDepth.value(QThread::currentThread(), 0) > 0;
+}
+
+void DatabaseManager::setStatementCacheCapacity(int capacity)
+{
+    m_statementCache.setCapacity(capacity);
+}
+
+int DatabaseManager::statementCacheCapacity() const
+{
+    return m_statementCache.capacity();
+}
+
+quint64 DatabaseManager::statementCacheHits() const
+{
+    return m_statementCache.hits() + m_connectionPool->statementCacheHits();
+}
+
+quint64 DatabaseManager::statementCacheMisses() const
+{
+    return m_statementCache.misses() + m_connectionPool->statementCacheMisses();
+}
+
+void DatabaseManager::clearStatementCache()
+{
+    m_statementCache.clear();
+    // Statements prepared by worker threads against the old schema
+    m_connectionPool->invalidateStatementCaches();
+}
+
 bool DatabaseManager::createTables()
 {
     return m_migrations->createInitialSchema();
@@ -153,14 +548,24 @@ bool DatabaseManager::runMigrations()
     return m_migrations->runMigrations();
 }
 
+Migrations *DatabaseManager::migrations() const
+{
+    return m_migrations.get();
+}
+
+QString DatabaseManager::connectionName() const
+{
+    return m_connectionName;
+}
+
 int DatabaseManager::currentSchemaVersion() const
 {
-    QSqlQuery query = const_cast<DatabaseManager*>(this)->executeQuery(
+    CachedQuery query = const_cast<DatabaseManager*>(this)->executeCached(
         "SELECT version FROM schema_version ORDER BY id DESC LIMIT 1"
     );
     
-    if (query.next()) {
-        return query.value(0).toInt();
+    if (query->next()) {
+        return query->value(0).toInt();
     }
     
     return 0;
@@ -168,6 +573,7 @@ int DatabaseManager::currentSchemaVersion() const
 
 QString DatabaseManager::lastError() const
 {
+    QMutexLocker locker(&m_stateMutex);
     return m_lastError;
 }
 
@@ -179,35 +585,32 @@ bool DatabaseManager::tableExists(const QString &tableName) const
 
 QStringList DatabaseManager::tableNames() const
 {
-    return m_database.tables();
+    return database().tables();
 }
 
 void DatabaseManager::onDatabaseError()
 {
     if (m_database.lastError().isValid()) {
-        m_lastError = m_database.lastError().text();
-        qWarning() << "Database error:" << m_lastError;
-        emit error(m_lastError);
+        setLastError(m_database.lastError().text());
     }
 }
 
 bool DatabaseManager::setupConnection(const QString &databasePath)
 {
-    m_database = QSqlDatabase::addDatabase("QSQLITE", CONNECTION_NAME);
+    m_database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
     m_database.setDatabaseName(databasePath);
     
     if (!m_database.open()) {
-        m_lastError = m_database.lastError().text();
-        qCritical() << "Failed to open database:" << m_lastError;
-        emit error(m_lastError);
+        const QString errorMessage = m_database.lastError().text();
+        qCritical() << "Failed to open database:" << errorMessage;
+        setLastError(errorMessage);
         return false;
     }
     
-    // Enable foreign key constraints
-    executeNonQuery("PRAGMA foreign_keys = ON");
-    
-    // Set journal mode for better performance
-    executeNonQuery("PRAGMA journal_mode = WAL");
+    // Foreign keys, WAL journal and a busy timeout so concurrent writers
+    // from pooled connections wait instead of failing immediately
+    ConnectionPool::configureConnection(m_database);
+    ChangeNotifier::instance()->attach(m_database, "archiflow");
     
     return true;
 }
@@ -228,12 +631,15 @@ bool DatabaseManager::createSchemaVersionTable()
 bool DatabaseManager::resetDatabase()
 {
     if (!m_connected) {
-        m_lastError = "Database not connected";
+        setLastError("Database not connected");
         return false;
     }
     
     qDebug() << "Resetting database - dropping all tables and recreating schema";
     
+    // Cached statements pin the old schema and would block DROP TABLE
+    clearStatementCache();
+    
     if (!beginTransaction()) {
         return false;
     }
@@ -321,7 +727,7 @@ bool DatabaseManager::recreateSchema()
 bool DatabaseManager::ensureDefaultData()
 {
     if (!m_connected) {
-        m_lastError = "Database not connected";
+        setLastError("Database not connected");
         return false;
     }
       qDebug() << "Ensuring default materials are present in database";
@@ -360,12 +766,88 @@ bool DatabaseManager::ensureDefaultData()
     if (success) {
         qDebug() << "Default materials inserted successfully";
     } else {
-        qDebug() << "Failed to insert default materials:" << m_lastError;
+        qDebug() << "Failed to insert default materials:" << lastError();
     }
     
     return success;
 }
 
+void DatabaseManager::setLastError(const QString &errorMessage)
+{
+    {
+        QMutexLocker locker(&m_stateMutex);
+        m_lastError = errorMessage;
+    }
+    qWarning() << "Database error:" << errorMessage;
+    emit error(errorMessage);
+}
+
+bool DatabaseManager::isOwnerThread() const
+{
+    return QThread::currentThread() == thread();
+}
+
+StatementCache *DatabaseManager::statementCacheForCurrentThread()
+{
+    if (isOwnerThread()) {
+        return &m_statementCache;
+    }
+    return m_connectionPool->statementCacheForCurrentThread();
+}
+
+void DatabaseManager::releaseWriteLock()
+{
+    QMutexLocker locker(&m_stateMutex);
+    auto it = m_writeLockDepth.find(QThread::currentThread());
+    if (it == m_writeLockDepth.end()) {
+        return;
+    }
+    
+    if (--it.value() == 0) {
+        m_writeLockDepth.erase(it);
+    }
+    m_connectionPool->writeMutex()->unlock();
+}
+
+DatabaseRowSet DatabaseManager::readRows(QSqlQuery &query, const std::function<bool()> &isCanceled)
+{
+    DatabaseRowSet rowSet;
+    
+    if (query.lastError().isValid()) {
+        rowSet.error = query.lastError().text();
+        return rowSet;
+    }
+    
+    if (!query.isActive()) {
+        rowSet.error = "Query was not executed";
+        return rowSet;
+    }
+    
+    const QSqlRecord record = query.record();
+    const int columnCount = record.count();
+    for (int i = 0; i < columnCount; ++i) {
+        rowSet.columns.append(record.fieldName(i));
+    }
+    rowSet.numRowsAffected = query.numRowsAffected();
+    rowSet.lastInsertId = query.lastInsertId();
+    
+    while (query.next()) {
+        if (isCanceled && isCanceled()) {
+            rowSet.error = "Query canceled";
+            break;
+        }
+        
+        QVariantList row;
+        row.reserve(columnCount);
+        for (int i = 0; i < columnCount; ++i) {
+            row.append(query.value(i));
+        }
+        rowSet.rows.append(row);
+    }
+    
+    return rowSet;
+}
+
 void DatabaseManager::setSchemaVersion(int version)
 {
     executeNonQuery("INSERT INTO schema_version (version) VALUES (?)", {version});
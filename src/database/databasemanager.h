@@ -6,20 +6,95 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QMap>
+#include <QThreadPool>
+#include <QFuture>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include "statementcache.h"
+#include "../interfaces/idatabasemanager.h"
 
 class Migrations;
+class DatabaseManager;
+class ConnectionPool;
+class ReportSession;
+class QThread;
+
+/**
+ * @brief Outcome of DatabaseManager::executeBatch
+ *
+ * Row indices refer to positions in the bound column lists. A batch with
+ * failed rows still commits every row that succeeded; error is only set
+ * when the batch as a whole could not run.
+ */
+struct BatchResult
+{
+    int totalRows = 0;
+    int succeededRows = 0;
+    QMap<int, QString> failedRows;
+    QString error;
+
+    bool isValid() const { return error.isEmpty(); }
+    bool hasFailures() const { return !failedRows.isEmpty(); }
+};
+
+/**
+ * @brief A statement checked out of the prepared-statement cache
+ *
+ * Returned by DatabaseManager::executeCached() and used like a pointer to
+ * the QSqlQuery. When it goes out of scope the statement is reset and
+ * handed back to the cache of the calling thread's connection, so keep it
+ * local to the thread that ran it.
+ */
+class CachedQuery
+{
+public:
+    CachedQuery(CachedQuery &&other) noexcept;
+    ~CachedQuery();
+
+    CachedQuery(const CachedQuery &) = delete;
+    CachedQuery &operator=(const CachedQuery &) = delete;
+    CachedQuery &operator=(CachedQuery &&) = delete;
+
+    QSqlQuery &operator*() { return m_query; }
+    QSqlQuery *operator->() { return &m_query; }
+
+private:
+    friend class DatabaseManager;
+    CachedQuery(DatabaseManager *manager, const QString &sql, QSqlQuery &&query, bool reusable);
+
+    DatabaseManager *m_manager;     // null once moved from
+    QString m_sql;
+    QSqlQuery m_query;
+    bool m_reusable;
+};
 
 /**
  * @brief The DatabaseManager class - Manages SQLite database operations
  * 
  * This class handles database connection, initialization, schema management,
  * and provides a centralized interface for all database operations.
+ *
+ * Query and transaction methods may be called from any thread: the thread
+ * that owns the manager uses the primary connection, every other thread is
+ * transparently given its own pooled connection to the same file. Write
+ * transactions are serialized across threads.
+ *
+ * The *Async methods run on a single dedicated worker thread and return a
+ * QFuture; attach continuations with QFuture::then(context, ...) to receive
+ * the result on the GUI thread. Never block on such a future while holding
+ * a transaction.
  */
 class DatabaseManager : public QObject
 {
     Q_OBJECT
 
 public:
+    static const int DEFAULT_BATCH_CHUNK_SIZE;
+
     explicit DatabaseManager(QObject *parent = nullptr);
     ~DatabaseManager();
 
@@ -29,21 +104,61 @@ public:
 
     // Connection management
     bool isConnected() const;
-    QSqlDatabase database() const;
+    QSqlDatabase database() const; // Connection for the calling thread
+    int pooledConnectionCount() const;
 
     // Query execution
+    // executeNonQuery(), fetchRows() and executeCached() reuse statements
+    // from a per-connection prepared-statement cache; executeQuery() hands
+    // the caller a statement of its own, which is not returned to the cache.
+    // Prefer executeCached() on hot paths. A query that could not run, for
+    // instance without a connection, is returned inactive.
     QSqlQuery executeQuery(const QString &query, const QVariantList &params = QVariantList());
+    CachedQuery executeCached(const QString &query, const QVariantList &params = QVariantList());
     bool executeNonQuery(const QString &query, const QVariantList &params = QVariantList());
+    DatabaseRowSet fetchRows(const QString &query, const QVariantList &params = QVariantList());
+    static DatabaseRowSet readRows(QSqlQuery &query, const std::function<bool()> &isCanceled = {});
+    
+    // Forward-only cursor prepared outside the statement cache, for reading
+    // large results row by row; rows already read are not kept. finish() it
+    // when done so it does not hold a read transaction open.
+    QSqlQuery executeForwardOnly(const QString &query, const QVariantList &params = QVariantList());
+
+    // Bulk writes - columns holds one QVariantList per placeholder, all of
+    // equal length. Runs in its own transaction, one savepoint per chunk.
+    BatchResult executeBatch(const QString &query, const QList<QVariantList> &columns,
+                             int chunkSize = DEFAULT_BATCH_CHUNK_SIZE);
+
+    // Asynchronous query execution
+    QFuture<DatabaseRowSet> executeQueryAsync(const QString &query, const QVariantList &params = QVariantList());
+    QFuture<bool> executeNonQueryAsync(const QString &query, const QVariantList &params = QVariantList());
+
+    // Read-only snapshot for multi-query reports; end it before close().
+    // Callable from any thread; a failure is in the session's lastError().
+    std::shared_ptr<ReportSession> beginReportSession();
 
     // Transaction management
     bool beginTransaction();
     bool commitTransaction();
     bool rollbackTransaction();
+    bool inTransaction() const; // True while the calling thread holds a transaction
+
+    // Prepared-statement cache; the statistics and clear cover every
+    // thread's connection
+    void setStatementCacheCapacity(int capacity);
+    int statementCacheCapacity() const;
+    quint64 statementCacheHits() const;
+    quint64 statementCacheMisses() const;
+    void clearStatementCache();
 
     // Schema management
     bool createTables();
     bool runMigrations();
-    int currentSchemaVersion() const;    // Utility methods
+    int currentSchemaVersion() const;
+    Migrations *migrations() const;
+    QString connectionName() const;
+
+    // Utility methods
     QString lastError() const;
     bool tableExists(const QString &tableName) const;
     QStringList tableNames() const;
@@ -62,16 +177,31 @@ private slots:
     void onDatabaseError();
 
 private:
+    friend class CachedQuery;
+
     bool setupConnection(const QString &databasePath);
     bool createSchemaVersionTable();
     void setSchemaVersion(int version);
+    QSqlQuery runStatement(const QString &query, const QVariantList &params, bool *reusable);
+    void releaseStatement(const QString &query, QSqlQuery &&sqlQuery, bool reusable);
+    void setLastError(const QString &errorMessage);
+    bool isOwnerThread() const;
+    StatementCache *statementCacheForCurrentThread();
+    void releaseWriteLock();
 
     QSqlDatabase m_database;
     std::unique_ptr<Migrations> m_migrations;
+    StatementCache m_statementCache;
+    ConnectionPool *m_connectionPool;
     QString m_lastError;
+    QHash<QThread*, int> m_writeLockDepth;
+    mutable QMutex m_stateMutex;
     bool m_connected;
+    QThreadPool m_workerPool;
+    QString m_connectionName;
 
     static const QString CONNECTION_NAME;
+    static std::atomic<int> s_instanceCount;
 };
 
 #endif // DATABASEMANAGER_H
@@ -1,6 +1,12 @@
 #include "databaseservice.h"
 #include "databasemanager.h"
+#include "sqlitebackup.h"
+#include "migrations.h"
+#include "fulltextsearch.h"
+#include "inventoryledger.h"
+#include "reportsession.h"
 #include "../features/materials/materialmodel.h"
+#include "../features/materials/materialcsvimporter.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -10,16 +16,30 @@
 #include <QDebug>
 #include <QDateTime>
 #include <QFileInfo>
+#include <QBuffer>
+#include <QtConcurrent>
+
+// Every column, rows in the order the materials list shows them
+static const QString MATERIALS_EXPORT_SQL = "SELECT * FROM materials ORDER BY name, id";
+
+// Materials at or below their reorder point, the most urgent first; served
+// by idx_materials_low_stock
+static const QString LOW_STOCK_SQL =
+    "SELECT * FROM materials WHERE quantity <= reorder_point ORDER BY reorder_point - quantity DESC, id";
 
 DatabaseService::DatabaseService(QObject *parent)
     : QObject(parent)
     , m_dbManager(nullptr)
     , m_materialModel(nullptr)
+    , m_lastExportRowCount(0)
 {
 }
 
 DatabaseService::~DatabaseService()
 {
+    // The worker emits through this object until it returns
+    cancelGuardedQuery();
+    m_guardedFuture.waitForFinished();
 }
 
 void DatabaseService::setDatabaseManager(DatabaseManager *dbManager)
@@ -82,14 +102,26 @@ QJsonArray DatabaseService::searchMaterials(const QString &query)
         return result;
     }
     
-    QString searchQuery = QString(
-        "SELECT * FROM materials WHERE "
-        "name LIKE ? OR description LIKE ? OR category LIKE ? OR barcode LIKE ? "
-        "ORDER BY name"
-    );
+    QString searchQuery;
+    QVariantList params;
     
-    QString searchTerm = QString("%%1%").arg(query);
-    QVariantList params = {searchTerm, searchTerm, searchTerm, searchTerm};
+    const FullTextSearch::IndexDefinition &searchIndex = Migrations::materialsSearchIndex();
+    const QString matchExpression = FullTextSearch::matchExpression(query);
+    if (!matchExpression.isEmpty()
+        && FullTextSearch::instance()->isRegistered(m_dbManager->connectionName(), searchIndex.table)) {
+        // Ranked by relevance
+        searchQuery = FullTextSearch::searchSql(searchIndex);
+        params = {matchExpression};
+    } else {
+        searchQuery = QString(
+            "SELECT * FROM materials WHERE "
+            "name LIKE ? OR description LIKE ? OR category LIKE ? OR barcode LIKE ? "
+            "ORDER BY name"
+        );
+        
+        QString searchTerm = QString("%%1%").arg(query);
+        params = {searchTerm, searchTerm, searchTerm, searchTerm};
+    }
     
     QSqlQuery sqlQuery = m_dbManager->executeQuery(searchQuery, params);    
     while (sqlQuery.next()) {
@@ -112,6 +144,24 @@ QJsonArray DatabaseService::searchMaterials(const QString &query)
     return result;
 }
 
+QJsonArray DatabaseService::searchAll(const QString &query, int limit)
+{
+    QJsonArray result;
+    
+    const QList<FullTextSearch::Hit> hits = FullTextSearch::instance()->search(query, limit);
+    for (const FullTextSearch::Hit &hit : hits) {
+        QJsonObject item;
+        item["type"] = hit.entityType;
+        item["id"] = QJsonValue::fromVariant(hit.key);
+        item["title"] = hit.title;
+        item["snippet"] = hit.snippet;
+        item["rank"] = hit.rank;
+        result.append(item);
+    }
+    
+    return result;
+}
+
 QJsonArray DatabaseService::getMaterialsByCategory(const QString &category)
 {
     QJsonArray result;
@@ -149,8 +199,9 @@ QJsonArray DatabaseService::getLowStockMaterials()
     if (!m_dbManager || !m_dbManager->isConnected()) {
         return result;
     }
-      QSqlQuery query = m_dbManager->executeQuery(
-        "SELECT * FROM materials WHERE quantity <= reorderPoint ORDER BY quantity ASC");
+    
+    // Read from the low stock partial index, furthest below the reorder point first
+    QSqlQuery query = m_dbManager->executeQuery(LOW_STOCK_SQL);
     
     while (query.next()) {
         QJsonObject material;
@@ -284,47 +335,481 @@ bool DatabaseService::deleteMaterial(int id)
     return false;
 }
 
-QJsonObject DatabaseService::getDashboardStats()
+bool DatabaseService::addMultipleMaterials(const QJsonArray &materialsData)
 {
-    QJsonObject stats;
+    return writeMaterialsBatch("addMultipleMaterials", materialsData, false);
+}
+
+bool DatabaseService::updateMultipleMaterials(const QJsonArray &materialsData)
+{
+    return writeMaterialsBatch("updateMultipleMaterials", materialsData, true);
+}
+
+BatchResult DatabaseService::lastBatchResult() const
+{
+    return m_lastBatchResult;
+}
+
+bool DatabaseService::writeMaterialsBatch(const QString &operation, const QJsonArray &materialsData, bool update)
+{
+    m_lastBatchResult = BatchResult();
+    m_lastBatchResult.totalRows = materialsData.size();
     
     if (!m_dbManager || !m_dbManager->isConnected()) {
-        return stats;
+        m_lastBatchResult.error = "Database not connected";
+        emit operationCompleted(operation, false, m_lastBatchResult.error);
+        return false;
+    }
+    
+    const QString insertQuery = R"(
+        INSERT INTO materials (name, description, category, quantity, unit, price, 
+                             supplier_id, barcode, location, minimum_stock, maximum_stock, 
+                             reorder_point, status, created_by, updated_by)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )";
+    
+    const QString updateQuery = R"(
+        UPDATE materials SET 
+            name = ?, description = ?, category = ?, quantity = ?, unit = ?, 
+            price = ?, supplier_id = ?, barcode = ?, location = ?, 
+            minimum_stock = ?, maximum_stock = ?, reorder_point = ?, 
+            status = ?, updated_at = CURRENT_TIMESTAMP, updated_by = ?
+        WHERE id = ?
+    )";
+    
+    // Column-wise binding, one list per placeholder
+    QList<QVariantList> columns(15);
+    QList<int> sourceRows; // Batch row -> index in materialsData
+    
+    for (int i = 0; i < materialsData.size(); ++i) {
+        const QJsonObject materialData = materialsData.at(i).toObject();
+        
+        QString errorMessage;
+        if (!validateMaterialData(materialData, errorMessage)) {
+            m_lastBatchResult.failedRows.insert(i, errorMessage);
+            continue;
+        }
+        if (update && materialData["id"].toInt() <= 0) {
+            m_lastBatchResult.failedRows.insert(i, "Material id is required for updates");
+            continue;
+        }
+        
+        Material material = jsonToMaterial(materialData);
+        if (material.unit.isEmpty()) {
+            material.unit = "pcs";
+        }
+        if (material.status.isEmpty()) {
+            material.status = "active";
+        }
+        
+        // Empty barcodes are stored as NULL so they do not collide on the UNIQUE index
+        const QVariant barcode = material.barcode.isEmpty() ? QVariant() : QVariant(material.barcode);
+        const QVariant supplierId = material.supplierId > 0 ? QVariant(material.supplierId) : QVariant();
+        
+        const QVariantList values = {
+            material.name, material.description, material.category, material.quantity,
+            material.unit, material.price, supplierId, barcode,
+            material.location, material.minimumStock, material.maximumStock,
+            material.reorderPoint, material.status,
+            update ? QVariant(material.updatedBy) : QVariant(material.createdBy),
+            update ? QVariant(material.id) : QVariant(material.updatedBy)
+        };
+        for (int column = 0; column < values.size(); ++column) {
+            columns[column].append(values.at(column));
+        }
+        sourceRows.append(i);
+    }
+    
+    if (!sourceRows.isEmpty()) {
+        const BatchResult batch = m_dbManager->executeBatch(update ? updateQuery : insertQuery, columns);
+        if (!batch.isValid()) {
+            m_lastBatchResult.error = batch.error;
+            emit operationCompleted(operation, false, "Batch write failed: " + batch.error);
+            return false;
+        }
+        
+        m_lastBatchResult.succeededRows = batch.succeededRows;
+        for (auto it = batch.failedRows.constBegin(); it != batch.failedRows.constEnd(); ++it) {
+            m_lastBatchResult.failedRows.insert(sourceRows.at(it.key()), it.value());
+        }
+    }
+    
+    const bool success = !m_lastBatchResult.hasFailures();
+    const QString message = QString("%1 of %2 materials written")
+                                .arg(m_lastBatchResult.succeededRows)
+                                .arg(m_lastBatchResult.totalRows);
+    qDebug() << operation << ":" << message;
+    
+    if (m_lastBatchResult.succeededRows > 0) {
+        refreshMaterialModel();
+        emit dataChanged();
+    }
+    emit operationCompleted(operation, success, message);
+    
+    return success;
+}
+
+void DatabaseService::refreshMaterialModel()
+{
+    if (!m_materialModel) {
+        return;
+    }
+    
+    // Queued when bulk writes run off the GUI thread
+    QMetaObject::invokeMethod(m_materialModel, &MaterialModel::loadFromDatabaseAsync);
+}
+
+bool DatabaseService::importMaterialsFromJson(const QJsonArray &materialsData)
+{
+    // Imported ids are meaningless in this database
+    QJsonArray materials;
+    for (const QJsonValue &value : materialsData) {
+        QJsonObject material = value.toObject();
+        material.remove("id");
+        materials.append(material);
+    }
+    
+    return writeMaterialsBatch("importMaterialsFromJson", materials, false);
+}
+
+bool DatabaseService::importMaterialsFromCsv(const QString &csvData)
+{
+    m_lastBatchResult = BatchResult();
+    if (!m_dbManager || !m_dbManager->isConnected()) {
+        m_lastBatchResult.error = "Database not connected";
+        emit operationCompleted("importMaterialsFromCsv", false, m_lastBatchResult.error);
+        return false;
+    }
+    
+    // The same reader, header names and validation as the file import
+    QByteArray data = csvData.toUtf8();
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    MaterialCsvImporter importer(m_dbManager);
+    const MaterialImportResult imported = importer.run(&buffer);
+    
+    m_lastBatchResult.totalRows = imported.importedRows + imported.failedRows;
+    m_lastBatchResult.succeededRows = imported.importedRows;
+    m_lastBatchResult.error = imported.error;
+    for (auto it = imported.failedLines.constBegin(); it != imported.failedLines.constEnd(); ++it) {
+        m_lastBatchResult.failedRows.insert(int(it.key()), it.value());
+    }
+    
+    if (m_lastBatchResult.succeededRows > 0) {
+        refreshMaterialModel();
+        emit dataChanged();
+    }
+    if (!imported.isValid()) {
+        emit operationCompleted("importMaterialsFromCsv", false, "Import failed: " + imported.error);
+        return false;
+    }
+    if (m_lastBatchResult.totalRows == 0) {
+        emit operationCompleted("importMaterialsFromCsv", false, "CSV data contains no materials");
+        return false;
+    }
+    
+    const bool success = imported.failedRows == 0;
+    emit operationCompleted("importMaterialsFromCsv", success,
+                            QString("%1 of %2 materials written")
+                                .arg(m_lastBatchResult.succeededRows)
+                                .arg(m_lastBatchResult.totalRows));
+    return success;
+}
+
+QJsonArray DatabaseService::exportMaterialsToJson()
+{
+    QJsonArray result;
+    
+    if (!m_dbManager || !m_dbManager->isConnected()) {
+        return result;
+    }
+    
+    QSqlQuery query = m_dbManager->executeForwardOnly(MATERIALS_EXPORT_SQL);
+    while (query.next()) {
+        result.append(recordToJson(query.record()));
+    }
+    query.finish();
+    
+    return result;
+}
+
+QString DatabaseService::exportMaterialsToCsv()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    if (!exportMaterialsToCsv(&buffer)) {
+        return QString();
+    }
+    return QString::fromUtf8(buffer.data());
+}
+
+bool DatabaseService::exportMaterialsToJson(QIODevice *device)
+{
+    return streamQuery("exportMaterialsToJson", MATERIALS_EXPORT_SQL, QVariantList(), device, RowStreamWriter::Json);
+}
+
+bool DatabaseService::exportMaterialsToCsv(QIODevice *device)
+{
+    return streamQuery("exportMaterialsToCsv", MATERIALS_EXPORT_SQL, QVariantList(), device, RowStreamWriter::Csv);
+}
+
+qint64 DatabaseService::lastExportRowCount() const
+{
+    return m_lastExportRowCount;
+}
+
+bool DatabaseService::streamQuery(const QString &operation, const QString &query, const QVariantList &params,
+                                  QIODevice *device, RowStreamWriter::Format format)
+{
+    m_lastExportRowCount = 0;
+    
+    if (!m_dbManager || !m_dbManager->isConnected()) {
+        emit operationCompleted(operation, false, "Database not connected");
+        return false;
+    }
+    if (!device || !device->isWritable()) {
+        emit operationCompleted(operation, false, "Export device is not writable");
+        return false;
+    }
+    
+    // A query_only reader: exports cannot write, whatever the query says
+    std::shared_ptr<ReportSession> session = m_dbManager->beginReportSession();
+    if (!session->isActive()) {
+        emit operationCompleted(operation, false, session->lastError());
+        return false;
     }
     
-    // Total materials
-    QSqlQuery totalQuery = m_dbManager->executeQuery("SELECT COUNT(*) FROM materials");
-    if (totalQuery.next()) {
-        stats["totalMaterials"] = totalQuery.value(0).toInt();
+    QSqlQuery cursor = session->executeQuery(query, params);
+    QString errorMessage;
+    const bool success = RowStreamWriter::writeQuery(
+        cursor, device, format,
+        [this, &operation](qint64 rowsWritten) {
+            emit exportProgress(operation, rowsWritten);
+            return true;
+        },
+        &m_lastExportRowCount, &errorMessage);
+    cursor.finish();
+    session->end();
+    
+    if (!success) {
+        qWarning() << operation << "failed after" << m_lastExportRowCount << "rows:" << errorMessage;
+        emit operationCompleted(operation, false, errorMessage);
+        return false;
     }
     
-    // Active materials
-    QSqlQuery activeQuery = m_dbManager->executeQuery("SELECT COUNT(*) FROM materials WHERE status = 'active'");
-    if (activeQuery.next()) {
-        stats["activeMaterials"] = activeQuery.value(0).toInt();
+    emit operationCompleted(operation, true, QString("%1 rows exported").arg(m_lastExportRowCount));
+    return true;
+}
+
+QJsonArray DatabaseService::executeCustomQuery(const QString &query, const QVariantList &params)
+{
+    QJsonArray result;
+    
+    const QString sql = sanitizeQuery(query);
+    if (!m_dbManager || !m_dbManager->isConnected() || !isValidSqlQuery(sql)) {
+        return result;
     }
     
-    // Low stock count
-    QSqlQuery lowStockQuery = m_dbManager->executeQuery("SELECT COUNT(*) FROM materials WHERE quantity <= reorderPoint");
-    if (lowStockQuery.next()) {
-        stats["lowStockCount"] = lowStockQuery.value(0).toInt();
+    // Checked again by SQLite: a reader in query_only mode rejects any write,
+    // e.g. WITH ... DELETE
+    std::shared_ptr<ReportSession> session = m_dbManager->beginReportSession();
+    if (!session->isActive()) {
+        return result;
     }
     
-    // Total inventory value
-    QSqlQuery valueQuery = m_dbManager->executeQuery("SELECT SUM(quantity * price) FROM materials WHERE status = 'active'");
-    if (valueQuery.next()) {
-        stats["totalValue"] = valueQuery.value(0).toDouble();
+    QSqlQuery cursor = session->executeQuery(sql, params);
+    while (cursor.next()) {
+        result.append(recordToJson(cursor.record()));
     }
+    cursor.finish();
+    session->end();
     
-    // Categories count
-    QSqlQuery categoriesQuery = m_dbManager->executeQuery("SELECT COUNT(DISTINCT category) FROM materials");
-    if (categoriesQuery.next()) {
-        stats["categoriesCount"] = categoriesQuery.value(0).toInt();
+    return result;
+}
+
+bool DatabaseService::executeCustomQuery(const QString &query, QIODevice *device, RowStreamWriter::Format format,
+                                         const QVariantList &params)
+{
+    const QString sql = sanitizeQuery(query);
+    if (!isValidSqlQuery(sql)) {
+        m_lastExportRowCount = 0;
+        emit operationCompleted("executeCustomQuery", false, "Only single SELECT statements can be run");
+        return false;
     }
     
+    return streamQuery("executeCustomQuery", sql, params, device, format);
+}
+
+QFuture<GuardedQueryResult> DatabaseService::executeGuardedQuery(const QString &query,
+                                                                 const GuardedQueryLimits &limits,
+                                                                 const QVariantList &params)
+{
+    GuardedQueryResult rejected;
+    const QString sql = sanitizeQuery(query);
+    
+    if (!m_dbManager || !m_dbManager->isConnected()) {
+        rejected.error = "Database not connected";
+    } else if (!isValidSqlQuery(sql)) {
+        rejected.error = "Only single SELECT statements can be run";
+    } else if (isGuardedQueryRunning()) {
+        rejected.error = "Another query is still running";
+    }
+    if (!rejected.error.isEmpty()) {
+        return QtFuture::makeReadyFuture(rejected);
+    }
+    
+    std::shared_ptr<GuardedQuery> guard = std::make_shared<GuardedQuery>(limits);
+    m_guardedQuery = guard;
+    DatabaseManager *dbManager = m_dbManager;
+    
+    m_guardedFuture = QtConcurrent::run([this, guard, dbManager, sql, params]() {
+        // A query_only reader: whatever the statement says, it cannot write.
+        // Its error goes back with the result, never into dbManager.
+        std::shared_ptr<ReportSession> session = dbManager->beginReportSession();
+        if (!session->isActive()) {
+            GuardedQueryResult failed;
+            failed.error = session->lastError();
+            return failed;
+        }
+        
+        QSqlDatabase connection = session->database();
+        const GuardedQueryResult result = guard->run(connection, sql, params, "ai",
+                                                     [this](const QStringList &columns, const QJsonArray &rows) {
+            emit guardedQueryRows(columns, rows);
+        });
+        session->end();
+        return result;
+    });
+    return m_guardedFuture;
+}
+
+void DatabaseService::cancelGuardedQuery()
+{
+    if (m_guardedQuery && isGuardedQueryRunning()) {
+        m_guardedQuery->cancel();
+    }
+}
+
+bool DatabaseService::isGuardedQueryRunning() const
+{
+    return m_guardedFuture.isRunning();
+}
+
+QString DatabaseService::sanitizeQuery(const QString &query)
+{
+    QString sql = query.trimmed();
+    while (sql.endsWith(';')) {
+        sql.chop(1);
+        sql = sql.trimmed();
+    }
+    return sql;
+}
+
+bool DatabaseService::isValidSqlQuery(const QString &query)
+{
+    // A first filter for a clear error message only; what keeps custom SQL
+    // from writing is the query_only reader it runs on. A second statement
+    // after a ';' is refused by the driver when the query is prepared.
+    static const QRegularExpression readOnly("^(SELECT|WITH)\\b", QRegularExpression::CaseInsensitiveOption);
+    return readOnly.match(query).hasMatch();
+}
+
+// All dashboard figures in a single pass over the materials table
+static const QString DASHBOARD_STATS_SQL =
+    "SELECT COUNT(*), "
+    "SUM(CASE WHEN status = 'active' THEN 1 ELSE 0 END), "
+    "SUM(CASE WHEN quantity <= reorder_point THEN 1 ELSE 0 END), "
+    "SUM(CASE WHEN status = 'active' THEN quantity * price ELSE 0 END), "
+    "COUNT(DISTINCT category) "
+    "FROM materials";
+
+static QJsonObject dashboardStatsFromRowSet(const DatabaseRowSet &rows)
+{
+    QJsonObject stats;
+    if (!rows.isValid() || rows.rowCount() == 0) {
+        return stats;
+    }
+    
+    stats["totalMaterials"] = rows.value(0, 0).toInt();
+    stats["activeMaterials"] = rows.value(0, 1).toInt();
+    stats["lowStockCount"] = rows.value(0, 2).toInt();
+    stats["totalValue"] = rows.value(0, 3).toDouble();
+    stats["categoriesCount"] = rows.value(0, 4).toInt();
     return stats;
 }
 
+QJsonObject DatabaseService::getDashboardStats()
+{
+    if (!m_dbManager || !m_dbManager->isConnected()) {
+        return QJsonObject();
+    }
+    
+    return dashboardStatsFromRowSet(m_dbManager->fetchRows(DASHBOARD_STATS_SQL));
+}
+
+QFuture<QJsonObject> DatabaseService::getDashboardStatsAsync()
+{
+    if (!m_dbManager || !m_dbManager->isConnected()) {
+        return QtFuture::makeReadyFuture(QJsonObject());
+    }
+    
+    return m_dbManager->executeQueryAsync(DASHBOARD_STATS_SQL).then(dashboardStatsFromRowSet);
+}
+
+QJsonObject DatabaseService::getInventoryAnalysis()
+{
+    QJsonObject analysis;
+    
+    if (!m_dbManager || !m_dbManager->isConnected()) {
+        return analysis;
+    }
+    
+    // Every section reads the same snapshot, so the totals, the category
+    // breakdown and the alert list describe one consistent inventory
+    std::shared_ptr<ReportSession> session = m_dbManager->beginReportSession();
+    if (!session->isActive()) {
+        return analysis;
+    }
+    
+    analysis["summary"] = dashboardStatsFromRowSet(session->fetchRows(DASHBOARD_STATS_SQL));
+    analysis["generatedAt"] = session->snapshotTime().toString(Qt::ISODate);
+    
+    QJsonArray categories;
+    const DatabaseRowSet categoryRows = session->fetchRows(
+        "SELECT category, COUNT(*), TOTAL(quantity), TOTAL(quantity * price) "
+        "FROM materials GROUP BY category ORDER BY 4 DESC");
+    for (int row = 0; row < categoryRows.rowCount(); ++row) {
+        QJsonObject category;
+        category["category"] = categoryRows.value(row, 0).toString();
+        category["count"] = categoryRows.value(row, 1).toInt();
+        category["quantity"] = categoryRows.value(row, 2).toDouble();
+        category["value"] = categoryRows.value(row, 3).toDouble();
+        categories.append(category);
+    }
+    analysis["categories"] = categories;
+    
+    QJsonObject stockLevels;
+    const DatabaseRowSet levelRows = session->fetchRows(
+        "SELECT TOTAL(quantity = 0), "
+        "TOTAL(quantity > 0 AND quantity <= reorder_point), "
+        "TOTAL(maximum_stock > 0 AND quantity > maximum_stock) "
+        "FROM materials");
+    stockLevels["outOfStock"] = levelRows.value(0, 0).toInt();
+    stockLevels["belowReorderPoint"] = levelRows.value(0, 1).toInt();
+    stockLevels["overstocked"] = levelRows.value(0, 2).toInt();
+    analysis["stockLevels"] = stockLevels;
+    
+    QJsonArray reorderAlerts;
+    const DatabaseRowSet alertRows = session->fetchRows(LOW_STOCK_SQL);
+    for (int row = 0; row < alertRows.rowCount(); ++row) {
+        reorderAlerts.append(recordToJson(alertRows.record(row)));
+    }
+    analysis["reorderAlerts"] = reorderAlerts;
+    
+    session->end();
+    return analysis;
+}
+
 QJsonArray DatabaseService::getCategoryStats()
 {
     QJsonArray result;
@@ -353,6 +838,33 @@ QJsonArray DatabaseService::getReorderAlerts()
     return getLowStockMaterials(); // Same as low stock materials
 }
 
+QJsonObject DatabaseService::getStockHistory(int materialId, const QDateTime &from, const QDateTime &to)
+{
+    QJsonObject result;
+    
+    if (!m_dbManager || !m_dbManager->isConnected()) {
+        return result;
+    }
+    
+    InventoryLedger ledger(m_dbManager);
+    bool ok = false;
+    const InventoryLedger::Flow flow = ledger.flowBetween(materialId, from, to, &ok);
+    if (!ok) {
+        qWarning() << "Failed to read stock history of material" << materialId << ":" << ledger.lastError();
+        return result;
+    }
+    
+    result["materialId"] = materialId;
+    result["from"] = from.toString(Qt::ISODate);
+    result["to"] = to.toString(Qt::ISODate);
+    result["openingQuantity"] = flow.openingQuantity;
+    result["closingQuantity"] = flow.closingQuantity;
+    result["received"] = flow.received;
+    result["consumed"] = flow.consumed;
+    
+    return result;
+}
+
 Material DatabaseService::jsonToMaterial(const QJsonObject &json)
 {
     Material material;
@@ -488,19 +1000,52 @@ QJsonObject DatabaseService::recordToJson(const QSqlRecord &record)
     QJsonObject json;
     
     for (int i = 0; i < record.count(); ++i) {
-        QString fieldName = record.fieldName(i);
-        QVariant value = record.value(i);
-        
-        if (value.metaType() == QMetaType::fromType<QDateTime>()) {
-            json[fieldName] = value.toDateTime().toString(Qt::ISODate);
-        } else {
-            json[fieldName] = QJsonValue::fromVariant(value);
-        }
+        json[record.fieldName(i)] = RowStreamWriter::jsonValue(record.value(i));
     }
     
     return json;
 }
 
+bool DatabaseService::backupDatabase(const QString &filePath)
+{
+    if (!m_dbManager || !m_dbManager->isConnected()) {
+        emit operationCompleted("backupDatabase", false, "Database not connected");
+        return false;
+    }
+    
+    // Online snapshot, consistent even while the WAL is being written
+    QString errorMessage;
+    if (!SqliteBackup::copy(m_dbManager->database().databaseName(), filePath, &errorMessage)) {
+        emit operationCompleted("backupDatabase", false, "Backup failed: " + errorMessage);
+        return false;
+    }
+    
+    emit operationCompleted("backupDatabase", true, "Database backed up to " + filePath);
+    return true;
+}
+
+bool DatabaseService::restoreDatabase(const QString &filePath)
+{
+    if (!m_dbManager || !m_dbManager->isConnected()) {
+        emit operationCompleted("restoreDatabase", false, "Database not connected");
+        return false;
+    }
+    
+    // Prepared statements must not hold the file while pages are replaced
+    m_dbManager->clearStatementCache();
+    
+    QString errorMessage;
+    if (!SqliteBackup::restore(filePath, m_dbManager->database().databaseName(), &errorMessage)) {
+        emit operationCompleted("restoreDatabase", false, "Restore failed: " + errorMessage);
+        return false;
+    }
+    
+    refreshMaterialModel();
+    emit dataChanged();
+    emit operationCompleted("restoreDatabase", true, "Database restored from " + filePath);
+    return true;
+}
+
 bool DatabaseService::resetDatabase()
 {
     if (!m_dbManager || !m_dbManager->isConnected()) {
@@ -6,10 +6,16 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QSqlRecord>
+#include <QFuture>
 #include "../features/materials/materialmodel.h"
+#include "databasemanager.h"
+#include "rowstreamwriter.h"
+#include "guardedquery.h"
+#include <memory>
 
 class DatabaseManager;
 class MaterialModel;
+class QIODevice;
 
 /**
  * @brief High-level database service for AI assistant integration
@@ -33,6 +39,8 @@ public:
     QJsonArray getAllMaterials();
     QJsonObject getMaterialById(int id);
     QJsonArray searchMaterials(const QString &query);
+    // Ranked hits across every module's full-text index
+    QJsonArray searchAll(const QString &query, int limit = 50);
     QJsonArray getMaterialsByCategory(const QString &category);
     QJsonArray getLowStockMaterials();
     QJsonArray getMaterialsByStatus(const QString &status);
@@ -41,16 +49,23 @@ public:
     bool updateMaterial(int id, const QJsonObject &materialData);
     bool deleteMaterial(int id);
     
-    // Bulk operations
+    // Bulk operations - written in one batched transaction; rows that fail
+    // are skipped and listed in lastBatchResult()
     bool addMultipleMaterials(const QJsonArray &materialsData);
     bool updateMultipleMaterials(const QJsonArray &materialsData);
+    BatchResult lastBatchResult() const;
     
     // Statistics and analytics
     QJsonObject getDashboardStats();
+    QFuture<QJsonObject> getDashboardStatsAsync();
     QJsonObject getInventoryAnalysis();
     QJsonArray getCategoryStats();
     QJsonObject getPriceAnalysis();
     QJsonArray getReorderAlerts();
+    
+    // Stock history from the inventory ledger: quantities at both ends of
+    // (from, to] and what was received and consumed in between
+    QJsonObject getStockHistory(int materialId, const QDateTime &from, const QDateTime &to);
       // Database management
     QJsonObject getDatabaseInfo();
     bool backupDatabase(const QString &filePath);
@@ -58,10 +73,22 @@ public:
     bool resetDatabase();
     bool refreshDefaultMaterials();
     
-    // Query execution (for advanced operations)
+    // Query execution (for advanced operations) - read-only statements only
     QJsonArray executeCustomQuery(const QString &query, const QVariantList &params = QVariantList());
+    bool executeCustomQuery(const QString &query, QIODevice *device, RowStreamWriter::Format format,
+                            const QVariantList &params = QVariantList());
     bool executeCustomCommand(const QString &command, const QVariantList &params = QVariantList());
     
+    // Guarded execution for SQL written by the AI assistant. Runs on a worker
+    // thread over a read-only connection, within the row limit and time
+    // budget; rows are streamed through guardedQueryRows() as they are read.
+    // One guarded query runs at a time.
+    QFuture<GuardedQueryResult> executeGuardedQuery(const QString &query,
+                                                    const GuardedQueryLimits &limits = GuardedQueryLimits(),
+                                                    const QVariantList &params = QVariantList());
+    void cancelGuardedQuery();
+    bool isGuardedQueryRunning() const;
+    
     // Data validation
     bool validateMaterialData(const QJsonObject &materialData, QString &errorMessage);
     QStringList getValidCategories();
@@ -72,20 +99,36 @@ public:
     QJsonArray exportMaterialsToJson();
     bool importMaterialsFromJson(const QJsonArray &materialsData);
     QString exportMaterialsToCsv();
-    bool importMaterialsFromCsv(const QString &csvData);
+    bool importMaterialsFromCsv(const QString &csvData);   // via MaterialCsvImporter; failures by line
+    
+    // Streaming export - rows go from a forward-only cursor straight to the
+    // device, so memory stays bounded whatever the size of the result
+    bool exportMaterialsToJson(QIODevice *device);
+    bool exportMaterialsToCsv(QIODevice *device);
+    qint64 lastExportRowCount() const;
 
 signals:
     void operationCompleted(const QString &operation, bool success, const QString &message);
     void dataChanged();
+    void exportProgress(const QString &operation, qint64 rowsWritten);
+    void guardedQueryRows(const QStringList &columns, const QJsonArray &rows);
 
 private:
     Material jsonToMaterial(const QJsonObject &json);
     QJsonObject materialToJson(const Material &material);
     QString sanitizeQuery(const QString &query);
     bool isValidSqlQuery(const QString &query);
+    bool writeMaterialsBatch(const QString &operation, const QJsonArray &materialsData, bool update);
+    void refreshMaterialModel();
+    bool streamQuery(const QString &operation, const QString &query, const QVariantList &params,
+                     QIODevice *device, RowStreamWriter::Format format);
     
     DatabaseManager *m_dbManager;
     MaterialModel *m_materialModel;
+    BatchResult m_lastBatchResult;
+    qint64 m_lastExportRowCount;
+    std::shared_ptr<GuardedQuery> m_guardedQuery;
+    QFuture<GuardedQueryResult> m_guardedFuture;
     
     // Helper function to convert QSqlRecord to QJsonObject
     QJsonObject recordToJson(const QSqlRecord &record);
@@ -0,0 +1,236 @@
+#include "fulltextsearch.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QRegularExpression>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+const int FullTextSearch::DEFAULT_RESULT_LIMIT = 50;
+
+namespace {
+
+QString prefixed(const QStringList &columns, const QString &prefix)
+{
+    QStringList result;
+    for (const QString &column : columns) {
+        result << prefix + column;
+    }
+    return result.join(", ");
+}
+
+bool runStatements(const QSqlDatabase &database, const QStringList &statements)
+{
+    QSqlQuery query(database);
+
+    // A savepoint works both inside and outside a caller's transaction
+    if (!query.exec("SAVEPOINT fts_index")) {
+        qWarning() << "FullTextSearch:" << query.lastError().text();
+        return false;
+    }
+
+    for (const QString &statement : statements) {
+        if (!query.exec(statement)) {
+            qWarning() << "FullTextSearch:" << query.lastError().text() << "in" << statement;
+            query.exec("ROLLBACK TO SAVEPOINT fts_index");
+            query.exec("RELEASE SAVEPOINT fts_index");
+            return false;
+        }
+    }
+
+    return query.exec("RELEASE SAVEPOINT fts_index");
+}
+
+} // namespace
+
+FullTextSearch *FullTextSearch::instance()
+{
+    static FullTextSearch search;
+    return &search;
+}
+
+bool FullTextSearch::isAvailable(const QSqlDatabase &database)
+{
+    QSqlQuery query(database);
+    return query.exec("SELECT sqlite_compileoption_used('ENABLE_FTS5')")
+        && query.next() && query.value(0).toInt() == 1;
+}
+
+bool FullTextSearch::createIndex(const QSqlDatabase &database, const IndexDefinition &definition)
+{
+    if (!isAvailable(database)) {
+        qWarning() << "FullTextSearch: FTS5 is not available, keeping LIKE search for" << definition.table;
+        return false;
+    }
+
+    const bool existed = hasIndex(database, definition);
+    const QString fts = definition.ftsTable();
+    const QString columns = definition.columns.join(", ");
+    const QString newValues = prefixed(definition.columns, "new.");
+    const QString oldValues = prefixed(definition.columns, "old.");
+    const QString rowId = definition.rowIdColumn();
+
+    const QString insertNew = QString("INSERT INTO %1(rowid, %2) VALUES (new.%3, %4);")
+                                  .arg(fts, columns, rowId, newValues);
+    const QString deleteOld = QString("INSERT INTO %1(%1, rowid, %2) VALUES ('delete', old.%3, %4);")
+                                  .arg(fts, columns, rowId, oldValues);
+
+    const QStringList statements = {
+        QString("CREATE VIRTUAL TABLE IF NOT EXISTS %1 USING fts5(%2, content='%3', content_rowid='%4', "
+                "tokenize='unicode61 remove_diacritics 2', prefix='2 3')")
+            .arg(fts, columns, definition.table, rowId),
+        QString("CREATE TRIGGER IF NOT EXISTS %1_ai AFTER INSERT ON %2 BEGIN %3 END")
+            .arg(fts, definition.table, insertNew),
+        QString("CREATE TRIGGER IF NOT EXISTS %1_ad AFTER DELETE ON %2 BEGIN %3 END")
+            .arg(fts, definition.table, deleteOld),
+        // Edits to columns that are not indexed leave the index alone
+        QString("CREATE TRIGGER IF NOT EXISTS %1_au AFTER UPDATE OF %2 ON %3 BEGIN %4 %5 END")
+            .arg(fts, columns, definition.table, deleteOld, insertNew)
+    };
+
+    if (!runStatements(database, statements)) {
+        return false;
+    }
+
+    // Index rows that existed before the triggers
+    return existed || rebuildIndex(database, definition);
+}
+
+bool FullTextSearch::hasIndex(const QSqlDatabase &database, const IndexDefinition &definition)
+{
+    QSqlQuery query(database);
+    query.prepare("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = ?");
+    query.addBindValue(definition.ftsTable());
+    return query.exec() && query.next() && query.value(0).toInt() > 0;
+}
+
+bool FullTextSearch::rebuildIndex(const QSqlDatabase &database, const IndexDefinition &definition)
+{
+    QSqlQuery query(database);
+    if (!query.exec(QString("INSERT INTO %1(%1) VALUES ('rebuild')").arg(definition.ftsTable()))) {
+        qWarning() << "FullTextSearch: failed to rebuild" << definition.ftsTable() << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QString FullTextSearch::matchExpression(const QString &text)
+{
+    static const QRegularExpression word("[\\p{L}\\p{N}_]+", QRegularExpression::UseUnicodePropertiesOption);
+
+    QStringList terms;
+    QRegularExpressionMatchIterator it = word.globalMatch(text);
+    while (it.hasNext()) {
+        // Quoted so words like AND/OR/NEAR are never read as operators
+        terms << QString("\"%1\"*").arg(it.next().captured(0));
+    }
+    return terms.join(' ');
+}
+
+QString FullTextSearch::searchSql(const IndexDefinition &definition, const QString &extraCondition)
+{
+    const QString fts = definition.ftsTable();
+    QString sql = QString("SELECT t.* FROM %1 t JOIN %2 ON %2.rowid = t.%3 WHERE %2 MATCH ?")
+                      .arg(definition.table, fts, definition.rowIdColumn());
+    if (!extraCondition.isEmpty()) {
+        sql += QString(" AND (%1)").arg(extraCondition);
+    }
+    return sql + " ORDER BY " + rankExpression(definition);
+}
+
+void FullTextSearch::registerIndex(const QString &connectionName, const IndexDefinition &definition)
+{
+    QMutexLocker locker(&m_mutex);
+    for (RegisteredIndex &index : m_indexes) {
+        if (index.connectionName == connectionName && index.definition.table == definition.table) {
+            index.definition = definition;
+            return;
+        }
+    }
+    m_indexes.append({connectionName, definition});
+}
+
+void FullTextSearch::unregisterConnection(const QString &connectionName)
+{
+    QMutexLocker locker(&m_mutex);
+    m_indexes.erase(std::remove_if(m_indexes.begin(), m_indexes.end(), [&](const RegisteredIndex &index) {
+        return index.connectionName == connectionName;
+    }), m_indexes.end());
+}
+
+bool FullTextSearch::isRegistered(const QString &connectionName, const QString &table) const
+{
+    QMutexLocker locker(&m_mutex);
+    for (const RegisteredIndex &index : m_indexes) {
+        if (index.connectionName == connectionName && index.definition.table == table) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QList<FullTextSearch::Hit> FullTextSearch::search(const QString &text, int limit,
+                                                  const QStringList &entityTypes) const
+{
+    QList<Hit> hits;
+    const QString match = matchExpression(text);
+    if (match.isEmpty() || limit <= 0) {
+        return hits;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    const QList<RegisteredIndex> indexes = m_indexes;
+    locker.unlock();
+
+    for (const RegisteredIndex &index : indexes) {
+        const IndexDefinition &definition = index.definition;
+        if (!entityTypes.isEmpty() && !entityTypes.contains(definition.entityType)) {
+            continue;
+        }
+
+        // Module connections belong to the GUI thread, like this call
+        QSqlDatabase database = QSqlDatabase::database(index.connectionName, false);
+        if (!database.isOpen()) {
+            continue;
+        }
+
+        const QString fts = definition.ftsTable();
+        const QString rank = rankExpression(definition);
+        QSqlQuery query(database);
+        query.prepare(QString("SELECT t.%1, %2, snippet(%3, -1, '<b>', '</b>', '...', 12), %4 "
+                              "FROM %3 JOIN %5 t ON t.%6 = %3.rowid "
+                              "WHERE %3 MATCH ? ORDER BY %4 LIMIT ?")
+                          .arg(definition.keyColumn, definition.titleExpression, fts, rank,
+                               definition.table, definition.rowIdColumn()));
+        query.addBindValue(match);
+        query.addBindValue(limit);
+
+        if (!query.exec()) {
+            qWarning() << "FullTextSearch: search in" << fts << "failed:" << query.lastError().text();
+            continue;
+        }
+
+        while (query.next()) {
+            hits.append({definition.entityType, query.value(0), query.value(1).toString(),
+                         query.value(2).toString(), query.value(3).toDouble()});
+        }
+    }
+
+    std::stable_sort(hits.begin(), hits.end(), [](const Hit &a, const Hit &b) {
+        return a.rank < b.rank;
+    });
+    if (hits.size() > limit) {
+        hits.resize(limit);
+    }
+    return hits;
+}
+
+QString FullTextSearch::rankExpression(const IndexDefinition &definition)
+{
+    // The first column (name, title) outweighs free-text columns
+    QStringList weights;
+    for (int i = 0; i < definition.columns.size(); ++i) {
+        weights << (i == 0 ? "5.0" : "1.0");
+    }
+    return QString("bm25(%1, %2)").arg(definition.ftsTable(), weights.join(", "));
+}
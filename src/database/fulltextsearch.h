@@ -0,0 +1,92 @@
+#ifndef FULLTEXTSEARCH_H
+#define FULLTEXTSEARCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVariant>
+#include <QMutex>
+#include <QSqlDatabase>
+
+/**
+ * @brief The FullTextSearch class - FTS5 indexes and global ranked search
+ *
+ * Each searchable table gets an external-content FTS5 table (<table>_fts)
+ * kept in sync by insert, update and delete triggers. It uses a
+ * diacritic-insensitive tokenizer and prefix indexes, so search-as-you-type
+ * queries never scan the base table.
+ *
+ * Module managers create the index for their own database and register it
+ * here. search() queries every registered index and merges the hits by
+ * bm25 rank. Tables without an explicit INTEGER PRIMARY KEY index their
+ * implicit rowid, which VACUUM may renumber, so their owners rebuild the
+ * index after a VACUUM.
+ *
+ * When SQLite lacks FTS5, createIndex() returns false and callers keep
+ * their LIKE-based search.
+ */
+class FullTextSearch
+{
+public:
+    struct IndexDefinition {
+        QString entityType;         // Reported in hits, e.g. "contract"
+        QString table;              // Base table
+        QString keyColumn;          // Returned as the hit key
+        bool integerKey;            // keyColumn is the INTEGER PRIMARY KEY (rowid alias)
+        QStringList columns;        // Indexed columns; the first one ranks highest
+        QString titleExpression;    // SQL over alias t for the hit title
+
+        QString ftsTable() const { return table + "_fts"; }
+        QString rowIdColumn() const { return integerKey ? keyColumn : QString("rowid"); }
+    };
+
+    struct Hit {
+        QString entityType;
+        QVariant key;
+        QString title;
+        QString snippet;            // Matches wrapped in <b></b>
+        double rank;                // bm25, lower is better
+    };
+
+    static const int DEFAULT_RESULT_LIMIT;
+
+    static FullTextSearch *instance();
+
+    // Index maintenance; run on the connection's thread
+    static bool isAvailable(const QSqlDatabase &database);
+    static bool createIndex(const QSqlDatabase &database, const IndexDefinition &definition);
+    static bool hasIndex(const QSqlDatabase &database, const IndexDefinition &definition);
+    static bool rebuildIndex(const QSqlDatabase &database, const IndexDefinition &definition);
+
+    // Turns user input into an FTS5 query: every word must match as a prefix.
+    // Returns an empty string when the input has no searchable words.
+    static QString matchExpression(const QString &text);
+
+    // SELECT t.* from the base table joined to its index, best match first.
+    // Bind matchExpression() to the first placeholder; extraCondition may
+    // add filters on alias t with further placeholders.
+    static QString searchSql(const IndexDefinition &definition, const QString &extraCondition = QString());
+
+    // Global search across all registered indexes
+    void registerIndex(const QString &connectionName, const IndexDefinition &definition);
+    void unregisterConnection(const QString &connectionName);
+    // Cheap per-search check; the registry stands in for a sqlite_master lookup
+    bool isRegistered(const QString &connectionName, const QString &table) const;
+    QList<Hit> search(const QString &text, int limit = DEFAULT_RESULT_LIMIT,
+                      const QStringList &entityTypes = QStringList()) const;
+
+private:
+    FullTextSearch() = default;
+
+    static QString rankExpression(const IndexDefinition &definition);
+
+    struct RegisteredIndex {
+        QString connectionName;
+        IndexDefinition definition;
+    };
+
+    mutable QMutex m_mutex;
+    QList<RegisteredIndex> m_indexes;
+};
+
+#endif // FULLTEXTSEARCH_H
@@ -0,0 +1,182 @@
+#include "guardedquery.h"
+#include "queryprofiler.h"
+#include "rowstreamwriter.h"
+#include "sqlitenative.h"
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QMutexLocker>
+#include <QDebug>
+
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+#include <sqlite3.h>
+#endif
+
+const int GuardedQuery::DEFAULT_MAX_ROWS = 500;
+const int GuardedQuery::DEFAULT_TIMEOUT_MS = 5000;
+const int GuardedQuery::ROW_BATCH_SIZE = 50;
+
+namespace {
+
+// Virtual machine instructions between budget checks; a few microseconds
+const int PROGRESS_CHECK_INTERVAL = 1000;
+
+} // namespace
+
+GuardedQueryLimits::GuardedQueryLimits()
+    : maxRows(GuardedQuery::DEFAULT_MAX_ROWS)
+    , timeoutMs(GuardedQuery::DEFAULT_TIMEOUT_MS)
+{
+}
+
+GuardedQuery::GuardedQuery(const GuardedQueryLimits &limits)
+    : m_limits(limits)
+    , m_canceled(false)
+    , m_handle(nullptr)
+{
+}
+
+GuardedQueryResult GuardedQuery::run(QSqlDatabase &database, const QString &sql, const QVariantList &params,
+                                     const QString &source, const RowBatchHandler &onRows)
+{
+    GuardedQueryResult result;
+    QElapsedTimer timer;
+    timer.start();
+    m_deadline = m_limits.timeoutMs > 0 ? QDeadlineTimer(m_limits.timeoutMs)
+                                        : QDeadlineTimer(QDeadlineTimer::Forever);
+
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) {
+        result.error = query.lastError().text();
+        result.elapsedMs = timer.elapsed();
+        return result;
+    }
+    for (int i = 0; i < params.size(); ++i) {
+        query.bindValue(i, params.at(i));
+    }
+
+    attach(database);
+
+    if (!isCanceled() && QueryProfiler::instance()->execute(query, database, source)) {
+        const QSqlRecord record = query.record();
+        for (int i = 0; i < record.count(); ++i) {
+            result.columns << record.fieldName(i);
+        }
+
+        QJsonArray batch;
+        while (true) {
+            if (isCanceled()) {
+                result.canceled = true;
+                break;
+            }
+            if (hasExpired()) {
+                result.timedOut = true;
+                break;
+            }
+            if (!query.next()) {
+                break;
+            }
+            // The extra row only tells that there are more
+            if (m_limits.maxRows > 0 && result.rows.size() >= m_limits.maxRows) {
+                result.truncated = true;
+                break;
+            }
+
+            QJsonObject row;
+            for (int i = 0; i < result.columns.size(); ++i) {
+                row.insert(result.columns.at(i), RowStreamWriter::jsonValue(query.value(i)));
+            }
+            result.rows.append(row);
+            batch.append(row);
+
+            if (onRows && batch.size() >= ROW_BATCH_SIZE) {
+                onRows(result.columns, batch);
+                batch = QJsonArray();
+            }
+        }
+        if (onRows && !batch.isEmpty()) {
+            onRows(result.columns, batch);
+        }
+    }
+
+    // An interrupted step ends next() or exec() with an error
+    const QSqlError error = query.lastError();
+    query.finish();
+    detach();
+
+    if (!result.canceled && !result.timedOut && !result.truncated) {
+        if (isCanceled()) {
+            result.canceled = true;
+        } else if (error.isValid() && hasExpired()) {
+            result.timedOut = true;
+        } else if (error.isValid()) {
+            result.error = error.text();
+        }
+    }
+    result.truncated = result.truncated || result.canceled || result.timedOut;
+    result.elapsedMs = timer.elapsed();
+
+    if (result.timedOut) {
+        qWarning() << "GuardedQuery: stopped after" << result.elapsedMs << "ms with"
+                   << result.rows.size() << "rows:" << sql;
+    }
+    return result;
+}
+
+void GuardedQuery::cancel()
+{
+    m_canceled = true;
+
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    // Stops a step that is still scanning or sorting before its next row
+    QMutexLocker locker(&m_handleMutex);
+    if (m_handle) {
+        sqlite3_interrupt(m_handle);
+    }
+#endif
+}
+
+bool GuardedQuery::isCanceled() const
+{
+    return m_canceled;
+}
+
+bool GuardedQuery::hasExpired() const
+{
+    return m_deadline.hasExpired();
+}
+
+void GuardedQuery::attach(const QSqlDatabase &database)
+{
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    sqlite3 *handle = SqliteNative::handle(database);
+    if (handle) {
+        sqlite3_progress_handler(handle, PROGRESS_CHECK_INTERVAL, &GuardedQuery::progressCallback, this);
+    }
+    QMutexLocker locker(&m_handleMutex);
+    m_handle = handle;
+#else
+    Q_UNUSED(database)
+#endif
+}
+
+void GuardedQuery::detach()
+{
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    QMutexLocker locker(&m_handleMutex);
+    if (m_handle) {
+        sqlite3_progress_handler(m_handle, 0, nullptr, nullptr);
+        m_handle = nullptr;
+    }
+#endif
+}
+
+int GuardedQuery::progressCallback(void *guard)
+{
+    // Non-zero makes SQLite abandon the statement with SQLITE_INTERRUPT
+    const GuardedQuery *query = static_cast<GuardedQuery *>(guard);
+    return query->isCanceled() || query->hasExpired() ? 1 : 0;
+}
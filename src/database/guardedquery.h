@@ -0,0 +1,85 @@
+#ifndef GUARDEDQUERY_H
+#define GUARDEDQUERY_H
+
+#include <QDeadlineTimer>
+#include <QJsonArray>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <atomic>
+#include <functional>
+
+struct sqlite3;
+
+// Bounds for one guarded statement
+struct GuardedQueryLimits {
+    int maxRows;        // rows returned at most, 0 for no limit; more set truncated
+    int timeoutMs;      // wall-clock budget for executing and reading, 0 for none
+
+    GuardedQueryLimits();
+};
+
+// What a guarded statement produced. When it stopped early the rows read up
+// to then are kept, so a partial answer can still be shown.
+struct GuardedQueryResult {
+    QStringList columns;
+    QJsonArray rows;
+    bool truncated = false;   // the result holds fewer rows than the statement yields
+    bool timedOut = false;
+    bool canceled = false;
+    QString error;            // empty unless the statement itself failed
+    qint64 elapsedMs = 0;
+
+    bool isComplete() const { return !truncated && error.isEmpty(); }
+};
+
+/**
+ * @brief The GuardedQuery class - Runs untrusted SELECT statements within bounds
+ *
+ * Meant for SQL written by the AI assistant rather than by the application:
+ * the statement runs on a forward-only cursor, reading stops at a row limit,
+ * and a time budget and cancel() interrupt it even while SQLite is still
+ * scanning or sorting before the first row. The budget and interruption act
+ * inside SQLite only when the native API is linked (see SqliteNative);
+ * otherwise they are checked between rows.
+ *
+ * run() blocks, so call it from a worker thread; cancel() may be called
+ * from any thread. Each instance runs one statement.
+ */
+class GuardedQuery
+{
+public:
+    static const int DEFAULT_MAX_ROWS;
+    static const int DEFAULT_TIMEOUT_MS;
+    static const int ROW_BATCH_SIZE;
+
+    // Receives the rows as they are read, ROW_BATCH_SIZE at a time, on the
+    // thread calling run(); columns gives the result's column order
+    using RowBatchHandler = std::function<void(const QStringList &columns, const QJsonArray &rows)>;
+
+    explicit GuardedQuery(const GuardedQueryLimits &limits = GuardedQueryLimits());
+
+    GuardedQueryResult run(QSqlDatabase &database, const QString &sql, const QVariantList &params,
+                           const QString &source, const RowBatchHandler &onRows = RowBatchHandler());
+
+    void cancel();
+    bool isCanceled() const;
+
+private:
+    bool hasExpired() const;
+    void attach(const QSqlDatabase &database);
+    void detach();
+    static int progressCallback(void *guard);
+
+    GuardedQueryLimits m_limits;
+    std::atomic_bool m_canceled;
+    QDeadlineTimer m_deadline;          // read on the running thread only
+
+    // Guards m_handle, which cancel() interrupts from other threads
+    QMutex m_handleMutex;
+    sqlite3 *m_handle;
+};
+
+#endif // GUARDEDQUERY_H
@@ -0,0 +1,492 @@
+#include "inventoryledger.h"
+#include "databasemanager.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTimeZone>
+#include <QDebug>
+
+const int InventoryLedger::CHECKPOINT_INTERVAL = 256;
+
+namespace {
+
+const QString SQL_TIME_FORMAT = "yyyy-MM-dd hh:mm:ss";
+
+// What a movement does to the quantity on hand
+const QString EFFECT_SQL = "CASE movement_type WHEN 'out' THEN -quantity ELSE quantity END";
+
+const QString LATEST_CHECKPOINT_SQL = R"(
+    SELECT checkpoint_date, movement_id, balance, total_in, total_out
+    FROM material_stock_checkpoints
+    WHERE material_id = ?
+    ORDER BY checkpoint_date DESC, movement_id DESC LIMIT 1
+)";
+
+const QString CHECKPOINT_AT_SQL = R"(
+    SELECT checkpoint_date, movement_id, balance, total_in, total_out
+    FROM material_stock_checkpoints
+    WHERE material_id = ? AND checkpoint_date <= ?
+    ORDER BY checkpoint_date DESC, movement_id DESC LIMIT 1
+)";
+
+const QString INSERT_CHECKPOINT_SQL = R"(
+    INSERT OR REPLACE INTO material_stock_checkpoints
+        (material_id, checkpoint_date, movement_id, balance, total_in, total_out)
+    VALUES (?, ?, ?, ?, ?, ?)
+)";
+
+const QString INSERT_MOVEMENT_SQL = R"(
+    INSERT INTO material_movements (material_id, movement_type, quantity, reference, notes, performed_by)
+    VALUES (?, ?, ?, ?, ?, ?)
+)";
+
+// Stock never goes below zero through the ledger
+const QString APPLY_MOVEMENT_SQL = R"(
+    UPDATE materials
+    SET quantity = quantity + ?, updated_at = CURRENT_TIMESTAMP, updated_by = COALESCE(?, updated_by)
+    WHERE id = ? AND quantity + ? >= 0
+)";
+
+const QString MOVEMENT_TYPES[] = {"in", "out", "adjustment"};
+
+// Movements after a checkpoint, in ledger order
+const QString TAIL_SQL = QString(R"(
+    SELECT id, movement_date, %1
+    FROM material_movements
+    WHERE material_id = ? AND (movement_date, id) > (?, ?)
+    ORDER BY movement_date, id
+)").arg(EFFECT_SQL);
+
+// Received and consumed between a checkpoint and a date
+const QString RANGE_TOTALS_SQL = QString(R"(
+    SELECT IFNULL(SUM(CASE WHEN effect > 0 THEN effect ELSE 0 END), 0),
+           IFNULL(SUM(CASE WHEN effect < 0 THEN -effect ELSE 0 END), 0)
+    FROM (SELECT %1 AS effect
+          FROM material_movements
+          WHERE material_id = ? AND (movement_date, id) > (?, ?) AND movement_date <= ?)
+)").arg(EFFECT_SQL);
+
+void applyEffect(InventoryLedger::Balance *balance, int effect)
+{
+    balance->quantity += effect;
+    if (effect > 0) {
+        balance->received += effect;
+    } else {
+        balance->consumed -= effect;
+    }
+}
+
+} // namespace
+
+InventoryLedger::InventoryLedger(DatabaseManager *databaseManager)
+    : m_databaseManager(databaseManager)
+{
+}
+
+QStringList InventoryLedger::schemaStatements()
+{
+    return {
+        // One row per CHECKPOINT_INTERVAL movements of a material
+        R"(CREATE TABLE IF NOT EXISTS material_stock_checkpoints (
+            material_id INTEGER NOT NULL,
+            checkpoint_date DATETIME NOT NULL,
+            movement_id INTEGER NOT NULL,
+            balance INTEGER NOT NULL,
+            total_in INTEGER NOT NULL,
+            total_out INTEGER NOT NULL,
+            PRIMARY KEY (material_id, checkpoint_date, movement_id),
+            FOREIGN KEY (material_id) REFERENCES materials(id) ON DELETE CASCADE
+        ) WITHOUT ROWID)",
+
+        // Range scans of one material's history in ledger order; the
+        // material_id prefix serves what the single-column index did
+        "DROP INDEX IF EXISTS idx_material_movements_material_id",
+        "CREATE INDEX IF NOT EXISTS idx_material_movements_ledger ON material_movements(material_id, movement_date)",
+
+        // Materials whose quantity recordMovement() is changing inside its
+        // transaction; the edit trigger leaves those alone
+        "CREATE TABLE IF NOT EXISTS material_ledger_pending (material_id INTEGER PRIMARY KEY)",
+
+        R"(CREATE TRIGGER IF NOT EXISTS materials_ledger_ai AFTER INSERT ON materials
+           WHEN NEW.quantity <> 0
+           BEGIN
+               INSERT INTO material_movements (material_id, movement_type, quantity, reference, performed_by)
+               VALUES (NEW.id, CASE WHEN NEW.quantity > 0 THEN 'in' ELSE 'adjustment' END,
+                       NEW.quantity, 'opening stock', NEW.created_by);
+           END)",
+
+        R"(CREATE TRIGGER IF NOT EXISTS materials_ledger_au AFTER UPDATE OF quantity ON materials
+           WHEN NEW.quantity <> OLD.quantity
+            AND NOT EXISTS (SELECT 1 FROM material_ledger_pending WHERE material_id = NEW.id)
+           BEGIN
+               INSERT INTO material_movements (material_id, movement_type, quantity, reference, performed_by)
+               VALUES (NEW.id, 'adjustment', NEW.quantity - OLD.quantity, 'stock edit', NEW.updated_by);
+           END)",
+
+        // A movement before a checkpoint invalidates it and the ones after
+        R"(CREATE TRIGGER IF NOT EXISTS material_movements_ledger_ai AFTER INSERT ON material_movements
+           BEGIN
+               DELETE FROM material_stock_checkpoints
+               WHERE material_id = NEW.material_id
+                 AND (checkpoint_date, movement_id) > (NEW.movement_date, NEW.id);
+           END)",
+
+        R"(CREATE TRIGGER IF NOT EXISTS material_movements_ledger_ad AFTER DELETE ON material_movements
+           BEGIN
+               DELETE FROM material_stock_checkpoints
+               WHERE material_id = OLD.material_id
+                 AND (checkpoint_date, movement_id) >= (OLD.movement_date, OLD.id);
+           END)",
+
+        R"(CREATE TRIGGER IF NOT EXISTS material_movements_ledger_au
+           AFTER UPDATE OF material_id, movement_type, quantity, movement_date ON material_movements
+           BEGIN
+               DELETE FROM material_stock_checkpoints
+               WHERE (material_id = OLD.material_id
+                      AND (checkpoint_date, movement_id) >= (OLD.movement_date, OLD.id))
+                  OR (material_id = NEW.material_id
+                      AND (checkpoint_date, movement_id) >= (NEW.movement_date, NEW.id));
+           END)"
+    };
+}
+
+bool InventoryLedger::createSchema()
+{
+    if (!isConnected()) {
+        return false;
+    }
+
+    const QStringList statements = schemaStatements();
+    for (const QString &sql : statements) {
+        if (!execute(sql, QVariantList())) {
+            qWarning() << "Failed to create inventory ledger schema:" << m_lastError;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool InventoryLedger::openBalances()
+{
+    if (!isConnected()) {
+        return false;
+    }
+
+    // Stock entered before the ledger existed has no movements behind it
+    const QString sql = QString(R"(
+        INSERT INTO material_movements (material_id, movement_type, quantity, reference, performed_by)
+        SELECT m.id, 'adjustment', m.quantity - IFNULL(h.total, 0), 'opening balance', 'system'
+        FROM materials m
+        LEFT JOIN (SELECT material_id, SUM(%1) AS total
+                   FROM material_movements GROUP BY material_id) h ON h.material_id = m.id
+        WHERE m.quantity <> IFNULL(h.total, 0)
+    )").arg(EFFECT_SQL);
+    return execute(sql, QVariantList());
+}
+
+bool InventoryLedger::recordMovement(int materialId, MovementType type, int quantity,
+                                     const QString &reference, const QString &notes,
+                                     const QString &performedBy)
+{
+    if (!isConnected()) {
+        return false;
+    }
+    if (type == Adjustment ? quantity == 0 : quantity <= 0) {
+        m_lastError = QString("Invalid movement quantity: %1").arg(quantity);
+        return false;
+    }
+
+    const int effect = type == StockOut ? -quantity : quantity;
+    const QVariant user = performedBy.isEmpty() ? QVariant() : QVariant(performedBy);
+
+    bool ownTransaction = false;
+    if (!beginWrite(&ownTransaction)) {
+        return false;
+    }
+
+    bool success = execute("INSERT INTO material_ledger_pending (material_id) VALUES (?)", {materialId});
+    if (success) {
+        QSqlQuery update = m_databaseManager->executeQuery(APPLY_MOVEMENT_SQL, {effect, user, materialId, effect});
+        if (update.lastError().isValid()) {
+            m_lastError = update.lastError().text();
+            success = false;
+        } else if (update.numRowsAffected() != 1) {
+            m_lastError = QString("Unknown material %1 or not enough stock").arg(materialId);
+            success = false;
+        }
+    }
+    success = success
+              && execute(INSERT_MOVEMENT_SQL, {materialId, MOVEMENT_TYPES[type], quantity,
+                                               reference, notes, user})
+              && execute("DELETE FROM material_ledger_pending WHERE material_id = ?", {materialId});
+
+    if (!endWrite(ownTransaction, success)) {
+        qWarning() << "Failed to record movement for material" << materialId << ":" << m_lastError;
+        return false;
+    }
+    return updateCheckpoints(materialId);
+}
+
+InventoryLedger::Balance InventoryLedger::balanceAt(int materialId, const QDateTime &at, bool *ok)
+{
+    const QString date = sqlTime(at);
+    Checkpoint checkpoint;
+    bool success = latestCheckpoint(materialId, date, &checkpoint);
+
+    // Only the movements between the checkpoint and the date are read; a
+    // checkpoint not written yet just means a few more of them
+    if (success) {
+        QSqlQuery query = m_databaseManager->executeQuery(
+            RANGE_TOTALS_SQL, {materialId, checkpoint.date, checkpoint.movementId, date});
+        if (query.next()) {
+            const qint64 received = query.value(0).toLongLong();
+            const qint64 consumed = query.value(1).toLongLong();
+            checkpoint.balance.quantity += int(received - consumed);
+            checkpoint.balance.received += received;
+            checkpoint.balance.consumed += consumed;
+        } else {
+            m_lastError = query.lastError().text();
+            success = false;
+        }
+        query.finish();
+    }
+
+    if (ok) {
+        *ok = success;
+    }
+    return success ? checkpoint.balance : Balance();
+}
+
+int InventoryLedger::stockAt(int materialId, const QDateTime &at, bool *ok)
+{
+    return balanceAt(materialId, at, ok).quantity;
+}
+
+InventoryLedger::Flow InventoryLedger::flowBetween(int materialId, const QDateTime &from,
+                                                   const QDateTime &to, bool *ok)
+{
+    bool openingOk = false;
+    bool closingOk = false;
+    const Balance opening = balanceAt(materialId, from, &openingOk);
+    const Balance closing = balanceAt(materialId, to, &closingOk);
+
+    Flow flow;
+    if (openingOk && closingOk) {
+        flow.openingQuantity = opening.quantity;
+        flow.closingQuantity = closing.quantity;
+        flow.received = closing.received - opening.received;
+        flow.consumed = closing.consumed - opening.consumed;
+    }
+    if (ok) {
+        *ok = openingOk && closingOk;
+    }
+    return flow;
+}
+
+QList<InventoryLedger::Movement> InventoryLedger::movements(int materialId, const QDateTime &from,
+                                                            const QDateTime &to, bool *ok)
+{
+    QList<Movement> result;
+    bool success = isConnected();
+    if (success) {
+        QSqlQuery query = m_databaseManager->executeForwardOnly(R"(
+            SELECT id, movement_type, quantity, reference, notes, performed_by, movement_date
+            FROM material_movements
+            WHERE material_id = ? AND movement_date > ? AND movement_date <= ?
+            ORDER BY movement_date, id
+        )", {materialId, sqlTime(from), sqlTime(to)});
+        success = query.isActive();
+
+        while (query.next()) {
+            Movement movement;
+            movement.id = query.value(0).toLongLong();
+            movement.type = query.value(1).toString();
+            movement.quantity = query.value(2).toInt();
+            movement.reference = query.value(3).toString();
+            movement.notes = query.value(4).toString();
+            movement.performedBy = query.value(5).toString();
+            movement.date = QDateTime::fromString(query.value(6).toString(), SQL_TIME_FORMAT);
+            movement.date.setTimeZone(QTimeZone::utc());
+            result.append(movement);
+        }
+        if (!success || query.lastError().isValid()) {
+            m_lastError = query.lastError().text();
+            success = false;
+        }
+    }
+
+    if (ok) {
+        *ok = success;
+    }
+    return result;
+}
+
+bool InventoryLedger::updateCheckpoints(int materialId)
+{
+    if (!isConnected()) {
+        return false;
+    }
+
+    // Walks the movements after the latest checkpoint, normally fewer than
+    // CHECKPOINT_INTERVAL, and collects the checkpoints they complete
+    auto collect = [this, materialId](QList<Checkpoint> *checkpoints) {
+        Checkpoint checkpoint;
+        if (!latestCheckpoint(materialId, QString(), &checkpoint)) {
+            return false;
+        }
+        QSqlQuery query = m_databaseManager->executeForwardOnly(
+            TAIL_SQL, {materialId, checkpoint.date, checkpoint.movementId});
+        if (!query.isActive()) {
+            m_lastError = query.lastError().text();
+            return false;
+        }
+
+        int count = 0;
+        while (query.next()) {
+            checkpoint.movementId = query.value(0).toLongLong();
+            checkpoint.date = query.value(1).toString();
+            applyEffect(&checkpoint.balance, query.value(2).toInt());
+            if (++count == CHECKPOINT_INTERVAL) {
+                checkpoints->append(checkpoint);
+                count = 0;
+            }
+        }
+        return true;
+    };
+
+    QList<Checkpoint> checkpoints;
+    if (!collect(&checkpoints)) {
+        return false;
+    }
+    if (checkpoints.isEmpty()) {
+        return true;
+    }
+
+    // Walked again under the write lock, so a movement written meanwhile
+    // cannot be missing from the checkpoints stored
+    bool ownTransaction = false;
+    if (!beginWrite(&ownTransaction)) {
+        return false;
+    }
+    checkpoints.clear();
+    bool success = collect(&checkpoints);
+    for (const Checkpoint &checkpoint : std::as_const(checkpoints)) {
+        if (!success) {
+            break;
+        }
+        success = execute(INSERT_CHECKPOINT_SQL, {materialId, checkpoint.date, checkpoint.movementId,
+                                                  checkpoint.balance.quantity, checkpoint.balance.received,
+                                                  checkpoint.balance.consumed});
+    }
+    return endWrite(ownTransaction, success);
+}
+
+bool InventoryLedger::rebuildCheckpoints()
+{
+    if (!isConnected()) {
+        return false;
+    }
+
+    QList<int> materialIds;
+    QSqlQuery query = m_databaseManager->executeForwardOnly("SELECT DISTINCT material_id FROM material_movements");
+    while (query.next()) {
+        materialIds.append(query.value(0).toInt());
+    }
+    if (query.lastError().isValid()) {
+        m_lastError = query.lastError().text();
+        return false;
+    }
+    query.finish();
+
+    for (int materialId : std::as_const(materialIds)) {
+        if (!updateCheckpoints(materialId)) {
+            qWarning() << "Failed to update stock checkpoints of material" << materialId << ":" << m_lastError;
+            return false;
+        }
+    }
+    return true;
+}
+
+QString InventoryLedger::sqlTime(const QDateTime &time)
+{
+    return time.toUTC().toString(SQL_TIME_FORMAT);
+}
+
+QString InventoryLedger::lastError() const
+{
+    return m_lastError;
+}
+
+bool InventoryLedger::latestCheckpoint(int materialId, const QString &notAfter, Checkpoint *checkpoint)
+{
+    *checkpoint = Checkpoint();
+    QSqlQuery query = notAfter.isEmpty()
+        ? m_databaseManager->executeQuery(LATEST_CHECKPOINT_SQL, {materialId})
+        : m_databaseManager->executeQuery(CHECKPOINT_AT_SQL, {materialId, notAfter});
+    if (query.lastError().isValid()) {
+        m_lastError = query.lastError().text();
+        return false;
+    }
+
+    if (query.next()) {
+        checkpoint->date = query.value(0).toString();
+        checkpoint->movementId = query.value(1).toLongLong();
+        checkpoint->balance.quantity = query.value(2).toInt();
+        checkpoint->balance.received = query.value(3).toLongLong();
+        checkpoint->balance.consumed = query.value(4).toLongLong();
+    }
+    query.finish();
+    return true;
+}
+
+bool InventoryLedger::beginWrite(bool *ownTransaction)
+{
+    // Inside a caller's transaction (a migration, a batch) nest under a savepoint
+    *ownTransaction = !m_databaseManager->inTransaction();
+    const bool started = *ownTransaction ? m_databaseManager->beginTransaction()
+                                         : m_databaseManager->executeNonQuery("SAVEPOINT inventory_ledger");
+    if (!started) {
+        m_lastError = m_databaseManager->lastError();
+    }
+    return started;
+}
+
+bool InventoryLedger::endWrite(bool ownTransaction, bool success)
+{
+    if (ownTransaction) {
+        if (success && m_databaseManager->commitTransaction()) {
+            return true;
+        }
+        if (success) {
+            m_lastError = m_databaseManager->lastError();
+        }
+        m_databaseManager->rollbackTransaction();
+        return false;
+    }
+
+    if (success) {
+        return execute("RELEASE SAVEPOINT inventory_ledger", QVariantList());
+    }
+    m_databaseManager->executeNonQuery("ROLLBACK TO SAVEPOINT inventory_ledger");
+    m_databaseManager->executeNonQuery("RELEASE SAVEPOINT inventory_ledger");
+    return false;
+}
+
+bool InventoryLedger::execute(const QString &sql, const QVariantList &params)
+{
+    if (!m_databaseManager->executeNonQuery(sql, params)) {
+        m_lastError = m_databaseManager->lastError();
+        return false;
+    }
+    return true;
+}
+
+bool InventoryLedger::isConnected()
+{
+    // The connection, not DatabaseManager::isConnected(): migration 6 uses
+    // the ledger before initialize() has finished
+    if (!m_databaseManager || !m_databaseManager->database().isOpen()) {
+        m_lastError = "Database not connected";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,113 @@
+#ifndef INVENTORYLEDGER_H
+#define INVENTORYLEDGER_H
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+class DatabaseManager;
+
+/**
+ * @brief The InventoryLedger class - Stock history of materials from material_movements
+ *
+ * Every change of materials.quantity appends a movement: recordMovement()
+ * writes typed ones ("in", "out", "adjustment") and updates the quantity in
+ * the same transaction, and triggers log any other quantity edit - the
+ * materials table, batch updates, imports - as a signed adjustment, so the
+ * movements always add up to the quantity on hand.
+ *
+ * Per material, a checkpoint holding the running balance and totals is
+ * stored every CHECKPOINT_INTERVAL movements in (movement_date, id) order.
+ * stockAt() and flowBetween() start from the nearest checkpoint at or
+ * before the date and sum the few movements after it, never the whole
+ * history. A movement inserted, changed or deleted before a checkpoint
+ * drops the checkpoints after it; they are written again by
+ * updateCheckpoints(). The queries only read, so they also work on a
+ * query_only connection: recordMovement() updates the checkpoints of its
+ * material, and DatabaseManager calls rebuildCheckpoints() after each idle
+ * maintenance pass for movements the triggers logged. Until then a query
+ * sums the movements after the last checkpoint still in place.
+ *
+ * Dates are compared as SQLite's "yyyy-MM-dd hh:mm:ss" UTC text, the
+ * format CURRENT_TIMESTAMP fills movement_date with.
+ */
+class InventoryLedger
+{
+public:
+    enum MovementType {
+        StockIn,
+        StockOut,
+        Adjustment      // signed
+    };
+
+    // Running totals up to a point in time; consumed is positive
+    struct Balance {
+        int quantity = 0;
+        qint64 received = 0;
+        qint64 consumed = 0;
+    };
+
+    // Movements over a period
+    struct Flow {
+        int openingQuantity = 0;
+        int closingQuantity = 0;
+        qint64 received = 0;
+        qint64 consumed = 0;
+    };
+
+    struct Movement {
+        qint64 id = 0;
+        QString type;
+        int quantity = 0;
+        QString reference;
+        QString notes;
+        QString performedBy;
+        QDateTime date;
+    };
+
+    static const int CHECKPOINT_INTERVAL;
+
+    explicit InventoryLedger(DatabaseManager *databaseManager);
+
+    // Schema, for the migration that introduces the ledger
+    static QStringList schemaStatements();
+    bool createSchema();
+    bool openBalances();        // one adjustment per material whose history does not add up
+
+    bool recordMovement(int materialId, MovementType type, int quantity,
+                        const QString &reference = QString(), const QString &notes = QString(),
+                        const QString &performedBy = QString());
+
+    // History; the range of flowBetween() and movements() is (from, to]
+    Balance balanceAt(int materialId, const QDateTime &at, bool *ok = nullptr);
+    int stockAt(int materialId, const QDateTime &at, bool *ok = nullptr);
+    Flow flowBetween(int materialId, const QDateTime &from, const QDateTime &to, bool *ok = nullptr);
+    QList<Movement> movements(int materialId, const QDateTime &from, const QDateTime &to, bool *ok = nullptr);
+
+    // Checkpoint maintenance
+    bool updateCheckpoints(int materialId);
+    bool rebuildCheckpoints();  // every material
+
+    static QString sqlTime(const QDateTime &time);
+    QString lastError() const;
+
+private:
+    struct Checkpoint {
+        QString date;           // empty before the first movement
+        qint64 movementId = 0;  // last movement the balance includes
+        Balance balance;
+    };
+
+    bool latestCheckpoint(int materialId, const QString &notAfter, Checkpoint *checkpoint);
+    bool beginWrite(bool *ownTransaction);
+    bool endWrite(bool ownTransaction, bool success);
+    bool execute(const QString &sql, const QVariantList &params);
+    bool isConnected();
+
+    DatabaseManager *m_databaseManager;
+    QString m_lastError;
+};
+
+#endif // INVENTORYLEDGER_H
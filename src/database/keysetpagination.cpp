@@ -0,0 +1,182 @@
+#include "keysetpagination.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+const int KeysetPagination::DEFAULT_PAGE_SIZE = 100;
+const int KeysetPagination::MAX_PAGE_SIZE = 1000;
+
+KeysetPagination::KeysetPagination(const QString &table, const QString &keyColumn,
+                                   const QList<SortKey> &sortKeys, const QString &defaultSortKey,
+                                   Qt::SortOrder defaultOrder)
+    : m_table(table)
+    , m_keyColumn(keyColumn)
+    , m_sortKeys(sortKeys)
+    , m_defaultSortKey(defaultSortKey)
+    , m_defaultOrder(defaultOrder)
+{
+}
+
+QStringList KeysetPagination::sortKeys() const
+{
+    QStringList names;
+    for (const SortKey &key : m_sortKeys) {
+        names << key.name;
+    }
+    return names;
+}
+
+QStringList KeysetPagination::indexStatements() const
+{
+    // SQLite walks the same index backwards for descending pages
+    QStringList statements;
+    for (const SortKey &key : m_sortKeys) {
+        statements << QString("CREATE INDEX IF NOT EXISTS idx_%1_page_%2 ON %1(%3, %4)")
+                          .arg(m_table, key.name, key.expressions.join(", "), m_keyColumn);
+    }
+    return statements;
+}
+
+QStringList KeysetPagination::planQueries() const
+{
+    QStringList queries;
+    for (const SortKey &key : m_sortKeys) {
+        QString sql;
+        QVariantList params;
+        if (buildQuery(PageRequest{key.name, Qt::AscendingOrder, 0, QString()}, &sql, &params, nullptr)) {
+            queries << sql;
+        }
+    }
+    return queries;
+}
+
+int KeysetPagination::pageSize(const PageRequest &request) const
+{
+    if (request.pageSize <= 0) {
+        return DEFAULT_PAGE_SIZE;
+    }
+    return qMin(request.pageSize, MAX_PAGE_SIZE);
+}
+
+bool KeysetPagination::buildQuery(const PageRequest &request, QString *sql, QVariantList *params,
+                                  QString *errorMessage) const
+{
+    return buildQuery(request, QString(), QVariantList(), sql, params, errorMessage);
+}
+
+bool KeysetPagination::buildQuery(const PageRequest &request, const QString &condition,
+                                  const QVariantList &conditionParams, QString *sql, QVariantList *params,
+                                  QString *errorMessage) const
+{
+    Order order;
+    if (!resolve(request, &order, errorMessage)) {
+        return false;
+    }
+
+    const QStringList columns = QStringList(order.key->expressions) << m_keyColumn;
+
+    QString select = "SELECT *";
+    for (int i = 0; i < order.key->expressions.size(); ++i) {
+        select += QString(", %1 AS %2").arg(order.key->expressions.at(i), cursorColumn(i));
+    }
+    *sql = QString("%1 FROM %2").arg(select, m_table);
+    params->clear();
+
+    QStringList where;
+    if (!condition.isEmpty()) {
+        where << QString("(%1)").arg(condition);
+        *params << conditionParams;
+    }
+
+    if (!request.continuationToken.isEmpty()) {
+        const QByteArray::FromBase64Result decoded = QByteArray::fromBase64Encoding(
+            request.continuationToken.toLatin1(),
+            QByteArray::Base64UrlEncoding | QByteArray::AbortOnBase64DecodingErrors);
+        const QJsonObject token = decoded ? QJsonDocument::fromJson(*decoded).object() : QJsonObject();
+        const QJsonArray values = token.value("v").toArray();
+
+        // A token only continues the listing it came from
+        if (token.value("t").toString() != m_table || token.value("s").toString() != order.key->name
+            || token.value("d").toBool() != order.descending || values.size() != columns.size()) {
+            if (errorMessage) {
+                *errorMessage = QString("Invalid continuation token for %1").arg(m_table);
+            }
+            return false;
+        }
+
+        QStringList placeholders;
+        for (const QJsonValue &value : values) {
+            params->append(value.toVariant());
+            placeholders << "?";
+        }
+        where << QString("(%1) %2 (%3)")
+                     .arg(columns.join(", "), order.descending ? "<" : ">", placeholders.join(", "));
+    }
+    if (!where.isEmpty()) {
+        *sql += " WHERE " + where.join(" AND ");
+    }
+
+    QStringList orderBy;
+    for (const QString &column : columns) {
+        orderBy << column + (order.descending ? " DESC" : " ASC");
+    }
+    *sql += QString(" ORDER BY %1 LIMIT ?").arg(orderBy.join(", "));
+    params->append(pageSize(request) + 1);
+    return true;
+}
+
+QString KeysetPagination::continuationToken(const PageRequest &request, const QSqlRecord &lastRecord) const
+{
+    return encodeToken(request, cursorValues(lastRecord));
+}
+
+bool KeysetPagination::resolve(const PageRequest &request, Order *order, QString *errorMessage) const
+{
+    const QString name = request.sortKey.isEmpty() ? m_defaultSortKey : request.sortKey;
+    const Qt::SortOrder sortOrder = request.sortKey.isEmpty() ? m_defaultOrder : request.sortOrder;
+
+    for (const SortKey &key : m_sortKeys) {
+        if (key.name == name) {
+            order->key = &key;
+            order->descending = sortOrder == Qt::DescendingOrder;
+            return true;
+        }
+    }
+
+    if (errorMessage) {
+        *errorMessage = QString("Cannot sort %1 by '%2'").arg(m_table, name);
+    }
+    return false;
+}
+
+QVariantList KeysetPagination::cursorValues(const QSqlRecord &record) const
+{
+    QVariantList values;
+    for (int i = 0; record.indexOf(cursorColumn(i)) >= 0; ++i) {
+        values << record.value(cursorColumn(i));
+    }
+    values << record.value(m_keyColumn);
+    return values;
+}
+
+QString KeysetPagination::encodeToken(const PageRequest &request, const QVariantList &cursor) const
+{
+    Order order;
+    if (!resolve(request, &order, nullptr)) {
+        return QString();
+    }
+
+    QJsonObject token;
+    token["t"] = m_table;
+    token["s"] = order.key->name;
+    token["d"] = order.descending;
+    token["v"] = QJsonArray::fromVariantList(cursor);
+
+    return QString::fromLatin1(QJsonDocument(token).toJson(QJsonDocument::Compact)
+                                   .toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
+
+QString KeysetPagination::cursorColumn(int index)
+{
+    return QString("page_cursor_%1").arg(index);
+}
@@ -0,0 +1,137 @@
+#ifndef KEYSETPAGINATION_H
+#define KEYSETPAGINATION_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVariant>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <type_traits>
+
+/**
+ * @brief One page request for a keyset-paginated list
+ */
+struct PageRequest
+{
+    QString sortKey;                    // Empty selects the list's default order
+    Qt::SortOrder sortOrder = Qt::AscendingOrder; // Ignored for the default order
+    int pageSize = 0;                   // 0 selects KeysetPagination::DEFAULT_PAGE_SIZE
+    QString continuationToken;          // From the previous page; empty for the first
+};
+
+/**
+ * @brief One page of a keyset-paginated list
+ *
+ * Pass continuationToken back in the next PageRequest, with the same sort
+ * key and order, to get the rows that follow.
+ */
+template <typename T>
+struct Page
+{
+    QList<T> items;
+    QString continuationToken;          // Empty on the last page
+    QString error;
+
+    bool isValid() const { return error.isEmpty(); }
+    bool hasMore() const { return !continuationToken.isEmpty(); }
+};
+
+/**
+ * @brief The KeysetPagination class - Seek-based paging over one table
+ *
+ * Pages are read with WHERE (sort columns, key) > (last row's values)
+ * instead of OFFSET, so every page costs the same no matter how deep the
+ * caller has scrolled and rows inserted meanwhile never shift a page.
+ * The continuation token carries the last row's sort values and key.
+ *
+ * Each sort key is a list of SQL expressions ordered in one direction,
+ * with the table's unique key column as the final tie-breaker. Expressions
+ * must never be NULL (wrap nullable columns in IFNULL) because row-value
+ * comparisons skip NULLs. indexStatements() yields one composite index per
+ * sort key that serves both directions.
+ */
+class KeysetPagination
+{
+public:
+    struct SortKey {
+        QString name;                   // PageRequest::sortKey
+        QStringList expressions;
+    };
+
+    static const int DEFAULT_PAGE_SIZE;
+    static const int MAX_PAGE_SIZE;
+
+    KeysetPagination(const QString &table, const QString &keyColumn, const QList<SortKey> &sortKeys,
+                     const QString &defaultSortKey, Qt::SortOrder defaultOrder);
+
+    QStringList sortKeys() const;
+    QStringList indexStatements() const;
+    QStringList planQueries() const;    // First-page query of every sort key
+    int pageSize(const PageRequest &request) const;
+
+    // Builds the page query; returns false for unknown sort keys and tokens
+    // that belong to another table, sort key or order
+    bool buildQuery(const PageRequest &request, QString *sql, QVariantList *params,
+                    QString *errorMessage) const;
+
+    // Same, limited to rows matching condition, an SQL expression whose
+    // placeholders take conditionParams. The condition must be the same
+    // for every page of one listing.
+    bool buildQuery(const PageRequest &request, const QString &condition, const QVariantList &conditionParams,
+                    QString *sql, QVariantList *params, QString *errorMessage) const;
+
+    // Reads the executed query into a page. Null pointers from makeItem are skipped.
+    template <typename T, typename Factory>
+    Page<T> readPage(QSqlQuery &query, const PageRequest &request, Factory makeItem) const
+    {
+        Page<T> page;
+        const int size = pageSize(request);
+        QVariantList cursor;
+        int rows = 0;
+
+        while (query.next()) {
+            // The query asks for one row more than the page holds
+            if (rows == size) {
+                page.continuationToken = encodeToken(request, cursor);
+                break;
+            }
+            if (++rows == size) {
+                cursor = cursorValues(query.record());
+            }
+
+            T item = makeItem(query);
+            if constexpr (std::is_pointer_v<T>) {
+                if (!item) {
+                    continue;
+                }
+            }
+            page.items.append(item);
+        }
+
+        query.finish();
+        return page;
+    }
+
+    // Token for the page ending at record; for callers that read rows themselves
+    QString continuationToken(const PageRequest &request, const QSqlRecord &lastRecord) const;
+
+private:
+    struct Order {
+        const SortKey *key;
+        bool descending;
+    };
+
+    bool resolve(const PageRequest &request, Order *order, QString *errorMessage) const;
+    QVariantList cursorValues(const QSqlRecord &record) const;
+    QString encodeToken(const PageRequest &request, const QVariantList &cursor) const;
+    static QString cursorColumn(int index);
+
+    QString m_table;
+    QString m_keyColumn;
+    QList<SortKey> m_sortKeys;
+    QString m_defaultSortKey;
+    Qt::SortOrder m_defaultOrder;
+};
+
+#endif // KEYSETPAGINATION_H
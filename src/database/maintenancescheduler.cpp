@@ -0,0 +1,599 @@
+#include "maintenancescheduler.h"
+#include "queryprofiler.h"
+#include "sqlitenative.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QThread>
+#include <QTimer>
+#include <QFileInfo>
+#include <QDeadlineTimer>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QMutexLocker>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+#include <sqlite3.h>
+#endif
+
+const int MaintenanceScheduler::DEFAULT_IDLE_THRESHOLD_MS = 60 * 1000;
+const int MaintenanceScheduler::DEFAULT_STEP_BUDGET_MS = 250;
+const int MaintenanceScheduler::ANALYZE_ROW_THRESHOLD = 1000;
+const int MaintenanceScheduler::MAX_HISTORY = 50;
+
+namespace {
+
+const int IDLE_CHECK_INTERVAL_MS = 5000;
+
+// A database is visited again only after this long, unless work was left over
+const int MIN_PASS_INTERVAL_MS = 15 * 60 * 1000;
+
+// Pages freed per incremental_vacuum statement; small enough to keep the
+// write lock short
+const int INCREMENTAL_VACUUM_PAGES = 128;
+
+// Rows ANALYZE samples per index; keeps it fast on large tables
+const int ANALYSIS_LIMIT = 1000;
+
+// Most expensive profiled statements whose plans are compared
+const int MAX_PROFILED_PLANS = 10;
+
+// Bounds one maintenance step. Statements run past the deadline are
+// interrupted through the progress handler where the native API is linked.
+class StepBudget
+{
+public:
+    StepBudget(const QSqlDatabase &database, int milliseconds)
+        : m_deadline(milliseconds)
+    {
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+        m_handle = SqliteNative::handle(database);
+        if (m_handle) {
+            sqlite3_progress_handler(m_handle, 1000, &StepBudget::check, this);
+        }
+#else
+        Q_UNUSED(database)
+#endif
+    }
+
+    ~StepBudget()
+    {
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+        if (m_handle) {
+            sqlite3_progress_handler(m_handle, 0, nullptr, nullptr);
+        }
+#endif
+    }
+
+    bool hasExpired() const { return m_deadline.hasExpired(); }
+
+private:
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    static int check(void *budget)
+    {
+        return static_cast<StepBudget *>(budget)->hasExpired() ? 1 : 0;
+    }
+
+    sqlite3 *m_handle = nullptr;
+#endif
+    QDeadlineTimer m_deadline;
+};
+
+QString workerConnectionName(const QString &connectionName)
+{
+    return QString("maintenance_%1").arg(connectionName);
+}
+
+qint64 fileSize(const QString &path)
+{
+    return QFileInfo(path).size() + QFileInfo(path + "-wal").size();
+}
+
+int pragmaValue(QSqlDatabase &database, const QString &pragma)
+{
+    QSqlQuery query(database);
+    if (query.exec("PRAGMA " + pragma) && query.next()) {
+        return query.value(0).toInt();
+    }
+    return -1;
+}
+
+// Statements whose plans are compared before and after new statistics
+QStringList planQueries(const MaintenanceScheduler::Database &database)
+{
+    QStringList queries = database.planQueries;
+
+    QList<QueryProfiler::StatementStats> statistics = QueryProfiler::instance()->statistics();
+    std::sort(statistics.begin(), statistics.end(),
+              [](const QueryProfiler::StatementStats &a, const QueryProfiler::StatementStats &b) {
+                  return a.totalMs > b.totalMs;
+              });
+
+    int profiled = 0;
+    for (const QueryProfiler::StatementStats &stats : std::as_const(statistics)) {
+        if (profiled == MAX_PROFILED_PLANS) {
+            break;
+        }
+        if (!stats.sources.contains(database.source)
+            || !stats.normalizedSql.startsWith("SELECT", Qt::CaseInsensitive)) {
+            continue;
+        }
+        QString sql = stats.normalizedSql;
+        sql.replace("(?, ...)", "(?)");
+        if (!queries.contains(sql)) {
+            queries << sql;
+            ++profiled;
+        }
+    }
+    return queries;
+}
+
+QHash<QString, QString> queryPlans(QSqlDatabase &database, const QStringList &queries)
+{
+    QHash<QString, QString> plans;
+    for (const QString &sql : queries) {
+        QSqlQuery query(database);
+        if (!query.prepare("EXPLAIN QUERY PLAN " + sql)) {
+            continue;
+        }
+        // Every placeholder is unbound; the plan does not depend on values
+        for (int i = 0; i < sql.count('?'); ++i) {
+            query.bindValue(i, QVariant());
+        }
+        if (!query.exec()) {
+            continue;
+        }
+
+        QStringList steps;
+        while (query.next()) {
+            steps << query.value("detail").toString();
+        }
+        plans.insert(sql, steps.join("; "));
+    }
+    return plans;
+}
+
+} // namespace
+
+MaintenanceScheduler *MaintenanceScheduler::instance()
+{
+    static MaintenanceScheduler scheduler;
+    return &scheduler;
+}
+
+MaintenanceScheduler::MaintenanceScheduler(QObject *parent)
+    : QObject(parent)
+    , m_running(false)
+    , m_idleThresholdMs(DEFAULT_IDLE_THRESHOLD_MS)
+    , m_stepBudgetMs(DEFAULT_STEP_BUDGET_MS)
+    , m_idleTimer(new QTimer(this))
+{
+    // One worker keeps passes strictly sequential and owns every
+    // maintenance connection
+    m_workerPool.setMaxThreadCount(1);
+    m_workerPool.setExpiryTimeout(-1);
+
+    m_lastActivity.start();
+    m_idleTimer->setInterval(IDLE_CHECK_INTERVAL_MS);
+    connect(m_idleTimer, &QTimer::timeout, this, &MaintenanceScheduler::checkIdle);
+
+    // User input is seen by the application object on the GUI thread
+    if (QCoreApplication::instance()) {
+        moveToThread(QCoreApplication::instance()->thread());
+        QCoreApplication::instance()->installEventFilter(this);
+    }
+    QMetaObject::invokeMethod(m_idleTimer, qOverload<>(&QTimer::start));
+}
+
+MaintenanceScheduler::~MaintenanceScheduler()
+{
+    shutdown();
+}
+
+void MaintenanceScheduler::registerDatabase(const Database &database)
+{
+    QMutexLocker locker(&m_mutex);
+    DatabaseState &state = m_databases[database.connectionName];
+    state.database = database;
+    if (!m_order.contains(database.connectionName)) {
+        m_order.append(database.connectionName);
+    }
+}
+
+void MaintenanceScheduler::unregisterDatabase(const QString &connectionName)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_databases.remove(connectionName)) {
+            return;
+        }
+        m_order.removeAll(connectionName);
+        m_requested.removeAll(connectionName);
+    }
+
+    // The worker owns the connection; queued behind any running pass
+    QtConcurrent::run(&m_workerPool, [connectionName]() {
+        closeConnection(workerConnectionName(connectionName));
+    }).waitForFinished();
+}
+
+bool MaintenanceScheduler::isRegistered(const QString &connectionName) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_databases.contains(connectionName);
+}
+
+bool MaintenanceScheduler::requestMaintenance(const QString &connectionName, bool convertVacuum)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_databases.find(connectionName);
+        if (it == m_databases.end()) {
+            return false;
+        }
+        it->convertPending = it->convertPending || convertVacuum;
+        if (!m_requested.contains(connectionName)) {
+            m_requested.append(connectionName);
+        }
+    }
+
+    QMetaObject::invokeMethod(this, &MaintenanceScheduler::checkIdle, Qt::QueuedConnection);
+    return true;
+}
+
+void MaintenanceScheduler::noteBulkWrite(const QString &connectionName, int rowCount)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_databases.find(connectionName);
+        if (it == m_databases.end()) {
+            return;
+        }
+
+        it->bulkRows += rowCount;
+        if (it->bulkRows < ANALYZE_ROW_THRESHOLD) {
+            return;
+        }
+        it->bulkRows = 0;
+        it->analyzePending = true;
+    }
+
+    requestMaintenance(connectionName);
+}
+
+void MaintenanceScheduler::setIdleThreshold(int milliseconds)
+{
+    QMutexLocker locker(&m_mutex);
+    m_idleThresholdMs = qMax(0, milliseconds);
+}
+
+int MaintenanceScheduler::idleThreshold() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_idleThresholdMs;
+}
+
+void MaintenanceScheduler::setStepBudget(int milliseconds)
+{
+    QMutexLocker locker(&m_mutex);
+    m_stepBudgetMs = qMax(1, milliseconds);
+}
+
+int MaintenanceScheduler::stepBudget() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stepBudgetMs;
+}
+
+QList<MaintenanceScheduler::Report> MaintenanceScheduler::history() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_history;
+}
+
+bool MaintenanceScheduler::isRunning() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_running;
+}
+
+void MaintenanceScheduler::shutdown()
+{
+    m_idleTimer->stop();
+
+    QStringList connectionNames;
+    {
+        QMutexLocker locker(&m_mutex);
+        connectionNames = m_databases.keys();
+        m_databases.clear();
+        m_order.clear();
+        m_requested.clear();
+    }
+
+    QtConcurrent::run(&m_workerPool, [connectionNames]() {
+        for (const QString &connectionName : connectionNames) {
+            closeConnection(workerConnectionName(connectionName));
+        }
+    }).waitForFinished();
+}
+
+bool MaintenanceScheduler::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::KeyPress:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::TouchBegin:
+        m_lastActivity.restart();
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void MaintenanceScheduler::checkIdle()
+{
+    QString connectionName;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_running) {
+            return;
+        }
+
+        if (!m_requested.isEmpty()) {
+            connectionName = m_requested.takeFirst();
+        } else if (m_lastActivity.elapsed() >= m_idleThresholdMs) {
+            connectionName = nextIdleCandidate();
+        }
+
+        if (connectionName.isEmpty()) {
+            return;
+        }
+
+        // The next idle pass starts after this database
+        m_order.removeAll(connectionName);
+        m_order.append(connectionName);
+    }
+
+    startPass(connectionName);
+}
+
+QString MaintenanceScheduler::nextIdleCandidate() const
+{
+    // Called with m_mutex held
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    for (const QString &connectionName : m_order) {
+        const DatabaseState &state = m_databases.value(connectionName);
+        if (state.moreWork || state.analyzePending || !state.lastPass.isValid()
+            || state.lastPass.msecsTo(now) >= MIN_PASS_INTERVAL_MS) {
+            return connectionName;
+        }
+    }
+    return QString();
+}
+
+void MaintenanceScheduler::startPass(const QString &connectionName)
+{
+    Database database;
+    bool analyze = false;
+    bool convertVacuum = false;
+    int stepBudgetMs = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_databases.find(connectionName);
+        if (it == m_databases.end()) {
+            return;
+        }
+        database = it->database;
+        analyze = it->analyzePending;
+        it->analyzePending = false;
+        convertVacuum = it->convertPending;
+        it->convertPending = false;
+        stepBudgetMs = m_stepBudgetMs;
+        m_running = true;
+    }
+
+    QtConcurrent::run(&m_workerPool, [this, database, analyze, convertVacuum, stepBudgetMs]() {
+        const Report report = runPass(database, analyze, convertVacuum, stepBudgetMs);
+        QMetaObject::invokeMethod(this, [this, report, analyze]() {
+            finishPass(report, analyze);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MaintenanceScheduler::finishPass(const Report &report, bool analyzeRequested)
+{
+    bool requestsQueued = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_running = false;
+
+        auto it = m_databases.find(report.connectionName);
+        if (it != m_databases.end()) {
+            it->lastPass = report.finishedAt;
+            it->moreWork = report.budgetExhausted;
+            // An interrupted ANALYZE runs again in the next pass
+            if (analyzeRequested && !report.steps.contains("analyze")) {
+                it->analyzePending = true;
+            }
+        }
+
+        m_history.append(report);
+        while (m_history.size() > MAX_HISTORY) {
+            m_history.removeFirst();
+        }
+        requestsQueued = !m_requested.isEmpty();
+    }
+
+    if (!report.error.isEmpty()) {
+        qWarning() << "MaintenanceScheduler:" << report.connectionName << "-" << report.error;
+    } else if (!report.steps.isEmpty()) {
+        qDebug() << "MaintenanceScheduler:" << report.connectionName << report.steps.join(", ")
+                 << "in" << report.elapsedMs << "ms, reclaimed" << report.bytesReclaimed << "bytes,"
+                 << report.planChanges.size() << "plan changes";
+    }
+
+    emit maintenanceFinished(report);
+
+    if (requestsQueued) {
+        checkIdle();
+    }
+}
+
+MaintenanceScheduler::Report MaintenanceScheduler::runPass(const Database &database, bool analyze,
+                                                           bool convertVacuum, int stepBudgetMs)
+{
+    Report report;
+    report.connectionName = database.connectionName;
+    report.fileSizeBefore = fileSize(database.path);
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    QSqlDatabase connection = maintenanceConnection(database, &report.error);
+    if (!connection.isOpen()) {
+        report.finishedAt = QDateTime::currentDateTimeUtc();
+        return report;
+    }
+
+    // WAL checkpoint - PASSIVE copies what it can without waiting on anyone
+    {
+        QSqlQuery checkpoint(connection);
+        if (checkpoint.exec("PRAGMA wal_checkpoint(PASSIVE)") && checkpoint.next()
+            && checkpoint.value(1).toInt() > 0) {
+            report.walFramesCheckpointed = checkpoint.value(2).toInt();
+            report.steps << "checkpoint";
+        }
+    }
+
+    // Statistics - a full ANALYZE after bulk writes, otherwise whatever
+    // PRAGMA optimize finds worth refreshing
+    {
+        // 0x10000 considers every table, not just those this connection used
+        QSqlQuery pending(connection);
+        const bool optimizeDue = !analyze && pending.exec("PRAGMA optimize(0x10003)") && pending.next();
+        pending.finish();
+
+        if (analyze || optimizeDue) {
+            const QStringList queries = planQueries(database);
+            const QHash<QString, QString> plansBefore = queryPlans(connection, queries);
+
+            QSqlQuery statistics(connection);
+            statistics.exec(QString("PRAGMA analysis_limit = %1").arg(ANALYSIS_LIMIT));
+
+            bool updated = false;
+            {
+                StepBudget budget(connection, stepBudgetMs);
+                updated = statistics.exec(analyze ? "ANALYZE" : "PRAGMA optimize(0x10002)");
+                if (!updated && budget.hasExpired()) {
+                    report.budgetExhausted = true;
+                }
+            }
+
+            if (updated) {
+                report.steps << (analyze ? "analyze" : "optimize");
+                const QHash<QString, QString> plansAfter = queryPlans(connection, queries);
+                for (auto it = plansBefore.constBegin(); it != plansBefore.constEnd(); ++it) {
+                    const QString after = plansAfter.value(it.key());
+                    if (after != it.value()) {
+                        report.planChanges.append(PlanChange{it.key(), it.value(), after});
+                    }
+                }
+            } else if (!report.budgetExhausted) {
+                report.error = "Statistics update failed: " + statistics.lastError().text();
+            }
+        }
+    }
+
+    // Free pages
+    const int pageSize = pragmaValue(connection, "page_size");
+    const int autoVacuum = pragmaValue(connection, "auto_vacuum");
+    int freePages = pragmaValue(connection, "freelist_count");
+
+    if (autoVacuum == 2 && freePages > 0) {
+        const int freeBefore = freePages;
+        StepBudget budget(connection, stepBudgetMs);
+        QSqlQuery vacuum(connection);
+        while (freePages > 0 && !budget.hasExpired()) {
+            if (!vacuum.exec(QString("PRAGMA incremental_vacuum(%1)").arg(INCREMENTAL_VACUUM_PAGES))) {
+                break;
+            }
+            while (vacuum.next()) {
+            }
+            freePages = pragmaValue(connection, "freelist_count");
+        }
+        report.bytesReclaimed = qint64(freeBefore - freePages) * pageSize;
+        report.budgetExhausted = report.budgetExhausted || freePages > 0;
+        report.steps << "incremental_vacuum";
+    } else if (autoVacuum != 2 && convertVacuum) {
+        // One-time switch to incremental auto-vacuum; only a VACUUM applies
+        // it, so it runs on user request only, never in an idle pass
+        QSqlQuery vacuum(connection);
+        vacuum.exec("PRAGMA auto_vacuum = INCREMENTAL");
+        if (vacuum.exec("VACUUM")) {
+            for (const FullTextSearch::IndexDefinition &index : database.searchIndexes) {
+                if (!index.integerKey && FullTextSearch::hasIndex(connection, index)) {
+                    FullTextSearch::rebuildIndex(connection, index);
+                }
+            }
+            report.bytesReclaimed = qint64(freePages) * pageSize;
+            report.steps << "vacuum";
+            freePages = pragmaValue(connection, "freelist_count");
+        } else {
+            // Busy writers; runs again when the user next asks for it
+            qDebug() << "MaintenanceScheduler: VACUUM postponed:" << vacuum.lastError().text();
+        }
+    }
+
+    // In WAL mode the file only shrinks once the freed pages are checkpointed
+    if (report.bytesReclaimed > 0) {
+        QSqlQuery checkpoint(connection);
+        checkpoint.exec("PRAGMA wal_checkpoint(PASSIVE)");
+    }
+
+    report.freePagesLeft = qMax(0, freePages);
+    report.fileSizeAfter = fileSize(database.path);
+    report.elapsedMs = elapsed.elapsed();
+    report.finishedAt = QDateTime::currentDateTimeUtc();
+    return report;
+}
+
+QSqlDatabase MaintenanceScheduler::maintenanceConnection(const Database &database, QString *errorMessage)
+{
+    const QString name = workerConnectionName(database.connectionName);
+    if (QSqlDatabase::contains(name)) {
+        return QSqlDatabase::database(name, false);
+    }
+
+    QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", name);
+    connection.setDatabaseName(database.path);
+    if (!connection.open()) {
+        *errorMessage = "Failed to open maintenance connection: " + connection.lastError().text();
+        connection = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+        return QSqlDatabase();
+    }
+
+    // Short waits: a busy database is simply visited again later
+    QSqlQuery pragma(connection);
+    pragma.exec(QString("PRAGMA busy_timeout = %1").arg(DEFAULT_STEP_BUDGET_MS));
+    return connection;
+}
+
+void MaintenanceScheduler::closeConnection(const QString &connectionName)
+{
+    if (!QSqlDatabase::contains(connectionName)) {
+        return;
+    }
+    {
+        QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
+        if (connection.isOpen()) {
+            connection.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
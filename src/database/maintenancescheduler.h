@@ -0,0 +1,156 @@
+#ifndef MAINTENANCESCHEDULER_H
+#define MAINTENANCESCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThreadPool>
+#include <QSqlDatabase>
+#include "fulltextsearch.h"
+
+class QTimer;
+
+/**
+ * @brief The MaintenanceScheduler class - Idle-time upkeep of every database file
+ *
+ * Module managers register their database once it is open. While the user
+ * is idle the scheduler visits the databases in turn and, on a connection of
+ * its own on a background thread, runs one maintenance pass:
+ *
+ * - a passive WAL checkpoint, which never waits for readers or writers
+ * - PRAGMA optimize, or a full ANALYZE after large imports (noteBulkWrite)
+ * - incremental vacuum steps returning free pages to the file system
+ *
+ * Each step is bounded by a time budget: statements are interrupted once it
+ * runs out (when the native SQLite API is available) and vacuum works in
+ * small page chunks, so a pass never holds the write lock for long. Work
+ * left over is picked up in the next idle window.
+ *
+ * New files are created with incremental auto-vacuum (see
+ * ConnectionPool::configureConnection). Older files only switch to it with a
+ * full VACUUM, which cannot be budgeted and renumbers implicit rowids; idle
+ * passes never run it. It runs once, in a pass the user asked for with
+ * requestMaintenance(name, true), and the registered search indexes over
+ * such tables are rebuilt after it.
+ *
+ * Every pass yields a Report with the space reclaimed and the query plans
+ * that changed after new statistics, for the registered plan queries and
+ * the statements QueryProfiler has seen for the database.
+ */
+class MaintenanceScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Database {
+        QString connectionName;     // Owner's connection; identifies the database here
+        QString path;
+        QString source;             // QueryProfiler source of the owner's statements
+        QList<FullTextSearch::IndexDefinition> searchIndexes;
+        QStringList planQueries;    // Statements whose query plans are tracked
+    };
+
+    struct PlanChange {
+        QString sql;
+        QString before;
+        QString after;
+    };
+
+    struct Report {
+        QString connectionName;
+        QDateTime finishedAt;
+        qint64 elapsedMs = 0;
+        QStringList steps;          // checkpoint, optimize, analyze, incremental_vacuum, vacuum
+        int walFramesCheckpointed = 0;
+        qint64 fileSizeBefore = 0;  // Database file plus WAL, in bytes
+        qint64 fileSizeAfter = 0;
+        qint64 bytesReclaimed = 0;  // Free pages returned to the file system
+        int freePagesLeft = 0;
+        bool budgetExhausted = false;
+        QList<PlanChange> planChanges;
+        QString error;
+    };
+
+    static const int DEFAULT_IDLE_THRESHOLD_MS;
+    static const int DEFAULT_STEP_BUDGET_MS;
+    static const int ANALYZE_ROW_THRESHOLD;
+    static const int MAX_HISTORY;
+
+    static MaintenanceScheduler *instance();
+
+    void registerDatabase(const Database &database);
+    void unregisterDatabase(const QString &connectionName);
+    bool isRegistered(const QString &connectionName) const;
+
+    // Runs a pass for the database as soon as the worker is free, idle or not.
+    // convertVacuum lets that pass convert an old file to incremental
+    // auto-vacuum; only explicit user actions set it.
+    bool requestMaintenance(const QString &connectionName, bool convertVacuum = false);
+
+    // Bulk writes add up; past ANALYZE_ROW_THRESHOLD rows the next pass
+    // runs ANALYZE, and it is requested right away. Thread-safe.
+    void noteBulkWrite(const QString &connectionName, int rowCount);
+
+    // Configuration
+    void setIdleThreshold(int milliseconds);
+    int idleThreshold() const;
+    void setStepBudget(int milliseconds);
+    int stepBudget() const;
+
+    QList<Report> history() const;
+    bool isRunning() const;
+
+    // Waits for the running pass and closes the maintenance connections
+    void shutdown();
+
+signals:
+    void maintenanceFinished(const MaintenanceScheduler::Report &report);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct DatabaseState {
+        Database database;
+        QDateTime lastPass;
+        bool moreWork = false;
+        bool analyzePending = false;
+        bool convertPending = false;
+        int bulkRows = 0;
+    };
+
+    explicit MaintenanceScheduler(QObject *parent = nullptr);
+    ~MaintenanceScheduler();
+
+    void checkIdle();
+    void startPass(const QString &connectionName);
+    void finishPass(const Report &report, bool analyzeRequested);
+    QString nextIdleCandidate() const;
+
+    // Worker thread
+    static Report runPass(const Database &database, bool analyze, bool convertVacuum, int stepBudgetMs);
+    static QSqlDatabase maintenanceConnection(const Database &database, QString *errorMessage);
+    static void closeConnection(const QString &connectionName);
+
+    mutable QMutex m_mutex;
+    QHash<QString, DatabaseState> m_databases;
+    QStringList m_order;            // Round-robin order of idle passes
+    QStringList m_requested;
+    QList<Report> m_history;
+    bool m_running;
+    int m_idleThresholdMs;
+    int m_stepBudgetMs;
+    QElapsedTimer m_lastActivity;
+    QTimer *m_idleTimer;
+    QThreadPool m_workerPool;
+};
+
+Q_DECLARE_METATYPE(MaintenanceScheduler::Report)
+
+#endif // MAINTENANCESCHEDULER_H
@@ -1,11 +1,155 @@
 #include "migrations.h"
 #include "databasemanager.h"
+#include "inventoryledger.h"
+#include <QSqlQuery>
+#include <QElapsedTimer>
+#include <QRegularExpression>
 #include <QDebug>
 #include <algorithm>
 
+namespace {
+
+// Flattened result of migrations 1..SNAPSHOT_VERSION, applied to empty
+// databases in place of replaying each migration. Keep it in sync with
+// registerCoreMigrations(); migrations newer than SNAPSHOT_VERSION are
+// still replayed on top of it.
+const int SNAPSHOT_VERSION = 3;
+
+const QStringList SCHEMA_SNAPSHOT = {
+    // Migration 1
+    R"(CREATE TABLE settings (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        key TEXT UNIQUE NOT NULL,
+        value TEXT,
+        category TEXT DEFAULT 'general',
+        created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+        updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
+    ))",
+    R"(CREATE TABLE audit_log (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        table_name TEXT NOT NULL,
+        record_id INTEGER,
+        action TEXT NOT NULL,
+        old_values TEXT,
+        new_values TEXT,
+        user_id INTEGER,
+        timestamp DATETIME DEFAULT CURRENT_TIMESTAMP
+    ))",
+    "CREATE INDEX idx_settings_key ON settings(key)",
+    "CREATE INDEX idx_audit_log_table_record ON audit_log(table_name, record_id)",
+    "CREATE INDEX idx_audit_log_timestamp ON audit_log(timestamp)",
+
+    // Migration 2
+    R"(CREATE TABLE users (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        username TEXT UNIQUE NOT NULL,
+        email TEXT UNIQUE NOT NULL,
+        password_hash TEXT NOT NULL,
+        full_name TEXT NOT NULL,
+        role TEXT NOT NULL DEFAULT 'user',
+        is_active BOOLEAN DEFAULT 1,
+        last_login DATETIME,
+        created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+        updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
+    ))",
+    R"(CREATE TABLE user_sessions (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        user_id INTEGER NOT NULL,
+        session_token TEXT UNIQUE NOT NULL,
+        expires_at DATETIME NOT NULL,
+        created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+        FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE
+    ))",
+    "CREATE INDEX idx_users_username ON users(username)",
+    "CREATE INDEX idx_users_email ON users(email)",
+    "CREATE INDEX idx_sessions_token ON user_sessions(session_token)",
+    R"(INSERT INTO users (username, email, password_hash, full_name, role)
+       VALUES ('admin', 'admin@archiflow.local',
+               '$2b$12$LQv3c1yqBWVHxkd0LHAkCOYz6TtxMQJqhN8/LewrvL.UdW9k0ZQHW',
+               'System Administrator', 'admin'))",
+
+    // Migration 3
+    R"(CREATE TABLE materials (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        name TEXT NOT NULL,
+        description TEXT,
+        category TEXT NOT NULL,
+        quantity INTEGER NOT NULL DEFAULT 0,
+        unit TEXT NOT NULL DEFAULT 'pieces',
+        price REAL NOT NULL DEFAULT 0.0,
+        supplier_id INTEGER,
+        barcode TEXT UNIQUE,
+        location TEXT,
+        minimum_stock INTEGER DEFAULT 0,
+        maximum_stock INTEGER DEFAULT 1000,
+        reorder_point INTEGER DEFAULT 10,
+        status TEXT DEFAULT 'active' CHECK (status IN ('active', 'inactive', 'discontinued')),
+        created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+        updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+        created_by TEXT,
+        updated_by TEXT
+    ))",
+    R"(CREATE TABLE suppliers (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        name TEXT NOT NULL UNIQUE,
+        contact_person TEXT,
+        email TEXT,
+        phone TEXT,
+        address TEXT,
+        city TEXT,
+        country TEXT,
+        postal_code TEXT,
+        website TEXT,
+        notes TEXT,
+        rating INTEGER DEFAULT 0 CHECK (rating >= 0 AND rating <= 5),
+        status TEXT DEFAULT 'active' CHECK (status IN ('active', 'inactive')),
+        created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+        updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
+    ))",
+    R"(CREATE TABLE material_movements (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        material_id INTEGER NOT NULL,
+        movement_type TEXT NOT NULL CHECK (movement_type IN ('in', 'out', 'adjustment')),
+        quantity INTEGER NOT NULL,
+        reference TEXT,
+        notes TEXT,
+        performed_by TEXT,
+        movement_date DATETIME DEFAULT CURRENT_TIMESTAMP,
+        FOREIGN KEY (material_id) REFERENCES materials(id) ON DELETE CASCADE
+    ))",
+    "CREATE INDEX idx_materials_name ON materials(name)",
+    "CREATE INDEX idx_materials_category ON materials(category)",
+    "CREATE INDEX idx_materials_status ON materials(status)",
+    "CREATE INDEX idx_materials_barcode ON materials(barcode)",
+    "CREATE INDEX idx_suppliers_name ON suppliers(name)",
+    "CREATE INDEX idx_material_movements_material_id ON material_movements(material_id)",
+    "CREATE INDEX idx_material_movements_date ON material_movements(movement_date)",
+    R"(INSERT INTO suppliers (name, contact_person, email, phone, address, city, country, rating)
+       VALUES
+       ('BuildCorp Materials', 'John Smith', 'john@buildcorp.com', '+1-555-0101', '123 Industrial Ave', 'Chicago', 'USA', 5),
+       ('SteelWorks Ltd', 'Maria Garcia', 'maria@steelworks.com', '+1-555-0102', '456 Steel Street', 'Pittsburgh', 'USA', 4),
+       ('Concrete Solutions', 'David Wilson', 'david@concrete-sol.com', '+1-555-0103', '789 Concrete Blvd', 'Denver', 'USA', 4))"
+};
+
+QString normalizeSql(const QString &sql)
+{
+    static const QRegularExpression lineComment("--[^\n]*");
+    static const QRegularExpression whitespace("\\s+");
+    static const QRegularExpression spaceAroundPunctuation("\\s*([(),])\\s*");
+
+    QString normalized = sql;
+    normalized.remove(lineComment);
+    normalized.replace(whitespace, " ");
+    normalized.replace(spaceAroundPunctuation, "\\1");
+    return normalized.trimmed();
+}
+
+} // namespace
+
 Migrations::Migrations(DatabaseManager *databaseManager, QObject *parent)
     : QObject(parent)
     , m_databaseManager(databaseManager)
+    , m_snapshotEnabled(true)
 {
     registerCoreMigrations();
 }
@@ -22,6 +166,7 @@ bool Migrations::createInitialSchema()
 bool Migrations::runMigrations()
 {
     qDebug() << "Running database migrations...";
+    m_lastRunTimings.clear();
     
     int currentVersion = m_databaseManager->currentSchemaVersion();
     qDebug() << "Current schema version:" << currentVersion;
@@ -32,28 +177,91 @@ bool Migrations::runMigrations()
                   return a.version < b.version;
               });
     
+    if (latestVersion() <= currentVersion) {
+        qDebug() << "Schema is up to date";
+        return true;
+    }
+    
+    // One transaction for the whole upgrade; when the caller already holds
+    // one (resetDatabase), nest under a savepoint instead
+    const bool ownTransaction = !m_databaseManager->inTransaction();
+    const bool started = ownTransaction ? m_databaseManager->beginTransaction()
+                                        : m_databaseManager->executeNonQuery("SAVEPOINT migrations");
+    if (!started) {
+        return false;
+    }
+    
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+    
     bool allSuccessful = true;
-    for (const Migration &migration : m_migrations) {
+    
+    // An empty database takes the flattened snapshot instead of the history
+    if (currentVersion == 0 && m_snapshotEnabled && isEmptyDatabase()) {
+        m_databaseManager->clearStatementCache();
+        
+        QElapsedTimer timer;
+        timer.start();
+        qDebug() << "Applying schema snapshot up to version" << SNAPSHOT_VERSION;
+        
+        if (applySnapshot()) {
+            m_lastRunTimings.append({0, QString("Schema snapshot (v%1)").arg(SNAPSHOT_VERSION),
+                                     timer.nsecsElapsed() / 1e6});
+            currentVersion = SNAPSHOT_VERSION;
+        } else {
+            qCritical() << "Schema snapshot failed!";
+            allSuccessful = false;
+        }
+    }
+    
+    for (const Migration &migration : std::as_const(m_migrations)) {
+        if (!allSuccessful) {
+            break;
+        }
         if (migration.version <= currentVersion) {
             continue; // Skip already applied migrations
         }
         
+        // Statements prepared against the previous schema must not be reused
+        m_databaseManager->clearStatementCache();
+        
         qDebug() << "Applying migration" << migration.version << ":" << migration.description;
         
+        QElapsedTimer timer;
+        timer.start();
+        
         if (!executeMigration(migration)) {
             qCritical() << "Migration" << migration.version << "failed!";
             allSuccessful = false;
             break;
         }
         
+        m_lastRunTimings.append({migration.version, migration.description, timer.nsecsElapsed() / 1e6});
         qDebug() << "Migration" << migration.version << "applied successfully";
     }
     
+    m_databaseManager->clearStatementCache();
+    
     if (allSuccessful) {
-        qDebug() << "All migrations completed successfully";
+        allSuccessful = ownTransaction ? m_databaseManager->commitTransaction()
+                                       : m_databaseManager->executeNonQuery("RELEASE SAVEPOINT migrations");
+    }
+    
+    if (!allSuccessful) {
+        if (ownTransaction) {
+            m_databaseManager->rollbackTransaction();
+        } else {
+            m_databaseManager->executeNonQuery("ROLLBACK TO SAVEPOINT migrations");
+            m_databaseManager->executeNonQuery("RELEASE SAVEPOINT migrations");
+        }
+        m_lastRunTimings.clear();
+        return false;
     }
     
-    return allSuccessful;
+    m_lastRunTimings.append({-1, "Total", totalTimer.nsecsElapsed() / 1e6});
+    qDebug().noquote() << timingReport();
+    qDebug() << "All migrations completed successfully";
+    return true;
 }
 
 void Migrations::addMigration(int version, const QString &description, std::function<bool()> migration)
@@ -61,28 +269,144 @@ void Migrations::addMigration(int version, const QString &description, std::func
     m_migrations.append({version, description, migration});
 }
 
-bool Migrations::executeMigration(const Migration &migration)
+int Migrations::latestVersion() const
 {
-    if (!m_databaseManager->beginTransaction()) {
-        return false;
+    int latest = 0;
+    for (const Migration &migration : m_migrations) {
+        latest = qMax(latest, migration.version);
+    }
+    return latest;
+}
+
+void Migrations::setSnapshotEnabled(bool enabled)
+{
+    m_snapshotEnabled = enabled;
+}
+
+bool Migrations::isSnapshotEnabled() const
+{
+    return m_snapshotEnabled;
+}
+
+int Migrations::snapshotVersion()
+{
+    return SNAPSHOT_VERSION;
+}
+
+QList<Migrations::MigrationTiming> Migrations::lastRunTimings() const
+{
+    return m_lastRunTimings;
+}
+
+QString Migrations::timingReport() const
+{
+    QStringList lines;
+    lines << "Migration timings:";
+    for (const MigrationTiming &timing : m_lastRunTimings) {
+        const QString label = timing.version > 0 ? QString("v%1 %2").arg(timing.version).arg(timing.description)
+                                                 : timing.description;
+        lines << QString("  %1: %2 ms").arg(label).arg(timing.elapsedMs, 0, 'f', 2);
     }
+    return lines.join('\n');
+}
+
+QString Migrations::schemaFingerprint(const QSqlDatabase &database)
+{
+    QStringList entries;
+    QStringList tables;
     
-    bool success = migration.execute();
+    QSqlQuery schemaQuery(database);
+    schemaQuery.exec("SELECT type, name, tbl_name, sql FROM sqlite_master "
+                     "WHERE name NOT LIKE 'sqlite_%' ORDER BY type, name");
+    while (schemaQuery.next()) {
+        const QString type = schemaQuery.value(0).toString();
+        const QString name = schemaQuery.value(1).toString();
+        entries << QString("%1 %2 on %3: %4").arg(type, name, schemaQuery.value(2).toString(),
+                                                  normalizeSql(schemaQuery.value(3).toString()));
+        if (type == "table") {
+            tables << name;
+        }
+    }
     
-    if (success) {
-        // Record the migration
-        success = m_databaseManager->executeNonQuery(
-            "INSERT INTO schema_version (version) VALUES (?)",
-            {migration.version}
-        );
+    // Seed data is part of what a migration path must reproduce
+    for (const QString &table : std::as_const(tables)) {
+        QSqlQuery countQuery(database);
+        if (countQuery.exec(QString("SELECT COUNT(*) FROM \"%1\"").arg(table)) && countQuery.next()) {
+            entries << QString("rows %1: %2").arg(table).arg(countQuery.value(0).toInt());
+        }
     }
     
-    if (success) {
-        return m_databaseManager->commitTransaction();
-    } else {
-        m_databaseManager->rollbackTransaction();
+    return entries.join('\n');
+}
+
+const FullTextSearch::IndexDefinition &Migrations::materialsSearchIndex()
+{
+    static const FullTextSearch::IndexDefinition definition = {
+        "material", "materials", "id", true,
+        {"name", "description", "category", "barcode"},
+        "t.name"
+    };
+    return definition;
+}
+
+const KeysetPagination &Migrations::materialsPagination()
+{
+    static const KeysetPagination pagination(
+        "materials", "id",
+        {
+            {"name", {"name"}},
+            {"category", {"category", "name"}},
+            {"quantity", {"quantity"}},
+            {"price", {"price"}},
+            {"updated_at", {"IFNULL(updated_at, '')"}}
+        },
+        "name", Qt::AscendingOrder);
+    return pagination;
+}
+
+bool Migrations::executeMigration(const Migration &migration)
+{
+    // Runs inside the transaction opened by runMigrations()
+    if (!migration.execute()) {
         return false;
     }
+    
+    // Record the migration
+    return m_databaseManager->executeNonQuery(
+        "INSERT INTO schema_version (version) VALUES (?)",
+        {migration.version}
+    );
+}
+
+bool Migrations::applySnapshot()
+{
+    for (const QString &statement : SCHEMA_SNAPSHOT) {
+        if (!m_databaseManager->executeNonQuery(statement)) {
+            return false;
+        }
+    }
+    
+    // Same version history as a full replay
+    for (const Migration &migration : std::as_const(m_migrations)) {
+        if (migration.version > SNAPSHOT_VERSION) {
+            break;
+        }
+        if (!m_databaseManager->executeNonQuery("INSERT INTO schema_version (version) VALUES (?)",
+                                                {migration.version})) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+bool Migrations::isEmptyDatabase() const
+{
+    QSqlQuery query = m_databaseManager->executeQuery(
+        "SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' "
+        "AND name NOT LIKE 'sqlite_%' AND name <> 'schema_version'"
+    );
+    return query.next() && query.value(0).toInt() == 0;
 }
 
 void Migrations::registerCoreMigrations()
@@ -312,9 +636,66 @@ void Migrations::registerCoreMigrations()
           return success;
     });
 
+    // Migration 4: Full-text search over materials
+    addMigration(4, "Create materials full-text index", [this]() {
+        const QSqlDatabase database = m_databaseManager->database();
+        
+        // Without FTS5 material search keeps using LIKE; DatabaseManager
+        // creates the index at startup once SQLite supports it
+        if (!FullTextSearch::isAvailable(database)) {
+            qWarning() << "FTS5 not available, deferring materials search index";
+            return true;
+        }
+        
+        return FullTextSearch::createIndex(database, materialsSearchIndex());
+    });
+
+    // Migration 5: Keyset pagination over materials
+    addMigration(5, "Create materials pagination indexes", [this]() {
+        // The page indexes on (name, id) and (category, name, id) serve
+        // every lookup the single-column ones did
+        QStringList statements = {
+            "DROP INDEX IF EXISTS idx_materials_name",
+            "DROP INDEX IF EXISTS idx_materials_category"
+        };
+        statements << materialsPagination().indexStatements();
+        
+        for (const QString &sql : statements) {
+            if (!m_databaseManager->executeNonQuery(sql)) {
+                qWarning() << "Failed to create materials pagination index:" << m_databaseManager->lastError();
+                return false;
+            }
+        }
+        return true;
+    });
+
+    // Migration 6: Inventory ledger over material_movements
+    addMigration(6, "Create inventory ledger", [this]() {
+        // Quantities entered so far become opening adjustments, so the
+        // history adds up to the stock on hand from here on
+        InventoryLedger ledger(m_databaseManager);
+        if (!ledger.createSchema() || !ledger.openBalances() || !ledger.rebuildCheckpoints()) {
+            qWarning() << "Failed to create inventory ledger:" << ledger.lastError();
+            return false;
+        }
+        return true;
+    });
+
+    // Migration 7: Low stock alerts
+    addMigration(7, "Create low stock index", [this]() {
+        // Holds only the materials at or below their reorder point, most
+        // urgent first, so alerts are read without scanning the catalogue
+        const QString sql = "CREATE INDEX IF NOT EXISTS idx_materials_low_stock "
+                            "ON materials(reorder_point - quantity) WHERE quantity <= reorder_point";
+        if (!m_databaseManager->executeNonQuery(sql)) {
+            qWarning() << "Failed to create low stock index:" << m_databaseManager->lastError();
+            return false;
+        }
+        return true;
+    });
+
     // Future migrations will be added here as features are implemented
     // Examples:
-    // addMigration(5, "Create employees tables", [this]() { ... });
-    // addMigration(6, "Create clients tables", [this]() { ... });
-    // addMigration(7, "Create projects tables", [this]() { ... });
+    // addMigration(8, "Create employees tables", [this]() { ... });
+    // addMigration(9, "Create clients tables", [this]() { ... });
 }
@@ -3,7 +3,10 @@
 
 #include <QObject>
 #include <QStringList>
+#include <QSqlDatabase>
 #include <functional>
+#include "fulltextsearch.h"
+#include "keysetpagination.h"
 
 class DatabaseManager;
 
@@ -12,12 +15,23 @@ class DatabaseManager;
  * 
  * This class manages database schema versioning and migrations,
  * ensuring the database structure is always up-to-date.
+ *
+ * All pending migrations run in one transaction. An empty database is
+ * brought up to date from a flattened schema snapshot instead of replaying
+ * every migration; test_migrations checks that both paths produce the
+ * same schema and seed data.
  */
 class Migrations : public QObject
 {
     Q_OBJECT
 
 public:
+    struct MigrationTiming {
+        int version;            // 0 for the schema snapshot
+        QString description;
+        double elapsedMs;
+    };
+
     explicit Migrations(DatabaseManager *databaseManager, QObject *parent = nullptr);
 
     // Migration management
@@ -26,6 +40,26 @@ public:
     
     // Migration registration
     void addMigration(int version, const QString &description, std::function<bool()> migration);
+    int latestVersion() const;
+    
+    // Fresh-install snapshot
+    void setSnapshotEnabled(bool enabled);
+    bool isSnapshotEnabled() const;
+    static int snapshotVersion();
+    
+    // Timing of the last runMigrations() call
+    QList<MigrationTiming> lastRunTimings() const;
+    QString timingReport() const;
+    
+    // Normalized description of schema objects and table row counts, used
+    // to compare databases built through different migration paths
+    static QString schemaFingerprint(const QSqlDatabase &database);
+    
+    // Full-text index over materials, created by migration 4
+    static const FullTextSearch::IndexDefinition &materialsSearchIndex();
+    
+    // Keyset pagination over materials; migration 5 creates its indexes
+    static const KeysetPagination &materialsPagination();
 
 private:
     struct Migration {
@@ -35,10 +69,14 @@ private:
     };
 
     bool executeMigration(const Migration &migration);
+    bool applySnapshot();
+    bool isEmptyDatabase() const;
     void registerCoreMigrations();
     
     DatabaseManager *m_databaseManager;
     QList<Migration> m_migrations;
+    QList<MigrationTiming> m_lastRunTimings;
+    bool m_snapshotEnabled;
 };
 
 #endif // MIGRATIONS_H
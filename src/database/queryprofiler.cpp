@@ -0,0 +1,307 @@
+#include "queryprofiler.h"
+#include <QSqlError>
+#include <QSqlRecord>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+const int QueryProfiler::DEFAULT_SLOW_THRESHOLD_MS = 100;
+const int QueryProfiler::MAX_SLOW_QUERIES = 200;
+
+const QList<double> &QueryProfiler::histogramBounds()
+{
+    static const QList<double> bounds = {1, 5, 10, 50, 100, 500, 1000};
+    return bounds;
+}
+
+double QueryProfiler::StatementStats::percentileMs(double percentile) const
+{
+    if (executions == 0) {
+        return 0.0;
+    }
+
+    const QList<double> &bounds = histogramBounds();
+    const qint64 target = qMax<qint64>(1, qint64(executions * percentile + 0.5));
+    qint64 cumulative = 0;
+    for (int i = 0; i < histogram.size(); ++i) {
+        cumulative += histogram.at(i);
+        if (cumulative >= target) {
+            // Upper bound of the bucket, capped by the slowest observation
+            return i < bounds.size() ? qMin(bounds.at(i), maxMs) : maxMs;
+        }
+    }
+    return maxMs;
+}
+
+QueryProfiler *QueryProfiler::instance()
+{
+    static QueryProfiler profiler;
+    return &profiler;
+}
+
+QueryProfiler::QueryProfiler()
+    : m_enabled(false)
+    , m_slowThresholdMs(DEFAULT_SLOW_THRESHOLD_MS)
+{
+}
+
+void QueryProfiler::setEnabled(bool enabled)
+{
+    if (m_enabled.exchange(enabled) != enabled) {
+        qDebug() << "Query profiler" << (enabled ? "enabled" : "disabled");
+    }
+}
+
+bool QueryProfiler::isEnabled() const
+{
+    return m_enabled;
+}
+
+void QueryProfiler::setSlowQueryThreshold(int milliseconds)
+{
+    m_slowThresholdMs = qMax(0, milliseconds);
+}
+
+int QueryProfiler::slowQueryThreshold() const
+{
+    return m_slowThresholdMs;
+}
+
+bool QueryProfiler::execute(QSqlQuery &query, const QSqlDatabase &database,
+                            const QString &source, const QString &sql)
+{
+    if (!m_enabled) {
+        return sql.isEmpty() ? query.exec() : query.exec(sql);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool success = sql.isEmpty() ? query.exec() : query.exec(sql);
+    // SQLite does most of the work while stepping, so the fetch is part of the cost
+    const int rows = success ? countRows(query) : -1;
+
+    const double elapsedMs = timer.nsecsElapsed() / 1e6;
+    const QString statement = sql.isEmpty() ? query.lastQuery() : sql;
+
+    QString queryPlan;
+    if (success && elapsedMs >= m_slowThresholdMs) {
+        queryPlan = explainQueryPlan(database, statement, sql.isEmpty() ? query.boundValues() : QVariantList());
+    }
+
+    record(source, statement, elapsedMs, rows, success, queryPlan);
+    return success;
+}
+
+QList<QueryProfiler::StatementStats> QueryProfiler::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    QList<StatementStats> statistics = m_statistics.values();
+    locker.unlock();
+
+    // Most expensive first
+    std::sort(statistics.begin(), statistics.end(), [](const StatementStats &a, const StatementStats &b) {
+        return a.totalMs > b.totalMs;
+    });
+    return statistics;
+}
+
+QList<QueryProfiler::SlowQuery> QueryProfiler::slowQueries() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_slowQueries;
+}
+
+void QueryProfiler::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_statistics.clear();
+    m_slowQueries.clear();
+}
+
+QJsonObject QueryProfiler::toJson() const
+{
+    QJsonArray bounds;
+    for (double bound : histogramBounds()) {
+        bounds.append(bound);
+    }
+
+    QJsonArray statements;
+    for (const StatementStats &stats : statistics()) {
+        QJsonArray histogram;
+        for (qint64 count : stats.histogram) {
+            histogram.append(count);
+        }
+
+        QJsonObject statement;
+        statement["sql"] = stats.normalizedSql;
+        statement["sources"] = QJsonArray::fromStringList(stats.sources);
+        statement["executions"] = stats.executions;
+        statement["failures"] = stats.failures;
+        statement["rowsReturned"] = stats.rowsReturned;
+        statement["totalMs"] = stats.totalMs;
+        statement["averageMs"] = stats.averageMs();
+        statement["minMs"] = stats.minMs;
+        statement["maxMs"] = stats.maxMs;
+        statement["p95Ms"] = stats.percentileMs(0.95);
+        statement["histogram"] = histogram;
+        statements.append(statement);
+    }
+
+    QJsonArray slow;
+    for (const SlowQuery &query : slowQueries()) {
+        QJsonObject entry;
+        entry["timestamp"] = query.timestamp.toString(Qt::ISODateWithMs);
+        entry["source"] = query.source;
+        entry["sql"] = query.sql;
+        entry["normalizedSql"] = query.normalizedSql;
+        entry["elapsedMs"] = query.elapsedMs;
+        entry["rows"] = query.rows;
+        entry["queryPlan"] = query.queryPlan;
+        slow.append(entry);
+    }
+
+    QJsonObject root;
+    root["generatedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["slowQueryThresholdMs"] = slowQueryThreshold();
+    root["histogramBoundsMs"] = bounds;
+    root["statements"] = statements;
+    root["slowQueries"] = slow;
+    return root;
+}
+
+bool QueryProfiler::exportToJson(const QString &filePath, QString *errorMessage) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorMessage) {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+
+    file.write(QJsonDocument(toJson()).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        if (errorMessage) {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+QString QueryProfiler::normalizeSql(const QString &sql)
+{
+    static const QRegularExpression stringLiteral("'(?:[^']|'')*'");
+    static const QRegularExpression namedPlaceholder("[:@$][A-Za-z_][A-Za-z0-9_]*");
+    static const QRegularExpression numberLiteral("\\b\\d+(?:\\.\\d+)?\\b");
+    static const QRegularExpression placeholderList("\\(\\s*\\?(?:\\s*,\\s*\\?)+\\s*\\)");
+    static const QRegularExpression whitespace("\\s+");
+
+    QString normalized = sql;
+    normalized.replace(stringLiteral, "?");
+    normalized.replace(namedPlaceholder, "?");
+    normalized.replace(numberLiteral, "?");
+    normalized.replace(whitespace, " ");
+    // IN lists of any length share one entry
+    normalized.replace(placeholderList, "(?, ...)");
+    return normalized.trimmed();
+}
+
+void QueryProfiler::record(const QString &source, const QString &sql, double elapsedMs, int rows,
+                           bool success, const QString &queryPlan)
+{
+    const QString normalized = normalizeSql(sql);
+    const QList<double> &bounds = histogramBounds();
+
+    int bucket = 0;
+    while (bucket < bounds.size() && elapsedMs > bounds.at(bucket)) {
+        ++bucket;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    StatementStats &stats = m_statistics[normalized];
+    if (stats.executions == 0) {
+        stats.normalizedSql = normalized;
+        stats.histogram = QList<qint64>(bounds.size() + 1, 0);
+        stats.minMs = elapsedMs;
+    }
+    if (!stats.sources.contains(source)) {
+        stats.sources.append(source);
+    }
+
+    ++stats.executions;
+    if (!success) {
+        ++stats.failures;
+    }
+    if (rows > 0) {
+        stats.rowsReturned += rows;
+    }
+    stats.totalMs += elapsedMs;
+    stats.minMs = qMin(stats.minMs, elapsedMs);
+    stats.maxMs = qMax(stats.maxMs, elapsedMs);
+    ++stats.histogram[bucket];
+
+    if (success && elapsedMs >= m_slowThresholdMs) {
+        m_slowQueries.append({QDateTime::currentDateTime(), source, sql, normalized, elapsedMs, rows, queryPlan});
+        while (m_slowQueries.size() > MAX_SLOW_QUERIES) {
+            m_slowQueries.removeFirst();
+        }
+        qWarning().noquote() << QString("Slow query (%1 ms, %2):").arg(elapsedMs, 0, 'f', 1).arg(source) << normalized;
+    }
+}
+
+int QueryProfiler::countRows(QSqlQuery &query)
+{
+    if (!query.isSelect()) {
+        return query.numRowsAffected();
+    }
+
+    if (query.isForwardOnly()) {
+        return -1;
+    }
+
+    // Walk to the end and rewind so callers still see every row
+    const int rows = query.last() ? query.at() + 1 : 0;
+    query.seek(QSql::BeforeFirstRow);
+    return rows;
+}
+
+QString QueryProfiler::explainQueryPlan(const QSqlDatabase &database, const QString &sql,
+                                        const QVariantList &boundValues)
+{
+    static const QRegularExpression explainable("^\\s*(SELECT|WITH|INSERT|UPDATE|DELETE|REPLACE)\\b",
+                                                QRegularExpression::CaseInsensitiveOption);
+    if (!database.isOpen() || !explainable.match(sql).hasMatch()) {
+        return QString();
+    }
+
+    QSqlQuery plan(database);
+    if (!plan.prepare("EXPLAIN QUERY PLAN " + sql)) {
+        return QString("EXPLAIN failed: %1").arg(plan.lastError().text());
+    }
+    for (int i = 0; i < boundValues.size(); ++i) {
+        plan.bindValue(i, boundValues.at(i));
+    }
+    if (!plan.exec()) {
+        return QString("EXPLAIN failed: %1").arg(plan.lastError().text());
+    }
+
+    // Rows are (id, parent, notused, detail); indent children under their parent
+    QHash<int, int> depths;
+    QStringList lines;
+    while (plan.next()) {
+        const int id = plan.value(0).toInt();
+        const int parent = plan.value(1).toInt();
+        const int depth = depths.contains(parent) ? depths.value(parent) + 1 : 0;
+        depths.insert(id, depth);
+        lines << QString(depth * 2, ' ') + plan.value(3).toString();
+    }
+    return lines.join('\n');
+}
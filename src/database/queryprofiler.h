@@ -0,0 +1,104 @@
+#ifndef QUERYPROFILER_H
+#define QUERYPROFILER_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <atomic>
+
+/**
+ * @brief The QueryProfiler class - Opt-in latency profiling for SQL statements
+ *
+ * Every database manager runs its statements through execute(). While the
+ * profiler is disabled that is a plain QSqlQuery::exec(). When enabled, each
+ * statement is timed including the fetch of its result rows. Latency goes
+ * into a histogram keyed by the normalized SQL text, with literals and
+ * placeholders folded to '?'. Statements slower than the threshold are
+ * added to a bounded slow-query log together with their EXPLAIN QUERY PLAN
+ * output.
+ *
+ * Counting rows steps through the whole result set once and rewinds it, so
+ * profiling adds some cost of its own; it is meant for diagnostics, not for
+ * normal operation.
+ */
+class QueryProfiler
+{
+public:
+    static const int DEFAULT_SLOW_THRESHOLD_MS;
+    static const int MAX_SLOW_QUERIES;
+
+    // Upper bounds (ms) of the histogram buckets; the last bucket is open
+    static const QList<double> &histogramBounds();
+
+    struct StatementStats {
+        QString normalizedSql;
+        QStringList sources;
+        qint64 executions = 0;
+        qint64 failures = 0;
+        qint64 rowsReturned = 0;
+        double totalMs = 0.0;
+        double minMs = 0.0;
+        double maxMs = 0.0;
+        QList<qint64> histogram;
+
+        double averageMs() const { return executions > 0 ? totalMs / executions : 0.0; }
+        double percentileMs(double percentile) const;
+    };
+
+    struct SlowQuery {
+        QDateTime timestamp;
+        QString source;
+        QString sql;
+        QString normalizedSql;
+        double elapsedMs = 0.0;
+        int rows = -1;
+        QString queryPlan;
+    };
+
+    static QueryProfiler *instance();
+
+    // Configuration
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    void setSlowQueryThreshold(int milliseconds);
+    int slowQueryThreshold() const;
+
+    // Executes query (or sql when given) on database and records it when
+    // profiling is enabled. source names the module issuing the statement.
+    bool execute(QSqlQuery &query, const QSqlDatabase &database,
+                 const QString &source, const QString &sql = QString());
+
+    // Results
+    QList<StatementStats> statistics() const;
+    QList<SlowQuery> slowQueries() const;
+    void reset();
+
+    QJsonObject toJson() const;
+    bool exportToJson(const QString &filePath, QString *errorMessage = nullptr) const;
+
+    static QString normalizeSql(const QString &sql);
+
+private:
+    QueryProfiler();
+
+    void record(const QString &source, const QString &sql, double elapsedMs, int rows,
+                bool success, const QString &queryPlan);
+    static int countRows(QSqlQuery &query);
+    static QString explainQueryPlan(const QSqlDatabase &database, const QString &sql,
+                                    const QVariantList &boundValues);
+
+    std::atomic<bool> m_enabled;
+    std::atomic<int> m_slowThresholdMs;
+
+    mutable QMutex m_mutex;
+    QHash<QString, StatementStats> m_statistics;
+    QList<SlowQuery> m_slowQueries; // Oldest first
+};
+
+#endif // QUERYPROFILER_H
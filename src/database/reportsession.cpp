@@ -0,0 +1,162 @@
+#include "reportsession.h"
+#include "connectionpool.h"
+#include "databasemanager.h"
+#include "queryprofiler.h"
+#include <QSqlError>
+#include <QDebug>
+
+ReportSession::ReportSession(ConnectionPool *pool, const QString &source)
+    : m_pool(pool)
+    , m_source(source)
+    , m_active(false)
+{
+}
+
+ReportSession::~ReportSession()
+{
+    end();
+}
+
+std::shared_ptr<ReportSession> ReportSession::begin(ConnectionPool *pool, const QString &source)
+{
+    std::shared_ptr<ReportSession> session(new ReportSession(pool, source));
+    if (!session->start()) {
+        qWarning() << "ReportSession: could not begin snapshot for" << source << "-" << session->m_lastError;
+    }
+    return session;
+}
+
+bool ReportSession::start()
+{
+    if (!m_pool) {
+        m_lastError = "No connection pool available";
+        return false;
+    }
+
+    QSqlDatabase database = m_pool->acquireReader();
+    if (!database.isOpen()) {
+        m_lastError = "No reader connection available";
+        return false;
+    }
+    m_connectionName = database.connectionName();
+
+    if (!database.transaction()) {
+        m_lastError = QString("Failed to begin report snapshot: %1").arg(database.lastError().text());
+        m_pool->releaseReader(m_connectionName);
+        m_connectionName.clear();
+        return false;
+    }
+
+    // A deferred transaction takes its snapshot at the first read, so read
+    // now rather than at whatever the report happens to query first
+    QSqlQuery pin(database);
+    if (!pin.exec("SELECT COUNT(*) FROM sqlite_master") || !pin.next()) {
+        m_lastError = QString("Failed to begin report snapshot: %1").arg(pin.lastError().text());
+        pin.finish();
+        database.rollback();
+        m_pool->releaseReader(m_connectionName);
+        m_connectionName.clear();
+        return false;
+    }
+    pin.finish();
+
+    m_snapshotTime = QDateTime::currentDateTimeUtc();
+    m_active = true;
+    return true;
+}
+
+bool ReportSession::isActive() const
+{
+    return m_active;
+}
+
+QDateTime ReportSession::snapshotTime() const
+{
+    return m_snapshotTime;
+}
+
+QSqlDatabase ReportSession::database() const
+{
+    if (!m_active) {
+        return QSqlDatabase();
+    }
+    return QSqlDatabase::database(m_connectionName, false);
+}
+
+QString ReportSession::lastError() const
+{
+    return m_lastError;
+}
+
+QSqlQuery ReportSession::executeQuery(const QString &sql, const QVariantList &params)
+{
+    QSqlDatabase connection = database();
+    QSqlQuery query(connection);
+    query.setForwardOnly(true);
+    if (!connection.isOpen()) {
+        m_lastError = "Report session is not active";
+        return query;
+    }
+
+    if (!query.prepare(sql)) {
+        m_lastError = query.lastError().text();
+        qWarning() << "ReportSession: failed to prepare:" << sql << "-" << m_lastError;
+        return query;
+    }
+
+    for (int i = 0; i < params.size(); ++i) {
+        query.bindValue(i, params.at(i));
+    }
+
+    if (!QueryProfiler::instance()->execute(query, connection, m_source)) {
+        m_lastError = query.lastError().text();
+        qWarning() << "ReportSession: query failed:" << sql << "-" << m_lastError;
+    }
+    return query;
+}
+
+DatabaseRowSet ReportSession::fetchRows(const QString &sql, const QVariantList &params)
+{
+    QSqlQuery query = executeQuery(sql, params);
+    if (!query.isActive() && !query.lastError().isValid()) {
+        DatabaseRowSet rowSet;
+        rowSet.error = m_lastError;
+        return rowSet;
+    }
+
+    DatabaseRowSet rowSet = DatabaseManager::readRows(query);
+    query.finish();
+    return rowSet;
+}
+
+QVariant ReportSession::scalar(const QString &sql, const QVariantList &params)
+{
+    QSqlQuery query = executeQuery(sql, params);
+    QVariant value;
+    if (query.isActive() && query.next()) {
+        value = query.value(0);
+    }
+    query.finish();
+    return value;
+}
+
+void ReportSession::end()
+{
+    if (!m_active) {
+        return;
+    }
+    m_active = false;
+
+    {
+        QSqlDatabase connection = QSqlDatabase::database(m_connectionName, false);
+        if (connection.isOpen() && !connection.commit()) {
+            qWarning() << "ReportSession: failed to end snapshot:" << connection.lastError().text();
+            connection.rollback();
+        }
+    }
+
+    if (m_pool) {
+        m_pool->releaseReader(m_connectionName);
+    }
+    m_connectionName.clear();
+}
@@ -0,0 +1,66 @@
+#ifndef REPORTSESSION_H
+#define REPORTSESSION_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QVariant>
+#include <QDateTime>
+#include <QPointer>
+#include <memory>
+#include "../interfaces/idatabasemanager.h"
+
+class ConnectionPool;
+
+/**
+ * @brief The ReportSession class - One consistent read-only view for a report
+ *
+ * A session takes a reader connection from a ConnectionPool and opens a read
+ * transaction on it, so every query run through the session sees the
+ * database exactly as it was when the session began, however many queries
+ * the report needs and whatever is committed in between. Hand the same
+ * session to the export that follows so the file matches what was shown.
+ *
+ * In WAL mode the snapshot never blocks writers; it only holds back
+ * checkpoints while open, so end sessions once the report and its export
+ * are done. The session ends automatically when the last reference goes.
+ *
+ * A session belongs to the thread that began it and must be used and ended
+ * there. Finish any QSqlQuery from executeQuery() before end().
+ */
+class ReportSession
+{
+public:
+    ~ReportSession();
+
+    // Never null; check isActive() and lastError() for failures
+    static std::shared_ptr<ReportSession> begin(ConnectionPool *pool, const QString &source);
+
+    bool isActive() const;
+    QDateTime snapshotTime() const;     // UTC time the snapshot was taken
+    QSqlDatabase database() const;
+    QString lastError() const;
+
+    // Queries - run against the snapshot and recorded under the session's
+    // source; executeQuery() returns a forward-only cursor
+    QSqlQuery executeQuery(const QString &sql, const QVariantList &params = QVariantList());
+    DatabaseRowSet fetchRows(const QString &sql, const QVariantList &params = QVariantList());
+    QVariant scalar(const QString &sql, const QVariantList &params = QVariantList());
+
+    // Releases the snapshot and returns the connection to the pool
+    void end();
+
+private:
+    ReportSession(ConnectionPool *pool, const QString &source);
+
+    bool start();
+
+    QPointer<ConnectionPool> m_pool;
+    QString m_source;
+    QString m_connectionName;
+    QDateTime m_snapshotTime;
+    QString m_lastError;
+    bool m_active;
+};
+
+#endif // REPORTSESSION_H
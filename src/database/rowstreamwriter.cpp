@@ -0,0 +1,186 @@
+#include "rowstreamwriter.h"
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QSqlError>
+
+const int RowStreamWriter::PROGRESS_INTERVAL = 1000;
+
+namespace {
+
+// Bytes collected before they are handed to the device
+const int WRITE_BUFFER_SIZE = 64 * 1024;
+
+} // namespace
+
+RowStreamWriter::RowStreamWriter(QIODevice *device, Format format)
+    : m_device(device)
+    , m_format(format)
+    , m_rowCount(0)
+    , m_headerWritten(false)
+{
+    m_buffer.reserve(WRITE_BUFFER_SIZE);
+}
+
+bool RowStreamWriter::writeHeader(const QSqlRecord &record)
+{
+    if (m_headerWritten) {
+        return true;
+    }
+    if (!m_device || !m_device->isWritable()) {
+        m_errorString = "Export device is not writable";
+        return false;
+    }
+
+    m_columns.clear();
+    for (int i = 0; i < record.count(); ++i) {
+        m_columns << record.fieldName(i);
+    }
+
+    if (m_format == Json) {
+        m_buffer += '[';
+    } else {
+        QByteArrayList names;
+        for (const QString &column : std::as_const(m_columns)) {
+            names << csvField(column);
+        }
+        m_buffer += names.join(',') + "\r\n";
+    }
+
+    m_headerWritten = true;
+    return flush(false);
+}
+
+bool RowStreamWriter::writeRow(const QSqlRecord &record)
+{
+    if (!m_headerWritten && !writeHeader(record)) {
+        return false;
+    }
+
+    if (m_format == Json) {
+        QJsonObject object;
+        for (int i = 0; i < m_columns.size(); ++i) {
+            object.insert(m_columns.at(i), jsonValue(record.value(i)));
+        }
+        if (m_rowCount > 0) {
+            m_buffer += ',';
+        }
+        m_buffer += QJsonDocument(object).toJson(QJsonDocument::Compact);
+    } else {
+        for (int i = 0; i < m_columns.size(); ++i) {
+            if (i > 0) {
+                m_buffer += ',';
+            }
+            m_buffer += csvField(record.value(i));
+        }
+        m_buffer += "\r\n";
+    }
+
+    ++m_rowCount;
+    return flush(false);
+}
+
+bool RowStreamWriter::finish()
+{
+    // An empty result is still a valid document
+    if (!m_headerWritten && !writeHeader(QSqlRecord())) {
+        return false;
+    }
+    if (m_format == Json) {
+        m_buffer += ']';
+    }
+    return flush(true);
+}
+
+qint64 RowStreamWriter::rowCount() const
+{
+    return m_rowCount;
+}
+
+QString RowStreamWriter::errorString() const
+{
+    return m_errorString;
+}
+
+bool RowStreamWriter::writeQuery(QSqlQuery &query, QIODevice *device, Format format,
+                                 const Progress &progress, qint64 *rowCount, QString *errorMessage)
+{
+    RowStreamWriter writer(device, format);
+    bool ok = !query.lastError().isValid();
+    if (!ok) {
+        writer.m_errorString = query.lastError().text();
+    } else {
+        ok = writer.writeHeader(query.record());
+    }
+
+    while (ok && query.next()) {
+        ok = writer.writeRow(query.record());
+        if (ok && progress && writer.rowCount() % PROGRESS_INTERVAL == 0 && !progress(writer.rowCount())) {
+            writer.m_errorString = "Export canceled";
+            ok = false;
+        }
+    }
+    if (ok && query.lastError().isValid()) {
+        // A step failing mid-result ends next() like the last row does
+        writer.m_errorString = query.lastError().text();
+        ok = false;
+    }
+
+    // Close the document even when stopping early, so the rows so far can be read
+    const bool finished = writer.finish();
+    query.finish();
+    if (ok && progress) {
+        progress(writer.rowCount());
+    }
+
+    if (rowCount) {
+        *rowCount = writer.rowCount();
+    }
+    if (errorMessage) {
+        *errorMessage = writer.errorString();
+    }
+    return ok && finished;
+}
+
+QJsonValue RowStreamWriter::jsonValue(const QVariant &value)
+{
+    if (value.metaType() == QMetaType::fromType<QDateTime>()) {
+        return value.toDateTime().toString(Qt::ISODate);
+    }
+    return QJsonValue::fromVariant(value);
+}
+
+bool RowStreamWriter::flush(bool force)
+{
+    if (m_buffer.isEmpty() || (!force && m_buffer.size() < WRITE_BUFFER_SIZE)) {
+        return true;
+    }
+
+    const qint64 written = m_device->write(m_buffer);
+    if (written != m_buffer.size()) {
+        m_errorString = "Failed to write export: " + m_device->errorString();
+        m_buffer.clear();
+        return false;
+    }
+    m_buffer.clear();
+    return true;
+}
+
+QByteArray RowStreamWriter::csvField(const QVariant &value)
+{
+    if (value.isNull()) {
+        return QByteArray();
+    }
+
+    QString text = value.metaType() == QMetaType::fromType<QDateTime>()
+                       ? value.toDateTime().toString(Qt::ISODate)
+                       : value.toString();
+
+    // RFC 4180: quote fields holding separators, quotes or line breaks
+    if (text.contains(',') || text.contains('"') || text.contains('\n') || text.contains('\r')) {
+        text.replace("\"", "\"\"");
+        text = '"' + text + '"';
+    }
+    return text.toUtf8();
+}
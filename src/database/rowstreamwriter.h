@@ -0,0 +1,70 @@
+#ifndef ROWSTREAMWRITER_H
+#define ROWSTREAMWRITER_H
+
+#include <QByteArray>
+#include <QJsonValue>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <functional>
+
+class QIODevice;
+
+/**
+ * @brief The RowStreamWriter class - Writes query results to a device as they are read
+ *
+ * Serializes rows one at a time as a JSON array of objects or as RFC 4180
+ * CSV with a header line, so exporting a result never holds more than a
+ * small write buffer and the current row in memory. Pair it with a
+ * forward-only QSqlQuery; a scrollable one caches every row it has visited.
+ *
+ * The output is a complete document only after finish() succeeds.
+ */
+class RowStreamWriter
+{
+public:
+    enum Format {
+        Json,
+        Csv
+    };
+
+    // Called every PROGRESS_INTERVAL rows with the rows written so far;
+    // returning false stops the export
+    using Progress = std::function<bool(qint64 rowsWritten)>;
+
+    static const int PROGRESS_INTERVAL;
+
+    RowStreamWriter(QIODevice *device, Format format);
+
+    bool writeHeader(const QSqlRecord &record);
+    bool writeRow(const QSqlRecord &record);
+    bool finish();
+
+    qint64 rowCount() const;
+    QString errorString() const;
+
+    // Writes every remaining row of an executed query. False when writing
+    // failed or progress stopped it; the rows up to then are written.
+    static bool writeQuery(QSqlQuery &query, QIODevice *device, Format format,
+                           const Progress &progress = Progress(), qint64 *rowCount = nullptr,
+                           QString *errorMessage = nullptr);
+
+    // Same conversion as the exported JSON; dates become ISO 8601 strings
+    static QJsonValue jsonValue(const QVariant &value);
+
+private:
+    bool flush(bool force);
+    static QByteArray csvField(const QVariant &value);
+
+    QIODevice *m_device;
+    Format m_format;
+    QStringList m_columns;
+    QByteArray m_buffer;
+    qint64 m_rowCount;
+    bool m_headerWritten;
+    QString m_errorString;
+};
+
+#endif // ROWSTREAMWRITER_H
@@ -0,0 +1,221 @@
+#include "sqlitebackup.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QUuid>
+#include <QDebug>
+
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+#include <sqlite3.h>
+#endif
+
+const int SqliteBackup::DEFAULT_PAGES_PER_STEP = 256;
+const int SqliteBackup::DEFAULT_STEP_DELAY_MS = 5;
+
+namespace {
+
+// Consecutive busy steps tolerated before giving up
+const int MAX_BUSY_RETRIES = 200;
+
+void setError(QString *errorMessage, const QString &message)
+{
+    if (errorMessage) {
+        *errorMessage = message;
+    }
+    qWarning() << "SqliteBackup:" << message;
+}
+
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+bool runNativeBackup(const QString &sourcePath, const QString &destinationPath,
+                     QString *errorMessage, const SqliteBackup::ProgressCallback &progress,
+                     int pagesPerStep, int stepDelayMs)
+{
+    sqlite3 *source = nullptr;
+    sqlite3 *destination = nullptr;
+
+    int rc = sqlite3_open_v2(QFile::encodeName(sourcePath).constData(), &source,
+                             SQLITE_OPEN_READONLY, nullptr);
+    if (rc != SQLITE_OK) {
+        setError(errorMessage, QString("Cannot open %1: %2").arg(sourcePath, sqlite3_errmsg(source)));
+        sqlite3_close(source);
+        return false;
+    }
+
+    rc = sqlite3_open_v2(QFile::encodeName(destinationPath).constData(), &destination,
+                         SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+    if (rc != SQLITE_OK) {
+        setError(errorMessage, QString("Cannot open %1: %2").arg(destinationPath, sqlite3_errmsg(destination)));
+        sqlite3_close(destination);
+        sqlite3_close(source);
+        return false;
+    }
+
+    sqlite3_busy_timeout(source, 5000);
+    sqlite3_busy_timeout(destination, 5000);
+
+    // Pin one read snapshot: backup_step reuses an open read transaction, so
+    // writes from other connections cannot invalidate the pages copied so far
+    sqlite3_exec(source, "BEGIN; SELECT COUNT(*) FROM sqlite_master;", nullptr, nullptr, nullptr);
+
+    bool aborted = false;
+    sqlite3_backup *backup = sqlite3_backup_init(destination, "main", source, "main");
+    if (backup) {
+        int busyRetries = 0;
+        do {
+            rc = sqlite3_backup_step(backup, pagesPerStep);
+
+            const int totalPages = sqlite3_backup_pagecount(backup);
+            const int remainingPages = sqlite3_backup_remaining(backup);
+            if (progress && !progress(totalPages - remainingPages, totalPages)) {
+                aborted = true;
+                break;
+            }
+
+            if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+                if (++busyRetries > MAX_BUSY_RETRIES) {
+                    break;
+                }
+            } else {
+                busyRetries = 0;
+            }
+
+            // Give other connections a chance at the destination and the WAL
+            if (rc != SQLITE_DONE && stepDelayMs > 0) {
+                sqlite3_sleep(stepDelayMs);
+            }
+        } while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED);
+
+        sqlite3_backup_finish(backup);
+    }
+
+    const bool success = !aborted && rc == SQLITE_DONE && sqlite3_errcode(destination) == SQLITE_OK;
+    if (aborted) {
+        setError(errorMessage, "Backup canceled");
+    } else if (!success) {
+        setError(errorMessage, QString("Backup of %1 failed: %2").arg(sourcePath, sqlite3_errmsg(destination)));
+    }
+
+    sqlite3_exec(source, "COMMIT", nullptr, nullptr, nullptr);
+    sqlite3_close(destination);
+    sqlite3_close(source);
+    return success;
+}
+#else
+bool runVacuumInto(const QString &sourcePath, const QString &destinationPath,
+                   QString *errorMessage, const SqliteBackup::ProgressCallback &progress)
+{
+    if (progress && !progress(0, 1)) {
+        setError(errorMessage, "Backup canceled");
+        return false;
+    }
+
+    const QString connectionName = "SqliteBackup_" + QUuid::createUuid().toString(QUuid::WithoutBraces);
+    bool success = false;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        database.setDatabaseName(sourcePath);
+        database.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+
+        if (!database.open()) {
+            setError(errorMessage, QString("Cannot open %1: %2").arg(sourcePath, database.lastError().text()));
+        } else {
+            // VACUUM INTO reads from a single snapshot and never blocks writers
+            QSqlQuery query(database);
+            query.prepare("VACUUM INTO ?");
+            query.addBindValue(destinationPath);
+            success = query.exec();
+            if (!success) {
+                setError(errorMessage, QString("Backup of %1 failed: %2").arg(sourcePath, query.lastError().text()));
+            }
+            database.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (success && progress) {
+        progress(1, 1);
+    }
+    return success;
+}
+#endif
+
+} // namespace
+
+bool SqliteBackup::copy(const QString &sourcePath, const QString &destinationPath,
+                        QString *errorMessage, const ProgressCallback &progress,
+                        int pagesPerStep, int stepDelayMs)
+{
+    if (!QFile::exists(sourcePath)) {
+        setError(errorMessage, QString("Database file does not exist: %1").arg(sourcePath));
+        return false;
+    }
+
+    if (destinationPath.isEmpty()) {
+        setError(errorMessage, "Backup path is empty");
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(destinationPath).absolutePath());
+
+    // Build the copy next to the target so a failed run never leaves a partial backup
+    const QString partialPath = destinationPath + ".part";
+    QFile::remove(partialPath);
+
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    bool success = runNativeBackup(sourcePath, partialPath, errorMessage, progress,
+                                   qMax(1, pagesPerStep), stepDelayMs);
+#else
+    Q_UNUSED(pagesPerStep)
+    Q_UNUSED(stepDelayMs)
+    bool success = runVacuumInto(sourcePath, partialPath, errorMessage, progress);
+#endif
+
+    if (success) {
+        QFile::remove(destinationPath);
+        success = QFile::rename(partialPath, destinationPath);
+        if (!success) {
+            setError(errorMessage, QString("Cannot write backup file: %1").arg(destinationPath));
+        }
+    }
+
+    if (!success) {
+        QFile::remove(partialPath);
+    }
+
+    return success;
+}
+
+bool SqliteBackup::restore(const QString &backupPath, const QString &databasePath,
+                           QString *errorMessage, const ProgressCallback &progress,
+                           int pagesPerStep, int stepDelayMs)
+{
+    if (!QFile::exists(backupPath)) {
+        setError(errorMessage, QString("Backup file does not exist: %1").arg(backupPath));
+        return false;
+    }
+
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    // Pages are written straight into the live database under its own locks
+    return runNativeBackup(backupPath, databasePath, errorMessage, progress,
+                           qMax(1, pagesPerStep), stepDelayMs);
+#else
+    Q_UNUSED(databasePath)
+    Q_UNUSED(progress)
+    Q_UNUSED(pagesPerStep)
+    Q_UNUSED(stepDelayMs)
+    setError(errorMessage, "Online restore requires the native SQLite backup API");
+    return false;
+#endif
+}
+
+bool SqliteBackup::isOnlineBackupAvailable()
+{
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    return true;
+#else
+    return false;
+#endif
+}
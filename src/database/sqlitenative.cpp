@@ -0,0 +1,60 @@
+#include "sqlitenative.h"
+#include <QSqlDriver>
+#include <QSqlQuery>
+#include <QVariant>
+
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+#include <sqlite3.h>
+#endif
+
+namespace {
+
+void setError(QString *errorMessage, const QString &message)
+{
+    if (errorMessage) {
+        *errorMessage = message;
+    }
+}
+
+} // namespace
+
+bool SqliteNative::isAvailable()
+{
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    return true;
+#else
+    return false;
+#endif
+}
+
+sqlite3 *SqliteNative::handle(const QSqlDatabase &database, QString *errorMessage)
+{
+#ifdef ARCHIFLOW_HAVE_SQLITE_API
+    if (!database.isOpen() || !database.driver()) {
+        setError(errorMessage, "Connection is not open");
+        return nullptr;
+    }
+
+    const QVariant driverHandle = database.driver()->handle();
+    if (!driverHandle.isValid() || qstrcmp(driverHandle.typeName(), "sqlite3*") != 0) {
+        setError(errorMessage, "Connection is not a QSQLITE connection");
+        return nullptr;
+    }
+
+    // The build only links the API when Qt uses the system SQLite; still
+    // refuse a driver that was swapped for one with another version
+    QSqlQuery versionQuery(database);
+    if (!versionQuery.exec("SELECT sqlite_version()") || !versionQuery.next()
+        || versionQuery.value(0).toString() != QString::fromLatin1(sqlite3_libversion())) {
+        setError(errorMessage, QString("Qt SQL driver uses SQLite %1, application links %2")
+                                   .arg(versionQuery.value(0).toString(), QString::fromLatin1(sqlite3_libversion())));
+        return nullptr;
+    }
+
+    return *static_cast<sqlite3 *const *>(driverHandle.constData());
+#else
+    Q_UNUSED(database)
+    setError(errorMessage, "Built without the native SQLite API");
+    return nullptr;
+#endif
+}
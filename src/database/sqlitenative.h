@@ -0,0 +1,27 @@
+#ifndef SQLITENATIVE_H
+#define SQLITENATIVE_H
+
+#include <QSqlDatabase>
+#include <QString>
+
+struct sqlite3;
+
+/**
+ * @brief SqliteNative - Access to the sqlite3 handle behind a QSQLITE connection
+ *
+ * Native calls on a Qt connection are only safe when the application links
+ * the same SQLite library the Qt driver uses (Qt built with -system-sqlite).
+ * handle() refuses connections whose library version differs from the
+ * linked one. Builds without ARCHIFLOW_HAVE_SQLITE_API always get nullptr.
+ */
+namespace SqliteNative
+{
+    // True when the build links the SQLite C API
+    bool isAvailable();
+
+    // The connection's sqlite3 handle, or nullptr when it cannot be used.
+    // errorMessage receives the reason in that case.
+    sqlite3 *handle(const QSqlDatabase &database, QString *errorMessage = nullptr);
+}
+
+#endif // SQLITENATIVE_H
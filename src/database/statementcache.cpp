@@ -0,0 +1,106 @@
+#include "statementcache.h"
+#include <QRegularExpression>
+#include <utility>
+
+const int StatementCache::DEFAULT_CAPACITY = 64;
+
+StatementCache::StatementCache(int capacity)
+    : m_capacity(qMax(0, capacity))
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+QSqlQuery StatementCache::acquire(const QSqlDatabase &database, const QString &sql, bool *ok)
+{
+    if (ok) {
+        *ok = true;
+    }
+
+    auto it = m_index.find(sql);
+    if (it != m_index.end()) {
+        ++m_hits;
+
+        // Checked out: the caller owns the statement until it is released
+        QSqlQuery query = std::move(it.value()->query);
+        m_entries.erase(it.value());
+        m_index.erase(it);
+        return query;
+    }
+
+    ++m_misses;
+
+    QSqlQuery query(database);
+    if (!query.prepare(sql) && ok) {
+        *ok = false;
+    }
+    return query;
+}
+
+void StatementCache::release(const QString &sql, QSqlQuery &&query)
+{
+    // Reset the statement so its result set releases its locks
+    query.finish();
+
+    if (m_capacity <= 0 || !isCacheable(sql) || m_index.contains(sql)) {
+        return;
+    }
+
+    m_entries.push_front(Entry{sql, std::move(query)});
+    m_index.insert(sql, m_entries.begin());
+    evictOverflow();
+}
+
+void StatementCache::clear()
+{
+    m_index.clear();
+    m_entries.clear();
+}
+
+void StatementCache::setCapacity(int capacity)
+{
+    m_capacity = qMax(0, capacity);
+    evictOverflow();
+}
+
+int StatementCache::capacity() const
+{
+    return m_capacity;
+}
+
+int StatementCache::size() const
+{
+    return static_cast<int>(m_entries.size());
+}
+
+quint64 StatementCache::hits() const
+{
+    return m_hits.load();
+}
+
+quint64 StatementCache::misses() const
+{
+    return m_misses.load();
+}
+
+void StatementCache::resetStatistics()
+{
+    m_hits = 0;
+    m_misses = 0;
+}
+
+bool StatementCache::isCacheable(const QString &sql)
+{
+    static const QRegularExpression dmlPattern(
+        "^\\s*(SELECT|INSERT|UPDATE|DELETE|REPLACE|WITH)\\b",
+        QRegularExpression::CaseInsensitiveOption);
+    return dmlPattern.match(sql).hasMatch();
+}
+
+void StatementCache::evictOverflow()
+{
+    while (static_cast<int>(m_entries.size()) > m_capacity) {
+        m_index.remove(m_entries.back().sql);
+        m_entries.pop_back();
+    }
+}
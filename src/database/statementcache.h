@@ -0,0 +1,67 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <atomic>
+#include <list>
+
+/**
+ * @brief The StatementCache class - Bounded LRU cache of prepared statements
+ *
+ * Keeps prepared QSqlQuery objects keyed by their SQL text so hot statements
+ * are compiled once per connection instead of on every call. Only plain DML
+ * (SELECT/INSERT/UPDATE/DELETE/REPLACE/WITH) is cached; DDL and PRAGMAs are
+ * always prepared fresh.
+ *
+ * Statements are checked out and back in: acquire() moves a cached query out
+ * of the cache, so the caller owns it and its result set exclusively, and
+ * release() resets it and puts it back for the next caller. A query that is
+ * never released is simply prepared again next time. The cache must be
+ * cleared whenever the schema changes.
+ */
+class StatementCache
+{
+public:
+    static const int DEFAULT_CAPACITY;
+
+    explicit StatementCache(int capacity = DEFAULT_CAPACITY);
+
+    // Returns a prepared query for sql, taken from the cache when possible.
+    // ok is set to false when the statement could not be prepared.
+    QSqlQuery acquire(const QSqlDatabase &database, const QString &sql, bool *ok = nullptr);
+
+    // Hands a query prepared from sql back for reuse
+    void release(const QString &sql, QSqlQuery &&query);
+
+    void clear();
+    void setCapacity(int capacity);
+    int capacity() const;
+    int size() const;
+
+    // Statistics
+    quint64 hits() const;
+    quint64 misses() const;
+    void resetStatistics();
+
+    static bool isCacheable(const QString &sql);
+
+private:
+    struct Entry {
+        QString sql;
+        QSqlQuery query;
+    };
+
+    void evictOverflow();
+
+    std::list<Entry> m_entries; // Most recently used first
+    QHash<QString, std::list<Entry>::iterator> m_index;
+    int m_capacity;
+
+    std::atomic<quint64> m_hits;
+    std::atomic<quint64> m_misses;
+};
+
+#endif // STATEMENTCACHE_H
@@ -1,5 +1,10 @@
 #include "clientdatabasemanager.h"
 #include "client.h"
+#include "../../database/sqlitebackup.h"
+#include "../../database/queryprofiler.h"
+#include "../../database/changenotifier.h"
+#include "../../database/fulltextsearch.h"
+#include "../../database/maintenancescheduler.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QSqlRecord>
@@ -15,9 +20,30 @@
 const QString ClientDatabaseManager::DATABASE_VERSION = "1.0";
 const QString ClientDatabaseManager::CLIENTS_TABLE = "clients";
 
+namespace {
+
+const FullTextSearch::IndexDefinition CLIENTS_SEARCH_INDEX = {
+    "client", "clients", "id", false,
+    {"name", "company_name", "email", "address_city", "address_country"},
+    "t.name"
+};
+
+const KeysetPagination CLIENTS_PAGINATION(
+    "clients", "id",
+    {
+        {"name", {"name"}},
+        {"company_name", {"IFNULL(company_name, '')", "name"}},
+        {"created_at", {"IFNULL(created_at, '')"}}
+    },
+    "name", Qt::AscendingOrder);
+
+} // namespace
+
 ClientDatabaseManager::ClientDatabaseManager(QObject *parent)
     : QObject(parent)
     , m_connectionName(generateConnectionName())
+    , m_inTransaction(false)
+    , m_fullTextSearch(false)
 {
 }
 
@@ -46,6 +72,7 @@ bool ClientDatabaseManager::initialize(const QString &databasePath)
         setLastError("Failed to open database: " + m_database.lastError().text());
         return false;
     }
+    ChangeNotifier::instance()->attach(m_database, "clients");
     
     // Create tables if they don't exist
     if (!createTables()) {
@@ -53,6 +80,10 @@ bool ClientDatabaseManager::initialize(const QString &databasePath)
         return false;
     }
     
+    MaintenanceScheduler::instance()->registerDatabase({
+        m_connectionName, dbPath, "clients", {CLIENTS_SEARCH_INDEX}, CLIENTS_PAGINATION.planQueries()
+    });
+    
     qDebug() << "ClientDatabaseManager: Database initialized at" << dbPath;
     return true;
 }
@@ -66,6 +97,9 @@ bool ClientDatabaseManager::isConnected() const
 void ClientDatabaseManager::close()
 {
     QMutexLocker locker(&m_mutex);
+    FullTextSearch::instance()->unregisterConnection(m_connectionName);
+    ChangeNotifier::instance()->detach(m_connectionName);
+    MaintenanceScheduler::instance()->unregisterDatabase(m_connectionName);
     if (m_database.isOpen()) {
         m_database.close();
     }
@@ -80,6 +114,11 @@ QString ClientDatabaseManager::lastError() const
 
 bool ClientDatabaseManager::createTables()
 {
+    // Before the first table: a new file gets incremental auto-vacuum, so
+    // maintenance never needs a full VACUUM. Ignored by existing files.
+    QSqlQuery pragma(m_database);
+    pragma.exec("PRAGMA auto_vacuum = INCREMENTAL");
+
     return createClientsTable() && createIndexes();
 }
 
@@ -106,7 +145,7 @@ bool ClientDatabaseManager::createClientsTable()
         )
     )").arg(CLIENTS_TABLE);
     
-    if (!query.exec(sql)) {
+    if (!executeQuery(query, sql)) {
         setLastError("Failed to create clients table: " + query.lastError().text());
         return false;
     }
@@ -119,21 +158,29 @@ bool ClientDatabaseManager::createIndexes()
     QSqlQuery query(m_database);
     
     QStringList indexQueries = {
-        QString("CREATE INDEX IF NOT EXISTS idx_clients_name ON %1(name)").arg(CLIENTS_TABLE),
+        // Replaced by idx_clients_page_name
+        "DROP INDEX IF EXISTS idx_clients_name",
         QString("CREATE INDEX IF NOT EXISTS idx_clients_email ON %1(email)").arg(CLIENTS_TABLE),
         QString("CREATE INDEX IF NOT EXISTS idx_clients_company ON %1(company_name)").arg(CLIENTS_TABLE),
         QString("CREATE INDEX IF NOT EXISTS idx_clients_city ON %1(address_city)").arg(CLIENTS_TABLE),
         QString("CREATE INDEX IF NOT EXISTS idx_clients_country ON %1(address_country)").arg(CLIENTS_TABLE),
         QString("CREATE INDEX IF NOT EXISTS idx_clients_location ON %1(latitude, longitude)").arg(CLIENTS_TABLE)
     };
+    indexQueries << CLIENTS_PAGINATION.indexStatements();
     
     for (const QString &sql : indexQueries) {
-        if (!query.exec(sql)) {
+        if (!executeQuery(query, sql)) {
             setLastError("Failed to create index: " + query.lastError().text());
             return false;
         }
     }
     
+    // Optional; searchClients() falls back to LIKE without it
+    m_fullTextSearch = FullTextSearch::createIndex(m_database, CLIENTS_SEARCH_INDEX);
+    if (m_fullTextSearch) {
+        FullTextSearch::instance()->registerIndex(m_connectionName, CLIENTS_SEARCH_INDEX);
+    }
+    
     return true;
 }
 
@@ -169,7 +216,7 @@ bool ClientDatabaseManager::addClient(const ClientContact *client)
     query.addBindValue(client->createdAt());
     query.addBindValue(client->updatedAt());
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to add client: " + query.lastError().text());
         return false;
     }
@@ -209,7 +256,7 @@ bool ClientDatabaseManager::updateClient(const ClientContact *client)
     query.addBindValue(client->updatedAt());
     query.addBindValue(client->id());
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to update client: " + query.lastError().text());
         return false;
     }
@@ -229,7 +276,7 @@ bool ClientDatabaseManager::deleteClient(const QString &clientId)
     query.prepare(QString("DELETE FROM %1 WHERE id = ?").arg(CLIENTS_TABLE));
     query.addBindValue(clientId);
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to delete client: " + query.lastError().text());
         return false;
     }
@@ -249,7 +296,7 @@ ClientContact* ClientDatabaseManager::getClient(const QString &clientId)
     query.prepare(QString("SELECT * FROM %1 WHERE id = ?").arg(CLIENTS_TABLE));
     query.addBindValue(clientId);
     
-    if (!query.exec() || !query.next()) {
+    if (!executeQuery(query) || !query.next()) {
         return nullptr;
     }
     
@@ -263,7 +310,7 @@ QList<ClientContact*> ClientDatabaseManager::getAllClients()
     
     QSqlQuery query(m_database);    query.prepare(QString("SELECT * FROM %1 ORDER BY name").arg(CLIENTS_TABLE));
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to get clients: " + query.lastError().text());
         return clients;
     }
@@ -277,26 +324,61 @@ QList<ClientContact*> ClientDatabaseManager::getAllClients()
     return clients;
 }
 
+Page<ClientContact*> ClientDatabaseManager::getClientsPage(const PageRequest &request)
+{
+    QMutexLocker locker(&m_mutex);
+    Page<ClientContact*> page;
+    
+    QString sql;
+    QVariantList params;
+    if (!CLIENTS_PAGINATION.buildQuery(request, &sql, &params, &page.error)) {
+        setLastError(page.error);
+        return page;
+    }
+    
+    QSqlQuery query(m_database);
+    query.prepare(sql);
+    for (const QVariant &param : params) {
+        query.addBindValue(param);
+    }
+    
+    if (!executeQuery(query)) {
+        page.error = "Failed to get clients: " + query.lastError().text();
+        setLastError(page.error);
+        return page;
+    }
+    
+    return CLIENTS_PAGINATION.readPage<ClientContact*>(query, request, [this](const QSqlQuery &row) {
+        return clientFromQuery(row);
+    });
+}
+
 QList<ClientContact*> ClientDatabaseManager::searchClients(const QString &searchTerm)
 {
     QMutexLocker locker(&m_mutex);
     QList<ClientContact*> clients;
     
     QSqlQuery query(m_database);
-    query.prepare(QString(R"(
-        SELECT * FROM %1 
-        WHERE name LIKE ? OR company_name LIKE ? OR email LIKE ? 
-           OR address_city LIKE ? OR address_country LIKE ?
-        ORDER BY name
-    )").arg(CLIENTS_TABLE));
-    
-    QString term = "%" + searchTerm + "%";
-    query.addBindValue(term);
-    query.addBindValue(term);
-    query.addBindValue(term);
-    query.addBindValue(term);
-    query.addBindValue(term);
-      if (!query.exec()) {
+    const QString matchExpression = FullTextSearch::matchExpression(searchTerm);
+    if (m_fullTextSearch && !matchExpression.isEmpty()) {
+        query.prepare(FullTextSearch::searchSql(CLIENTS_SEARCH_INDEX));
+        query.addBindValue(matchExpression);
+    } else {
+        query.prepare(QString(R"(
+            SELECT * FROM %1 
+            WHERE name LIKE ? OR company_name LIKE ? OR email LIKE ? 
+               OR address_city LIKE ? OR address_country LIKE ?
+            ORDER BY name
+        )").arg(CLIENTS_TABLE));
+        
+        QString term = "%" + searchTerm + "%";
+        query.addBindValue(term);
+        query.addBindValue(term);
+        query.addBindValue(term);
+        query.addBindValue(term);
+        query.addBindValue(term);
+    }
+      if (!executeQuery(query)) {
         setLastError("Failed to search clients: " + query.lastError().text());
         return clients;
     }
@@ -320,7 +402,7 @@ bool ClientDatabaseManager::clientExists(const QString &clientId)
     query.prepare(QString("SELECT COUNT(*) FROM %1 WHERE id = ?").arg(CLIENTS_TABLE));
     query.addBindValue(clientId);
     
-    if (!query.exec() || !query.next()) {
+    if (!executeQuery(query) || !query.next()) {
         return false;
     }
     
@@ -343,7 +425,7 @@ bool ClientDatabaseManager::emailExists(const QString &email, const QString &exc
         query.addBindValue(excludeClientId);
     }
     
-    if (!query.exec() || !query.next()) {
+    if (!executeQuery(query) || !query.next()) {
         return false;
     }
     
@@ -362,7 +444,7 @@ QList<ClientContact*> ClientDatabaseManager::getClientsByLocation(double latitud
         ORDER BY name
     )").arg(CLIENTS_TABLE));
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to get clients by location: " + query.lastError().text());
         return clients;
     }
@@ -404,7 +486,7 @@ QList<ClientContact*> ClientDatabaseManager::getClientsWithCoordinates()
         ORDER BY name
     )").arg(CLIENTS_TABLE));
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to get clients with coordinates: " + query.lastError().text());
         return clients;    }
     
@@ -425,7 +507,7 @@ int ClientDatabaseManager::getTotalClientCount()
     
     query.prepare(QString("SELECT COUNT(*) FROM %1").arg(CLIENTS_TABLE));
     
-    if (!query.exec() || !query.next()) {
+    if (!executeQuery(query) || !query.next()) {
         return 0;
     }
     
@@ -440,7 +522,7 @@ int ClientDatabaseManager::getClientCountByCity(const QString &city)
     query.prepare(QString("SELECT COUNT(*) FROM %1 WHERE address_city = ?").arg(CLIENTS_TABLE));
     query.addBindValue(city);
     
-    if (!query.exec() || !query.next()) {
+    if (!executeQuery(query) || !query.next()) {
         return 0;
     }
     
@@ -455,7 +537,7 @@ int ClientDatabaseManager::getClientCountByCountry(const QString &country)
     query.prepare(QString("SELECT COUNT(*) FROM %1 WHERE address_country = ?").arg(CLIENTS_TABLE));
     query.addBindValue(country);
     
-    if (!query.exec() || !query.next()) {
+    if (!executeQuery(query) || !query.next()) {
         return 0;
     }
     
@@ -470,7 +552,7 @@ QStringList ClientDatabaseManager::getAllCities()
     QSqlQuery query(m_database);
     query.prepare(QString("SELECT DISTINCT address_city FROM %1 WHERE address_city != '' ORDER BY address_city").arg(CLIENTS_TABLE));
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         return cities;
     }
     
@@ -489,7 +571,7 @@ QStringList ClientDatabaseManager::getAllCountries()
     QSqlQuery query(m_database);
     query.prepare(QString("SELECT DISTINCT address_country FROM %1 WHERE address_country != '' ORDER BY address_country").arg(CLIENTS_TABLE));
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         return countries;
     }
     
@@ -503,30 +585,48 @@ QStringList ClientDatabaseManager::getAllCountries()
 // Transaction management
 bool ClientDatabaseManager::beginTransaction()
 {
-    return m_database.transaction();
+    m_inTransaction = m_database.transaction();
+    return m_inTransaction;
 }
 
 bool ClientDatabaseManager::commitTransaction()
 {
-    return m_database.commit();
+    if (!m_database.commit()) {
+        return false;
+    }
+    m_inTransaction = false;
+    ChangeNotifier::instance()->commit(m_connectionName);
+    return true;
 }
 
 bool ClientDatabaseManager::rollbackTransaction()
 {
-    return m_database.rollback();
+    const bool rolledBack = m_database.rollback();
+    m_inTransaction = false;
+    ChangeNotifier::instance()->rollback(m_connectionName);
+    return rolledBack;
 }
 
 bool ClientDatabaseManager::vacuum()
 {
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_database);
-    return query.exec("VACUUM");
+    // Runs in the background in bounded steps; a file from before incremental
+    // auto-vacuum gets its one full VACUUM here, and the search index is rebuilt
+    if (!MaintenanceScheduler::instance()->requestMaintenance(m_connectionName, true)) {
+        setLastError("Database maintenance is not available");
+        return false;
+    }
+    return true;
 }
 
 bool ClientDatabaseManager::backup(const QString &backupPath)
 {
-    QMutexLocker locker(&m_mutex);
-    return QFile::copy(m_database.databaseName(), backupPath);
+    // No lock needed: the backup reads through its own connection
+    QString errorMessage;
+    if (!SqliteBackup::copy(m_database.databaseName(), backupPath, &errorMessage)) {
+        setLastError("Backup failed: " + errorMessage);
+        return false;
+    }
+    return true;
 }
 
 bool ClientDatabaseManager::restore(const QString &backupPath)
@@ -578,6 +678,24 @@ ClientContact* ClientDatabaseManager::clientFromQuery(const QSqlQuery &query)
     return client;
 }
 
+bool ClientDatabaseManager::executeQuery(QSqlQuery &query, const QString &sql) const
+{
+    if (!QueryProfiler::instance()->execute(query, m_database, "clients", sql)) {
+        return false;
+    }
+
+    if (!query.isSelect()) {
+        // Without native hooks the notifier only learns of writes from here
+        ChangeNotifier *notifier = ChangeNotifier::instance();
+        notifier->recordStatement(m_connectionName, query.lastQuery(),
+                                  query.lastInsertId(), query.numRowsAffected());
+        if (!m_inTransaction) {
+            notifier->commit(m_connectionName);
+        }
+    }
+    return true;
+}
+
 void ClientDatabaseManager::setLastError(const QString &error)
 {
     m_lastError = error;
@@ -8,6 +8,7 @@
 #include <QString>
 #include <QList>
 #include <QMutex>
+#include "../../database/keysetpagination.h"
 
 class ClientContact;
 
@@ -37,6 +38,8 @@ public:
     bool deleteClient(const QString &clientId);
     ClientContact* getClient(const QString &clientId);
     QList<ClientContact*> getAllClients();
+    // Sort keys: name (default), company_name, created_at
+    Page<ClientContact*> getClientsPage(const PageRequest &request);
     QList<ClientContact*> searchClients(const QString &searchTerm);
     bool clientExists(const QString &clientId);
     bool emailExists(const QString &email, const QString &excludeClientId = QString());
@@ -76,12 +79,15 @@ private:
     bool createIndexes();
     
     ClientContact* clientFromQuery(const QSqlQuery &query);
+    bool executeQuery(QSqlQuery &query, const QString &sql = QString()) const;
     void setLastError(const QString &error);
     QString generateConnectionName();
 
     QSqlDatabase m_database;
     QString m_connectionName;
     QString m_lastError;
+    bool m_inTransaction;
+    bool m_fullTextSearch;
     mutable QMutex m_mutex;
     
     static const QString DATABASE_VERSION;
@@ -1,5 +1,13 @@
 #include "contractdatabasemanager.h"
 #include "contract.h"
+#include "../../database/sqlitebackup.h"
+#include "../../database/queryprofiler.h"
+#include "../../database/changenotifier.h"
+#include "../../database/fulltextsearch.h"
+#include "../../database/auditlogger.h"
+#include "../../database/connectionpool.h"
+#include "../../database/reportsession.h"
+#include "../../database/maintenancescheduler.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
@@ -13,9 +21,66 @@
 #include <QSqlRecord>
 #include <QDateTime>
 
+namespace {
+
+const FullTextSearch::IndexDefinition CONTRACTS_SEARCH_INDEX = {
+    "contract", "contracts", "id", false,
+    {"client_name", "description", "status"},
+    "t.client_name"
+};
+
+const KeysetPagination CONTRACTS_PAGINATION(
+    "contracts", "id",
+    {
+        {"created_at", {"IFNULL(created_at, '')"}},
+        {"client_name", {"client_name"}},
+        {"start_date", {"start_date"}},
+        {"end_date", {"end_date"}},
+        {"value", {"value"}}
+    },
+    "created_at", Qt::DescendingOrder);
+
+// PRAGMA user_version of the contracts database.
+// 2: start_date and end_date hold Julian day numbers (QDate::toJulianDay)
+const int CONTRACTS_SCHEMA_VERSION = 2;
+
+const char *CREATE_CONTRACTS_TABLE_SQL = R"(
+    CREATE TABLE IF NOT EXISTS contracts (
+        id TEXT PRIMARY KEY,
+        client_name TEXT NOT NULL,
+        start_date INTEGER NOT NULL,
+        end_date INTEGER NOT NULL,
+        value REAL NOT NULL DEFAULT 0.0,
+        status TEXT NOT NULL DEFAULT 'Draft',
+        description TEXT,
+        payment_terms INTEGER DEFAULT 30,
+        has_non_compete_clause BOOLEAN DEFAULT FALSE,
+        created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+        updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
+    )
+)";
+
+// Integer day numbers compare and range-scan like any other integer.
+// Invalid dates are stored as 0.
+qint64 toDayNumber(const QDate &date)
+{
+    return date.isValid() ? date.toJulianDay() : 0;
+}
+
+QDate fromDayNumber(const QVariant &value)
+{
+    const qint64 day = value.toLongLong();
+    return day > 0 ? QDate::fromJulianDay(day) : QDate();
+}
+
+} // namespace
+
 ContractDatabaseManager::ContractDatabaseManager(QObject *parent)
     : QObject(parent)
+    , m_readerPool(new ConnectionPool("contracts_connection", this))
     , m_isInitialized(false)
+    , m_fullTextSearch(false)
+    , m_inTransaction(false)
     , m_cachingEnabled(true)
     , m_cacheTimestamp(QDateTime::currentDateTime())
 {
@@ -61,12 +126,23 @@ bool ContractDatabaseManager::initialize(const QString &databasePath)
 
     qDebug() << "Database opened successfully";
 
+    // WAL lets report snapshots read alongside writes
+    ConnectionPool::configureConnection(m_database);
+    m_readerPool->setDatabasePath(m_databasePath);
+    ChangeNotifier::instance()->attach(m_database, "contracts");
+
     // Create tables
     qDebug() << "Creating database tables...";
     if (!createTables()) {
         qWarning() << "Failed to create database tables";
         return false;
     }
+    
+    AuditLogger::instance()->attach(m_database, "contracts", {"contracts"});
+    MaintenanceScheduler::instance()->registerDatabase({
+        m_database.connectionName(), m_databasePath, "contracts",
+        {CONTRACTS_SEARCH_INDEX}, CONTRACTS_PAGINATION.planQueries()
+    });
 
     m_isInitialized = true;
     qDebug() << "Contract database initialized successfully at:" << m_databasePath;
@@ -76,6 +152,11 @@ bool ContractDatabaseManager::initialize(const QString &databasePath)
 void ContractDatabaseManager::shutdown()
 {
     if (m_database.isOpen()) {
+        FullTextSearch::instance()->unregisterConnection(m_database.connectionName());
+        ChangeNotifier::instance()->detach(m_database.connectionName());
+        AuditLogger::instance()->detach(m_database.connectionName());
+        MaintenanceScheduler::instance()->unregisterDatabase(m_database.connectionName());
+        m_readerPool->closeAll();
         m_database.close();
     }
     m_isInitialized = false;
@@ -84,35 +165,35 @@ void ContractDatabaseManager::shutdown()
 bool ContractDatabaseManager::createTables()
 {
     QSqlQuery query(m_database);
-    
-    QString createTableSQL = R"(
-        CREATE TABLE IF NOT EXISTS contracts (
-            id TEXT PRIMARY KEY,
-            client_name TEXT NOT NULL,
-            start_date TEXT NOT NULL,
-            end_date TEXT NOT NULL,
-            value REAL NOT NULL DEFAULT 0.0,
-            status TEXT NOT NULL DEFAULT 'Draft',
-            description TEXT,
-            payment_terms INTEGER DEFAULT 30,
-            has_non_compete_clause BOOLEAN DEFAULT FALSE,
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-            updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
-        )
-    )";
 
-    query.prepare(createTableSQL);
+    // Also set by configureConnection; repeated here so it is in place
+    // before the first table whatever opened the file
+    query.exec("PRAGMA auto_vacuum = INCREMENTAL");
+
+    query.prepare(CREATE_CONTRACTS_TABLE_SQL);
     if (!executeQuery(query, "create contracts table")) {
         return false;
     }
 
-    // Create indexes for better performance
+    bool rebuilt = false;
+    if (!migrateSchema(&rebuilt)) {
+        return false;
+    }
+
+    // Create indexes for better performance. The page indexes lead with
+    // the same columns as the single-column ones they replace.
     QStringList indexes = {
-        "CREATE INDEX IF NOT EXISTS idx_contracts_client_name ON contracts(client_name)",
-        "CREATE INDEX IF NOT EXISTS idx_contracts_status ON contracts(status)",
-        "CREATE INDEX IF NOT EXISTS idx_contracts_start_date ON contracts(start_date)",
-        "CREATE INDEX IF NOT EXISTS idx_contracts_end_date ON contracts(end_date)"
+        "DROP INDEX IF EXISTS idx_contracts_client_name",
+        "DROP INDEX IF EXISTS idx_contracts_start_date",
+        "DROP INDEX IF EXISTS idx_contracts_end_date",
+        "DROP INDEX IF EXISTS idx_contracts_status",
+        // Expiry and synchronization: status = ? AND end_date range,
+        // answered from the index alone when only counting
+        "CREATE INDEX IF NOT EXISTS idx_contracts_status_end_date ON contracts(status, end_date)",
+        // Monthly counts and value totals by start date never touch the table
+        "CREATE INDEX IF NOT EXISTS idx_contracts_start_date_value ON contracts(start_date, value)"
     };
+    indexes << CONTRACTS_PAGINATION.indexStatements();
 
     for (const QString &indexSQL : indexes) {
         query.prepare(indexSQL);
@@ -121,9 +202,89 @@ bool ContractDatabaseManager::createTables()
         }
     }
 
+    // Optional; searchContracts() falls back to LIKE without it
+    m_fullTextSearch = FullTextSearch::createIndex(m_database, CONTRACTS_SEARCH_INDEX);
+    if (m_fullTextSearch) {
+        // The rebuilt table has new implicit rowids
+        if (rebuilt) {
+            FullTextSearch::rebuildIndex(m_database, CONTRACTS_SEARCH_INDEX);
+        }
+        FullTextSearch::instance()->registerIndex(m_database.connectionName(), CONTRACTS_SEARCH_INDEX);
+    }
+
     return true;
 }
 
+bool ContractDatabaseManager::migrateSchema(bool *rebuilt)
+{
+    QSqlQuery query(m_database);
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        m_lastError = QString("Failed to read contracts schema version: %1").arg(query.lastError().text());
+        return false;
+    }
+    const int version = query.value(0).toInt();
+    query.finish();
+
+    if (version >= CONTRACTS_SCHEMA_VERSION) {
+        return true;
+    }
+
+    // Databases created before version 2 declare the dates as TEXT, whose
+    // affinity would turn integers back into text, so the table is rebuilt
+    bool textDates = false;
+    if (query.exec("PRAGMA table_info(contracts)")) {
+        while (query.next()) {
+            if (query.value("name").toString() == "start_date") {
+                textDates = query.value("type").toString().compare("INTEGER", Qt::CaseInsensitive) != 0;
+            }
+        }
+    }
+
+    if (textDates) {
+        qDebug() << "Migrating contract dates to Julian day numbers...";
+
+        // ISO dates map to julianday() at midnight, half a day before QDate's day number
+        const QStringList statements = {
+            "ALTER TABLE contracts RENAME TO contracts_v1",
+            CREATE_CONTRACTS_TABLE_SQL,
+            R"(INSERT INTO contracts (
+                   id, client_name, start_date, end_date, value, status, description,
+                   payment_terms, has_non_compete_clause, created_at, updated_at)
+               SELECT id, client_name,
+                   IFNULL(CAST(julianday(start_date) + 0.5 AS INTEGER), 0),
+                   IFNULL(CAST(julianday(end_date) + 0.5 AS INTEGER), 0),
+                   value, status, description, payment_terms, has_non_compete_clause,
+                   created_at, updated_at
+               FROM contracts_v1)",
+            // Takes the old indexes and search triggers with it
+            "DROP TABLE contracts_v1"
+        };
+
+        if (!beginTransaction()) {
+            m_lastError = QString("Failed to start contracts migration: %1").arg(m_database.lastError().text());
+            return false;
+        }
+
+        for (const QString &sql : statements) {
+            if (!query.exec(sql)) {
+                m_lastError = QString("Contracts migration failed: %1").arg(query.lastError().text());
+                qWarning() << m_lastError;
+                rollbackTransaction();
+                return false;
+            }
+        }
+
+        if (!commitTransaction()) {
+            m_lastError = QString("Failed to commit contracts migration: %1").arg(m_database.lastError().text());
+            rollbackTransaction();
+            return false;
+        }
+        *rebuilt = true;
+    }
+
+    return query.exec(QString("PRAGMA user_version = %1").arg(CONTRACTS_SCHEMA_VERSION));
+}
+
 QString ContractDatabaseManager::addContract(Contract *contract)
 {
     qDebug() << "ContractDatabaseManager::addContract called";
@@ -175,7 +336,7 @@ QString ContractDatabaseManager::addContract(Contract *contract)
     }
 
     // Begin transaction for data integrity
-    if (!m_database.transaction()) {
+    if (!beginTransaction()) {
         m_lastError = QString("Failed to start transaction: %1").arg(m_database.lastError().text());
         qDebug() << m_lastError;
         emit databaseError(m_lastError);
@@ -200,7 +361,7 @@ QString ContractDatabaseManager::addContract(Contract *contract)
 
     qDebug() << "Executing contract insert query...";
     if (executeQuery(query, "add contract")) {
-        if (m_database.commit()) {
+        if (commitTransaction()) {
             qDebug() << "Contract added successfully to database with ID:" << contract->id();
             emit contractAdded(contract->id());
             return contract->id();
@@ -212,7 +373,7 @@ QString ContractDatabaseManager::addContract(Contract *contract)
     }
 
     // Rollback on failure
-    m_database.rollback();
+    rollbackTransaction();
     qDebug() << "Failed to add contract to database, transaction rolled back";
     return QString();
 }
@@ -258,7 +419,7 @@ bool ContractDatabaseManager::updateContract(Contract *contract)
     }
 
     // Begin transaction for data integrity
-    if (!m_database.transaction()) {
+    if (!beginTransaction()) {
         m_lastError = QString("Failed to start transaction: %1").arg(m_database.lastError().text());
         qDebug() << m_lastError;
         emit databaseError(m_lastError);
@@ -286,7 +447,7 @@ bool ContractDatabaseManager::updateContract(Contract *contract)
     qDebug() << "Updating contract with ID:" << contract->id();
     if (executeQuery(query, "update contract")) {
         if (query.numRowsAffected() > 0) {
-            if (m_database.commit()) {
+            if (commitTransaction()) {
                 qDebug() << "Contract updated successfully in database";
                 emit contractUpdated(contract->id());
                 return true;
@@ -303,7 +464,7 @@ bool ContractDatabaseManager::updateContract(Contract *contract)
     }
 
     // Rollback on failure
-    m_database.rollback();
+    rollbackTransaction();
     qDebug() << "Failed to update contract, transaction rolled back";
     return false;
 }
@@ -345,7 +506,7 @@ bool ContractDatabaseManager::deleteContract(const QString &contractId)
     delete existingContract; // Clean up
 
     // Begin transaction for data integrity
-    if (!m_database.transaction()) {
+    if (!beginTransaction()) {
         m_lastError = QString("Failed to start transaction: %1").arg(m_database.lastError().text());
         qDebug() << m_lastError;
         emit databaseError(m_lastError);
@@ -359,7 +520,7 @@ bool ContractDatabaseManager::deleteContract(const QString &contractId)
     qDebug() << "Deleting contract with ID:" << contractId;
     if (executeQuery(query, "delete contract")) {
         if (query.numRowsAffected() > 0) {
-            if (m_database.commit()) {
+            if (commitTransaction()) {
                 qDebug() << "Contract deleted successfully from database";
                 emit contractDeleted(contractId);
                 return true;
@@ -376,7 +537,7 @@ bool ContractDatabaseManager::deleteContract(const QString &contractId)
     }
 
     // Rollback on failure
-    m_database.rollback();
+    rollbackTransaction();
     qDebug() << "Failed to delete contract, transaction rolled back";
     return false;
 }
@@ -445,6 +606,38 @@ QList<Contract*> ContractDatabaseManager::getAllContracts()
     return contracts;
 }
 
+Page<Contract*> ContractDatabaseManager::getContractsPage(const PageRequest &request)
+{
+    Page<Contract*> page;
+
+    if (!m_isInitialized) {
+        page.error = "Database not initialized";
+        return page;
+    }
+
+    QString sql;
+    QVariantList params;
+    if (!CONTRACTS_PAGINATION.buildQuery(request, &sql, &params, &page.error)) {
+        m_lastError = page.error;
+        return page;
+    }
+
+    QSqlQuery query(m_database);
+    query.prepare(sql);
+    for (const QVariant &param : params) {
+        query.addBindValue(param);
+    }
+
+    if (!executeQuery(query, "get contracts page")) {
+        page.error = m_lastError;
+        return page;
+    }
+
+    return CONTRACTS_PAGINATION.readPage<Contract*>(query, request, [this](const QSqlQuery &row) {
+        return createContractFromQuery(row);
+    });
+}
+
 QList<Contract*> ContractDatabaseManager::searchContracts(const QString &searchTerm)
 {
     QList<Contract*> contracts;
@@ -454,16 +647,23 @@ QList<Contract*> ContractDatabaseManager::searchContracts(const QString &searchT
     }
 
     QSqlQuery query(m_database);
-    QString sql = R"(
-        SELECT * FROM contracts 
-        WHERE client_name LIKE :term 
-           OR description LIKE :term 
-           OR status LIKE :term
-        ORDER BY created_at DESC
-    )";
+    const QString matchExpression = FullTextSearch::matchExpression(searchTerm);
+    if (m_fullTextSearch && !matchExpression.isEmpty()) {
+        // Best match first
+        query.prepare(FullTextSearch::searchSql(CONTRACTS_SEARCH_INDEX));
+        query.addBindValue(matchExpression);
+    } else {
+        QString sql = R"(
+            SELECT * FROM contracts 
+            WHERE client_name LIKE :term 
+               OR description LIKE :term 
+               OR status LIKE :term
+            ORDER BY created_at DESC
+        )";
 
-    query.prepare(sql);
-    query.bindValue(":term", "%" + searchTerm + "%");
+        query.prepare(sql);
+        query.bindValue(":term", "%" + searchTerm + "%");
+    }
 
     if (executeQuery(query, "search contracts")) {
         while (query.next()) {
@@ -509,16 +709,18 @@ QList<Contract*> ContractDatabaseManager::getContractsByDateRange(const QDate &s
         return contracts;
     }
 
+    // A contract ending by endDate also starts by then, which bounds the
+    // start_date range scan on both sides
     QSqlQuery query(m_database);
     QString sql = R"(
         SELECT * FROM contracts 
-        WHERE start_date >= :start_date AND end_date <= :end_date
+        WHERE start_date BETWEEN :start_date AND :end_date AND end_date <= :end_date
         ORDER BY start_date
     )";
 
     query.prepare(sql);
-    query.bindValue(":start_date", startDate.toString(Qt::ISODate));
-    query.bindValue(":end_date", endDate.toString(Qt::ISODate));
+    query.bindValue(":start_date", toDayNumber(startDate));
+    query.bindValue(":end_date", toDayNumber(endDate));
 
     if (executeQuery(query, "get contracts by date range")) {
         while (query.next()) {
@@ -552,8 +754,8 @@ QList<Contract*> ContractDatabaseManager::getExpiringContracts(int daysFromNow)
     )";
 
     query.prepare(sql);
-    query.bindValue(":current_date", currentDate.toString(Qt::ISODate));
-    query.bindValue(":future_date", futureDate.toString(Qt::ISODate));
+    query.bindValue(":current_date", toDayNumber(currentDate));
+    query.bindValue(":future_date", toDayNumber(futureDate));
 
     if (executeQuery(query, "get expiring contracts")) {
         while (query.next()) {
@@ -584,7 +786,8 @@ int ContractDatabaseManager::getExpiredContracts()
     QSqlQuery query(m_database);
     QString sql = "SELECT COUNT(*) FROM contracts WHERE end_date < :current_date";
     query.prepare(sql);
-    query.bindValue(":current_date", QDate::currentDate().toString(Qt::ISODate));    if (executeQuery(query, "get expired contracts count") && query.next()) {
+    query.bindValue(":current_date", toDayNumber(QDate::currentDate()));
+    if (executeQuery(query, "get expired contracts count") && query.next()) {
         return query.value(0).toInt();
     }
     return 0;
@@ -640,8 +843,8 @@ Contract* ContractDatabaseManager::createContractFromQuery(const QSqlQuery &quer
     
     contract->setId(query.value("id").toString());
     contract->setClientName(query.value("client_name").toString());
-    contract->setStartDate(QDate::fromString(query.value("start_date").toString(), Qt::ISODate));
-    contract->setEndDate(QDate::fromString(query.value("end_date").toString(), Qt::ISODate));
+    contract->setStartDate(fromDayNumber(query.value("start_date")));
+    contract->setEndDate(fromDayNumber(query.value("end_date")));
     contract->setValue(query.value("value").toDouble());
     contract->setStatus(query.value("status").toString());
     contract->setDescription(query.value("description").toString());
@@ -655,8 +858,8 @@ void ContractDatabaseManager::bindContractToQuery(QSqlQuery &query, Contract *co
 {
     query.bindValue(":id", contract->id());
     query.bindValue(":client_name", contract->clientName());
-    query.bindValue(":start_date", contract->startDate().toString(Qt::ISODate));
-    query.bindValue(":end_date", contract->endDate().toString(Qt::ISODate));
+    query.bindValue(":start_date", toDayNumber(contract->startDate()));
+    query.bindValue(":end_date", toDayNumber(contract->endDate()));
     query.bindValue(":value", contract->value());
     query.bindValue(":status", contract->status());
     query.bindValue(":description", contract->description());
@@ -666,15 +869,50 @@ void ContractDatabaseManager::bindContractToQuery(QSqlQuery &query, Contract *co
 
 bool ContractDatabaseManager::executeQuery(QSqlQuery &query, const QString &operation)
 {
-    if (!query.exec()) {
+    if (!QueryProfiler::instance()->execute(query, m_database, "contracts")) {
         m_lastError = QString("Failed to execute %1: %2").arg(operation, query.lastError().text());
         qWarning() << m_lastError;
         emit databaseError(m_lastError);
         return false;
     }
+
+    if (!query.isSelect()) {
+        // Without native hooks the notifier only learns of writes from here
+        ChangeNotifier *notifier = ChangeNotifier::instance();
+        notifier->recordStatement(m_database.connectionName(), query.lastQuery(),
+                                  query.lastInsertId(), query.numRowsAffected());
+        if (!m_inTransaction) {
+            notifier->commit(m_database.connectionName());
+        }
+    }
+    return true;
+}
+
+bool ContractDatabaseManager::beginTransaction()
+{
+    m_inTransaction = m_database.transaction();
+    return m_inTransaction;
+}
+
+bool ContractDatabaseManager::commitTransaction()
+{
+    if (!m_database.commit()) {
+        // Still open; the caller rolls back
+        return false;
+    }
+    m_inTransaction = false;
+    ChangeNotifier::instance()->commit(m_database.connectionName());
     return true;
 }
 
+bool ContractDatabaseManager::rollbackTransaction()
+{
+    const bool rolledBack = m_database.rollback();
+    m_inTransaction = false;
+    ChangeNotifier::instance()->rollback(m_database.connectionName());
+    return rolledBack;
+}
+
 // IContractService interface implementation
 
 QList<Contract*> ContractDatabaseManager::getContractsByClient(const QString &clientName)
@@ -774,24 +1012,39 @@ QJsonArray ContractDatabaseManager::getMonthlyContractCounts()
         return monthlyCounts;
     }
 
+    // Per-day counts walk idx_contracts_start_date_value backwards; days
+    // are folded into months here and the walk stops after the 12th month
     QSqlQuery query(m_database);
+    query.setForwardOnly(true);
     query.prepare(R"(
-        SELECT 
-            strftime('%Y-%m', start_date) as month,
-            COUNT(*) as count
+        SELECT start_date, COUNT(*) as count
         FROM contracts 
-        GROUP BY strftime('%Y-%m', start_date)
-        ORDER BY month DESC
-        LIMIT 12
+        WHERE start_date > 0
+        GROUP BY start_date
+        ORDER BY start_date DESC
     )");
 
     if (executeQuery(query, "get monthly contract counts")) {
+        QString month;
+        int count = 0;
         while (query.next()) {
-            QJsonObject monthData;
-            monthData["month"] = query.value("month").toString();
-            monthData["count"] = query.value("count").toInt();
-            monthlyCounts.append(monthData);
+            const QString dayMonth = fromDayNumber(query.value(0)).toString("yyyy-MM");
+            if (dayMonth != month) {
+                if (!month.isEmpty()) {
+                    monthlyCounts.append(QJsonObject{{"month", month}, {"count", count}});
+                }
+                if (monthlyCounts.size() == 12) {
+                    break;
+                }
+                month = dayMonth;
+                count = 0;
+            }
+            count += query.value(1).toInt();
+        }
+        if (!month.isEmpty() && monthlyCounts.size() < 12) {
+            monthlyCounts.append(QJsonObject{{"month", month}, {"count", count}});
         }
+        query.finish();
     }
 
     return monthlyCounts;
@@ -993,6 +1246,8 @@ bool ContractDatabaseManager::importContracts(const QJsonArray &contracts, QStri
         delete contract;
     }
 
+    MaintenanceScheduler::instance()->noteBulkWrite(m_database.connectionName(), successCount);
+
     if (errorCount > 0) {
         errorMessage = QString("Import completed with %1 successes and %2 errors:\n%3")
                       .arg(successCount).arg(errorCount).arg(errorMessage);
@@ -1019,6 +1274,15 @@ QList<Contract*> ContractDatabaseManager::getContractsInDateRange(const QDate &s
     return getContractsByDateRange(startDate, endDate);
 }
 
+std::shared_ptr<ReportSession> ContractDatabaseManager::beginReportSession()
+{
+    std::shared_ptr<ReportSession> session = ReportSession::begin(m_readerPool, "contracts");
+    if (!session->isActive()) {
+        m_lastError = session->lastError();
+    }
+    return session;
+}
+
 // Enhanced CRUD operations with better error handling
 
 bool ContractDatabaseManager::addContracts(const QList<Contract*> &contracts, QStringList &addedIds, QString &errorMessage)
@@ -1034,7 +1298,7 @@ bool ContractDatabaseManager::addContracts(const QList<Contract*> &contracts, QS
     }
 
     // Begin transaction for batch operation
-    if (!m_database.transaction()) {
+    if (!beginTransaction()) {
         errorMessage = QString("Failed to start transaction: %1").arg(m_database.lastError().text());
         return false;
     }
@@ -1103,12 +1367,13 @@ bool ContractDatabaseManager::addContracts(const QList<Contract*> &contracts, QS
     }
 
     if (overallSuccess && errorCount == 0) {
-        if (m_database.commit()) {
+        if (commitTransaction()) {
             // Emit signals for successfully added contracts
             for (const QString &contractId : addedIds) {
                 emit contractAdded(contractId);
             }
             qDebug() << "Batch add completed successfully:" << successCount << "contracts added";
+            MaintenanceScheduler::instance()->noteBulkWrite(m_database.connectionName(), successCount);
             return true;
         } else {
             errorMessage = QString("Failed to commit transaction: %1").arg(m_database.lastError().text());
@@ -1117,7 +1382,7 @@ bool ContractDatabaseManager::addContracts(const QList<Contract*> &contracts, QS
     }
 
     // Rollback on any failure
-    m_database.rollback();
+    rollbackTransaction();
     errorMessage = QString("Batch add completed with %1 successes and %2 errors:\n%3")
                   .arg(successCount).arg(errorCount).arg(errors.join("\n"));
     
@@ -1137,7 +1402,7 @@ bool ContractDatabaseManager::updateContracts(const QList<Contract*> &contracts,
     }
 
     // Begin transaction for batch operation
-    if (!m_database.transaction()) {
+    if (!beginTransaction()) {
         errorMessage = QString("Failed to start transaction: %1").arg(m_database.lastError().text());
         return false;
     }
@@ -1202,7 +1467,7 @@ bool ContractDatabaseManager::updateContracts(const QList<Contract*> &contracts,
     }
 
     if (overallSuccess && errorCount == 0) {
-        if (m_database.commit()) {
+        if (commitTransaction()) {
             // Emit signals for successfully updated contracts
             for (const QString &contractId : updatedIds) {
                 emit contractUpdated(contractId);
@@ -1216,7 +1481,7 @@ bool ContractDatabaseManager::updateContracts(const QList<Contract*> &contracts,
     }
 
     // Rollback on any failure
-    m_database.rollback();
+    rollbackTransaction();
     errorMessage = QString("Batch update completed with %1 successes and %2 errors:\n%3")
                   .arg(successCount).arg(errorCount).arg(errors.join("\n"));
     
@@ -1236,7 +1501,7 @@ bool ContractDatabaseManager::deleteContracts(const QStringList &contractIds, QS
     }
 
     // Begin transaction for batch operation
-    if (!m_database.transaction()) {
+    if (!beginTransaction()) {
         errorMessage = QString("Failed to start transaction: %1").arg(m_database.lastError().text());
         return false;
     }
@@ -1293,7 +1558,7 @@ bool ContractDatabaseManager::deleteContracts(const QStringList &contractIds, QS
     }
 
     if (overallSuccess && errorCount == 0) {
-        if (m_database.commit()) {
+        if (commitTransaction()) {
             // Emit signals for successfully deleted contracts
             for (const QString &contractId : deletedIds) {
                 emit contractDeleted(contractId);
@@ -1307,7 +1572,7 @@ bool ContractDatabaseManager::deleteContracts(const QStringList &contractIds, QS
     }
 
     // Rollback on any failure
-    m_database.rollback();
+    rollbackTransaction();
     errorMessage = QString("Batch delete completed with %1 successes and %2 errors:\n%3")
                   .arg(successCount).arg(errorCount).arg(errors.join("\n"));
     
@@ -1392,7 +1657,7 @@ bool ContractDatabaseManager::synchronizeDatabase()
     qDebug() << "Starting database synchronization...";
 
     // Begin transaction
-    if (!m_database.transaction()) {
+    if (!beginTransaction()) {
         m_lastError = QString("Failed to start synchronization transaction: %1").arg(m_database.lastError().text());
         return false;
     }
@@ -1405,7 +1670,7 @@ bool ContractDatabaseManager::synchronizeDatabase()
             SET status = 'Expired', updated_at = CURRENT_TIMESTAMP 
             WHERE status = 'Active' AND end_date < :current_date
         )");
-        updateExpiredQuery.bindValue(":current_date", QDate::currentDate().toString(Qt::ISODate));
+        updateExpiredQuery.bindValue(":current_date", toDayNumber(QDate::currentDate()));
 
         if (!executeQuery(updateExpiredQuery, "update expired contracts")) {
             throw std::runtime_error("Failed to update expired contracts");
@@ -1428,7 +1693,7 @@ bool ContractDatabaseManager::synchronizeDatabase()
         }
 
         // Commit transaction
-        if (!m_database.commit()) {
+        if (!commitTransaction()) {
             throw std::runtime_error(QString("Failed to commit synchronization: %1").arg(m_database.lastError().text()).toStdString());
         }
 
@@ -1439,7 +1704,7 @@ bool ContractDatabaseManager::synchronizeDatabase()
         return true;
 
     } catch (const std::exception &e) {
-        m_database.rollback();
+        rollbackTransaction();
         m_lastError = QString("Database synchronization failed: %1").arg(e.what());
         qDebug() << m_lastError;
         emit databaseError(m_lastError);
@@ -1454,21 +1719,13 @@ bool ContractDatabaseManager::optimizeDatabase()
         return false;
     }
 
-    qDebug() << "Starting database optimization...";
-
-    QSqlQuery query(m_database);
-    
-    // Vacuum database to reclaim space
-    if (!executeQuery(query, "VACUUM")) {
-        qWarning() << "Failed to vacuum database";
-    }
-
-    // Reindex for better performance
-    if (!executeQuery(query, "REINDEX")) {
-        qWarning() << "Failed to reindex database";
+    // Checkpoint, statistics and vacuum run in the background, step by step
+    if (!MaintenanceScheduler::instance()->requestMaintenance(m_database.connectionName(), true)) {
+        m_lastError = "Database maintenance is not available";
+        return false;
     }
 
-    qDebug() << "Database optimization completed";
+    qDebug() << "Database optimization scheduled";
     return true;
 }
 
@@ -1484,27 +1741,34 @@ bool ContractDatabaseManager::backupDatabase(const QString &backupPath)
         return false;
     }
 
-    qDebug() << "Creating database backup at:" << backupPath;
+    return backupDatabaseFile(m_databasePath, backupPath, &m_lastError);
+}
 
-    // Close current connection temporarily
-    QString originalPath = m_databasePath;
-    m_database.close();
+bool ContractDatabaseManager::backupDatabaseFile(const QString &databasePath, const QString &backupPath,
+                                                 QString *errorMessage)
+{
+    qDebug() << "Creating database backup at:" << backupPath;
 
-    // Copy database file
-    if (QFile::copy(originalPath, backupPath)) {
-        qDebug() << "Database backup created successfully";
-        
-        // Reopen database
-        m_database.open();
-        return true;
-    } else {
-        m_lastError = QString("Failed to create backup at: %1").arg(backupPath);
-        qDebug() << m_lastError;
-        
-        // Reopen database
-        m_database.open();
+    // Online copy - the connection stays open and other users keep working
+    QString copyError;
+    if (!SqliteBackup::copy(databasePath, backupPath, &copyError)) {
+        if (copyError.isEmpty()) {
+            copyError = QString("Failed to back up database to: %1").arg(backupPath);
+        }
+        qDebug() << copyError;
+        if (errorMessage) {
+            *errorMessage = copyError;
+        }
         return false;
     }
+
+    qDebug() << "Database backup created successfully";
+    return true;
+}
+
+QString ContractDatabaseManager::databasePath() const
+{
+    return m_databasePath;
 }
 
 bool ContractDatabaseManager::restoreDatabase(const QString &backupPath)
@@ -1516,11 +1780,35 @@ bool ContractDatabaseManager::restoreDatabase(const QString &backupPath)
 
     qDebug() << "Restoring database from:" << backupPath;
 
-    // Close current connection
+    // The backup API writes the pages through SQLite itself, WAL included,
+    // while the connections stay open
+    if (SqliteBackup::isOnlineBackupAvailable() && m_isInitialized && m_database.isOpen()) {
+        if (!SqliteBackup::restore(backupPath, m_databasePath, &m_lastError)) {
+            qDebug() << m_lastError;
+            return false;
+        }
+        clearCache();
+        qDebug() << "Database restored successfully";
+        return true;
+    }
+
+    // Close every connection, reader pool included, so none holds the WAL
     shutdown();
 
+    // A leftover -wal would be replayed onto the restored file, and its
+    // -shm index describes the old one
+    for (const QString &suffix : {QStringLiteral("-wal"), QStringLiteral("-shm")}) {
+        const QString path = m_databasePath + suffix;
+        if (QFile::exists(path) && !QFile::remove(path)) {
+            m_lastError = QString("Failed to remove %1 before restore").arg(path);
+            qDebug() << m_lastError;
+            return false;
+        }
+    }
+
     // Replace current database with backup
-    if (QFile::remove(m_databasePath) && QFile::copy(backupPath, m_databasePath)) {
+    if ((!QFile::exists(m_databasePath) || QFile::remove(m_databasePath))
+        && QFile::copy(backupPath, m_databasePath)) {
         // Reinitialize database
         if (initialize(m_databasePath)) {
             qDebug() << "Database restored successfully";
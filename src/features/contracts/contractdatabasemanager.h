@@ -11,8 +11,12 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include "../../interfaces/icontractservice.h"
+#include "../../database/keysetpagination.h"
+#include <memory>
 
 class Contract;
+class ConnectionPool;
+class ReportSession;
 
 /**
  * @brief The ContractDatabaseManager class handles all database operations for contracts
@@ -38,6 +42,10 @@ public:
     bool deleteContract(const QString &contractId) override;
     Contract* getContract(const QString &contractId) override;
     QList<Contract*> getAllContracts() override;
+    
+    // Keyset-paginated listing; sort keys: created_at (default, newest
+    // first), client_name, start_date, end_date, value
+    Page<Contract*> getContractsPage(const PageRequest &request);
 
     // Search and Filter
     QList<Contract*> searchContracts(const QString &searchTerm) override;
@@ -77,6 +85,9 @@ public:
     double getActiveContractValue();
     QList<Contract*> getContractsInDateRange(const QDate &startDate, const QDate &endDate);
 
+    // Read-only snapshot of the contracts database for multi-query reports
+    std::shared_ptr<ReportSession> beginReportSession();
+
     // Database utilities
     bool isDatabaseConnected() const;
     QString getLastError() const;
@@ -91,6 +102,10 @@ public:
     bool synchronizeDatabase();
     bool optimizeDatabase();
     bool backupDatabase(const QString &backupPath);
+    // Thread-safe: touches no manager state, the error is returned through errorMessage
+    static bool backupDatabaseFile(const QString &databasePath, const QString &backupPath,
+                                   QString *errorMessage);
+    QString databasePath() const;
     bool restoreDatabase(const QString &backupPath);
     void clearCache();
     
@@ -111,14 +126,21 @@ private slots:
 
 private:
     bool createTables();
+    bool migrateSchema(bool *rebuilt);
     Contract* createContractFromQuery(const QSqlQuery &query);
     void bindContractToQuery(QSqlQuery &query, Contract *contract);
     bool executeQuery(QSqlQuery &query, const QString &operation);
+    bool beginTransaction();
+    bool commitTransaction();
+    bool rollbackTransaction();
 
     QSqlDatabase m_database;
+    ConnectionPool *m_readerPool;
     QString m_databasePath;
     QString m_lastError;
     bool m_isInitialized;
+    bool m_fullTextSearch;
+    bool m_inTransaction;
     
     // Caching for performance
     mutable QHash<QString, Contract*> m_contractCache;
@@ -2,6 +2,8 @@
 #include "contractdatabasemanager.h"
 #include "contract.h"
 #include "utils/stylemanager.h"
+#include "database/changenotifier.h"
+#include "database/reportsession.h"
 #include <QApplication>
 #include <QSplitter>
 #include <QGroupBox>
@@ -30,11 +32,24 @@
 
 // Qt Charts classes are included directly
 
+namespace {
+
+// One contract's share of the statistics, keyed by rowid
+const QString CONTRACT_ROWS_SQL = "SELECT rowid, status, value, start_date, end_date FROM contracts";
+
+// Row ids bound per lookup, well under SQLite's host parameter limit
+const int ROW_ID_CHUNK_SIZE = 500;
+
+} // namespace
+
 ContractStatisticsWidget::ContractStatisticsWidget(QWidget *parent)
     : QWidget(parent)
     , m_dbManager(nullptr)
     , m_refreshTimer(new QTimer(this))
     , m_autoRefresh(true)
+    , m_statisticsUpdatePending(false)
+    , m_totalDuration(0.0)
+    , m_statisticsDay(0)
     , m_currentTimeRange("All Time")
     , m_currentChartType("Status Distribution")
 {
@@ -513,13 +528,11 @@ void ContractStatisticsWidget::setDatabaseManager(ContractDatabaseManager *dbMan
 {
     m_dbManager = dbManager;
     if (m_dbManager) {
-        // Connect to database signals for auto-refresh
-        connect(m_dbManager, &ContractDatabaseManager::contractAdded,
-                this, &ContractStatisticsWidget::onContractAdded);
-        connect(m_dbManager, &ContractDatabaseManager::contractUpdated,
-                this, &ContractStatisticsWidget::onContractUpdated);
-        connect(m_dbManager, &ContractDatabaseManager::contractDeleted,
-                this, &ContractStatisticsWidget::onContractDeleted);
+        // Committed row changes of the contracts table, whichever path wrote
+        // them (dialogs, imports, sync), patch the statistics row by row
+        disconnect(ChangeNotifier::instance(), &ChangeNotifier::tableChanged, this, nullptr);
+        connect(ChangeNotifier::instance(), &ChangeNotifier::tableChanged,
+                this, &ContractStatisticsWidget::onTableChanged);
         
         // Initial load
         updateStatistics();
@@ -537,8 +550,13 @@ void ContractStatisticsWidget::updateStatistics()
         return;
     }
     
-    // Calculate statistics
-    m_currentStats = calculateStatistics();
+    loadStatisticsData();
+    publishStatistics();
+}
+
+void ContractStatisticsWidget::publishStatistics()
+{
+    finishStatistics();
     
     // Update cards
     updateStatCard(m_totalContractsCard, formatNumber(m_currentStats.totalContracts), "All contracts");
@@ -560,67 +578,169 @@ void ContractStatisticsWidget::updateStatistics()
     emit statisticsUpdated();
 }
 
-ContractStatisticsWidget::ContractStatistics ContractStatisticsWidget::calculateStatistics()
+void ContractStatisticsWidget::loadStatisticsData()
 {
-    ContractStatistics stats;
-    
-    if (!m_dbManager) {
-        return stats;
+    m_currentStats = ContractStatistics();
+    m_contractRows.clear();
+    m_totalDuration = 0.0;
+    m_statisticsDay = QDate::currentDate().toJulianDay();
+    
+    // Read on one snapshot, so the cards always add up even while
+    // contracts are being saved
+    std::shared_ptr<ReportSession> session = m_dbManager->beginReportSession();
+    if (!session->isActive()) {
+        emit errorOccurred(session->lastError());
+        return;
     }
     
-    // Get all contracts within date range
-    QList<Contract*> contracts = m_dbManager->getContractsInDateRange(m_startDate, m_endDate);
+    // Contracts within the date range, as getContractsInDateRange() selects them
+    const DatabaseRowSet rows = session->fetchRows(
+        CONTRACT_ROWS_SQL + " WHERE start_date BETWEEN ? AND ? AND end_date <= ?",
+        {m_startDate.toJulianDay(), m_endDate.toJulianDay(), m_endDate.toJulianDay()});
+    session->end();
     
-    stats.totalContracts = contracts.size();
+    if (!rows.isValid()) {
+        emit errorOccurred(rows.error);
+        return;
+    }
     
-    double totalValue = 0.0;
-    QDate currentDate = QDate::currentDate();
-    int totalDuration = 0;
+    for (int row = 0; row < rows.rowCount(); ++row) {
+        const ContractRow contract = contractRowAt(rows, row);
+        m_contractRows.insert(rows.value(row, 0).toLongLong(), contract);
+        applyContractRow(contract, 1);
+    }
+}
+
+void ContractStatisticsWidget::onTableChanged(const QString &databaseName, const QString &table,
+                                              const QList<ChangeNotifier::RowChange> &rows, bool allRows)
+{
+    if (databaseName != "contracts" || table != "contracts" || !m_dbManager || !m_autoRefresh) {
+        return;
+    }
+    if (allRows) {
+        // Row ids unknown; a burst of such changes costs one reload
+        scheduleStatisticsUpdate();
+        return;
+    }
     
-    for (Contract *contract : contracts) {
-        totalValue += contract->value();
-        
-        // Calculate duration
-        int duration = contract->startDate().daysTo(contract->endDate());
-        totalDuration += duration;
-        
-        // Count by status
-        QString status = contract->status();
-        if (status == "Active") {
-            stats.activeContracts++;
-            stats.activeValue += contract->value();
-        } else if (status == "Completed") {
-            stats.completedContracts++;
-            stats.completedValue += contract->value();
-        } else if (status == "Expired") {
-            stats.expiredContracts++;
-        } else if (status == "Draft") {
-            stats.draftContracts++;
-        } else if (status == "Pending") {
-            stats.pendingContracts++;
+    QList<qint64> changedIds;
+    for (const ChangeNotifier::RowChange &row : rows) {
+        // The row's old share comes off first, whatever the change was
+        const auto it = m_contractRows.constFind(row.rowId);
+        if (it != m_contractRows.constEnd()) {
+            applyContractRow(it.value(), -1);
+            m_contractRows.erase(it);
         }
-        
-        // Check expiration
-        int daysToExpiration = currentDate.daysTo(contract->endDate());
-        if (daysToExpiration <= 30 && daysToExpiration >= 0) {
-            stats.expiringIn30Days++;
-        } else if (daysToExpiration <= 90 && daysToExpiration >= 0) {
-            stats.expiringIn90Days++;
+        if (row.operation != ChangeNotifier::Delete) {
+            changedIds.append(row.rowId);
+        }
+    }
+    
+    if (!changedIds.isEmpty()) {
+        std::shared_ptr<ReportSession> session = m_dbManager->beginReportSession();
+        if (!session->isActive()) {
+            emit errorOccurred(session->lastError());
+            scheduleStatisticsUpdate();
+            return;
         }
         
-        // Check overdue
-        if (daysToExpiration < 0 && status != "Completed" && status != "Expired") {
-            stats.overdueContracts++;
+        // Only the changed rows are read back; a missing one was deleted by
+        // a later commit, one outside the date range no longer counts
+        for (int start = 0; start < changedIds.size(); start += ROW_ID_CHUNK_SIZE) {
+            const QList<qint64> ids = changedIds.mid(start, ROW_ID_CHUNK_SIZE);
+            QStringList placeholders;
+            QVariantList params;
+            for (qint64 id : ids) {
+                placeholders << "?";
+                params << id;
+            }
+            
+            const DatabaseRowSet changed = session->fetchRows(
+                CONTRACT_ROWS_SQL + QString(" WHERE rowid IN (%1)").arg(placeholders.join(", ")), params);
+            if (!changed.isValid()) {
+                emit errorOccurred(changed.error);
+                session->end();
+                scheduleStatisticsUpdate();
+                return;
+            }
+            
+            for (int row = 0; row < changed.rowCount(); ++row) {
+                const ContractRow contract = contractRowAt(changed, row);
+                if (isInDateRange(contract)) {
+                    m_contractRows.insert(changed.value(row, 0).toLongLong(), contract);
+                    applyContractRow(contract, 1);
+                }
+            }
         }
+        session->end();
     }
     
-    stats.totalValue = totalValue;
-    stats.averageContractValue = stats.totalContracts > 0 ? totalValue / stats.totalContracts : 0.0;
-    stats.averageDuration = stats.totalContracts > 0 ? static_cast<double>(totalDuration) / stats.totalContracts : 0.0;
+    publishStatistics();
+}
+
+ContractStatisticsWidget::ContractRow ContractStatisticsWidget::contractRowAt(const DatabaseRowSet &rows, int row)
+{
+    ContractRow contract;
+    contract.status = rows.value(row, 1).toString();
+    contract.value = rows.value(row, 2).toDouble();
+    contract.startDay = rows.value(row, 3).toLongLong();
+    contract.endDay = rows.value(row, 4).toLongLong();
+    return contract;
+}
+
+bool ContractStatisticsWidget::isInDateRange(const ContractRow &contract) const
+{
+    const qint64 startDay = m_startDate.toJulianDay();
+    const qint64 endDay = m_endDate.toJulianDay();
+    return contract.startDay >= startDay && contract.startDay <= endDay && contract.endDay <= endDay;
+}
+
+void ContractStatisticsWidget::applyContractRow(const ContractRow &contract, int sign)
+{
+    ContractStatistics &stats = m_currentStats;
+    
+    stats.totalContracts += sign;
+    stats.totalValue += sign * contract.value;
+    m_totalDuration += sign * double(contract.endDay - contract.startDay);
+    
+    // Count by status
+    if (contract.status == "Active") {
+        stats.activeContracts += sign;
+        stats.activeValue += sign * contract.value;
+    } else if (contract.status == "Completed") {
+        stats.completedContracts += sign;
+        stats.completedValue += sign * contract.value;
+    } else if (contract.status == "Expired") {
+        stats.expiredContracts += sign;
+    } else if (contract.status == "Draft") {
+        stats.draftContracts += sign;
+    } else if (contract.status == "Pending") {
+        stats.pendingContracts += sign;
+    }
+    
+    // Expiration and overdue counts, relative to the day of the last full load
+    const qint64 today = m_statisticsDay;
+    if (contract.endDay >= today && contract.endDay <= today + 30) {
+        stats.expiringIn30Days += sign;
+    } else if (contract.endDay >= today + 31 && contract.endDay <= today + 90) {
+        stats.expiringIn90Days += sign;
+    }
+    if (contract.endDay < today && contract.status != "Completed" && contract.status != "Expired") {
+        stats.overdueContracts += sign;
+    }
+}
+
+void ContractStatisticsWidget::finishStatistics()
+{
+    ContractStatistics &stats = m_currentStats;
+    
+    stats.averageContractValue = stats.totalContracts > 0 ? stats.totalValue / stats.totalContracts : 0.0;
+    stats.averageDuration = stats.totalContracts > 0 ? m_totalDuration / stats.totalContracts : 0.0;
     stats.completionRate = stats.totalContracts > 0 ? 
         (static_cast<double>(stats.completedContracts) / stats.totalContracts) * 100.0 : 0.0;
     
     // Calculate monthly revenue (simple estimation)
+    stats.monthlyRevenue = 0.0;
     if (m_startDate.daysTo(m_endDate) > 0) {
         double months = m_startDate.daysTo(m_endDate) / 30.0;
         stats.monthlyRevenue = stats.activeValue / std::max(months, 1.0);
@@ -628,11 +748,6 @@ ContractStatisticsWidget::ContractStatistics ContractStatisticsWidget::calculate
     
     // Calculate renewal rate (placeholder - needs historical data)
     stats.renewalRate = 75.0; // Default placeholder
-    
-    // Clean up
-    qDeleteAll(contracts);
-    
-    return stats;
 }
 
 void ContractStatisticsWidget::updateChartData()
@@ -738,28 +853,18 @@ void ContractStatisticsWidget::onChartTypeChanged()
     m_expirationChartView->setVisible(showExpiration);
 }
 
-void ContractStatisticsWidget::onContractAdded(const QString &contractId)
-{
-    Q_UNUSED(contractId)
-    if (m_autoRefresh) {
-        updateStatistics();
-    }
-}
-
-void ContractStatisticsWidget::onContractUpdated(const QString &contractId)
+void ContractStatisticsWidget::scheduleStatisticsUpdate()
 {
-    Q_UNUSED(contractId)
-    if (m_autoRefresh) {
-        updateStatistics();
+    if (!m_autoRefresh || m_statisticsUpdatePending) {
+        return;
     }
-}
-
-void ContractStatisticsWidget::onContractDeleted(const QString &contractId)
-{
-    Q_UNUSED(contractId)
-    if (m_autoRefresh) {
+    
+    // A burst of changes (bulk import, batch delete) costs one recompute
+    m_statisticsUpdatePending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_statisticsUpdatePending = false;
         updateStatistics();
-    }
+    });
 }
 
 void ContractStatisticsWidget::onRefreshRequested()
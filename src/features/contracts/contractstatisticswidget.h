@@ -13,6 +13,9 @@
 #include <QPushButton>
 #include <QComboBox>
 #include <QDateEdit>
+#include <QHash>
+#include "database/changenotifier.h"
+#include "interfaces/idatabasemanager.h"
 
 // Forward declarations for Qt Charts
 #include <QtCharts/QChart>
@@ -81,9 +84,6 @@ public:
 
 public slots:
     void updateStatistics();
-    void onContractAdded(const QString &contractId);
-    void onContractUpdated(const QString &contractId);
-    void onContractDeleted(const QString &contractId);
     void onDateRangeChanged();
     void onRefreshRequested();
     void exportReport();
@@ -102,18 +102,33 @@ private slots:
     void onChartTypeChanged();
     void onExportClicked();
     void updateCharts();
+    void onTableChanged(const QString &databaseName, const QString &table,
+                        const QList<ChangeNotifier::RowChange> &rows, bool allRows);
 
 private:
     void setupUi();
+    void scheduleStatisticsUpdate();
     void setupControlPanel();
     void setupStatisticsCards();
     void setupCharts();
     void setupConnections();
     void applyArchiFlowStyling();
 
+    // One contract within the date range, as counted in m_currentStats
+    struct ContractRow {
+        QString status;
+        double value = 0.0;
+        qint64 startDay = 0;   // Julian days
+        qint64 endDay = 0;
+    };
+
     // Data operations
-    ContractStatistics calculateStatistics();
     void loadStatisticsData();
+    void publishStatistics();
+    static ContractRow contractRowAt(const DatabaseRowSet &rows, int row);
+    bool isInDateRange(const ContractRow &contract) const;
+    void applyContractRow(const ContractRow &contract, int sign);  // +1 adds, -1 removes its share
+    void finishStatistics();  // derived averages and rates
     
     // UI helpers
     QWidget* createStatCard(const QString &title, const QString &value, 
@@ -196,6 +211,10 @@ private:
     QDate m_endDate;
     QTimer *m_refreshTimer;
     bool m_autoRefresh;
+    bool m_statisticsUpdatePending;
+    QHash<qint64, ContractRow> m_contractRows;  // by rowid
+    double m_totalDuration;
+    qint64 m_statisticsDay;  // "today" of the expiration counts
     QString m_currentTimeRange;
     QString m_currentChartType;
     
@@ -31,6 +31,7 @@
 #include <QTextEdit>
 #include <QDateTime>
 #include <QSettings>
+#include <QtConcurrent>
 
 ContractWidget::ContractWidget(QWidget *parent)
     : QWidget(parent)
@@ -2036,13 +2037,9 @@ void ContractWidget::optimizeDatabase()
         return;
     }
     
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-    
     if (m_dbManager->optimizeDatabase()) {
-        QApplication::restoreOverrideCursor();
-        showMessage("Database optimized successfully");
+        showMessage("Database optimization started in the background");
     } else {
-        QApplication::restoreOverrideCursor();
         showMessage("Database optimization failed", true);
     }
 }
@@ -2060,15 +2057,23 @@ void ContractWidget::backupDatabase()
                                                     "Database Files (*.db)");
     if (backupPath.isEmpty()) return;
     
-    QApplication::setOverrideCursor(Qt::WaitCursor);
+    showMessage("Backing up database...");
     
-    if (m_dbManager->backupDatabase(backupPath)) {
-        QApplication::restoreOverrideCursor();
-        showMessage(QString("Database backed up successfully to: %1").arg(backupPath));
-    } else {
-        QApplication::restoreOverrideCursor();
-        showMessage(QString("Database backup failed: %1").arg(m_dbManager->getLastError()), true);
-    }
+    // The online backup keeps the module usable, so run it off the GUI thread.
+    // The worker leaves the manager alone and hands its error back with the
+    // result, empty on success.
+    const QString databasePath = m_dbManager->databasePath();
+    QtConcurrent::run([databasePath, backupPath]() {
+        QString errorMessage;
+        ContractDatabaseManager::backupDatabaseFile(databasePath, backupPath, &errorMessage);
+        return errorMessage;
+    }).then(this, [this, backupPath](const QString &errorMessage) {
+        if (errorMessage.isEmpty()) {
+            showMessage(QString("Database backed up successfully to: %1").arg(backupPath));
+        } else {
+            showMessage(QString("Database backup failed: %1").arg(errorMessage), true);
+        }
+    });
 }
 
 void ContractWidget::restoreDatabase()
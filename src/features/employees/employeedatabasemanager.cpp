@@ -1,4 +1,10 @@
 #include "employeedatabasemanager.h"
+#include "../../database/sqlitebackup.h"
+#include "../../database/queryprofiler.h"
+#include "../../database/changenotifier.h"
+#include "../../database/fulltextsearch.h"
+#include "../../database/auditlogger.h"
+#include "../../database/maintenancescheduler.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
@@ -79,9 +85,30 @@ const QString EmployeeDatabaseManager::SEARCH_EMPLOYEES_SQL =
     "department LIKE ? OR notes LIKE ? "
     "ORDER BY last_name, first_name";
 
+namespace {
+
+const FullTextSearch::IndexDefinition EMPLOYEES_SEARCH_INDEX = {
+    "employee", "employees", "cin", false,
+    {"last_name", "first_name", "cin", "email", "phone_number", "position", "department", "notes"},
+    "t.first_name || ' ' || t.last_name"
+};
+
+const KeysetPagination EMPLOYEES_PAGINATION(
+    "employees", "cin",
+    {
+        {"name", {"last_name", "first_name"}},
+        {"hire_date", {"IFNULL(hire_date, '')"}},
+        {"department", {"IFNULL(department, '')", "last_name", "first_name"}},
+        {"created_at", {"created_at"}}
+    },
+    "name", Qt::AscendingOrder);
+
+} // namespace
+
 EmployeeDatabaseManager::EmployeeDatabaseManager(QObject *parent)
     : QObject(parent)
     , m_isConnected(false)
+    , m_fullTextSearch(false)
 {
     m_connectionName = generateConnectionName();
 }
@@ -132,11 +159,16 @@ bool EmployeeDatabaseManager::openDatabase(const QString &dbPath)
     // Enable foreign key constraints
     QSqlQuery query(m_database);
     query.exec("PRAGMA foreign_keys = ON");
+    ChangeNotifier::instance()->attach(m_database, "employees");
 
     if (!createTables()) {
         closeDatabase();
         return false;
     }
+    AuditLogger::instance()->attach(m_database, "employees", {"employees"});
+    MaintenanceScheduler::instance()->registerDatabase({
+        m_connectionName, databasePath, "employees", {EMPLOYEES_SEARCH_INDEX}, EMPLOYEES_PAGINATION.planQueries()
+    });
 
     m_isConnected = true;
     qDebug() << "EmployeeDatabaseManager: Database opened successfully:" << databasePath;
@@ -146,6 +178,10 @@ bool EmployeeDatabaseManager::openDatabase(const QString &dbPath)
 void EmployeeDatabaseManager::closeDatabase()
 {
     if (m_isConnected) {
+        FullTextSearch::instance()->unregisterConnection(m_connectionName);
+        ChangeNotifier::instance()->detach(m_connectionName);
+        AuditLogger::instance()->detach(m_connectionName);
+        MaintenanceScheduler::instance()->unregisterDatabase(m_connectionName);
         m_database.close();
         QSqlDatabase::removeDatabase(m_connectionName);
         m_isConnected = false;
@@ -288,6 +324,36 @@ QList<Employee*> EmployeeDatabaseManager::getAllEmployees() const
     return employees;
 }
 
+Page<Employee*> EmployeeDatabaseManager::getEmployeesPage(const PageRequest &request) const
+{
+    Page<Employee*> page;
+    
+    if (!isConnected()) {
+        page.error = tr("Database is not connected");
+        return page;
+    }
+
+    QString sql;
+    QVariantList params;
+    if (!EMPLOYEES_PAGINATION.buildQuery(request, &sql, &params, &page.error)) {
+        return page;
+    }
+
+    QSqlQuery query = prepareQuery(sql);
+    for (const QVariant &param : params) {
+        query.addBindValue(param);
+    }
+
+    if (!executeQuery(query)) {
+        page.error = m_lastError;
+        return page;
+    }
+
+    return EMPLOYEES_PAGINATION.readPage<Employee*>(query, request, [this](const QSqlQuery &row) {
+        return new Employee(employeeFromQuery(row));
+    });
+}
+
 QList<Employee*> EmployeeDatabaseManager::searchEmployees(const QString &searchTerm) const
 {
     QList<Employee*> employees;
@@ -296,11 +362,18 @@ QList<Employee*> EmployeeDatabaseManager::searchEmployees(const QString &searchT
         return employees;
     }
 
-    QString term = "%" + searchTerm.trimmed() + "%";
-    QSqlQuery query = prepareQuery(SEARCH_EMPLOYEES_SQL);
-      // Bind search term to all LIKE placeholders
-    for (int i = 0; i < 8; ++i) {
-        query.addBindValue(term);
+    QSqlQuery query;
+    const QString matchExpression = FullTextSearch::matchExpression(searchTerm);
+    if (m_fullTextSearch && !matchExpression.isEmpty()) {
+        query = prepareQuery(FullTextSearch::searchSql(EMPLOYEES_SEARCH_INDEX));
+        query.addBindValue(matchExpression);
+    } else {
+        QString term = "%" + searchTerm.trimmed() + "%";
+        query = prepareQuery(SEARCH_EMPLOYEES_SQL);
+        // Bind search term to all LIKE placeholders
+        for (int i = 0; i < 8; ++i) {
+            query.addBindValue(term);
+        }
     }
 
     if (executeQuery(query)) {
@@ -534,10 +607,64 @@ int EmployeeDatabaseManager::getPresentEmployeeCount() const
 }
 
 // Helper methods
+bool EmployeeDatabaseManager::backupDatabase(const QString &backupPath)
+{
+    if (!isConnected()) {
+        m_lastError = tr("Database not connected");
+        return false;
+    }
+
+    QString errorMessage;
+    const bool success = SqliteBackup::copy(m_database.databaseName(), backupPath, &errorMessage);
+    if (!success) {
+        m_lastError = tr("Backup failed: %1").arg(errorMessage);
+        emit databaseError(m_lastError);
+    }
+
+    emit operationCompleted("backup", success);
+    return success;
+}
+
+bool EmployeeDatabaseManager::restoreDatabase(const QString &backupPath)
+{
+    if (!isConnected()) {
+        m_lastError = tr("Database not connected");
+        return false;
+    }
+
+    QString errorMessage;
+    const bool success = SqliteBackup::restore(backupPath, m_database.databaseName(), &errorMessage);
+    if (!success) {
+        m_lastError = tr("Restore failed: %1").arg(errorMessage);
+        emit databaseError(m_lastError);
+    }
+
+    emit operationCompleted("restore", success);
+    return success;
+}
+
+bool EmployeeDatabaseManager::optimizeDatabase()
+{
+    if (!isConnected()) {
+        m_lastError = tr("Database not connected");
+        return false;
+    }
+
+    // Runs in the background in bounded steps; see MaintenanceScheduler
+    if (!MaintenanceScheduler::instance()->requestMaintenance(m_connectionName, true)) {
+        m_lastError = tr("Database maintenance is not available");
+        return false;
+    }
+    return true;
+}
+
 bool EmployeeDatabaseManager::createTables()
 {
     QSqlQuery query(m_database);
 
+    // Before the first table; existing files keep their setting
+    query.exec("PRAGMA auto_vacuum = INCREMENTAL");
+
     // Create employees table
     if (!query.exec(CREATE_EMPLOYEE_TABLE_SQL)) {
         logError("createTables (employees)", query.lastError());
@@ -550,6 +677,19 @@ bool EmployeeDatabaseManager::createTables()
         return false;
     }
 
+    // Composite indexes behind getEmployeesPage()
+    for (const QString &sql : EMPLOYEES_PAGINATION.indexStatements()) {
+        if (!query.exec(sql)) {
+            qWarning() << "EmployeeDatabaseManager: failed to create index:" << query.lastError().text();
+        }
+    }
+
+    // Optional; searchEmployees() falls back to LIKE without it
+    m_fullTextSearch = FullTextSearch::createIndex(m_database, EMPLOYEES_SEARCH_INDEX);
+    if (m_fullTextSearch) {
+        FullTextSearch::instance()->registerIndex(m_connectionName, EMPLOYEES_SEARCH_INDEX);
+    }
+
     return true;
 }
 
@@ -574,10 +714,19 @@ QSqlQuery EmployeeDatabaseManager::prepareQuery(const QString &sql) const
 
 bool EmployeeDatabaseManager::executeQuery(QSqlQuery &query) const
 {
-    if (!query.exec()) {
+    if (!QueryProfiler::instance()->execute(query, m_database, "employees")) {
         const_cast<EmployeeDatabaseManager*>(this)->logError("executeQuery", query.lastError());
         return false;
     }
+
+    if (!query.isSelect()) {
+        // Without native hooks the notifier only learns of writes from here;
+        // every write here runs in its own implicit transaction
+        ChangeNotifier *notifier = ChangeNotifier::instance();
+        notifier->recordStatement(m_database.connectionName(), query.lastQuery(),
+                                  query.lastInsertId(), query.numRowsAffected());
+        notifier->commit(m_database.connectionName());
+    }
     return true;
 }
 
@@ -9,6 +9,7 @@
 #include <QStringList>
 #include <QDateTime>
 #include "employee.h"
+#include "../../database/keysetpagination.h"
 
 /**
  * @brief The EmployeeDatabaseManager class handles all database operations for employees
@@ -33,6 +34,8 @@ public:
     bool deleteEmployee(const QString &cin);
     Employee getEmployee(const QString &cin) const;
     QList<Employee*> getAllEmployees() const;
+    // Sort keys: name (default, last then first name), hire_date, department, created_at
+    Page<Employee*> getEmployeesPage(const PageRequest &request) const;
 
     // Search and filtering
     QList<Employee*> searchEmployees(const QString &searchTerm) const;
@@ -104,6 +107,7 @@ private:
     QString m_connectionName;
     mutable QString m_lastError;
     bool m_isConnected;
+    bool m_fullTextSearch;
 
     // Table and column names
     static const QString EMPLOYEE_TABLE;
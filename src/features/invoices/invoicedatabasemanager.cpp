@@ -2,6 +2,11 @@
 #include "invoice.h"
 #include "invoiceitem.h"
 #include "client.h"
+#include "../../database/sqlitebackup.h"
+#include "../../database/queryprofiler.h"
+#include "../../database/changenotifier.h"
+#include "../../database/auditlogger.h"
+#include "../../database/maintenancescheduler.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QSqlRecord>
@@ -17,9 +22,24 @@ const QString InvoiceDatabaseManager::CLIENTS_TABLE = "invoice_clients";
 const QString InvoiceDatabaseManager::INVOICES_TABLE = "invoices";
 const QString InvoiceDatabaseManager::INVOICE_ITEMS_TABLE = "invoice_items";
 
+namespace {
+
+const KeysetPagination INVOICES_PAGINATION(
+    "invoices", "id",
+    {
+        {"invoice_date", {"invoice_date"}},
+        {"due_date", {"due_date"}},
+        {"client_name", {"client_name"}},
+        {"total_amount", {"total_amount"}}
+    },
+    "invoice_date", Qt::DescendingOrder);
+
+} // namespace
+
 InvoiceDatabaseManager::InvoiceDatabaseManager(QObject *parent)
     : QObject(parent)
     , m_connectionName(generateConnectionName())
+    , m_inTransaction(false)
 {
 }
 
@@ -48,12 +68,17 @@ bool InvoiceDatabaseManager::initialize(const QString &databasePath)
         setLastError("Failed to open database: " + m_database.lastError().text());
         return false;
     }
+    ChangeNotifier::instance()->attach(m_database, "invoices");
     
     // Create tables if they don't exist
     if (!createTables()) {
         setLastError("Failed to create database tables");
         return false;
     }
+    AuditLogger::instance()->attach(m_database, "invoices", {INVOICES_TABLE});
+    MaintenanceScheduler::instance()->registerDatabase({
+        m_connectionName, dbPath, "invoices", {}, INVOICES_PAGINATION.planQueries()
+    });
     
     qDebug() << "InvoiceDatabaseManager: Database initialized at" << dbPath;
     return true;
@@ -68,6 +93,9 @@ bool InvoiceDatabaseManager::isConnected() const
 void InvoiceDatabaseManager::close()
 {
     QMutexLocker locker(&m_mutex);
+    ChangeNotifier::instance()->detach(m_connectionName);
+    AuditLogger::instance()->detach(m_connectionName);
+    MaintenanceScheduler::instance()->unregisterDatabase(m_connectionName);
     if (m_database.isOpen()) {
         m_database.close();
     }
@@ -82,6 +110,10 @@ QString InvoiceDatabaseManager::lastError() const
 
 bool InvoiceDatabaseManager::createTables()
 {
+    // Before the first table; existing files keep their setting
+    QSqlQuery pragma(m_database);
+    pragma.exec("PRAGMA auto_vacuum = INCREMENTAL");
+
     return createClientsTable() && createInvoicesTable() && createInvoiceItemsTable() && createIndexes();
 }
 
@@ -103,7 +135,7 @@ bool InvoiceDatabaseManager::createClientsTable()
         )
     )").arg(CLIENTS_TABLE);
     
-    if (!query.exec(sql)) {
+    if (!executeQuery(query, sql)) {
         setLastError("Failed to create clients table: " + query.lastError().text());
         return false;
     }
@@ -138,7 +170,7 @@ bool InvoiceDatabaseManager::createInvoicesTable()
         )
     )").arg(INVOICES_TABLE).arg(CLIENTS_TABLE);
     
-    if (!query.exec(sql)) {
+    if (!executeQuery(query, sql)) {
         setLastError("Failed to create invoices table: " + query.lastError().text());
         return false;
     }
@@ -163,7 +195,7 @@ bool InvoiceDatabaseManager::createInvoiceItemsTable()
         )
     )").arg(INVOICE_ITEMS_TABLE).arg(INVOICES_TABLE);
     
-    if (!query.exec(sql)) {
+    if (!executeQuery(query, sql)) {
         setLastError("Failed to create invoice items table: " + query.lastError().text());
         return false;
     }
@@ -178,12 +210,14 @@ bool InvoiceDatabaseManager::createIndexes()
     QStringList indexQueries = {
         QString("CREATE INDEX IF NOT EXISTS idx_invoices_client_id ON %1(client_id)").arg(INVOICES_TABLE),
         QString("CREATE INDEX IF NOT EXISTS idx_invoices_status ON %1(status)").arg(INVOICES_TABLE),
-        QString("CREATE INDEX IF NOT EXISTS idx_invoices_date ON %1(invoice_date)").arg(INVOICES_TABLE),
+        // Replaced by idx_invoices_page_invoice_date
+        "DROP INDEX IF EXISTS idx_invoices_date",
         QString("CREATE INDEX IF NOT EXISTS idx_invoice_items_invoice_id ON %1(invoice_id)").arg(INVOICE_ITEMS_TABLE)
     };
+    indexQueries << INVOICES_PAGINATION.indexStatements();
     
     for (const QString &sql : indexQueries) {
-        if (!query.exec(sql)) {
+        if (!executeQuery(query, sql)) {
             setLastError("Failed to create index: " + query.lastError().text());
             return false;
         }
@@ -214,7 +248,7 @@ bool InvoiceDatabaseManager::addClient(const Client *client)
     query.addBindValue(client->taxId());
     query.addBindValue(client->notes());
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to add client: " + query.lastError().text());
         return false;
     }
@@ -246,7 +280,7 @@ bool InvoiceDatabaseManager::updateClient(const Client *client)
     query.addBindValue(client->notes());
     query.addBindValue(client->id());
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to update client: " + query.lastError().text());
         return false;
     }
@@ -266,7 +300,7 @@ bool InvoiceDatabaseManager::deleteClient(const QString &clientId)
     query.prepare(QString("DELETE FROM %1 WHERE id = ?").arg(CLIENTS_TABLE));
     query.addBindValue(clientId);
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to delete client: " + query.lastError().text());
         return false;
     }
@@ -286,7 +320,7 @@ Client* InvoiceDatabaseManager::getClient(const QString &clientId)
     query.prepare(QString("SELECT * FROM %1 WHERE id = ?").arg(CLIENTS_TABLE));
     query.addBindValue(clientId);
     
-    if (!query.exec() || !query.next()) {
+    if (!executeQuery(query) || !query.next()) {
         return nullptr;
     }
     
@@ -301,7 +335,7 @@ QList<Client*> InvoiceDatabaseManager::getAllClients()
     QSqlQuery query(m_database);
     query.prepare(QString("SELECT * FROM %1 ORDER BY name").arg(CLIENTS_TABLE));
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to get clients: " + query.lastError().text());
         return clients;
     }
@@ -332,7 +366,7 @@ QList<Client*> InvoiceDatabaseManager::searchClients(const QString &searchTerm)
     query.addBindValue(term);
     query.addBindValue(term);
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to search clients: " + query.lastError().text());
         return clients;
     }
@@ -356,7 +390,7 @@ bool InvoiceDatabaseManager::clientExists(const QString &clientId)
     query.prepare(QString("SELECT COUNT(*) FROM %1 WHERE id = ?").arg(CLIENTS_TABLE));
     query.addBindValue(clientId);
     
-    if (query.exec() && query.next()) {
+    if (executeQuery(query) && query.next()) {
         return query.value(0).toInt() > 0;
     }
     
@@ -397,7 +431,7 @@ bool InvoiceDatabaseManager::addInvoice(const Invoice *invoice)
     query.addBindValue(invoice->notes());
     query.addBindValue(invoice->currency());
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         rollbackTransaction();
         setLastError("Failed to add invoice: " + query.lastError().text());
         return false;
@@ -426,7 +460,7 @@ QList<Invoice*> InvoiceDatabaseManager::getAllInvoices()
     QSqlQuery query(m_database);
     query.prepare(QString("SELECT * FROM %1 ORDER BY invoice_date DESC").arg(INVOICES_TABLE));
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to get invoices: " + query.lastError().text());
         return invoices;
     }
@@ -445,6 +479,45 @@ QList<Invoice*> InvoiceDatabaseManager::getAllInvoices()
     return invoices;
 }
 
+Page<Invoice*> InvoiceDatabaseManager::getInvoicesPage(const PageRequest &request)
+{
+    QMutexLocker locker(&m_mutex);
+    Page<Invoice*> page;
+    
+    QString sql;
+    QVariantList params;
+    if (!INVOICES_PAGINATION.buildQuery(request, &sql, &params, &page.error)) {
+        setLastError(page.error);
+        return page;
+    }
+    
+    QSqlQuery query(m_database);
+    query.prepare(sql);
+    for (const QVariant &param : params) {
+        query.addBindValue(param);
+    }
+    
+    if (!executeQuery(query)) {
+        page.error = "Failed to get invoices: " + query.lastError().text();
+        setLastError(page.error);
+        return page;
+    }
+    
+    page = INVOICES_PAGINATION.readPage<Invoice*>(query, request, [this](const QSqlQuery &row) {
+        return invoiceFromQuery(row);
+    });
+    
+    // Items only for the invoices on this page
+    for (Invoice *invoice : page.items) {
+        const QList<InvoiceItem*> items = getInvoiceItems(invoice->id());
+        for (InvoiceItem *item : items) {
+            invoice->addItem(item);
+        }
+    }
+    
+    return page;
+}
+
 // Additional methods with basic implementations
 bool InvoiceDatabaseManager::updateInvoice(const Invoice *invoice)
 {
@@ -484,7 +557,7 @@ bool InvoiceDatabaseManager::updateInvoice(const Invoice *invoice)
     query.addBindValue(invoice->currency());
     query.addBindValue(invoice->id());
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to update invoice: " + query.lastError().text());
         rollbackTransaction();
         return false;
@@ -534,7 +607,7 @@ bool InvoiceDatabaseManager::deleteInvoice(const QString &invoiceId)
     query.prepare(QString("DELETE FROM %1 WHERE id = ?").arg(INVOICES_TABLE));
     query.addBindValue(invoiceId);
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to delete invoice: " + query.lastError().text());
         rollbackTransaction();
         return false;
@@ -558,7 +631,7 @@ Invoice* InvoiceDatabaseManager::getInvoice(const QString &invoiceId)
     query.prepare(QString("SELECT * FROM %1 WHERE id = ?").arg(INVOICES_TABLE));
     query.addBindValue(invoiceId);
     
-    if (!query.exec() || !query.next()) {
+    if (!executeQuery(query) || !query.next()) {
         return nullptr;
     }
     
@@ -582,7 +655,7 @@ QList<Invoice*> InvoiceDatabaseManager::getInvoicesByClient(const QString &clien
     query.prepare(QString("SELECT * FROM %1 WHERE client_id = ? ORDER BY invoice_date DESC").arg(INVOICES_TABLE));
     query.addBindValue(clientId);
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to get invoices by client: " + query.lastError().text());
         return invoices;
     }
@@ -610,7 +683,7 @@ QList<Invoice*> InvoiceDatabaseManager::getInvoicesByStatus(const QString &statu
     query.prepare(QString("SELECT * FROM %1 WHERE status = ? ORDER BY invoice_date DESC").arg(INVOICES_TABLE));
     query.addBindValue(status);
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to get invoices by status: " + query.lastError().text());
         return invoices;
     }
@@ -639,7 +712,7 @@ QList<Invoice*> InvoiceDatabaseManager::getInvoicesByDateRange(const QDate &star
     query.addBindValue(startDate);
     query.addBindValue(endDate);
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to get invoices by date range: " + query.lastError().text());
         return invoices;
     }
@@ -675,7 +748,7 @@ QList<Invoice*> InvoiceDatabaseManager::searchInvoices(const QString &searchTerm
     query.addBindValue(term);
     query.addBindValue(term);
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to search invoices: " + query.lastError().text());
         return invoices;
     }
@@ -704,7 +777,7 @@ bool InvoiceDatabaseManager::invoiceExists(const QString &invoiceId)
     query.prepare(QString("SELECT COUNT(*) FROM %1 WHERE id = ?").arg(INVOICES_TABLE));
     query.addBindValue(invoiceId);
     
-    if (!query.exec() || !query.next()) {
+    if (!executeQuery(query) || !query.next()) {
         return false;
     }
     
@@ -721,7 +794,7 @@ bool InvoiceDatabaseManager::invoiceNumberExists(const QString &invoiceNumber)
     query.prepare(QString("SELECT COUNT(*) FROM %1 WHERE invoice_number = ?").arg(INVOICES_TABLE));
     query.addBindValue(invoiceNumber);
     
-    if (!query.exec() || !query.next()) {
+    if (!executeQuery(query) || !query.next()) {
         return false;
     }
     
@@ -746,7 +819,7 @@ bool InvoiceDatabaseManager::addInvoiceItem(const InvoiceItem *item)
     query.addBindValue(item->unitPrice());
     query.addBindValue(item->totalPrice());
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to add invoice item: " + query.lastError().text());
         return false;
     }
@@ -762,7 +835,7 @@ QList<InvoiceItem*> InvoiceDatabaseManager::getInvoiceItems(const QString &invoi
     query.prepare(QString("SELECT * FROM %1 WHERE invoice_id = ? ORDER BY id").arg(INVOICE_ITEMS_TABLE));
     query.addBindValue(invoiceId);
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to get invoice items: " + query.lastError().text());
         return items;
     }
@@ -784,7 +857,7 @@ double InvoiceDatabaseManager::getTotalRevenue()
     
     query.prepare(QString("SELECT SUM(total_amount) FROM %1 WHERE status = 'Paid'").arg(INVOICES_TABLE));
     
-    if (query.exec() && query.next()) {
+    if (executeQuery(query) && query.next()) {
         return query.value(0).toDouble();
     }
     
@@ -798,7 +871,7 @@ int InvoiceDatabaseManager::getTotalInvoiceCount()
     
     query.prepare(QString("SELECT COUNT(*) FROM %1").arg(INVOICES_TABLE));
     
-    if (query.exec() && query.next()) {
+    if (executeQuery(query) && query.next()) {
         return query.value(0).toInt();
     }
     
@@ -813,7 +886,7 @@ int InvoiceDatabaseManager::getInvoiceCountByStatus(const QString &status)
     query.prepare(QString("SELECT COUNT(*) FROM %1 WHERE status = ?").arg(INVOICES_TABLE));
     query.addBindValue(status);
     
-    if (query.exec() && query.next()) {
+    if (executeQuery(query) && query.next()) {
         return query.value(0).toInt();
     }
     
@@ -832,7 +905,7 @@ QList<Invoice*> InvoiceDatabaseManager::getOverdueInvoices()
         ORDER BY due_date
     )").arg(INVOICES_TABLE));
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to get overdue invoices: " + query.lastError().text());
         return invoices;
     }
@@ -859,7 +932,7 @@ QList<Invoice*> InvoiceDatabaseManager::getInvoicesDueSoon(int daysThreshold)
         ORDER BY due_date
     )").arg(INVOICES_TABLE).arg(daysThreshold));
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to get invoices due soon: " + query.lastError().text());
         return invoices;
     }
@@ -876,17 +949,26 @@ QList<Invoice*> InvoiceDatabaseManager::getInvoicesDueSoon(int daysThreshold)
 // Transaction management
 bool InvoiceDatabaseManager::beginTransaction()
 {
-    return m_database.transaction();
+    m_inTransaction = m_database.transaction();
+    return m_inTransaction;
 }
 
 bool InvoiceDatabaseManager::commitTransaction()
 {
-    return m_database.commit();
+    if (!m_database.commit()) {
+        return false;
+    }
+    m_inTransaction = false;
+    ChangeNotifier::instance()->commit(m_connectionName);
+    return true;
 }
 
 bool InvoiceDatabaseManager::rollbackTransaction()
 {
-    return m_database.rollback();
+    const bool rolledBack = m_database.rollback();
+    m_inTransaction = false;
+    ChangeNotifier::instance()->rollback(m_connectionName);
+    return rolledBack;
 }
 
 // Helper methods
@@ -945,6 +1027,24 @@ InvoiceItem* InvoiceDatabaseManager::invoiceItemFromQuery(const QSqlQuery &query
     return item;
 }
 
+bool InvoiceDatabaseManager::executeQuery(QSqlQuery &query, const QString &sql) const
+{
+    if (!QueryProfiler::instance()->execute(query, m_database, "invoices", sql)) {
+        return false;
+    }
+
+    if (!query.isSelect()) {
+        // Without native hooks the notifier only learns of writes from here
+        ChangeNotifier *notifier = ChangeNotifier::instance();
+        notifier->recordStatement(m_connectionName, query.lastQuery(),
+                                  query.lastInsertId(), query.numRowsAffected());
+        if (!m_inTransaction) {
+            notifier->commit(m_connectionName);
+        }
+    }
+    return true;
+}
+
 void InvoiceDatabaseManager::setLastError(const QString &error)
 {
     m_lastError = error;
@@ -980,7 +1080,7 @@ bool InvoiceDatabaseManager::updateInvoiceItem(const InvoiceItem *item)
     query.addBindValue(item->totalPrice());
     query.addBindValue(item->id());
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to update invoice item: " + query.lastError().text());
         return false;
     }
@@ -998,7 +1098,7 @@ bool InvoiceDatabaseManager::deleteInvoiceItem(const QString &itemId)
     query.prepare(QString("DELETE FROM %1 WHERE id = ?").arg(INVOICE_ITEMS_TABLE));
     query.addBindValue(itemId);
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to delete invoice item: " + query.lastError().text());
         return false;
     }
@@ -1016,16 +1116,45 @@ bool InvoiceDatabaseManager::deleteInvoiceItems(const QString &invoiceId)
     query.prepare(QString("DELETE FROM %1 WHERE invoice_id = ?").arg(INVOICE_ITEMS_TABLE));
     query.addBindValue(invoiceId);
     
-    if (!query.exec()) {
+    if (!executeQuery(query)) {
         setLastError("Failed to delete invoice items: " + query.lastError().text());
         return false;
     }
     
     return true;
 }
-bool InvoiceDatabaseManager::vacuum() { return false; }
-bool InvoiceDatabaseManager::backup(const QString &backupPath) { Q_UNUSED(backupPath); return false; }
-bool InvoiceDatabaseManager::restore(const QString &backupPath) { Q_UNUSED(backupPath); return false; }
+
+bool InvoiceDatabaseManager::vacuum()
+{
+    // Runs in the background in bounded steps; see MaintenanceScheduler
+    if (!MaintenanceScheduler::instance()->requestMaintenance(m_connectionName, true)) {
+        setLastError("Database maintenance is not available");
+        return false;
+    }
+    return true;
+}
+
+bool InvoiceDatabaseManager::backup(const QString &backupPath)
+{
+    QString errorMessage;
+    if (!SqliteBackup::copy(m_database.databaseName(), backupPath, &errorMessage)) {
+        setLastError("Backup failed: " + errorMessage);
+        return false;
+    }
+    return true;
+}
+
+bool InvoiceDatabaseManager::restore(const QString &backupPath)
+{
+    QString errorMessage;
+    if (!SqliteBackup::restore(backupPath, m_database.databaseName(), &errorMessage)) {
+        setLastError("Restore failed: " + errorMessage);
+        return false;
+    }
+    
+    emit dataChanged();
+    return true;
+}
 
 void InvoiceDatabaseManager::refresh()
 {
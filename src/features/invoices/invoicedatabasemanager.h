@@ -8,6 +8,7 @@
 #include <QString>
 #include <QList>
 #include <QMutex>
+#include "../../database/keysetpagination.h"
 
 class Invoice;
 class InvoiceItem;
@@ -48,6 +49,8 @@ public:
     bool deleteInvoice(const QString &invoiceId);
     Invoice* getInvoice(const QString &invoiceId);
     QList<Invoice*> getAllInvoices();
+    // Sort keys: invoice_date (default, newest first), due_date, client_name, total_amount
+    Page<Invoice*> getInvoicesPage(const PageRequest &request);
     QList<Invoice*> getInvoicesByClient(const QString &clientId);
     QList<Invoice*> getInvoicesByStatus(const QString &status);
     QList<Invoice*> getInvoicesByDateRange(const QDate &startDate, const QDate &endDate);
@@ -103,12 +106,14 @@ private:
     Invoice* invoiceFromQuery(const QSqlQuery &query);
     InvoiceItem* invoiceItemFromQuery(const QSqlQuery &query);
     
+    bool executeQuery(QSqlQuery &query, const QString &sql = QString()) const;
     void setLastError(const QString &error);
     QString generateConnectionName();
 
     QSqlDatabase m_database;
     QString m_connectionName;
     QString m_lastError;
+    bool m_inTransaction;
     mutable QMutex m_mutex;
     
     static const QString DATABASE_VERSION;
@@ -277,6 +277,7 @@ AIAssistantDialog::AIAssistantDialog(QWidget *parent)
     : QDialog(parent)
     , m_groqClient(nullptr)
     , m_databaseService(nullptr)
+    , m_queryRowCount(0)
     , m_autoScroll(true)
     , m_showTimestamps(true)
     , m_fontFamily("Poppins")
@@ -419,10 +420,18 @@ void AIAssistantDialog::setupUI()
     m_sendButton->setFixedSize(80, 40);
     m_sendButton->setEnabled(false);
     
+    // Shown while a database query streams into the chat
+    m_cancelQueryButton = new QPushButton("Cancel");
+    m_cancelQueryButton->setObjectName("sendButton");
+    m_cancelQueryButton->setFixedSize(80, 40);
+    m_cancelQueryButton->setToolTip("Stop the running database query");
+    m_cancelQueryButton->setVisible(false);
+    
     inputLayout->addWidget(m_attachButton);
     inputLayout->addWidget(m_messageInput);
     inputLayout->addWidget(m_voiceButton);
     inputLayout->addWidget(m_sendButton);
+    inputLayout->addWidget(m_cancelQueryButton);
     
     chatMainLayout->addWidget(m_inputFrame);
     
@@ -490,6 +499,7 @@ void AIAssistantDialog::setupConnections()
       connect(m_messageInput, &QLineEdit::returnPressed, this, &AIAssistantDialog::sendMessage);
     connect(m_sendButton, &QPushButton::clicked, this, &AIAssistantDialog::sendMessage);
     connect(m_attachButton, &QPushButton::clicked, this, &AIAssistantDialog::attachDocument);
+    connect(m_cancelQueryButton, &QPushButton::clicked, this, &AIAssistantDialog::cancelDatabaseQuery);
     
     // Header connections
     connect(m_closeButton, &QPushButton::clicked, this, &QDialog::close);
@@ -796,7 +806,7 @@ void AIAssistantDialog::onTypingFinished()
     m_typingIndicator->hide();
 }
 
-void AIAssistantDialog::addMessage(ChatBubble::Type type, const QString &message)
+ChatBubble *AIAssistantDialog::addMessage(ChatBubble::Type type, const QString &message)
 {
     ChatBubble *bubble = new ChatBubble(type, message);
     
@@ -813,6 +823,8 @@ void AIAssistantDialog::addMessage(ChatBubble::Type type, const QString &message
     if (m_autoScroll) {
         QTimer::singleShot(100, this, &AIAssistantDialog::scrollToBottom);
     }
+    
+    return bubble;
 }
 
 void AIAssistantDialog::scrollToBottom()
@@ -1151,6 +1163,9 @@ void AIAssistantDialog::setDatabaseService(DatabaseService *dbService)
                 this, [this]() {
             addMessage(ChatBubble::System, "Database updated. Current data context refreshed.");
         });
+        
+        connect(m_databaseService, &DatabaseService::guardedQueryRows,
+                this, &AIAssistantDialog::appendQueryRows);
     }
 }
 
@@ -1172,18 +1187,9 @@ void AIAssistantDialog::processDatabaseCommand(const QString &command)
     QString lowerCommand = command.toLower().trimmed();
     
     if (lowerCommand.startsWith("get all materials") || lowerCommand.startsWith("list all materials")) {
-        QJsonArray materials = m_databaseService->getAllMaterials();
-        QString response = QString("Found %1 materials in the database:\n").arg(materials.size());
-        
-        for (const auto &value : materials) {
-            QJsonObject material = value.toObject();
-            response += QString("- %1 (%2) - Qty: %3\n")
-                       .arg(material["name"].toString())
-                       .arg(material["category"].toString())
-                       .arg(material["quantity"].toInt());
-        }
-        
-        addMessage(ChatBubble::Assistant, response);
+        // Streamed and capped - the table can be far larger than a chat reply
+        runGuardedQuery("SELECT name, category, quantity FROM materials ORDER BY name",
+                        "Materials in the database");
     }
     else if (lowerCommand.startsWith("get low stock") || lowerCommand.startsWith("low stock materials")) {
         QJsonArray lowStock = m_databaseService->getLowStockMaterials();
@@ -1228,23 +1234,98 @@ void AIAssistantDialog::handleDatabaseQuery(const QString &query)
     
     addMessage(ChatBubble::System, QString("Executing database query: %1").arg(query));
     
-    // For security, we'll only allow certain safe queries
-    QString lowerQuery = query.toLower().trimmed();
-    
-    if (lowerQuery.contains("delete") || lowerQuery.contains("drop") || lowerQuery.contains("truncate")) {
-        addMessage(ChatBubble::System, "Destructive queries are not allowed for security reasons.");
+    // The service only accepts single SELECT statements and runs them on a
+    // read-only connection, within a row limit and a time budget
+    runGuardedQuery(query, "Query results");
+}
+
+void AIAssistantDialog::runGuardedQuery(const QString &sql, const QString &title)
+{
+    if (m_databaseService->isGuardedQueryRunning()) {
+        addMessage(ChatBubble::System, "A database query is still running. Cancel it or wait for it to finish.");
         return;
     }
     
-    // This is a simplified implementation - in a real app you'd want more sophisticated query parsing
-    if (lowerQuery.startsWith("select") && lowerQuery.contains("materials")) {
-        // For now, just redirect to search or general queries
-        if (lowerQuery.contains("where")) {
-            addMessage(ChatBubble::Assistant, "Complex SQL queries not yet supported. Try using the search command instead.");
-        } else {
-            processDatabaseCommand("get all materials");
+    m_queryBubble = nullptr;
+    m_queryText = title + ":\n";
+    m_queryRowCount = 0;
+    
+    m_cancelQueryButton->setEnabled(true);
+    m_cancelQueryButton->setVisible(true);
+    m_progressBar->setVisible(true);
+    
+    m_databaseService->executeGuardedQuery(sql).then(this, [this](const GuardedQueryResult &result) {
+        finishGuardedQuery(result);
+    });
+}
+
+void AIAssistantDialog::appendQueryRows(const QStringList &columns, const QJsonArray &rows)
+{
+    if (m_queryRowCount == 0) {
+        m_queryText += columns.join(" | ") + "\n";
+    }
+    
+    for (const QJsonValue &value : rows) {
+        const QJsonObject row = value.toObject();
+        QStringList fields;
+        for (const QString &column : columns) {
+            fields << row.value(column).toVariant().toString();
+        }
+        m_queryText += "- " + fields.join(" | ") + "\n";
+    }
+    m_queryRowCount += rows.size();
+    
+    // One bubble grows as the rows arrive
+    if (m_queryBubble) {
+        m_queryBubble->setMessage(m_queryText);
+        if (m_autoScroll) {
+            QTimer::singleShot(0, this, &AIAssistantDialog::scrollToBottom);
         }
     } else {
-        addMessage(ChatBubble::Assistant, "Only SELECT queries on materials table are currently supported.");
+        m_queryBubble = addMessage(ChatBubble::Assistant, m_queryText);
+    }
+}
+
+void AIAssistantDialog::finishGuardedQuery(const GuardedQueryResult &result)
+{
+    m_cancelQueryButton->setVisible(false);
+    m_progressBar->setVisible(false);
+    
+    if (!result.error.isEmpty()) {
+        addMessage(ChatBubble::System, QString("Query failed: %1").arg(result.error));
+        return;
+    }
+    
+    QString footer;
+    if (result.canceled) {
+        footer = QString("Canceled after %1 rows.").arg(result.rows.size());
+    } else if (result.timedOut) {
+        footer = QString("Stopped after %1 s with %2 rows; the query took too long.")
+                     .arg(result.elapsedMs / 1000.0, 0, 'f', 1)
+                     .arg(result.rows.size());
+    } else if (result.truncated) {
+        footer = QString("Showing the first %1 rows; refine the query to see the rest.").arg(result.rows.size());
+    } else {
+        footer = QString("%1 rows.").arg(result.rows.size());
+    }
+    
+    if (m_queryRowCount == 0 && !result.truncated) {
+        m_queryText += "No rows found.\n";
+    }
+    m_queryText += "\n" + footer;
+    
+    if (m_queryBubble) {
+        m_queryBubble->setMessage(m_queryText);
+    } else {
+        m_queryBubble = addMessage(ChatBubble::Assistant, m_queryText);
+    }
+    m_queryBubble = nullptr;
+}
+
+void AIAssistantDialog::cancelDatabaseQuery()
+{
+    if (m_databaseService) {
+        m_databaseService->cancelGuardedQuery();
     }
+    m_cancelQueryButton->setEnabled(false);
 }
@@ -23,9 +23,11 @@
 #include <QMimeData>
 #include <QDragEnterEvent>
 #include <QDropEvent>
+#include <QPointer>
 #include "groqclient.h"
 
 class DatabaseService;
+struct GuardedQueryResult;
 
 class ChatBubble : public QFrame
 {
@@ -120,6 +122,7 @@ private slots:
     void analyzeDocument(const QString &filePath);
     void processDatabaseCommand(const QString &command);
     void handleDatabaseQuery(const QString &query);
+    void cancelDatabaseQuery();
     
 protected:
     void dragEnterEvent(QDragEnterEvent *event) override;
@@ -130,7 +133,7 @@ private:
     void setupAnimations();
     void setupConnections();
     void setupQuickActions();
-    void addMessage(ChatBubble::Type type, const QString &message);
+    ChatBubble *addMessage(ChatBubble::Type type, const QString &message);
     void scrollToBottom();
     void updateConnectionIndicator();
     void animateDialogEntry();
@@ -141,6 +144,9 @@ private:
     QString processUserMessage(const QString &message);
     QString handleDatabaseOperation(const QString &operation, const QJsonObject &params);
     void addDatabaseQuickActions();
+    void runGuardedQuery(const QString &sql, const QString &title);
+    void appendQueryRows(const QStringList &columns, const QJsonArray &rows);
+    void finishGuardedQuery(const GuardedQueryResult &result);
     
     // UI Components
     QVBoxLayout *m_mainLayout;
@@ -159,6 +165,7 @@ private:
     QPushButton *m_sendButton;
     QPushButton *m_attachButton;
     QPushButton *m_voiceButton;
+    QPushButton *m_cancelQueryButton;
     
     QFrame *m_sidebarFrame;
     QVBoxLayout *m_sidebarLayout;
@@ -173,6 +180,11 @@ private:
     QList<ChatMessage> m_chatHistory;
     QJsonObject m_materialContext;
     
+    // Guarded query being streamed into the chat
+    QPointer<ChatBubble> m_queryBubble;
+    QString m_queryText;
+    int m_queryRowCount;
+    
     // Animations
     QPropertyAnimation *m_fadeInAnimation;
     QPropertyAnimation *m_scaleAnimation;
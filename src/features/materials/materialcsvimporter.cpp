@@ -0,0 +1,310 @@
+#include "materialcsvimporter.h"
+#include "../../database/csvreader.h"
+#include "../../database/databasemanager.h"
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+#include <iterator>
+
+const int MaterialCsvImporter::CHUNK_SIZE = 5000;
+const int MaterialCsvImporter::MAX_REPORTED_FAILURES = 100;
+
+namespace {
+
+const QString INSERT_SQL = R"(
+    INSERT INTO materials (name, description, category, quantity, unit, price,
+                           supplier_id, barcode, location, minimum_stock, maximum_stock,
+                           reorder_point, status, created_by, updated_by)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+)";
+const int INSERT_COLUMNS = 15;
+
+const QString IMPORT_USER = "Import";
+
+// Defaults for empty or missing fields, as the old line-by-line import had them
+const QString DEFAULT_CATEGORY = "General";
+const QString DEFAULT_UNIT = "pcs";
+const QString DEFAULT_STATUS = "active";
+const int DEFAULT_MINIMUM_STOCK = 10;
+const int DEFAULT_MAXIMUM_STOCK = 1000;
+const int DEFAULT_REORDER_POINT = 10;
+
+// Parses a count that cannot be negative; an empty field takes the default
+bool parseCount(const QString &text, int defaultValue, int *value)
+{
+    if (text.isEmpty()) {
+        *value = defaultValue;
+        return true;
+    }
+    bool ok = false;
+    *value = text.toInt(&ok);
+    return ok && *value >= 0;
+}
+
+// Accepts the "$1,234.50" the table shows as well as plain numbers
+bool parsePrice(QString text, double *value)
+{
+    if (text.startsWith('$')) {
+        text.remove(0, 1);
+    }
+    text.remove(',');
+    if (text.isEmpty()) {
+        *value = 0.0;
+        return true;
+    }
+    bool ok = false;
+    *value = text.toDouble(&ok);
+    return ok && *value >= 0.0;
+}
+
+} // namespace
+
+MaterialCsvImporter::MaterialCsvImporter(DatabaseManager *databaseManager)
+    : m_databaseManager(databaseManager)
+    , m_canceled(false)
+    , m_currentLine(0)
+{
+}
+
+MaterialImportResult MaterialCsvImporter::importFile(const QString &fileName, const Progress &progress)
+{
+    // Binary mode: CsvReader handles CRLF itself, including inside quoted fields
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        MaterialImportResult result;
+        result.error = QString("Could not open file: %1").arg(fileName);
+        return result;
+    }
+    return run(&file, progress);
+}
+
+MaterialImportResult MaterialCsvImporter::run(QIODevice *device, const Progress &progress)
+{
+    MaterialImportResult result;
+    if (!m_databaseManager || !m_databaseManager->isConnected()) {
+        result.error = "Database not connected";
+        return result;
+    }
+
+    const qint64 totalBytes = device->isSequential() ? 0 : device->size();
+    CsvReader reader(device);
+    m_values = QList<QVariantList>(INSERT_COLUMNS);
+    m_lines.clear();
+
+    // The header line, or the first row of a file without one
+    QStringList fields;
+    bool pending = reader.readRecord(&fields);
+    m_columns = QList<int>(FieldCount, -1);
+    const QHash<QString, Field> known = headerFields();
+    for (int i = 0; i < fields.size(); ++i) {
+        const auto it = known.constFind(normalizedHeader(fields.at(i)));
+        if (it != known.constEnd() && m_columns.at(it.value()) < 0) {
+            m_columns[it.value()] = i;
+        }
+    }
+    if (m_columns.at(NameField) >= 0) {
+        pending = false;
+    } else {
+        const Field exportOrder[] = {NameField, DescriptionField, CategoryField, QuantityField,
+                                     UnitField, PriceField, LocationField, MinimumStockField};
+        m_columns.fill(-1);
+        for (int i = 0; i < int(std::size(exportOrder)); ++i) {
+            m_columns[exportOrder[i]] = i;
+        }
+    }
+
+    while (!isCanceled()) {
+        if (!pending && !reader.readRecord(&fields)) {
+            break;
+        }
+        pending = false;
+        m_currentLine = reader.lineNumber();
+
+        const bool blank = std::all_of(fields.cbegin(), fields.cend(), [](const QString &field) {
+            return field.trimmed().isEmpty();
+        });
+        if (blank) {
+            ++result.skippedRows;
+            continue;
+        }
+
+        QString reason;
+        if (!appendRow(fields, &reason)) {
+            recordFailure(&result, m_currentLine, reason);
+            continue;
+        }
+        if (m_lines.size() >= CHUNK_SIZE) {
+            if (!flush(&result)) {
+                break;
+            }
+            if (progress) {
+                progress(reader.bytesRead(), totalBytes, result.importedRows);
+            }
+        }
+    }
+
+    if (isCanceled()) {
+        result.canceled = true;
+    } else if (result.isValid()) {
+        // An unterminated quote swallows the rest of the file into one bad record
+        if (reader.hasError()) {
+            recordFailure(&result, reader.lineNumber(), reader.errorString());
+        }
+        flush(&result);
+    }
+    if (progress) {
+        progress(reader.bytesRead(), totalBytes, result.importedRows);
+    }
+
+    m_values.clear();
+    m_lines.clear();
+    qDebug() << "MaterialCsvImporter:" << result.importedRows << "imported," << result.failedRows
+             << "failed," << result.skippedRows << "blank lines skipped";
+    return result;
+}
+
+void MaterialCsvImporter::cancel()
+{
+    m_canceled = true;
+}
+
+bool MaterialCsvImporter::isCanceled() const
+{
+    return m_canceled;
+}
+
+QHash<QString, MaterialCsvImporter::Field> MaterialCsvImporter::headerFields()
+{
+    // Normalized header names, including the ones exportToCSV() writes
+    return {
+        {"name", NameField},
+        {"materialname", NameField},
+        {"description", DescriptionField},
+        {"category", CategoryField},
+        {"quantity", QuantityField},
+        {"qty", QuantityField},
+        {"unit", UnitField},
+        {"price", PriceField},
+        {"unitprice", PriceField},
+        {"location", LocationField},
+        {"minimumstock", MinimumStockField},
+        {"minstock", MinimumStockField},
+        {"maximumstock", MaximumStockField},
+        {"maxstock", MaximumStockField},
+        {"reorderpoint", ReorderPointField},
+        {"status", StatusField},
+        {"barcode", BarcodeField},
+        {"sku", BarcodeField},
+        {"supplierid", SupplierIdField}
+    };
+}
+
+QString MaterialCsvImporter::normalizedHeader(const QString &header)
+{
+    // "Minimum Stock", "minimum_stock" and "MinimumStock" name the same column
+    QString normalized;
+    for (const QChar c : header) {
+        if (c.isLetterOrNumber()) {
+            normalized += c.toLower();
+        }
+    }
+    return normalized;
+}
+
+bool MaterialCsvImporter::appendRow(const QStringList &fields, QString *errorMessage)
+{
+    auto text = [this, &fields](Field field) {
+        const int column = m_columns.at(field);
+        return column >= 0 && column < fields.size() ? fields.at(column).trimmed() : QString();
+    };
+
+    const QString name = text(NameField);
+    if (name.isEmpty()) {
+        *errorMessage = "Name is required";
+        return false;
+    }
+
+    int quantity = 0;
+    int minimumStock = 0;
+    int maximumStock = 0;
+    int reorderPoint = 0;
+    int supplierId = 0;
+    double price = 0.0;
+    if (!parseCount(text(QuantityField), 0, &quantity)) {
+        *errorMessage = QString("Invalid quantity '%1'").arg(text(QuantityField));
+        return false;
+    }
+    if (!parsePrice(text(PriceField), &price)) {
+        *errorMessage = QString("Invalid price '%1'").arg(text(PriceField));
+        return false;
+    }
+    if (!parseCount(text(MinimumStockField), DEFAULT_MINIMUM_STOCK, &minimumStock)
+        || !parseCount(text(MaximumStockField), DEFAULT_MAXIMUM_STOCK, &maximumStock)
+        || !parseCount(text(ReorderPointField), DEFAULT_REORDER_POINT, &reorderPoint)) {
+        *errorMessage = "Invalid stock level";
+        return false;
+    }
+    if (!parseCount(text(SupplierIdField), 0, &supplierId)) {
+        *errorMessage = QString("Invalid supplier id '%1'").arg(text(SupplierIdField));
+        return false;
+    }
+
+    QString status = text(StatusField).toLower();
+    if (status.isEmpty()) {
+        status = DEFAULT_STATUS;
+    } else if (status != "active" && status != "inactive" && status != "discontinued") {
+        *errorMessage = QString("Unknown status '%1'").arg(text(StatusField));
+        return false;
+    }
+
+    const QString category = text(CategoryField);
+    const QString unit = text(UnitField);
+    const QString barcode = text(BarcodeField);
+
+    // Empty barcodes are stored as NULL so they do not collide on the UNIQUE index
+    const QVariant values[INSERT_COLUMNS] = {
+        name, text(DescriptionField), category.isEmpty() ? DEFAULT_CATEGORY : category, quantity,
+        unit.isEmpty() ? DEFAULT_UNIT : unit, price,
+        supplierId > 0 ? QVariant(supplierId) : QVariant(), barcode.isEmpty() ? QVariant() : QVariant(barcode),
+        text(LocationField), minimumStock, maximumStock, reorderPoint, status, IMPORT_USER, IMPORT_USER
+    };
+    for (int column = 0; column < INSERT_COLUMNS; ++column) {
+        m_values[column].append(values[column]);
+    }
+    m_lines.append(m_currentLine);
+    return true;
+}
+
+bool MaterialCsvImporter::flush(MaterialImportResult *result)
+{
+    if (m_lines.isEmpty()) {
+        return true;
+    }
+
+    // One transaction per chunk; a row breaking a constraint is replayed
+    // alone and reported, the chunk's other rows still commit
+    const BatchResult batch = m_databaseManager->executeBatch(INSERT_SQL, m_values);
+    if (!batch.isValid()) {
+        result->error = batch.error;
+        return false;
+    }
+
+    result->importedRows += batch.succeededRows;
+    for (auto it = batch.failedRows.constBegin(); it != batch.failedRows.constEnd(); ++it) {
+        recordFailure(result, m_lines.at(it.key()), it.value());
+    }
+
+    for (QVariantList &column : m_values) {
+        column.clear();
+    }
+    m_lines.clear();
+    return true;
+}
+
+void MaterialCsvImporter::recordFailure(MaterialImportResult *result, qint64 line, const QString &reason)
+{
+    ++result->failedRows;
+    if (result->failedLines.size() < MAX_REPORTED_FAILURES) {
+        result->failedLines.insert(line, reason);
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef MATERIALCSVIMPORTER_H
+#define MATERIALCSVIMPORTER_H
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <atomic>
+#include <functional>
+
+class DatabaseManager;
+class QIODevice;
+
+// What one import did. Lines are numbered from 1 as in the file.
+struct MaterialImportResult {
+    int importedRows = 0;
+    int skippedRows = 0;            // blank lines
+    QMap<qint64, QString> failedLines;  // line -> reason, first MAX_REPORTED_FAILURES only
+    int failedRows = 0;
+    bool canceled = false;
+    QString error;                  // what stopped the import, if anything did
+
+    bool isValid() const { return error.isEmpty(); }
+};
+
+/**
+ * @brief The MaterialCsvImporter class - Streams a CSV file into the materials table
+ *
+ * Records are read one at a time with CsvReader, mapped onto material
+ * columns by the header line and validated, then inserted CHUNK_SIZE at a
+ * time, each chunk in its own executeBatch() transaction. Rows that fail
+ * validation or a constraint are reported by line and skipped; the rest
+ * are imported. Without a header naming a "name" column the fields are
+ * taken in the export's order: name, description, category, quantity,
+ * unit, price, location, minimum stock.
+ *
+ * run() blocks and uses the calling thread's connection, so call it from a
+ * worker thread; cancel() may be called from any thread. Chunks committed
+ * before a cancel stay imported. The caller refreshes the model afterwards.
+ */
+class MaterialCsvImporter
+{
+public:
+    static const int CHUNK_SIZE;
+    static const int MAX_REPORTED_FAILURES;
+
+    // Called after every chunk with the bytes read so far, on the thread calling run()
+    using Progress = std::function<void(qint64 bytesRead, qint64 totalBytes, int importedRows)>;
+
+    explicit MaterialCsvImporter(DatabaseManager *databaseManager);
+
+    MaterialImportResult importFile(const QString &fileName, const Progress &progress = Progress());
+    MaterialImportResult run(QIODevice *device, const Progress &progress = Progress());
+
+    void cancel();
+    bool isCanceled() const;
+
+private:
+    enum Field {
+        NameField,
+        DescriptionField,
+        CategoryField,
+        QuantityField,
+        UnitField,
+        PriceField,
+        LocationField,
+        MinimumStockField,
+        MaximumStockField,
+        ReorderPointField,
+        StatusField,
+        BarcodeField,
+        SupplierIdField,
+        FieldCount
+    };
+
+    static QHash<QString, Field> headerFields();
+    static QString normalizedHeader(const QString &header);
+    bool appendRow(const QStringList &fields, QString *errorMessage);
+    bool flush(MaterialImportResult *result);
+    void recordFailure(MaterialImportResult *result, qint64 line, const QString &reason);
+
+    DatabaseManager *m_databaseManager;
+    std::atomic_bool m_canceled;
+
+    // Column of each Field in the file, -1 when absent
+    QList<int> m_columns;
+
+    // The chunk being collected, one list per insert placeholder
+    QList<QVariantList> m_values;
+    QList<qint64> m_lines;
+    qint64 m_currentLine;
+};
+
+#endif // MATERIALCSVIMPORTER_H
@@ -1,23 +1,128 @@
 #include "materialmodel.h"
 #include "../../database/databasemanager.h"
+#include "../../database/migrations.h"
+#include "stockalertmonitor.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
 #include <QColor>
 #include <QIcon>
+#include <QFile>
 #include <QDateTime>
+#include <QSqlRecord>
+#include <QSet>
+#include <algorithm>
+#include <iterator>
+
+// The id breaks ties between equal names, so every row has one fixed place
+// and single-row updates can find it by binary search (idx_materials_page_name
+// on (name, id) from migration 5 yields this order, so it needs no sort step)
+static const QString MATERIALS_SELECT_SQL =
+    "SELECT id, name, description, category, quantity, unit, price, supplier_id, "
+    "barcode, location, minimum_stock, maximum_stock, reorder_point, status, "
+    "created_at, updated_at, created_by, updated_by FROM materials ORDER BY name, id";
+
+const int MaterialModel::LAZY_CHUNK_SIZE = 200;
+const int MaterialModel::LAZY_LOAD_THRESHOLD = 20000;
+
+namespace {
+
+// Display order of m_materials
+bool displayOrderLess(const Material &a, const Material &b)
+{
+    const int byName = QString::compare(a.name, b.name, Qt::CaseSensitive);
+    return byName != 0 ? byName < 0 : a.id < b.id;
+}
+
+// Filter ids for "any value" and for a value no material has
+const int ANY_TERM = -1;
+const int UNKNOWN_TERM = -2;
+
+// Joins name and description in a search key; it cannot be typed into the
+// search box, so no match spans both fields
+const QChar SEARCH_KEY_SEPARATOR(0x1F);
+
+// Row colors
+const QColor LOW_STOCK_BACKGROUND(0xFF, 0xE6, 0xE6);   // light red
+const QColor EVEN_ROW_BACKGROUND(0xFF, 0xFF, 0xFF);
+const QColor ODD_ROW_BACKGROUND(0xF8, 0xF9, 0xFA);
+const QColor INACTIVE_FOREGROUND(0x6C, 0x75, 0x7D);    // gray
+const QColor LOW_STOCK_FOREGROUND(0xDC, 0x35, 0x45);   // red
+const QColor DEFAULT_FOREGROUND(0x49, 0x50, 0x57);
+
+// Statuses with an icon, in the order of MaterialModel::statusIcons()
+const char *const ICON_STATUSES[] = {"active", "inactive", "discontinued"};
+
+// Category and status filters that let every material through
+bool isAnyTerm(const QString &filter)
+{
+    return filter.isEmpty() || filter == "All";
+}
+
+// LIKE pattern matching text anywhere, with its wildcards taken literally
+QString containsPattern(const QString &text)
+{
+    QString escaped = text;
+    escaped.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+    return '%' + escaped + '%';
+}
+
+// Sort key of Migrations::materialsPagination() for a column; empty when
+// SQL cannot sort by it
+QString lazySortKey(int column)
+{
+    switch (column) {
+    case MaterialModel::NameColumn:
+        return "name";
+    case MaterialModel::CategoryColumn:
+        return "category";
+    case MaterialModel::QuantityColumn:
+        return "quantity";
+    case MaterialModel::PriceColumn:
+        return "price";
+    default:
+        return QString();
+    }
+}
+
+} // namespace
 
 MaterialModel::MaterialModel(QObject *parent)
     : QAbstractTableModel(parent)
+    , m_appliedCategoryId(ANY_TERM)
+    , m_appliedStatusId(ANY_TERM)
+    , m_lazy(false)
+    , m_lazyHasMore(false)
+    , m_lazySortKey("name")
+    , m_lazySortOrder(Qt::AscendingOrder)
+    , m_matchingCount(0)
     , m_databaseManager(nullptr)
+    , m_loadWatcher(new QFutureWatcher<QList<Material>>(this))
+    , m_stockAlerts(new StockAlertMonitor(this))
 {
+    connect(m_loadWatcher, &QFutureWatcher<QList<Material>>::finished, this, [this]() {
+        if (m_lazy) {
+            return; // switched to lazy loading meanwhile
+        }
+        setMaterials(m_loadWatcher->result());
+        
+        qDebug() << "Loaded" << m_materials.size() << "materials from database in background";
+        emit dataRefreshed();
+    });
+    
     loadFromDatabase();
 }
 
+MaterialModel::~MaterialModel()
+{
+    m_loadWatcher->cancel();
+    m_loadWatcher->waitForFinished();
+}
+
 int MaterialModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent)
-    return m_filteredMaterials.size();
+    return m_visibleRows.size();
 }
 
 int MaterialModel::columnCount(const QModelIndex &parent) const
@@ -28,11 +133,11 @@ int MaterialModel::columnCount(const QModelIndex &parent) const
 
 QVariant MaterialModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_filteredMaterials.size()) {
+    if (!index.isValid() || index.row() >= m_visibleRows.size()) {
         return QVariant();
     }
     
-    const Material &material = m_filteredMaterials.at(index.row());
+    const Material &material = materialAt(index.row());
     
     switch (role) {
     case Qt::DisplayRole:
@@ -51,7 +156,11 @@ QVariant MaterialModel::data(const QModelIndex &index, int role) const
         case UnitColumn:
             return material.unit;
         case PriceColumn:
-            return QString("$%1").arg(material.price, 0, 'f', 2);
+            // Editors get the number; "$x.xx" would not parse back
+            if (role == Qt::EditRole) {
+                return material.price;
+            }
+            return displayValuesAt(index.row()).priceText;
         case LocationColumn:
             return material.location;
         case StatusColumn:
@@ -63,28 +172,20 @@ QVariant MaterialModel::data(const QModelIndex &index, int role) const
         
     case Qt::BackgroundRole:
         // Highlight low stock items
-        if (material.quantity <= material.reorderPoint) {
-            return QColor("#FFE6E6"); // Light red background
+        if (displayValuesAt(index.row()).lowStock) {
+            return LOW_STOCK_BACKGROUND;
         }
         // Alternate row colors
-        return (index.row() % 2 == 0) ? QColor("#FFFFFF") : QColor("#F8F9FA");
+        return (index.row() % 2 == 0) ? EVEN_ROW_BACKGROUND : ODD_ROW_BACKGROUND;
         
     case Qt::ForegroundRole:
-        if (material.status == "inactive") {
-            return QColor("#6C757D"); // Gray text for inactive items
-        } else if (material.quantity <= material.reorderPoint) {
-            return QColor("#DC3545"); // Red text for low stock
-        }
-        return QColor("#495057"); // Default text color
+        return displayValuesAt(index.row()).foreground;
         
     case Qt::DecorationRole:
         if (index.column() == StatusColumn) {
-            if (material.status == "active") {
-                return QIcon(":/icons/status-active.png");
-            } else if (material.status == "inactive") {
-                return QIcon(":/icons/status-inactive.png");
-            } else if (material.status == "discontinued") {
-                return QIcon(":/icons/status-discontinued.png");
+            const int icon = displayValuesAt(index.row()).statusIcon;
+            if (icon >= 0) {
+                return statusIcons().at(icon);
             }
         }
         break;
@@ -139,11 +240,12 @@ QVariant MaterialModel::headerData(int section, Qt::Orientation orientation, int
 
 bool MaterialModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (!index.isValid() || index.row() >= m_filteredMaterials.size() || role != Qt::EditRole) {
+    if (!index.isValid() || index.row() >= m_visibleRows.size() || role != Qt::EditRole) {
         return false;
     }
     
-    Material &material = m_filteredMaterials[index.row()];
+    Material material = materialAt(index.row());
+    bool ok = true;
     
     switch (index.column()) {
     case NameColumn:
@@ -156,13 +258,15 @@ bool MaterialModel::setData(const QModelIndex &index, const QVariant &value, int
         material.category = value.toString();
         break;
     case QuantityColumn:
-        material.quantity = value.toInt();
+        material.quantity = value.toInt(&ok);
+        ok = ok && material.quantity >= 0;
         break;
     case UnitColumn:
         material.unit = value.toString();
         break;
     case PriceColumn:
-        material.price = value.toDouble();
+        material.price = value.toDouble(&ok);
+        ok = ok && material.price >= 0.0;
         break;
     case LocationColumn:
         material.location = value.toString();
@@ -174,13 +278,13 @@ bool MaterialModel::setData(const QModelIndex &index, const QVariant &value, int
         return false;
     }
     
-    material.updatedAt = QDateTime::currentDateTime();
-    material.updatedBy = "current_user"; // TODO: Get actual current user
-    
-    emit QAbstractTableModel::dataChanged(index, index, {role});
-    emit materialUpdated(material);
+    // Text that is not a valid number is refused rather than saved as 0
+    if (!ok) {
+        return false;
+    }
     
-    return true;
+    // Saved like any other edit; a renamed row moves to its new place
+    return updateMaterial(index.row(), material);
 }
 
 Qt::ItemFlags MaterialModel::flags(const QModelIndex &index) const
@@ -199,7 +303,64 @@ Qt::ItemFlags MaterialModel::flags(const QModelIndex &index) const
     return flags;
 }
 
-bool MaterialModel::addMaterial(const Material &material)
+bool MaterialModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_lazy && m_lazyHasMore;
+}
+
+void MaterialModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent) || !m_databaseManager || !m_databaseManager->isConnected()) {
+        return;
+    }
+    
+    const KeysetPagination &pagination = Migrations::materialsPagination();
+    const PageRequest request{m_lazySortKey, m_lazySortOrder, LAZY_CHUNK_SIZE, m_continuationToken};
+    QVariantList conditionParams;
+    const QString condition = lazyCondition(&conditionParams);
+    QString sql;
+    QVariantList params;
+    QString error;
+    if (!pagination.buildQuery(request, condition, conditionParams, &sql, &params, &error)) {
+        qWarning() << "MaterialModel: cannot fetch materials:" << error;
+        m_lazyHasMore = false;
+        return;
+    }
+    
+    // A forward-only cursor holds no more than the chunk it reads
+    QSqlQuery query = m_databaseManager->executeForwardOnly(sql, params);
+    if (!query.isActive()) {
+        qWarning() << "MaterialModel: fetching materials failed:" << query.lastError().text();
+        m_lazyHasMore = false;
+        return;
+    }
+    
+    const Page<Material> page = pagination.readPage<Material>(query, request, [](const QSqlQuery &row) {
+        return materialFromRecord(row.record());
+    });
+    m_continuationToken = page.continuationToken;
+    m_lazyHasMore = page.hasMore();
+    appendMaterialRows(page.items);
+}
+
+void MaterialModel::sort(int column, Qt::SortOrder order)
+{
+    // Loaded rows stay in name order, which the incremental updates rely
+    // on; views sort them through a proxy
+    if (!m_lazy) {
+        return;
+    }
+    
+    const QString sortKey = lazySortKey(column);
+    if (sortKey.isEmpty() || (sortKey == m_lazySortKey && order == m_lazySortOrder)) {
+        return;
+    }
+    m_lazySortKey = sortKey;
+    m_lazySortOrder = order;
+    restartLazyLoad();
+}
+
+bool MaterialModel::addMaterial(const Material &material, int *materialId)
 {
     Material newMaterial = material;
     
@@ -209,59 +370,36 @@ bool MaterialModel::addMaterial(const Material &material)
     newMaterial.createdBy = "current_user"; // TODO: Get actual current user
     newMaterial.updatedBy = "current_user";
     
-    // Add to database first
+    // Add to database first; the row keeps the id the database assigned
     if (m_databaseManager && m_databaseManager->isConnected()) {
-        if (!addMaterialToDatabase(newMaterial)) {
+        int insertedId = 0;
+        if (!addMaterialToDatabase(newMaterial, &insertedId)) {
             qDebug() << "Failed to add material to database";
             return false;
         }
-        
-        // Reload from database to get the actual ID assigned by the database
-        if (!loadMaterialsFromDatabase()) {
-            qDebug() << "Failed to reload materials after adding";
-            return false;
-        }
-        
-        // Apply current filters and refresh model
-        filterMaterials();
-        
-        // Find the newly added material and emit signal
-        for (const Material &mat : m_materials) {
-            if (mat.name == newMaterial.name && 
-                mat.category == newMaterial.category && 
-                mat.createdAt >= newMaterial.createdAt.addSecs(-5)) {
-                emit materialAdded(mat);
-                break;
-            }
-        }
-    } else {
+        newMaterial.id = insertedId;
+    } else if (newMaterial.id == 0) {
         // Fallback to in-memory only
-        beginInsertRows(QModelIndex(), m_materials.size(), m_materials.size());
-        
-        // Assign ID if not set
-        if (newMaterial.id == 0) {
-            newMaterial.id = getNextId();
-        }
-        
-        m_materials.append(newMaterial);
-        filterMaterials();
-        
-        endInsertRows();
-        
-        emit materialAdded(newMaterial);
+        newMaterial.id = getNextId();
+    }
+    
+    insertMaterialRow(newMaterial);
+    if (materialId) {
+        *materialId = newMaterial.id;
     }
     
+    emit materialAdded(newMaterial);
     emit dataRefreshed();
     return true;
 }
 
 void MaterialModel::removeMaterial(int row)
 {
-    if (row < 0 || row >= m_filteredMaterials.size()) {
+    if (row < 0 || row >= m_visibleRows.size()) {
         return;
     }
     
-    const Material &material = m_filteredMaterials.at(row);
+    const Material material = materialAt(row);
     
     // Delete from database first
     if (m_databaseManager && m_databaseManager->isConnected()) {
@@ -269,41 +407,21 @@ void MaterialModel::removeMaterial(int row)
             qDebug() << "Failed to delete material from database";
             return;
         }
-        
-        // Reload from database
-        if (!loadMaterialsFromDatabase()) {
-            qDebug() << "Failed to reload materials after deleting";
-            return;
-        }
-        
-        // Apply current filters and refresh model
-        filterMaterials();
-        
-        emit materialRemoved(material.id);
-    } else {
-        // Fallback to in-memory only
-        beginRemoveRows(QModelIndex(), row, row);
-        
-        int originalIndex = m_materials.indexOf(material);
-        if (originalIndex >= 0) {
-            m_materials.removeAt(originalIndex);
-            emit materialRemoved(material.id);
-        }
-        
-        filterMaterials();
-        endRemoveRows();
     }
     
+    removeMaterialRow(material);
+    
+    emit materialRemoved(material.id);
     emit dataRefreshed();
 }
 
 bool MaterialModel::updateMaterial(int row, const Material &material)
 {
-    if (row < 0 || row >= m_filteredMaterials.size()) {
+    if (row < 0 || row >= m_visibleRows.size()) {
         return false;
     }
     
-    const Material &oldMaterial = m_filteredMaterials.at(row);
+    const Material oldMaterial = materialAt(row);
     Material updatedMaterial = material;
     updatedMaterial.id = oldMaterial.id; // Preserve the original ID
     updatedMaterial.createdAt = oldMaterial.createdAt; // Preserve creation time
@@ -316,47 +434,40 @@ bool MaterialModel::updateMaterial(int row, const Material &material)
             qDebug() << "Failed to update material in database";
             return false;
         }
-        
-        // Reload from database
-        if (!loadMaterialsFromDatabase()) {
-            qDebug() << "Failed to reload materials after updating";
-            return false;
-        }
-        
-        // Apply current filters and refresh model
-        filterMaterials();
-        
-        emit materialUpdated(updatedMaterial);
-    } else {
-        // Fallback to in-memory only
-        int originalIndex = m_materials.indexOf(oldMaterial);
-        if (originalIndex >= 0) {
-            m_materials[originalIndex] = updatedMaterial;
-            filterMaterials();
-            
-            emit QAbstractTableModel::dataChanged(index(row, 0), index(row, ColumnCount - 1));
-            emit materialUpdated(updatedMaterial);
-        } else {
-            return false;
-        }
     }
     
+    replaceMaterialRow(oldMaterial, updatedMaterial);
+    
+    emit materialUpdated(updatedMaterial);
     emit dataRefreshed();
     return true;
 }
 
 Material MaterialModel::getMaterial(int row) const
 {
-    if (row >= 0 && row < m_filteredMaterials.size()) {
-        return m_filteredMaterials.at(row);
+    if (row >= 0 && row < m_visibleRows.size()) {
+        return materialAt(row);
     }
     return Material();
 }
 
+int MaterialModel::rowForId(int materialId) const
+{
+    for (int row = 0; row < m_visibleRows.size(); ++row) {
+        if (materialAt(row).id == materialId) {
+            return row;
+        }
+    }
+    return -1;
+}
+
 bool MaterialModel::loadFromDatabase()
 {
-    beginResetModel();
-    m_materials.clear();
+    if (m_lazy) {
+        restartLazyLoad();
+        emit dataRefreshed();
+        return true;
+    }
     
     // Try to load from actual database first
     if (m_databaseManager && m_databaseManager->isConnected()) {
@@ -364,16 +475,13 @@ bool MaterialModel::loadFromDatabase()
             qDebug() << "Loaded" << m_materials.size() << "materials from database";
         } else {
             qDebug() << "Database connected but no materials found";
+            setMaterials(QList<Material>());
         }
     } else {
         qDebug() << "Database not available, loading sample data as fallback";
         loadSampleMaterialsData();
     }
     
-    // Apply current filters
-    filterMaterials();
-    endResetModel();
-    
     emit dataRefreshed();
     return true;
 }
@@ -381,52 +489,148 @@ bool MaterialModel::loadFromDatabase()
 void MaterialModel::setDatabaseManager(DatabaseManager *dbManager)
 {
     m_databaseManager = dbManager;
+    m_lazy = false;
+    m_stockAlerts->setDatabaseManager(dbManager);
     // Reload data from the database when the manager is set
     if (m_databaseManager && m_databaseManager->isConnected()) {
-        loadFromDatabase();
+        // Large catalogues are read as the view scrolls instead of up front
+        CachedQuery countQuery = m_databaseManager->executeCached("SELECT COUNT(*) FROM materials");
+        const int total = countQuery->next() ? countQuery->value(0).toInt() : 0;
+        m_lazy = total > LAZY_LOAD_THRESHOLD;
+        
+        loadFromDatabaseAsync();
     }
 }
 
+StockAlertMonitor *MaterialModel::stockAlerts() const
+{
+    return m_stockAlerts;
+}
+
 bool MaterialModel::loadMaterialsFromDatabase()
 {
-    if (!m_databaseManager || !m_databaseManager->isConnected()) {
-        return false;
+    if (m_lazy) {
+        restartLazyLoad();
+        return m_databaseManager && m_databaseManager->isConnected();
     }
     
-    QSqlQuery query = m_databaseManager->executeQuery(
-        "SELECT id, name, description, category, quantity, unit, price, supplier_id, "
-        "barcode, location, minimum_stock, maximum_stock, reorder_point, status, "
-        "created_at, updated_at, created_by, updated_by FROM materials ORDER BY name"
-    );
-    
-    while (query.next()) {
-        Material material;
-        material.id = query.value("id").toInt();
-        material.name = query.value("name").toString();
-        material.description = query.value("description").toString();
-        material.category = query.value("category").toString();
-        material.quantity = query.value("quantity").toInt();
-        material.unit = query.value("unit").toString();
-        material.price = query.value("price").toDouble();
-        material.supplierId = query.value("supplier_id").toInt();
-        material.barcode = query.value("barcode").toString();
-        material.location = query.value("location").toString();
-        material.minimumStock = query.value("minimum_stock").toInt();
-        material.maximumStock = query.value("maximum_stock").toInt();
-        material.reorderPoint = query.value("reorder_point").toInt();
-        material.status = query.value("status").toString();
-        material.createdAt = query.value("created_at").toDateTime();
-        material.updatedAt = query.value("updated_at").toDateTime();
-        material.createdBy = query.value("created_by").toString();
-        material.updatedBy = query.value("updated_by").toString();
-        
-        m_materials.append(material);
+    bool ok = false;
+    QList<Material> materials = fetchMaterialsFromDatabase(&ok);
+    if (!ok) {
+        return false;
     }
     
+    // Replaces the list, so a reload never accumulates rows
+    setMaterials(materials);
     return true;
 }
 
-bool MaterialModel::addMaterialToDatabase(const Material &material)
+QList<Material> MaterialModel::fetchMaterialsFromDatabase(bool *ok) const
+{
+    // Only touches the database manager, so it is safe to call from a worker thread
+    if (ok) {
+        *ok = false;
+    }
+    
+    if (!m_databaseManager || !m_databaseManager->isConnected()) {
+        return QList<Material>();
+    }
+    
+    DatabaseRowSet rows = m_databaseManager->fetchRows(MATERIALS_SELECT_SQL);
+    if (!rows.isValid()) {
+        return QList<Material>();
+    }
+    
+    if (ok) {
+        *ok = true;
+    }
+    return materialsFromRowSet(rows);
+}
+
+Page<Material> MaterialModel::fetchMaterialsPage(const PageRequest &request) const
+{
+    Page<Material> page;
+    if (!m_databaseManager || !m_databaseManager->isConnected()) {
+        page.error = "Database not connected";
+        return page;
+    }
+    
+    const KeysetPagination &pagination = Migrations::materialsPagination();
+    QString sql;
+    QVariantList params;
+    if (!pagination.buildQuery(request, &sql, &params, &page.error)) {
+        return page;
+    }
+    
+    CachedQuery query = m_databaseManager->executeCached(sql, params);
+    if (query->lastError().isValid()) {
+        page.error = query->lastError().text();
+        return page;
+    }
+    
+    return pagination.readPage<Material>(*query, request, [](const QSqlQuery &row) {
+        return materialFromRecord(row.record());
+    });
+}
+
+void MaterialModel::loadFromDatabaseAsync()
+{
+    if (!m_databaseManager || !m_databaseManager->isConnected()) {
+        loadFromDatabase();
+        return;
+    }
+    
+    if (m_lazy) {
+        restartLazyLoad();
+        emit dataRefreshed();
+        return;
+    }
+    
+    if (m_loadWatcher->isRunning()) {
+        return;
+    }
+    
+    emit loadingStarted();
+    
+    // Rows are converted on the worker as well; only the model swap runs on the GUI thread
+    m_loadWatcher->setFuture(m_databaseManager->executeQueryAsync(MATERIALS_SELECT_SQL)
+        .then([](const DatabaseRowSet &rows) {
+            if (!rows.isValid()) {
+                qWarning() << "Background material load failed:" << rows.error;
+            }
+            QList<Material> materials = materialsFromRowSet(rows);
+            sortMaterials(materials);
+            return materials;
+        }));
+}
+
+bool MaterialModel::isLoading() const
+{
+    return m_loadWatcher->isRunning();
+}
+
+void MaterialModel::setLazyLoading(bool lazy)
+{
+    // Lazy loading reads from the database, so it needs a connection
+    lazy = lazy && m_databaseManager && m_databaseManager->isConnected();
+    if (lazy == m_lazy) {
+        return;
+    }
+    m_lazy = lazy;
+    loadFromDatabaseAsync();
+}
+
+bool MaterialModel::isLazyLoading() const
+{
+    return m_lazy;
+}
+
+int MaterialModel::matchingCount() const
+{
+    return m_lazy ? m_matchingCount : m_visibleRows.size();
+}
+
+bool MaterialModel::addMaterialToDatabase(const Material &material, int *insertedId)
 {
     if (!m_databaseManager || !m_databaseManager->isConnected()) {
         return false;
@@ -446,7 +650,15 @@ bool MaterialModel::addMaterialToDatabase(const Material &material)
         material.reorderPoint, material.status, material.createdBy, material.updatedBy
     };
     
-    return m_databaseManager->executeNonQuery(query, params);
+    CachedQuery result = m_databaseManager->executeCached(query, params);
+    if (result->lastError().isValid()) {
+        return false;
+    }
+    
+    if (insertedId) {
+        *insertedId = result->lastInsertId().toInt();
+    }
+    return true;
 }
 
 bool MaterialModel::updateMaterialInDatabase(const Material &material)
@@ -486,6 +698,8 @@ bool MaterialModel::deleteMaterialFromDatabase(int materialId)
 
 void MaterialModel::loadSampleMaterialsData()
 {
+    QList<Material> materials;
+    
     Material concrete;
     concrete.id = 1;
     concrete.name = "Concrete";
@@ -503,7 +717,7 @@ void MaterialModel::loadSampleMaterialsData()
     concrete.updatedAt = QDateTime::currentDateTime().addDays(-5);
     concrete.createdBy = "Admin";
     concrete.updatedBy = "Manager";
-    m_materials.append(concrete);
+    materials.append(concrete);
     
     Material steel;
     steel.id = 2;
@@ -522,7 +736,7 @@ void MaterialModel::loadSampleMaterialsData()
     steel.updatedAt = QDateTime::currentDateTime().addDays(-3);
     steel.createdBy = "Admin";
     steel.updatedBy = "Supervisor";
-    m_materials.append(steel);
+    materials.append(steel);
     
     Material cement;
     cement.id = 3;
@@ -541,7 +755,7 @@ void MaterialModel::loadSampleMaterialsData()
     cement.updatedAt = QDateTime::currentDateTime().addDays(-1);
     cement.createdBy = "Admin";
     cement.updatedBy = "Manager";
-    m_materials.append(cement);
+    materials.append(cement);
     
     Material bricks;
     bricks.id = 4;
@@ -560,7 +774,7 @@ void MaterialModel::loadSampleMaterialsData()
     bricks.updatedAt = QDateTime::currentDateTime().addDays(-2);
     bricks.createdBy = "Supervisor";
     bricks.updatedBy = "Admin";
-    m_materials.append(bricks);
+    materials.append(bricks);
     
     Material paint;
     paint.id = 5;
@@ -579,7 +793,7 @@ void MaterialModel::loadSampleMaterialsData()
     paint.updatedAt = QDateTime::currentDateTime();
     paint.createdBy = "Manager";
     paint.updatedBy = "Manager";
-    m_materials.append(paint);
+    materials.append(paint);
     
     Material tiles;
     tiles.id = 6;
@@ -598,7 +812,7 @@ void MaterialModel::loadSampleMaterialsData()
     tiles.updatedAt = QDateTime::currentDateTime().addDays(-1);
     tiles.createdBy = "Admin";
     tiles.updatedBy = "Supervisor";
-    m_materials.append(tiles);
+    materials.append(tiles);
     
     Material insulation;
     insulation.id = 7;
@@ -616,7 +830,7 @@ void MaterialModel::loadSampleMaterialsData()
     insulation.createdAt = QDateTime::currentDateTime().addDays(-12);
     insulation.updatedAt = QDateTime::currentDateTime().addDays(-4);
     insulation.createdBy = "Supervisor";    insulation.updatedBy = "Manager";
-    m_materials.append(insulation);
+    materials.append(insulation);
     
     Material lumber;
     lumber.id = 8;
@@ -635,7 +849,7 @@ void MaterialModel::loadSampleMaterialsData()
     lumber.updatedAt = QDateTime::currentDateTime().addDays(-6);
     lumber.createdBy = "Admin";
     lumber.updatedBy = "Supervisor";
-    m_materials.append(lumber);
+    materials.append(lumber);
     
     Material pipe;
     pipe.id = 9;
@@ -654,7 +868,7 @@ void MaterialModel::loadSampleMaterialsData()
     pipe.updatedAt = QDateTime::currentDateTime().addDays(-7);
     pipe.createdBy = "Manager";
     pipe.updatedBy = "Admin";
-    m_materials.append(pipe);
+    materials.append(pipe);
     
     Material electrical;
     electrical.id = 10;
@@ -673,11 +887,9 @@ void MaterialModel::loadSampleMaterialsData()
     electrical.updatedAt = QDateTime::currentDateTime().addDays(-2);
     electrical.createdBy = "Supervisor";
     electrical.updatedBy = "Manager";
-    m_materials.append(electrical);
-    
-    endResetModel();
+    materials.append(electrical);
     
-    // Apply filtering after model reset    filterMaterials();
+    setMaterials(materials);
     
     qDebug() << "Loaded" << m_materials.size() << "sample materials";
 }
@@ -701,17 +913,15 @@ void MaterialModel::clearAllMaterials()
             return;
         }
         
-        // Also clear material movements
+        // Also clear material movements and their checkpoints
         m_databaseManager->executeNonQuery("DELETE FROM material_movements");
+        m_databaseManager->executeNonQuery("DELETE FROM material_stock_checkpoints");
         
         qDebug() << "All materials cleared from database";
     }
     
     // Clear from model
-    beginResetModel();
-    m_materials.clear();
-    m_filteredMaterials.clear();
-    endResetModel();
+    setMaterials(QList<Material>());
     
     emit dataRefreshed();
     qDebug() << "All materials cleared from model";
@@ -719,8 +929,7 @@ void MaterialModel::clearAllMaterials()
 
 void MaterialModel::loadSampleData()
 {
-    beginResetModel();
-    m_materials.clear();
+    QList<Material> materials;
     
     // Add comprehensive sample materials for testing
     Material concrete;
@@ -740,7 +949,7 @@ void MaterialModel::loadSampleData()
     concrete.updatedAt = QDateTime::currentDateTime().addDays(-5);
     concrete.createdBy = "System";
     concrete.updatedBy = "System";
-    m_materials.append(concrete);
+    materials.append(concrete);
     
     Material steel;
     steel.id = 2;
@@ -759,7 +968,7 @@ void MaterialModel::loadSampleData()
     steel.updatedAt = QDateTime::currentDateTime().addDays(-3);
     steel.createdBy = "System";
     steel.updatedBy = "System";
-    m_materials.append(steel);
+    materials.append(steel);
     
     Material pipes;
     pipes.id = 3;
@@ -778,7 +987,7 @@ void MaterialModel::loadSampleData()
     pipes.updatedAt = QDateTime::currentDateTime().addDays(-7);
     pipes.createdBy = "System";
     pipes.updatedBy = "System";
-    m_materials.append(pipes);
+    materials.append(pipes);
     
     Material bricks;
     bricks.id = 4;
@@ -797,7 +1006,7 @@ void MaterialModel::loadSampleData()
     bricks.updatedAt = QDateTime::currentDateTime().addDays(-2);
     bricks.createdBy = "System";
     bricks.updatedBy = "System";
-    m_materials.append(bricks);
+    materials.append(bricks);
     
     Material paint;
     paint.id = 5;
@@ -816,10 +1025,9 @@ void MaterialModel::loadSampleData()
     paint.updatedAt = QDateTime::currentDateTime();
     paint.createdBy = "System";
     paint.updatedBy = "System";
-    m_materials.append(paint);
+    materials.append(paint);
     
-    filterMaterials();
-    endResetModel();
+    setMaterials(materials);
     
     emit dataRefreshed();
     qDebug() << "Loaded" << m_materials.size() << "sample materials";
@@ -850,34 +1058,56 @@ int MaterialModel::getTotalMaterials() const
 
 int MaterialModel::getLowStockCount() const
 {
-    int count = 0;
-    for (const Material &material : m_materials) {
-        if (material.quantity <= material.reorderPoint) {
-            count++;
-        }
-    }
-    return count;
+    return m_stockAlerts->count();
 }
 
 double MaterialModel::getTotalValue() const
 {
-    double total = 0.0;
-    for (const Material &material : m_materials) {
-        total += material.quantity * material.price;
+    const int *quantities = m_quantities.constData();
+    const double *prices = m_prices.constData();
+    const qsizetype count = m_quantities.size();
+    
+    // Four independent sums: the compiler may not reorder one floating
+    // point sum, but it can keep these in vector lanes
+    double sums[4] = {0.0, 0.0, 0.0, 0.0};
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        sums[0] += quantities[i] * prices[i];
+        sums[1] += quantities[i + 1] * prices[i + 1];
+        sums[2] += quantities[i + 2] * prices[i + 2];
+        sums[3] += quantities[i + 3] * prices[i + 3];
+    }
+    for (; i < count; ++i) {
+        sums[0] += quantities[i] * prices[i];
     }
-    return total;
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
 }
 
 QStringList MaterialModel::getCategories() const
 {
-    QSet<QString> categories;
-    for (const Material &material : m_materials) {
-        if (!material.category.isEmpty()) {
-            categories.insert(material.category);
+    if (m_lazy && m_databaseManager && m_databaseManager->isConnected()) {
+        // Most categories may not have been fetched yet
+        QStringList categories;
+        CachedQuery query = m_databaseManager->executeCached(
+            "SELECT DISTINCT category FROM materials WHERE IFNULL(category, '') <> '' ORDER BY category");
+        while (query->next()) {
+            categories << query->value(0).toString();
         }
+        return categories;
+    }
+    
+    // Mark the interned ids in use, then name them
+    QList<bool> used(m_terms.size(), false);
+    for (const SearchKey &key : m_searchKeys) {
+        used[key.categoryId] = true;
     }
     
-    QStringList sortedCategories = QStringList(categories.begin(), categories.end());
+    QStringList sortedCategories;
+    for (int id = 0; id < used.size(); ++id) {
+        if (used.at(id) && !m_terms.at(id).isEmpty()) {
+            sortedCategories.append(m_terms.at(id));
+        }
+    }
     sortedCategories.sort();
     return sortedCategories;
 }
@@ -887,47 +1117,141 @@ void MaterialModel::refresh()
     loadFromDatabase();
 }
 
-void MaterialModel::filterMaterials()
+void MaterialModel::setMaterials(QList<Material> materials)
 {
-    beginResetModel();
+    // Rows handed over in full leave nothing to fetch
+    m_lazy = false;
+    m_lazyHasMore = false;
+    sortMaterials(materials);
     
-    m_filteredMaterials.clear();
+    beginResetModel();
+    m_materials = std::move(materials);
+    rebuildColumns();
+    if (!m_stockAlerts->isWatchingDatabase()) {
+        m_stockAlerts->resetMaterials(m_materials);
+    }
+    m_appliedSearch = m_nameFilter.toCaseFolded();
     
-    for (const Material &material : m_materials) {
-        if (matchesFilter(material)) {
-            m_filteredMaterials.append(material);
+    m_visibleRows.clear();
+    for (int i = 0; i < m_searchKeys.size(); ++i) {
+        if (matchesFilter(m_searchKeys.at(i))) {
+            m_visibleRows.append(i);
         }
     }
-    
     endResetModel();
 }
 
-bool MaterialModel::matchesFilter(const Material &material) const
+void MaterialModel::filterMaterials()
 {
-    // Name filter
-    if (!m_nameFilter.isEmpty()) {
-        bool nameMatch = material.name.contains(m_nameFilter, Qt::CaseInsensitive) ||
-                        material.description.contains(m_nameFilter, Qt::CaseInsensitive);
-        if (!nameMatch) {
-            return false;
-        }
+    if (m_lazy) {
+        restartLazyLoad();
+        return;
     }
     
-    // Category filter
-    if (!m_categoryFilter.isEmpty() && m_categoryFilter != "All") {
-        if (material.category != m_categoryFilter) {
-            return false;
-        }
+    const QString search = m_nameFilter.toCaseFolded();
+    const int categoryId = filterTermId(m_categoryFilter);
+    const int statusId = filterTermId(m_statusFilter);
+    
+    // With the same category and status, a search containing the previous
+    // one can only match rows that are shown already
+    const bool narrows = categoryId == m_appliedCategoryId && statusId == m_appliedStatusId
+                         && search.contains(m_appliedSearch);
+    if (narrows && search == m_appliedSearch) {
+        return;
     }
     
-    // Status filter
-    if (!m_statusFilter.isEmpty() && m_statusFilter != "All") {
-        if (material.status != m_statusFilter) {
-            return false;
+    beginResetModel();
+    m_appliedSearch = search;
+    m_appliedCategoryId = categoryId;
+    m_appliedStatusId = statusId;
+    
+    if (narrows) {
+        m_visibleRows.removeIf([this](int materialIndex) {
+            return !matchesFilter(m_searchKeys.at(materialIndex));
+        });
+    } else {
+        m_visibleRows.clear();
+        for (int i = 0; i < m_searchKeys.size(); ++i) {
+            if (matchesFilter(m_searchKeys.at(i))) {
+                m_visibleRows.append(i);
+            }
         }
     }
+    endResetModel();
+}
+
+void MaterialModel::rebuildColumns()
+{
+    m_termIds.clear();
+    m_terms.clear();
+    m_searchKeys.clear();
+    m_quantities.clear();
+    m_prices.clear();
+    m_displayValues.clear();
     
-    return true;
+    m_searchKeys.reserve(m_materials.size());
+    m_quantities.reserve(m_materials.size());
+    m_prices.reserve(m_materials.size());
+    for (const Material &material : std::as_const(m_materials)) {
+        m_searchKeys.append(searchKeyFor(material));
+        m_quantities.append(material.quantity);
+        m_prices.append(material.price);
+    }
+    m_displayValues.resize(m_materials.size());
+    updateFilterTermIds();
+}
+
+MaterialModel::SearchKey MaterialModel::searchKeyFor(const Material &material)
+{
+    SearchKey key;
+    key.text = (material.name + SEARCH_KEY_SEPARATOR + material.description).toCaseFolded();
+    key.categoryId = internTerm(material.category);
+    key.statusId = internTerm(material.status);
+    return key;
+}
+
+bool MaterialModel::matchesFilter(const SearchKey &key) const
+{
+    if (m_appliedCategoryId != ANY_TERM && key.categoryId != m_appliedCategoryId) {
+        return false;
+    }
+    if (m_appliedStatusId != ANY_TERM && key.statusId != m_appliedStatusId) {
+        return false;
+    }
+    return m_appliedSearch.isEmpty() || key.text.contains(m_appliedSearch);
+}
+
+int MaterialModel::internTerm(const QString &term)
+{
+    auto it = m_termIds.constFind(term);
+    if (it != m_termIds.constEnd()) {
+        return it.value();
+    }
+    
+    const int id = m_terms.size();
+    m_termIds.insert(term, id);
+    m_terms.append(term);
+    return id;
+}
+
+int MaterialModel::filterTermId(const QString &filter) const
+{
+    if (isAnyTerm(filter)) {
+        return ANY_TERM;
+    }
+    return m_termIds.value(filter, UNKNOWN_TERM);
+}
+
+void MaterialModel::updateFilterTermIds()
+{
+    // A category or status first seen after the filter was set gets its id now
+    m_appliedCategoryId = filterTermId(m_categoryFilter);
+    m_appliedStatusId = filterTermId(m_statusFilter);
+}
+
+const Material &MaterialModel::materialAt(int row) const
+{
+    return m_materials.at(m_visibleRows.at(row));
 }
 
 int MaterialModel::getNextId() const
@@ -940,3 +1264,391 @@ int MaterialModel::getNextId() const
     }
     return maxId + 1;
 }
+
+Material MaterialModel::materialFromRecord(const QSqlRecord &record)
+{
+    Material material;
+    material.id = record.value("id").toInt();
+    material.name = record.value("name").toString();
+    material.description = record.value("description").toString();
+    material.category = record.value("category").toString();
+    material.quantity = record.value("quantity").toInt();
+    material.unit = record.value("unit").toString();
+    material.price = record.value("price").toDouble();
+    material.supplierId = record.value("supplier_id").toInt();
+    material.barcode = record.value("barcode").toString();
+    material.location = record.value("location").toString();
+    material.minimumStock = record.value("minimum_stock").toInt();
+    material.maximumStock = record.value("maximum_stock").toInt();
+    material.reorderPoint = record.value("reorder_point").toInt();
+    material.status = record.value("status").toString();
+    material.createdAt = record.value("created_at").toDateTime();
+    material.updatedAt = record.value("updated_at").toDateTime();
+    material.createdBy = record.value("created_by").toString();
+    material.updatedBy = record.value("updated_by").toString();
+    return material;
+}
+
+QList<Material> MaterialModel::materialsFromRowSet(const DatabaseRowSet &rows)
+{
+    // One QString per distinct value; the copy read from each row is freed
+    // straight away instead of living on in the model
+    QSet<QString> sharedStrings;
+    auto share = [&sharedStrings](QString &field) {
+        field = *sharedStrings.insert(field);
+    };
+    
+    QList<Material> materials;
+    materials.reserve(rows.rowCount());
+    for (int row = 0; row < rows.rowCount(); ++row) {
+        Material material = materialFromRecord(rows.record(row));
+        share(material.category);
+        share(material.unit);
+        share(material.location);
+        share(material.status);
+        share(material.createdBy);
+        share(material.updatedBy);
+        materials.append(std::move(material));
+    }
+    return materials;
+}
+
+void MaterialModel::insertMaterialRow(const Material &material)
+{
+    // With a database the monitor follows the committed rows itself
+    if (!m_stockAlerts->isWatchingDatabase()) {
+        m_stockAlerts->updateMaterial(material);
+    }
+    
+    if (m_lazy) {
+        // Its place among rows not fetched yet is unknown; it shows up on
+        // the next reload
+        bool ok = false;
+        const int count = countMatchingMaterials(&ok);
+        if (ok && count != m_matchingCount) {
+            m_matchingCount = count;
+            emit matchingCountChanged(m_matchingCount);
+        }
+        return;
+    }
+    
+    const int position = std::lower_bound(m_materials.cbegin(), m_materials.cend(), material, displayOrderLess)
+                         - m_materials.cbegin();
+    const SearchKey key = searchKeyFor(material);
+    updateFilterTermIds();
+    
+    // Visible rows from the insertion point on now refer one entry further
+    const int row = std::lower_bound(m_visibleRows.cbegin(), m_visibleRows.cend(), position)
+                    - m_visibleRows.cbegin();
+    const bool visible = matchesFilter(key);
+    
+    if (visible) {
+        beginInsertRows(QModelIndex(), row, row);
+    }
+    insertColumns(position, material, key);
+    for (int i = row; i < m_visibleRows.size(); ++i) {
+        ++m_visibleRows[i];
+    }
+    if (visible) {
+        m_visibleRows.insert(row, position);
+        endInsertRows();
+    }
+}
+
+void MaterialModel::removeMaterialRow(const Material &material)
+{
+    if (!m_stockAlerts->isWatchingDatabase()) {
+        m_stockAlerts->removeMaterial(material.id);
+    }
+    
+    if (m_lazy) {
+        // Fetched rows are all shown, in the order SQL returned them
+        const int row = m_materials.indexOf(material);
+        if (row < 0) {
+            return;
+        }
+        beginRemoveRows(QModelIndex(), row, row);
+        removeColumns(row);
+        m_visibleRows.removeLast();
+        endRemoveRows();
+        
+        m_matchingCount = qMax(0, m_matchingCount - 1);
+        emit matchingCountChanged(m_matchingCount);
+        return;
+    }
+    
+    const int position = indexOfMaterial(m_materials, material);
+    if (position < 0) {
+        return;
+    }
+    
+    const int row = visibleRowOf(position);
+    if (row >= 0) {
+        beginRemoveRows(QModelIndex(), row, row);
+        m_visibleRows.removeAt(row);
+    }
+    removeColumns(position);
+    
+    const int firstShifted = std::lower_bound(m_visibleRows.cbegin(), m_visibleRows.cend(), position)
+                             - m_visibleRows.cbegin();
+    for (int i = firstShifted; i < m_visibleRows.size(); ++i) {
+        --m_visibleRows[i];
+    }
+    if (row >= 0) {
+        endRemoveRows();
+    }
+}
+
+void MaterialModel::replaceMaterialRow(const Material &oldMaterial, const Material &material)
+{
+    if (!m_stockAlerts->isWatchingDatabase()) {
+        m_stockAlerts->updateMaterial(material);
+    }
+    
+    if (m_lazy) {
+        // Stays where it is until the next reload, even when it no longer
+        // sorts or filters there
+        const int row = m_materials.indexOf(oldMaterial);
+        if (row < 0) {
+            return;
+        }
+        const SearchKey key = searchKeyFor(material);
+        removeColumns(row);
+        insertColumns(row, material, key);
+        emit QAbstractTableModel::dataChanged(index(row, 0), index(row, ColumnCount - 1));
+        return;
+    }
+    
+    const int from = indexOfMaterial(m_materials, oldMaterial);
+    if (from < 0) {
+        insertMaterialRow(material);
+        return;
+    }
+    
+    // Where the material goes, counted with it still at its old place
+    const int before = std::lower_bound(m_materials.cbegin(), m_materials.cend(), material, displayOrderLess)
+                       - m_materials.cbegin();
+    const int to = before > from ? before - 1 : before;
+    
+    const SearchKey key = searchKeyFor(material);
+    updateFilterTermIds();
+    
+    const int oldRow = visibleRowOf(from);
+    const bool visible = matchesFilter(key);
+    int newRow = std::lower_bound(m_visibleRows.cbegin(), m_visibleRows.cend(), before) - m_visibleRows.cbegin();
+    if (oldRow >= 0 && oldRow < newRow) {
+        --newRow;
+    }
+    
+    const bool moved = oldRow >= 0 && visible && newRow != oldRow;
+    if (moved) {
+        beginMoveRows(QModelIndex(), oldRow, oldRow, QModelIndex(), newRow > oldRow ? newRow + 1 : newRow);
+    } else if (oldRow >= 0 && !visible) {
+        beginRemoveRows(QModelIndex(), oldRow, oldRow);
+    } else if (oldRow < 0 && visible) {
+        beginInsertRows(QModelIndex(), newRow, newRow);
+    }
+    
+    removeColumns(from);
+    insertColumns(to, material, key);
+    
+    // Entries between the old and the new place slide over by one
+    if (oldRow >= 0) {
+        m_visibleRows.removeAt(oldRow);
+    }
+    if (from != to) {
+        const int low = std::min(from, to);
+        const int high = std::max(from, to);
+        const int step = to > from ? -1 : 1;
+        for (int i = std::lower_bound(m_visibleRows.cbegin(), m_visibleRows.cend(), low) - m_visibleRows.cbegin();
+             i < m_visibleRows.size() && m_visibleRows.at(i) <= high; ++i) {
+            m_visibleRows[i] += step;
+        }
+    }
+    if (visible) {
+        m_visibleRows.insert(newRow, to);
+    }
+    
+    if (moved) {
+        endMoveRows();
+    } else if (oldRow >= 0 && !visible) {
+        endRemoveRows();
+    } else if (oldRow < 0 && visible) {
+        endInsertRows();
+    }
+    
+    if (visible) {
+        emit QAbstractTableModel::dataChanged(index(newRow, 0), index(newRow, ColumnCount - 1));
+    }
+}
+
+void MaterialModel::restartLazyLoad()
+{
+    beginResetModel();
+    m_materials.clear();
+    rebuildColumns();
+    m_visibleRows.clear();
+    m_appliedSearch = m_nameFilter.toCaseFolded();
+    m_continuationToken.clear();
+    m_lazyHasMore = m_databaseManager && m_databaseManager->isConnected();
+    endResetModel();
+    
+    bool ok = false;
+    const int count = countMatchingMaterials(&ok);
+    m_matchingCount = ok ? count : 0;
+    emit matchingCountChanged(m_matchingCount);
+    
+    // The first chunk, so the view has rows before it asks for more
+    fetchMore(QModelIndex());
+}
+
+void MaterialModel::appendMaterialRows(const QList<Material> &materials)
+{
+    if (materials.isEmpty()) {
+        return;
+    }
+    
+    beginInsertRows(QModelIndex(), m_visibleRows.size(), m_visibleRows.size() + materials.size() - 1);
+    for (Material material : materials) {
+        const SearchKey key = searchKeyFor(material);
+        // Rows of all chunks share the interned category and status
+        material.category = m_terms.at(key.categoryId);
+        material.status = m_terms.at(key.statusId);
+        
+        insertColumns(m_materials.size(), material, key);
+        m_visibleRows.append(m_materials.size() - 1);
+    }
+    endInsertRows();
+}
+
+QString MaterialModel::lazyCondition(QVariantList *params) const
+{
+    // Same filters as matchesFilter(), except that LIKE folds the case of
+    // ASCII letters only
+    QStringList conditions;
+    if (!m_nameFilter.isEmpty()) {
+        const QString pattern = containsPattern(m_nameFilter);
+        conditions << "(name LIKE ? ESCAPE '\\' OR IFNULL(description, '') LIKE ? ESCAPE '\\')";
+        *params << pattern << pattern;
+    }
+    if (!isAnyTerm(m_categoryFilter)) {
+        conditions << "category = ?";
+        *params << m_categoryFilter;
+    }
+    if (!isAnyTerm(m_statusFilter)) {
+        conditions << "status = ?";
+        *params << m_statusFilter;
+    }
+    return conditions.join(" AND ");
+}
+
+int MaterialModel::countMatchingMaterials(bool *ok) const
+{
+    *ok = false;
+    if (!m_databaseManager || !m_databaseManager->isConnected()) {
+        return 0;
+    }
+    
+    QVariantList params;
+    const QString condition = lazyCondition(&params);
+    QString sql = "SELECT COUNT(*) FROM materials";
+    if (!condition.isEmpty()) {
+        sql += " WHERE " + condition;
+    }
+    
+    CachedQuery query = m_databaseManager->executeCached(sql, params);
+    if (!query->next()) {
+        qWarning() << "MaterialModel: counting materials failed:" << query->lastError().text();
+        return 0;
+    }
+    const int count = query->value(0).toInt();
+    *ok = true;
+    return count;
+}
+
+void MaterialModel::insertColumns(int position, const Material &material, const SearchKey &key)
+{
+    m_materials.insert(position, material);
+    m_searchKeys.insert(position, key);
+    m_quantities.insert(position, material.quantity);
+    m_prices.insert(position, material.price);
+    m_displayValues.insert(position, DisplayValues());
+}
+
+void MaterialModel::removeColumns(int position)
+{
+    m_materials.removeAt(position);
+    m_searchKeys.removeAt(position);
+    m_quantities.removeAt(position);
+    m_prices.removeAt(position);
+    m_displayValues.removeAt(position);
+}
+
+const MaterialModel::DisplayValues &MaterialModel::displayValuesAt(int row) const
+{
+    const int materialIndex = m_visibleRows.at(row);
+    DisplayValues &values = m_displayValues[materialIndex];
+    if (values.valid) {
+        return values;
+    }
+    
+    const Material &material = m_materials.at(materialIndex);
+    values.priceText = QString("$%1").arg(material.price, 0, 'f', 2);
+    values.lowStock = material.quantity <= material.reorderPoint;
+    if (material.status == "inactive") {
+        values.foreground = INACTIVE_FOREGROUND;
+    } else if (values.lowStock) {
+        values.foreground = LOW_STOCK_FOREGROUND;
+    } else {
+        values.foreground = DEFAULT_FOREGROUND;
+    }
+    values.statusIcon = -1;
+    for (int i = 0; i < int(std::size(ICON_STATUSES)); ++i) {
+        if (material.status == QLatin1String(ICON_STATUSES[i])) {
+            values.statusIcon = statusIcons().at(i).isNull() ? -1 : i;
+            break;
+        }
+    }
+    values.valid = true;
+    return values;
+}
+
+const QList<QIcon> &MaterialModel::statusIcons()
+{
+    // Loaded once; a status whose icon is not in the resources gets none
+    static const QList<QIcon> icons = []() {
+        QList<QIcon> loaded;
+        for (const char *status : ICON_STATUSES) {
+            const QString path = QString(":/icons/status-%1.png").arg(QLatin1String(status));
+            loaded.append(QFile::exists(path) ? QIcon(path) : QIcon());
+        }
+        return loaded;
+    }();
+    return icons;
+}
+
+int MaterialModel::visibleRowOf(int materialIndex) const
+{
+    const auto position = std::lower_bound(m_visibleRows.cbegin(), m_visibleRows.cend(), materialIndex);
+    if (position != m_visibleRows.cend() && *position == materialIndex) {
+        return position - m_visibleRows.cbegin();
+    }
+    return -1;
+}
+
+void MaterialModel::sortMaterials(QList<Material> &materials)
+{
+    // Rows from the database normally arrive in this order already
+    if (!std::is_sorted(materials.cbegin(), materials.cend(), displayOrderLess)) {
+        std::sort(materials.begin(), materials.end(), displayOrderLess);
+    }
+}
+
+int MaterialModel::indexOfMaterial(const QList<Material> &materials, const Material &material)
+{
+    const auto position = std::lower_bound(materials.cbegin(), materials.cend(), material, displayOrderLess);
+    if (position != materials.cend() && position->id == material.id) {
+        return position - materials.cbegin();
+    }
+    return -1;
+}
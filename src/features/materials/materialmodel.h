@@ -4,34 +4,48 @@
 #include <QAbstractTableModel>
 #include <QDate>
 #include <QVariant>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QColor>
+#include <QIcon>
+#include "../../database/keysetpagination.h"
 
 /**
  * @brief Material data structure
+ *
+ * Fields are grouped by size so the struct carries no padding. The
+ * low-cardinality strings of materials loaded together share one QString
+ * per distinct value (see MaterialModel::materialsFromRowSet), so a row
+ * only owns its name, description and barcode.
  */
 struct Material
 {
-    int id;
     QString name;
     QString description;
+    QString barcode;
+    
+    // Shared between rows
     QString category;
-    int quantity;
     QString unit;
+    QString location;
+    QString status; // active, inactive, discontinued
+    QString createdBy;
+    QString updatedBy;
+    
+    QDateTime createdAt;
+    QDateTime updatedAt;
     double price;
+    
+    int id;
+    int quantity;
     int supplierId;
-    QString barcode;
-    QString location;
     int minimumStock;
     int maximumStock;
     int reorderPoint;
-    QDateTime createdAt;
-    QDateTime updatedAt;
-    QString createdBy;
-    QString updatedBy;
-    QString status; // active, inactive, discontinued
-      Material() 
-        : id(0), quantity(0), price(0.0), supplierId(0)
-        , minimumStock(0), maximumStock(1000), reorderPoint(10)
-        , status("active") {}
+    
+    Material()
+        : status("active"), price(0.0), id(0), quantity(0), supplierId(0)
+        , minimumStock(0), maximumStock(1000), reorderPoint(10) {}
     
     // Equality operator for QList operations
     bool operator==(const Material &other) const {
@@ -61,6 +75,7 @@ public:
     };
 
     explicit MaterialModel(QObject *parent = nullptr);
+    ~MaterialModel();
     
     // QAbstractTableModel interface
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -71,11 +86,18 @@ public:
     
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
-      // Custom methods
-    bool addMaterial(const Material &material);
+    
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+      // Custom methods - each writes one row to the database and updates
+    // only the affected model row; rows stay ordered by name, then id
+    bool addMaterial(const Material &material, int *materialId = nullptr);
     void removeMaterial(int row);
     bool updateMaterial(int row, const Material &material);
     Material getMaterial(int row) const;
+    const Material &materialAt(int row) const; // row must be valid; no copy
+    int rowForId(int materialId) const; // -1 when filtered out or unknown
     int getNextId() const;
       // Database operations
     bool loadFromDatabase();
@@ -84,21 +106,51 @@ public:
     void loadSampleData();
     
     // Real-time database operations
-    bool addMaterialToDatabase(const Material &material);
+    bool addMaterialToDatabase(const Material &material, int *insertedId = nullptr);
     bool updateMaterialInDatabase(const Material &material);
     bool deleteMaterialFromDatabase(int materialId);
     bool loadMaterialsFromDatabase();
     void loadSampleMaterialsData();
     
+    // Background loading - the query runs on the database worker thread
+    // and the model is swapped in on the GUI thread
+    QList<Material> fetchMaterialsFromDatabase(bool *ok = nullptr) const;
+    void loadFromDatabaseAsync();
+    bool isLoading() const;
+    
+    // Lazy loading - rows are read LAZY_CHUNK_SIZE at a time as the view
+    // scrolls, and filters and sort() run in SQL. Turned on by
+    // setDatabaseManager() for catalogues above LAZY_LOAD_THRESHOLD rows.
+    // Added rows appear on the next reload; edited rows keep their place.
+    static const int LAZY_CHUNK_SIZE;
+    static const int LAZY_LOAD_THRESHOLD;
+    void setLazyLoading(bool lazy);
+    bool isLazyLoading() const;
+    int matchingCount() const; // materials passing the filters, fetched or not
+    
+    // One keyset page straight from the database, independent of the
+    // loaded model. Sort keys: name (default), category, quantity, price, updated_at
+    Page<Material> fetchMaterialsPage(const PageRequest &request) const;
+    
+    // Materials from the rows of a SELECT * FROM materials; their
+    // low-cardinality strings are shared
+    static QList<Material> materialsFromRowSet(const struct DatabaseRowSet &rows);
+    
     // Database connection
     void setDatabaseManager(class DatabaseManager *dbManager);
     
+    // Materials at or below their reorder point, kept up to date as they change
+    class StockAlertMonitor *stockAlerts() const;
+    
     // Search and filter
     void setFilter(const QString &filter);
     void setCategoryFilter(const QString &category);
     void setStatusFilter(const QString &status);
     
     // Statistics
+    // Computed over all materials from the numeric columns; in lazy mode
+    // over the fetched ones, except for the categories and the low stock
+    // count, which comes from stockAlerts()
     int getTotalMaterials() const;
     int getLowStockCount() const;
     double getTotalValue() const;
@@ -109,20 +161,92 @@ public slots:
 
 signals:
     void dataRefreshed();
+    void loadingStarted();
     void materialAdded(const Material &material);
     void materialRemoved(int id);
     void materialUpdated(const Material &material);
+    void matchingCountChanged(int count);
 
 private:
+    // Filter keys of one material, parallel to m_materials. Category and
+    // status are interned so filtering compares integers.
+    struct SearchKey {
+        QString text;       // name and description, case-folded
+        int categoryId;
+        int statusId;
+    };
+    
+    // What data() shows for one material beyond its plain fields, worked
+    // out on the row's first paint and dropped when the material changes
+    struct DisplayValues {
+        QString priceText;
+        QColor foreground;
+        int statusIcon = -1;    // index into statusIcons(), -1 for none
+        bool lowStock = false;
+        bool valid = false;
+    };
+    
+    void setMaterials(QList<Material> materials);
     void filterMaterials();
-    bool matchesFilter(const Material &material) const;
-      QList<Material> m_materials;
-    QList<Material> m_filteredMaterials;
+    void rebuildColumns();
+    SearchKey searchKeyFor(const Material &material);
+    bool matchesFilter(const SearchKey &key) const;
+    int internTerm(const QString &term);
+    int filterTermId(const QString &filter) const;
+    void updateFilterTermIds();
+    static Material materialFromRecord(const class QSqlRecord &record);
+    
+    // Incremental updates of m_materials and the visible rows
+    void insertMaterialRow(const Material &material);
+    void removeMaterialRow(const Material &material);
+    void insertColumns(int position, const Material &material, const SearchKey &key);
+    void removeColumns(int position);
+    void replaceMaterialRow(const Material &oldMaterial, const Material &material);
+    int visibleRowOf(int materialIndex) const;
+    const DisplayValues &displayValuesAt(int row) const;
+    static const QList<QIcon> &statusIcons();
+    static void sortMaterials(QList<Material> &materials);
+    
+    // Lazy mode
+    void restartLazyLoad();
+    void appendMaterialRows(const QList<Material> &materials);
+    QString lazyCondition(QVariantList *params) const;
+    int countMatchingMaterials(bool *ok) const;
+    static int indexOfMaterial(const QList<Material> &materials, const Material &material);
+    
+    QList<Material> m_materials;        // ordered by name, then id
+    QList<SearchKey> m_searchKeys;
+    QList<int> m_visibleRows;           // ascending indices into m_materials
+    QHash<QString, int> m_termIds;
+    QStringList m_terms;                // term id to text
+    
+    // Numeric columns parallel to m_materials, so the statistics run as
+    // plain loops over contiguous arrays
+    QList<int> m_quantities;
+    QList<double> m_prices;
+    
+    mutable QList<DisplayValues> m_displayValues;   // parallel to m_materials
+    
     QString m_nameFilter;
     QString m_categoryFilter;
     QString m_statusFilter;
     
+    // Filters the visible rows were computed with
+    QString m_appliedSearch;
+    int m_appliedCategoryId;
+    int m_appliedStatusId;
+    
+    // Lazy mode state; the sort key is one of materialsPagination()'s
+    bool m_lazy;
+    bool m_lazyHasMore;
+    QString m_lazySortKey;
+    Qt::SortOrder m_lazySortOrder;
+    QString m_continuationToken;
+    int m_matchingCount;
+    
     class DatabaseManager *m_databaseManager;
+    QFutureWatcher<QList<Material>> *m_loadWatcher;
+    class StockAlertMonitor *m_stockAlerts;
 };
 
 Q_DECLARE_METATYPE(Material)
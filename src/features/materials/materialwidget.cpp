@@ -1,5 +1,6 @@
 #include "materialwidget.h"
 #include "materialmodel.h"
+#include "stockalertmonitor.h"
 #include "materialdialog.h"
 #include "materialdetailsdialog.h"
 #include "supplierwidget.h"
@@ -9,6 +10,8 @@
 #include "utils/stylemanager.h"
 #include "utils/animationmanager.h"
 #include "utils/environmentloader.h"
+#include "../../database/databasemanager.h"
+#include "../../database/reportsession.h"
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QFileDialog>
@@ -31,6 +34,8 @@
 #include <QFormLayout>
 #include <QCheckBox>
 #include <QScrollArea>
+#include <QProgressDialog>
+#include <QtConcurrent>
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
 #include <QtCharts/QPieSeries>
@@ -42,6 +47,16 @@
 #include <QtCharts/QValueAxis>
 #include <QtCharts/QLegend>
 
+namespace {
+
+// A report's snapshot stays open this long for the export that follows it
+const int REPORT_SNAPSHOT_TIMEOUT_MS = 5 * 60 * 1000;
+
+// Most urgent low stock materials listed in the card's tooltip
+const int LOW_STOCK_TOOLTIP_ITEMS = 5;
+
+} // namespace
+
 MaterialWidget::MaterialWidget(QWidget *parent)
     : QWidget(parent)
     , m_mainLayout(nullptr)
@@ -50,6 +65,7 @@ MaterialWidget::MaterialWidget(QWidget *parent)
     , m_suppliersTab(nullptr)
     , m_model(nullptr)
     , m_proxyModel(nullptr)
+    , m_databaseManager(nullptr)
     , m_groqClient(nullptr)
     , m_aiDialog(nullptr)    , m_aiPredictionDialog(nullptr)
     , m_supplierWidget(nullptr)
@@ -92,6 +108,23 @@ MaterialWidget::MaterialWidget(QWidget *parent)
     m_proxyModel->setSourceModel(m_model);
     qDebug() << "Proxy model source set";
     
+    // A lazily loaded catalogue is sorted in SQL; the proxy only sees the fetched rows
+    connect(m_tableView->horizontalHeader(), &QHeaderView::sortIndicatorChanged, this,
+            [this](int section, Qt::SortOrder order) {
+        if (m_model->isLazyLoading()) {
+            m_model->sort(section, order);
+        }
+    });
+    connect(m_model, &MaterialModel::matchingCountChanged, this, [this](int count) {
+        updateStatCard(m_totalMaterialsCard, QString::number(count));
+    });
+    
+    // Low stock alerts arrive as soon as a change commits, not on refresh
+    connect(m_model->stockAlerts(), &StockAlertMonitor::alertsChanged, this, &MaterialWidget::updateLowStockCard);
+    connect(m_model->stockAlerts(), &StockAlertMonitor::feedChanged, this, &MaterialWidget::updateStockAlertFeed);
+    updateLowStockCard();
+    updateStockAlertFeed();
+    
     qDebug() << "Setting up table selection connections...";
     // Set up table selection connections after model is set
     if (m_tableView && m_tableView->selectionModel()) {
@@ -122,6 +155,15 @@ MaterialWidget::MaterialWidget(QWidget *parent)
     qDebug() << "MaterialWidget constructor completed successfully";
 }
 
+MaterialWidget::~MaterialWidget()
+{
+    // The import's worker posts its progress to this widget
+    if (m_importer) {
+        m_importer->cancel();
+    }
+    m_importFuture.waitForFinished();
+}
+
 void MaterialWidget::setupUI()
 {
     m_mainLayout = new QVBoxLayout(this);
@@ -554,32 +596,55 @@ void MaterialWidget::refreshData()
 {
     qDebug() << "MaterialWidget::refreshData() starting...";
     if (m_model) {
-        qDebug() << "Calling m_model->refresh()...";
-        m_model->refresh();
-        qDebug() << "Model refresh completed";
+        // The model reloads on the database worker thread; filters and
+        // statistics are refreshed once the new rows have been swapped in
+        connect(m_model, &MaterialModel::dataRefreshed, this, &MaterialWidget::onMaterialsLoaded,
+                static_cast<Qt::ConnectionType>(Qt::SingleShotConnection | Qt::UniqueConnection));
         
-        // Update category filter
-        qDebug() << "Updating category filter...";
-        QStringList categories = m_model->getCategories();
-        m_categoryFilter->clear();
-        m_categoryFilter->addItem("All Categories");
-        m_categoryFilter->addItems(categories);
-        qDebug() << "Category filter updated";
-        
-        // Update dashboard statistics when data is refreshed
-        qDebug() << "Updating dashboard stats...";
-        updateDashboardStats();
-        qDebug() << "Dashboard stats updated";
+        qDebug() << "Starting background material load...";
+        m_model->loadFromDatabaseAsync();
     } else {
         qDebug() << "Warning: m_model is null in refreshData()";
     }
     qDebug() << "MaterialWidget::refreshData() completed";
 }
 
+void MaterialWidget::onMaterialsLoaded()
+{
+    const bool lazy = m_model->isLazyLoading();
+    m_tableView->setSortingEnabled(!lazy);
+    if (lazy) {
+        m_proxyModel->sort(-1);
+        m_tableView->horizontalHeader()->setSectionsClickable(true);
+        m_tableView->horizontalHeader()->setSortIndicatorShown(true);
+    }
+    
+    // Update category filter
+    qDebug() << "Updating category filter...";
+    QStringList categories = m_model->getCategories();
+    m_categoryFilter->clear();
+    m_categoryFilter->addItem("All Categories");
+    m_categoryFilter->addItems(categories);
+    qDebug() << "Category filter updated";
+    
+    // Update dashboard statistics when data is refreshed
+    qDebug() << "Updating dashboard stats...";
+    updateDashboardStats();
+    qDebug() << "Dashboard stats updated";
+}
+
 void MaterialWidget::selectMaterial(int materialId)
 {
-    // TODO: Implement material selection by ID
-    Q_UNUSED(materialId)
+    const int row = m_model->rowForId(materialId);
+    if (row < 0) {
+        return;
+    }
+    
+    const QModelIndex proxyIndex = m_proxyModel->mapFromSource(m_model->index(row, 0));
+    if (proxyIndex.isValid()) {
+        m_tableView->scrollTo(proxyIndex);
+        m_tableView->selectRow(proxyIndex.row());
+    }
 }
 
 void MaterialWidget::addMaterial()
@@ -610,13 +675,10 @@ void MaterialWidget::addMaterial()
         material.id = m_model->getNextId();
         material.createdAt = QDateTime::currentDateTime();
         material.updatedAt = QDateTime::currentDateTime();
-          if (m_model->addMaterial(material)) {
-            // Animate the addition
-            if (m_model->rowCount() > 0) {
-                QModelIndex lastIndex = m_proxyModel->index(m_model->rowCount() - 1, 0);
-                m_tableView->scrollTo(lastIndex);
-                m_tableView->selectRow(lastIndex.row());
-            }
+        int materialId = 0;
+        if (m_model->addMaterial(material, &materialId)) {
+            // The new row sits wherever its name sorts
+            selectMaterial(materialId);
             
             // Show success message
             QMessageBox::information(this, "Success", 
@@ -690,6 +752,15 @@ void MaterialWidget::deleteMaterial()
 
 void MaterialWidget::importFromCSV()
 {
+    if (m_importFuture.isRunning()) {
+        QMessageBox::information(this, "Import", "An import is already running.");
+        return;
+    }
+    if (!m_databaseManager || !m_databaseManager->isConnected()) {
+        QMessageBox::warning(this, "Import Error", "Importing materials needs a database connection.");
+        return;
+    }
+    
     QString fileName = QFileDialog::getOpenFileName(this,
                                                    "Import Materials from CSV",
                                                    QString(),
@@ -698,68 +769,90 @@ void MaterialWidget::importFromCSV()
         return;
     }
     
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "Import Error", 
-                           QString("Could not open file: %1").arg(fileName));
-        return;
-    }
+    std::shared_ptr<MaterialCsvImporter> importer = std::make_shared<MaterialCsvImporter>(m_databaseManager);
+    m_importer = importer;
     
-    QTextStream in(&file);
-    QStringList lines = in.readAll().split('\n', Qt::SkipEmptyParts);
+    // Progress in thousandths of the file, so any file size fits the dialog's range
+    m_importProgress = new QProgressDialog("Importing materials...", "Cancel", 0, 1000, this);
+    m_importProgress->setWindowTitle("Import Materials");
+    m_importProgress->setWindowModality(Qt::WindowModal);
+    m_importProgress->setMinimumDuration(500);
+    m_importProgress->setAutoClose(false);
+    m_importProgress->setAutoReset(false);
+    m_importProgress->setAttribute(Qt::WA_DeleteOnClose);
+    connect(m_importProgress, &QProgressDialog::canceled, this, [importer]() {
+        importer->cancel();
+    });
     
-    if (lines.isEmpty()) {
-        QMessageBox::warning(this, "Import Error", "The CSV file is empty.");
-        return;
+    // The destructor waits for the worker, so it may post back to this widget
+    m_importFuture = QtConcurrent::run([this, importer, fileName]() {
+        return importer->importFile(fileName, [this](qint64 bytesRead, qint64 totalBytes, int importedRows) {
+            const int value = totalBytes > 0 ? int(bytesRead * 1000 / totalBytes) : 0;
+            QMetaObject::invokeMethod(this, [this, value, importedRows]() {
+                if (m_importProgress) {
+                    m_importProgress->setValue(value);
+                    m_importProgress->setLabelText(QString("Importing materials... %1 imported").arg(importedRows));
+                }
+            }, Qt::QueuedConnection);
+        });
+    });
+    m_importFuture.then(this, [this](const MaterialImportResult &result) {
+        finishImport(result);
+    });
+}
+
+void MaterialWidget::finishImport(const MaterialImportResult &result)
+{
+    if (m_importProgress) {
+        m_importProgress->close();
     }
+    m_importer.reset();
     
-    // Skip header line if it exists
-    if (!lines.isEmpty() && lines.first().contains("name", Qt::CaseInsensitive)) {
-        lines.removeFirst();
+    // One reload for the whole file
+    if (result.importedRows > 0) {
+        refreshData();
     }
     
-    int imported = 0;
-    int failed = 0;
+    if (!result.isValid()) {
+        QMessageBox::warning(this, "Import Error",
+                             QString("The import stopped: %1\n%2 materials were imported before that.")
+                                 .arg(result.error).arg(result.importedRows));
+        return;
+    }
+    if (!result.canceled && result.importedRows == 0 && result.failedRows == 0) {
+        QMessageBox::warning(this, "Import Error", "The CSV file has no materials.");
+        return;
+    }
     
-    for (const QString &line : lines) {
-        QStringList fields = line.split(',');
-        if (fields.size() < 4) { // Minimum required fields
-            failed++;
-            continue;
-        }
-        
-        Material material;
-        material.id = m_model->getNextId() + imported;
-        material.name = fields[0].trimmed().remove('"');
-        material.description = fields.size() > 1 ? fields[1].trimmed().remove('"') : "";
-        material.category = fields.size() > 2 ? fields[2].trimmed().remove('"') : "General";
-        material.quantity = fields.size() > 3 ? fields[3].trimmed().toInt() : 0;
-        material.unit = fields.size() > 4 ? fields[4].trimmed().remove('"') : "pcs";
-        material.price = fields.size() > 5 ? fields[5].trimmed().toDouble() : 0.0;
-        material.location = fields.size() > 6 ? fields[6].trimmed().remove('"') : "";
-        material.minimumStock = fields.size() > 7 ? fields[7].trimmed().toInt() : 10;
-        material.status = "active";
-        material.createdAt = QDateTime::currentDateTime();
-        material.updatedAt = QDateTime::currentDateTime();
-        material.createdBy = "Import";
-        material.updatedBy = "Import";
-        
-        if (!material.name.isEmpty() && m_model->addMaterial(material)) {
-            imported++;
-        } else {
-            failed++;
-        }    }
+    QString message = QString("Import %1:\n- %2 materials imported\n- %3 failed")
+                     .arg(result.canceled ? "canceled" : "completed")
+                     .arg(result.importedRows).arg(result.failedRows);
     
-    QString message = QString("Import completed:\n- %1 materials imported\n- %2 failed")
-                     .arg(imported).arg(failed);
+    QStringList details;
+    for (auto it = result.failedLines.constBegin(); it != result.failedLines.constEnd() && details.size() < 10; ++it) {
+        details << QString("Line %1: %2").arg(it.key()).arg(it.value());
+    }
+    if (!details.isEmpty()) {
+        message += "\n\n" + details.join('\n');
+    }
     QMessageBox::information(this, "Import Results", message);
 }
 
 void MaterialWidget::exportToCSV()
+{
+    QList<Material> materials;
+    for (int i = 0; i < m_model->rowCount(); ++i) {
+        materials.append(m_model->getMaterial(i));
+    }
+    
+    exportMaterialsToCSV(materials, "materials.csv");
+}
+
+void MaterialWidget::exportMaterialsToCSV(const QList<Material> &materials, const QString &defaultFileName)
 {
     QString fileName = QFileDialog::getSaveFileName(this,
                                                    "Export Materials to CSV",
-                                                   "materials.csv",
+                                                   defaultFileName,
                                                    "CSV Files (*.csv)");
     if (fileName.isEmpty()) {
         return;
@@ -778,8 +871,7 @@ void MaterialWidget::exportToCSV()
     out << "Name,Description,Category,Quantity,Unit,Price,Location,Minimum Stock,Status,Created At\n";
     
     // Write data
-    for (int i = 0; i < m_model->rowCount(); ++i) {
-        Material material = m_model->getMaterial(i);
+    for (const Material &material : materials) {
         out << QString("\"%1\",\"%2\",\"%3\",%4,\"%5\",%6,\"%7\",%8,\"%9\",\"%10\"\n")
                .arg(material.name)
                .arg(material.description)
@@ -795,7 +887,7 @@ void MaterialWidget::exportToCSV()
     
     QMessageBox::information(this, "Export Complete", 
                            QString("Successfully exported %1 materials to %2")
-                           .arg(m_model->rowCount()).arg(fileName));
+                           .arg(materials.size()).arg(fileName));
 }
 
 void MaterialWidget::showMaterialDetails()
@@ -1042,16 +1134,13 @@ void MaterialWidget::addMaterialFromDetail()
     newMaterial.createdBy = "Current User"; // TODO: Get from user session
     newMaterial.updatedBy = "Current User";
     
-    if (m_model->addMaterial(newMaterial)) {
+    int materialId = 0;
+    if (m_model->addMaterial(newMaterial, &materialId)) {
         // Clear form after successful addition
         clearDetailForm();
         
         // Select the newly added material
-        if (m_model->rowCount() > 0) {
-            QModelIndex lastIndex = m_proxyModel->index(m_model->rowCount() - 1, 0);
-            m_tableView->scrollTo(lastIndex);
-            m_tableView->selectRow(lastIndex.row());
-        }
+        selectMaterial(materialId);
         
         QMessageBox::information(this, "Success", 
                                QString("Material '%1' has been added successfully.")
@@ -1574,6 +1663,21 @@ void MaterialWidget::setupDashboard()
     
     dashboardLayout->addWidget(recentActivityWidget);
     
+    // Stock alerts feed - materials crossing their reorder point, newest first
+    QWidget *stockAlertsWidget = new QWidget();
+    QVBoxLayout *stockAlertsLayout = new QVBoxLayout(stockAlertsWidget);
+    
+    QLabel *stockAlertsTitle = new QLabel("Stock Alerts");
+    stockAlertsTitle->setStyleSheet("font-size: 18px; font-weight: bold; color: #2c3e50; margin-bottom: 10px;");
+    stockAlertsLayout->addWidget(stockAlertsTitle);
+    
+    m_stockAlertFeed = new QListWidget();
+    m_stockAlertFeed->setMaximumHeight(200);
+    m_stockAlertFeed->setStyleSheet(m_recentActivityList->styleSheet());
+    stockAlertsLayout->addWidget(m_stockAlertFeed);
+    
+    dashboardLayout->addWidget(stockAlertsWidget);
+    
     // Quick actions section
     QWidget *quickActionsWidget = new QWidget();
     QVBoxLayout *quickActionsLayout = new QVBoxLayout(quickActionsWidget);
@@ -1778,7 +1882,6 @@ void MaterialWidget::updateDashboardStats()
     qDebug() << "MaterialWidget::updateDashboardStats() - Starting stats update";
     
     int totalMaterials = m_model->rowCount();
-    int lowStockCount = 0;
     double totalValue = 0.0;
     QSet<QString> categories;
     
@@ -1788,37 +1891,11 @@ void MaterialWidget::updateDashboardStats()
     QMap<QString, int> materialQuantities;
     
     for (int row = 0; row < totalMaterials; ++row) {
-        // Get quantity and check for low stock
-        QModelIndex quantityIndex = m_model->index(row, 4); // QuantityColumn = 4
-        int quantity = m_model->data(quantityIndex).toInt();
-          // Calculate total value (price * quantity)
-        // Use Qt::UserRole to get the raw Material object, then access price directly
-        QModelIndex materialIndex = m_model->index(row, 0);
-        QVariant materialVariant = m_model->data(materialIndex, Qt::UserRole);
-        
-        double price = 0.0;
-        QString materialName;
-        if (materialVariant.isValid()) {
-            Material material = materialVariant.value<Material>();
-            price = material.price;
-            materialName = material.name;
-        } else {
-            // Fallback: try to parse the formatted price string
-            QModelIndex priceIndex = m_model->index(row, 6); // PriceColumn = 6
-            QString priceStr = m_model->data(priceIndex).toString();
-            // Remove currency symbol and parse
-            priceStr.remove('$').remove(',');
-            price = priceStr.toDouble();
-            
-            QModelIndex nameIndex = m_model->index(row, 1);
-            materialName = m_model->data(nameIndex).toString();
-        }
-        
-        qDebug() << "Row" << row << "- Quantity:" << quantity << "Price:" << price;
-        
-        if (quantity < 10) { // Arbitrary low stock threshold
-            lowStockCount++;
-        }
+        // Read the row's material in place instead of formatting and parsing cells
+        const Material &material = m_model->materialAt(row);
+        const int quantity = material.quantity;
+        const double price = material.price;
+        const QString &materialName = material.name;
         
         totalValue += price * quantity;
         totalInventoryCost += price * quantity;
@@ -1826,10 +1903,8 @@ void MaterialWidget::updateDashboardStats()
         materialQuantities[materialName] = quantity;
         
         // Collect categories
-        QModelIndex categoryIndex = m_model->index(row, 3); // CategoryColumn = 3
-        QString category = m_model->data(categoryIndex).toString();
-        if (!category.isEmpty()) {
-            categories.insert(category);
+        if (!material.category.isEmpty()) {
+            categories.insert(material.category);
         }
     }
     
@@ -1852,11 +1927,11 @@ void MaterialWidget::updateDashboardStats()
             leastStocked = it.key();
         }
     }
-      qDebug() << "Final stats - Total Value:" << totalValue << "Low Stock:" << lowStockCount << "Categories:" << categories.size();
+      qDebug() << "Final stats - Total Value:" << totalValue << "Categories:" << categories.size();
     
     // Update stat cards
-    updateStatCard(m_totalMaterialsCard, QString::number(totalMaterials));
-    updateStatCard(m_lowStockCard, QString::number(lowStockCount));
+    updateStatCard(m_totalMaterialsCard, QString::number(m_model->matchingCount()));
+    updateLowStockCard();
     updateStatCard(m_totalValueCard, QString("$%L1").arg(totalValue, 0, 'f', 2));
     updateStatCard(m_categoriesCard, QString::number(categories.size()));
     
@@ -1882,6 +1957,44 @@ void MaterialWidget::updateStatCard(QWidget *card, const QString &newValue)
     }
 }
 
+void MaterialWidget::updateLowStockCard()
+{
+    if (!m_lowStockCard || !m_model) return;
+    
+    const StockAlertMonitor *alerts = m_model->stockAlerts();
+    updateStatCard(m_lowStockCard, QString::number(alerts->count()));
+    
+    QStringList lines;
+    for (const StockAlert &alert : alerts->alerts(LOW_STOCK_TOOLTIP_ITEMS)) {
+        lines << QString("%1: %2 %3 (reorder at %4)")
+                     .arg(alert.name).arg(alert.quantity).arg(alert.unit).arg(alert.reorderPoint);
+    }
+    if (alerts->count() > lines.size()) {
+        lines << QString("and %1 more").arg(alerts->count() - lines.size());
+    }
+    m_lowStockCard->setToolTip(lines.isEmpty() ? QString("No materials at or below their reorder point")
+                                               : lines.join('\n'));
+}
+
+void MaterialWidget::updateStockAlertFeed()
+{
+    if (!m_stockAlertFeed || !m_model) return;
+    
+    m_stockAlertFeed->clear();
+    const QList<StockAlertEvent> events = m_model->stockAlerts()->feed();
+    for (const StockAlertEvent &event : events) {
+        const StockAlert &alert = event.alert;
+        const QString text = event.kind == StockAlertEvent::Raised
+            ? QString("Low stock: '%1' down to %2 %3 (reorder at %4)")
+                  .arg(alert.name).arg(alert.quantity).arg(alert.unit).arg(alert.reorderPoint)
+            : QString("Alert cleared: '%1' at %2 %3").arg(alert.name).arg(alert.quantity).arg(alert.unit);
+        
+        QListWidgetItem *item = new QListWidgetItem(QString("%1  %2").arg(event.time.toString("hh:mm"), text));
+        item->setForeground(event.kind == StockAlertEvent::Raised ? QColor("#e74c3c") : QColor("#27ae60"));
+        m_stockAlertFeed->addItem(item);
+    }
+}
+
 void MaterialWidget::updateRecentActivity()
 {
     if (!m_recentActivityList) return;
@@ -2047,24 +2160,14 @@ void MaterialWidget::updateCharts()
     QStringList categories;
     
     for (int row = 0; row < m_model->rowCount(); ++row) {
-        QModelIndex materialIndex = m_model->index(row, 0);
-        QVariant materialData = m_model->data(materialIndex, Qt::UserRole);
+        const Material &material = m_model->materialAt(row);
         
-        if (materialData.canConvert<Material>()) {
-            Material material = materialData.value<Material>();
-            
-            qDebug() << "Processing material:" << material.name << "Category:" << material.category 
-                     << "Quantity:" << material.quantity << "Price:" << material.price;
-            
-            // Accumulate data by category
-            categoryQuantities[material.category] += material.quantity;
-            categoryValues[material.category] += material.price * material.quantity;
-            
-            if (!categories.contains(material.category)) {
-                categories.append(material.category);
-            }
-        } else {
-            qDebug() << "Row" << row << "doesn't contain valid Material data";
+        // Accumulate data by category
+        categoryQuantities[material.category] += material.quantity;
+        categoryValues[material.category] += material.price * material.quantity;
+        
+        if (!categories.contains(material.category)) {
+            categories.append(material.category);
         }
     }
     
@@ -2479,14 +2582,61 @@ void MaterialWidget::setupSettingsWidget()
 // Report generation methods
 void MaterialWidget::generateInventoryReport()
 {
-    QMessageBox::information(this, "Inventory Report", 
-        "Generating comprehensive inventory summary report...\n\n"
-        "This report will include:\n"
-        "• Complete materials listing\n"
-        "• Stock levels and values\n"
-        "• Category breakdown\n"
-        "• Supplier information\n\n"
-        "Report generation functionality will be implemented based on your requirements.");
+    if (!beginReportSession()) {
+        QMessageBox::warning(this, "Error", "No database connection available.");
+        return;
+    }
+    
+    const DatabaseRowSet summary = m_reportSession->fetchRows(
+        "SELECT COUNT(*), TOTAL(quantity), TOTAL(quantity * price), COUNT(DISTINCT category), "
+        "TOTAL(quantity <= reorder_point) FROM materials");
+    const DatabaseRowSet categories = m_reportSession->fetchRows(
+        "SELECT category, COUNT(*), TOTAL(quantity), TOTAL(quantity * price) "
+        "FROM materials GROUP BY category ORDER BY category");
+    
+    if (!summary.isValid() || !categories.isValid()) {
+        QMessageBox::warning(this, "Error", "Could not read the inventory: " + m_reportSession->lastError());
+        return;
+    }
+    
+    QString reportContent = "INVENTORY SUMMARY REPORT\n";
+    reportContent += "Generated: " + m_reportSession->snapshotTime().toLocalTime().toString("yyyy-MM-dd hh:mm:ss") + "\n\n";
+    
+    reportContent += QString("Total Materials: %1\n").arg(summary.value(0, 0).toInt());
+    reportContent += QString("Total Quantity: %1\n").arg(summary.value(0, 1).toLongLong());
+    reportContent += QString("Total Inventory Value: $%1\n").arg(summary.value(0, 2).toDouble(), 0, 'f', 2);
+    reportContent += QString("Categories: %1\n").arg(summary.value(0, 3).toInt());
+    reportContent += QString("At or Below Reorder Point: %1\n\n").arg(summary.value(0, 4).toInt());
+    
+    reportContent += "BY CATEGORY:\n";
+    for (int row = 0; row < categories.rowCount(); ++row) {
+        reportContent += QString("• %1: %2 materials, %3 units, $%4\n")
+            .arg(categories.value(row, 0).toString())
+            .arg(categories.value(row, 1).toInt())
+            .arg(categories.value(row, 2).toLongLong())
+            .arg(categories.value(row, 3).toDouble(), 0, 'f', 2);
+    }
+    
+    // Display report
+    QDialog reportDialog(this);
+    reportDialog.setWindowTitle("Inventory Summary Report");
+    reportDialog.resize(500, 400);
+    
+    QVBoxLayout *layout = new QVBoxLayout(&reportDialog);
+    QTextEdit *textEdit = new QTextEdit();
+    textEdit->setPlainText(reportContent);
+    textEdit->setReadOnly(true);
+    
+    QPushButton *exportBtn = new QPushButton("Export CSV");
+    connect(exportBtn, &QPushButton::clicked, this, &MaterialWidget::exportReportToCSV);
+    QPushButton *closeBtn = new QPushButton("Close");
+    connect(closeBtn, &QPushButton::clicked, &reportDialog, &QDialog::accept);
+    
+    layout->addWidget(textEdit);
+    layout->addWidget(exportBtn);
+    layout->addWidget(closeBtn);
+    
+    reportDialog.exec();
 }
 
 void MaterialWidget::generateLowStockReport()
@@ -2499,28 +2649,14 @@ void MaterialWidget::generateLowStockReport()
     QString reportContent = "LOW STOCK ALERT REPORT\n";
     reportContent += "Generated: " + QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss") + "\n\n";
     
-    bool foundLowStock = false;
-    int rowCount = m_model->rowCount();
-    
-    for (int row = 0; row < rowCount; ++row) {
-        QModelIndex nameIndex = m_model->index(row, 1);
-        QModelIndex quantityIndex = m_model->index(row, 3);
-        QModelIndex reorderIndex = m_model->index(row, 6);
-        
-        if (nameIndex.isValid() && quantityIndex.isValid() && reorderIndex.isValid()) {
-            QString name = m_model->data(nameIndex).toString();
-            int quantity = m_model->data(quantityIndex).toInt();
-            int reorderPoint = m_model->data(reorderIndex).toInt();
-            
-            if (quantity <= reorderPoint) {
-                foundLowStock = true;
-                reportContent += QString("⚠️ %1: %2 units (Reorder at: %3)\n")
-                    .arg(name).arg(quantity).arg(reorderPoint);
-            }
-        }
+    // Every material at or below its reorder point, the most urgent first
+    const QList<StockAlert> alerts = m_model->stockAlerts()->alerts();
+    for (const StockAlert &alert : alerts) {
+        reportContent += QString("⚠️ %1: %2 units (Reorder at: %3)\n")
+            .arg(alert.name).arg(alert.quantity).arg(alert.reorderPoint);
     }
     
-    if (!foundLowStock) {
+    if (alerts.isEmpty()) {
         reportContent += "✅ No items are currently at or below reorder points.\n";
     }
     
@@ -2556,25 +2692,38 @@ void MaterialWidget::generateValueReport()
     double totalValue = 0.0;
     int totalItems = 0;
     QMap<QString, double> categoryValues;
-    int rowCount = m_model->rowCount();
     
-    for (int row = 0; row < rowCount; ++row) {
-        QModelIndex nameIndex = m_model->index(row, 1);
-        QModelIndex categoryIndex = m_model->index(row, 2);
-        QModelIndex quantityIndex = m_model->index(row, 3);
-        QModelIndex priceIndex = m_model->index(row, 5);
+    if (beginReportSession()) {
+        // Category totals from the snapshot the CSV export will also read
+        const DatabaseRowSet rows = m_reportSession->fetchRows(
+            "SELECT category, TOTAL(quantity), TOTAL(quantity * price) FROM materials GROUP BY category");
+        for (int row = 0; row < rows.rowCount(); ++row) {
+            const double categoryValue = rows.value(row, 2).toDouble();
+            totalItems += rows.value(row, 1).toInt();
+            totalValue += categoryValue;
+            categoryValues[rows.value(row, 0).toString()] += categoryValue;
+        }
+    } else {
+        int rowCount = m_model->rowCount();
+    
+        for (int row = 0; row < rowCount; ++row) {
+            QModelIndex nameIndex = m_model->index(row, 1);
+            QModelIndex categoryIndex = m_model->index(row, 2);
+            QModelIndex quantityIndex = m_model->index(row, 3);
+            QModelIndex priceIndex = m_model->index(row, 5);
         
-        if (nameIndex.isValid() && categoryIndex.isValid() && 
-            quantityIndex.isValid() && priceIndex.isValid()) {
+            if (nameIndex.isValid() && categoryIndex.isValid() && 
+                quantityIndex.isValid() && priceIndex.isValid()) {
             
-            QString category = m_model->data(categoryIndex).toString();
-            int quantity = m_model->data(quantityIndex).toInt();
-            double price = m_model->data(priceIndex).toDouble();
-            double itemValue = quantity * price;
+                QString category = m_model->data(categoryIndex).toString();
+                int quantity = m_model->data(quantityIndex).toInt();
+                double price = m_model->data(priceIndex).toDouble();
+                double itemValue = quantity * price;
             
-            totalValue += itemValue;
-            totalItems += quantity;
-            categoryValues[category] += itemValue;
+                totalValue += itemValue;
+                totalItems += quantity;
+                categoryValues[category] += itemValue;
+            }
         }
     }
     
@@ -2599,10 +2748,13 @@ void MaterialWidget::generateValueReport()
     textEdit->setPlainText(reportContent);
     textEdit->setReadOnly(true);
     
+    QPushButton *exportBtn = new QPushButton("Export CSV");
+    connect(exportBtn, &QPushButton::clicked, this, &MaterialWidget::exportReportToCSV);
     QPushButton *closeBtn = new QPushButton("Close");
     connect(closeBtn, &QPushButton::clicked, &reportDialog, &QDialog::accept);
     
     layout->addWidget(textEdit);
+    layout->addWidget(exportBtn);
     layout->addWidget(closeBtn);
     
     reportDialog.exec();
@@ -2732,10 +2884,44 @@ void MaterialWidget::exportReportToPDF()
 
 void MaterialWidget::exportReportToCSV()
 {
+    // Export the materials exactly as the last report saw them
+    if (m_reportSession && m_reportSession->isActive()) {
+        const DatabaseRowSet rows = m_reportSession->fetchRows("SELECT * FROM materials ORDER BY name");
+        if (rows.isValid()) {
+            const QString snapshot = m_reportSession->snapshotTime().toLocalTime().toString("yyyyMMdd_hhmmss");
+            exportMaterialsToCSV(MaterialModel::materialsFromRowSet(rows),
+                                 QString("materials_report_%1.csv").arg(snapshot));
+            return;
+        }
+    }
+    
     // Reuse existing CSV export functionality
     exportToCSV();
 }
 
+bool MaterialWidget::beginReportSession()
+{
+    m_reportSession.reset();
+    if (!m_databaseManager || !m_databaseManager->isConnected()) {
+        return false;
+    }
+    
+    std::shared_ptr<ReportSession> session = m_databaseManager->beginReportSession();
+    if (!session->isActive()) {
+        return false;
+    }
+    m_reportSession = session;
+    
+    // Release the snapshot if no export follows
+    std::weak_ptr<ReportSession> weakSession = session;
+    QTimer::singleShot(REPORT_SNAPSHOT_TIMEOUT_MS, this, [this, weakSession]() {
+        if (!weakSession.expired() && weakSession.lock() == m_reportSession) {
+            m_reportSession.reset();
+        }
+    });
+    return true;
+}
+
 void MaterialWidget::exportReportToExcel()
 {
     QMessageBox::information(this, "Export to Excel", 
@@ -2829,6 +3015,8 @@ void MaterialWidget::hideRightPanel()
 
 void MaterialWidget::setDatabaseManager(DatabaseManager *dbManager)
 {
+    m_reportSession.reset();
+    m_databaseManager = dbManager;
     if (m_model) {
         m_model->setDatabaseManager(dbManager);
         qDebug() << "Database manager connected to MaterialWidget";
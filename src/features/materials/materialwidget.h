@@ -28,15 +28,22 @@
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QBarCategoryAxis>
 #include <QtCharts/QValueAxis>
+#include <QFuture>
+#include <QPointer>
+
+#include <memory>
 
 #include "suppliermodel.h"  // For Supplier struct
+#include "materialcsvimporter.h"
 
 class MaterialModel;
+class ReportSession;
 struct Material;
 class GroqClient;
 class AIAssistantDialog;
 class AIPredictionDialog;
 class SupplierWidget;
+class QProgressDialog;
 
 /**
  * @brief The MaterialWidget class provides the main interface for materials management
@@ -54,6 +61,7 @@ class MaterialWidget : public QWidget
 
 public:
     explicit MaterialWidget(QWidget *parent = nullptr);
+    ~MaterialWidget();
     
     // Public interface
     void refreshData();
@@ -89,6 +97,7 @@ private slots:
     void addMaterialFromDetail();
     void updateDashboardStats();
     void onDashboardCardClicked();
+    void onMaterialsLoaded();
     
     // Report generation slots
     void generateInventoryReport();
@@ -109,6 +118,9 @@ private slots:
 
 private:
     void setupUI();
+    bool beginReportSession();
+    void exportMaterialsToCSV(const QList<Material> &materials, const QString &defaultFileName);
+    void finishImport(const MaterialImportResult &result);
     void setupFilters();
     void setupTable();
     void setupActions();    void setupConnections();
@@ -117,6 +129,8 @@ private:
     void setupSettingsWidget();
     void createDashboardCard(const QString &title, const QString &value, const QString &subtitle, QGridLayout *layout, int row, int col);
     void updateRecentActivity();
+    void updateLowStockCard();
+    void updateStockAlertFeed();
     QWidget* createStatCard(const QString &title, const QString &value, const QString &color);
     void updateStatCard(QWidget *card, const QString &newValue);
     
@@ -150,6 +164,13 @@ private:
     // Data
     MaterialModel *m_model;
     QSortFilterProxyModel *m_proxyModel;
+    class DatabaseManager *m_databaseManager;
+    std::shared_ptr<ReportSession> m_reportSession; // Shared by a report and its export
+    
+    // CSV import running on a worker thread
+    std::shared_ptr<MaterialCsvImporter> m_importer;
+    QFuture<MaterialImportResult> m_importFuture;
+    QPointer<QProgressDialog> m_importProgress;
     
     // Actions section
     QWidget *m_actionsWidget;
@@ -197,6 +218,7 @@ private:
     QWidget *m_leastStockedCard;
     QWidget *m_totalCostCard;
     QListWidget *m_recentActivityList;
+    QListWidget *m_stockAlertFeed;
     QWidget *m_recentActivityWidget;
     QWidget *m_quickStatsWidget;
     
@@ -0,0 +1,308 @@
+#include "stockalertmonitor.h"
+#include "materialmodel.h"
+#include "../../database/databasemanager.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSet>
+#include <QStringList>
+#include <QDebug>
+
+const int StockAlertMonitor::FEED_CAPACITY = 50;
+
+namespace {
+
+const QString MAIN_DATABASE = "archiflow";
+const QString MATERIALS_TABLE = "materials";
+
+// Served by idx_materials_low_stock, which holds exactly these rows
+const QString LOW_STOCK_SQL =
+    "SELECT id, name, unit, quantity, reorder_point FROM materials WHERE quantity <= reorder_point";
+
+const QString ROWS_BY_ID_SQL =
+    "SELECT id, name, unit, quantity, reorder_point FROM materials WHERE id IN (%1)";
+
+// Ids bound per lookup, well under SQLite's host parameter limit
+const int ID_CHUNK_SIZE = 500;
+
+StockAlert alertFromQuery(const QSqlQuery &query)
+{
+    StockAlert alert;
+    alert.materialId = query.value(0).toInt();
+    alert.name = query.value(1).toString();
+    alert.unit = query.value(2).toString();
+    alert.quantity = query.value(3).toInt();
+    alert.reorderPoint = query.value(4).toInt();
+    return alert;
+}
+
+StockAlert alertFromMaterial(const Material &material)
+{
+    StockAlert alert;
+    alert.materialId = material.id;
+    alert.name = material.name;
+    alert.unit = material.unit;
+    alert.quantity = material.quantity;
+    alert.reorderPoint = material.reorderPoint;
+    return alert;
+}
+
+bool belowReorderPoint(const StockAlert &alert)
+{
+    return alert.quantity <= alert.reorderPoint;
+}
+
+} // namespace
+
+StockAlertMonitor::StockAlertMonitor(QObject *parent)
+    : QObject(parent)
+    , m_databaseManager(nullptr)
+    , m_loaded(false)
+    , m_alertsChanged(false)
+{
+    connect(ChangeNotifier::instance(), &ChangeNotifier::tableChanged,
+            this, &StockAlertMonitor::onTableChanged);
+}
+
+void StockAlertMonitor::setDatabaseManager(DatabaseManager *databaseManager)
+{
+    m_databaseManager = databaseManager;
+    m_loaded = false;
+    if (isWatchingDatabase()) {
+        reload();
+    }
+}
+
+bool StockAlertMonitor::isWatchingDatabase() const
+{
+    return m_databaseManager && m_databaseManager->isConnected();
+}
+
+bool StockAlertMonitor::reload()
+{
+    if (!isWatchingDatabase()) {
+        return false;
+    }
+
+    QSqlQuery query = m_databaseManager->executeForwardOnly(LOW_STOCK_SQL);
+    if (!query.isActive()) {
+        qWarning() << "Failed to load low stock materials:" << query.lastError().text();
+        return false;
+    }
+
+    QHash<int, StockAlert> alerts;
+    while (query.next()) {
+        const StockAlert alert = alertFromQuery(query);
+        alerts.insert(alert.materialId, alert);
+    }
+    query.finish();
+
+    replaceAll(alerts, m_loaded);
+    m_loaded = true;
+    return true;
+}
+
+void StockAlertMonitor::resetMaterials(const QList<Material> &materials)
+{
+    QHash<int, StockAlert> alerts;
+    for (const Material &material : materials) {
+        if (material.quantity <= material.reorderPoint) {
+            alerts.insert(material.id, alertFromMaterial(material));
+        }
+    }
+
+    replaceAll(alerts, m_loaded);
+    m_loaded = true;
+}
+
+void StockAlertMonitor::updateMaterial(const Material &material)
+{
+    finishChanges(apply(alertFromMaterial(material), m_loaded));
+}
+
+void StockAlertMonitor::removeMaterial(int materialId)
+{
+    finishChanges(remove(materialId, nullptr, m_loaded));
+}
+
+int StockAlertMonitor::count() const
+{
+    return m_alerts.size();
+}
+
+bool StockAlertMonitor::isLowStock(int materialId) const
+{
+    return m_alerts.contains(materialId);
+}
+
+StockAlert StockAlertMonitor::mostUrgent() const
+{
+    return m_order.empty() ? StockAlert() : m_alerts.value(m_order.begin()->second);
+}
+
+QList<StockAlert> StockAlertMonitor::alerts(int limit) const
+{
+    const int total = int(m_alerts.size());
+    const int size = limit < 0 ? total : qMin(limit, total);
+    QList<StockAlert> result;
+    result.reserve(size);
+    for (auto it = m_order.cbegin(); it != m_order.cend() && result.size() < size; ++it) {
+        result.append(m_alerts.value(it->second));
+    }
+    return result;
+}
+
+QList<StockAlertEvent> StockAlertMonitor::feed() const
+{
+    return m_feed;
+}
+
+void StockAlertMonitor::onTableChanged(const QString &databaseName, const QString &table,
+                                       const QList<ChangeNotifier::RowChange> &rows, bool allRows)
+{
+    if (databaseName != MAIN_DATABASE || table != MATERIALS_TABLE || !isWatchingDatabase()) {
+        return;
+    }
+    if (allRows) {
+        reload();
+        return;
+    }
+
+    bool eventsAdded = false;
+
+    QList<int> changedIds;
+    for (const ChangeNotifier::RowChange &row : rows) {
+        if (row.operation == ChangeNotifier::Delete) {
+            eventsAdded |= remove(int(row.rowId), nullptr, m_loaded);
+        } else {
+            changedIds.append(int(row.rowId));
+        }
+    }
+
+    // Only the changed rows are read back; one that is missing was
+    // deleted by a later commit
+    for (int start = 0; start < changedIds.size(); start += ID_CHUNK_SIZE) {
+        const QList<int> ids = changedIds.mid(start, ID_CHUNK_SIZE);
+        QStringList placeholders;
+        QVariantList params;
+        for (int id : ids) {
+            placeholders << "?";
+            params << id;
+        }
+
+        QSqlQuery query = m_databaseManager->executeForwardOnly(ROWS_BY_ID_SQL.arg(placeholders.join(", ")), params);
+        if (!query.isActive()) {
+            qWarning() << "Failed to read changed materials:" << query.lastError().text();
+            continue;
+        }
+
+        QSet<int> found;
+        while (query.next()) {
+            const StockAlert material = alertFromQuery(query);
+            found.insert(material.materialId);
+            eventsAdded |= apply(material, m_loaded);
+        }
+        for (int id : ids) {
+            if (!found.contains(id)) {
+                eventsAdded |= remove(id, nullptr, m_loaded);
+            }
+        }
+    }
+
+    finishChanges(eventsAdded);
+}
+
+StockAlertMonitor::OrderKey StockAlertMonitor::orderKey(const StockAlert &alert)
+{
+    return {-alert.shortfall(), alert.materialId};
+}
+
+void StockAlertMonitor::replaceAll(const QHash<int, StockAlert> &alerts, bool raiseEvents)
+{
+    bool eventsAdded = false;
+
+    const QList<int> currentIds = m_alerts.keys();
+    for (int id : currentIds) {
+        if (!alerts.contains(id)) {
+            eventsAdded |= remove(id, nullptr, raiseEvents);
+        }
+    }
+    for (const StockAlert &alert : alerts) {
+        eventsAdded |= apply(alert, raiseEvents);
+    }
+
+    finishChanges(eventsAdded);
+}
+
+bool StockAlertMonitor::apply(const StockAlert &material, bool raiseEvents)
+{
+    auto it = m_alerts.find(material.materialId);
+    if (it == m_alerts.end()) {
+        if (!belowReorderPoint(material)) {
+            return false;
+        }
+        m_alerts.insert(material.materialId, material);
+        m_order.insert(orderKey(material));
+        m_alertsChanged = true;
+        if (raiseEvents) {
+            addEvent(StockAlertEvent::Raised, material);
+            emit alertRaised(material);
+        }
+        return raiseEvents;
+    }
+
+    if (!belowReorderPoint(material)) {
+        return remove(material.materialId, &material, raiseEvents);
+    }
+
+    // Still low; its shortfall, and so its place, may have changed
+    if (it->quantity != material.quantity || it->reorderPoint != material.reorderPoint
+        || it->name != material.name || it->unit != material.unit) {
+        m_order.erase(orderKey(it.value()));
+        it.value() = material;
+        m_order.insert(orderKey(material));
+        m_alertsChanged = true;
+    }
+    return false;
+}
+
+bool StockAlertMonitor::remove(int materialId, const StockAlert *current, bool raiseEvents)
+{
+    auto it = m_alerts.find(materialId);
+    if (it == m_alerts.end()) {
+        return false;
+    }
+
+    const StockAlert alert = current ? *current : it.value();
+    m_order.erase(orderKey(it.value()));
+    m_alerts.erase(it);
+    m_alertsChanged = true;
+    if (raiseEvents) {
+        addEvent(StockAlertEvent::Cleared, alert);
+        emit alertCleared(alert);
+    }
+    return raiseEvents;
+}
+
+void StockAlertMonitor::addEvent(StockAlertEvent::Kind kind, const StockAlert &alert)
+{
+    StockAlertEvent event;
+    event.kind = kind;
+    event.alert = alert;
+    event.time = QDateTime::currentDateTime();
+
+    m_feed.prepend(event);
+    if (m_feed.size() > FEED_CAPACITY) {
+        m_feed.removeLast();
+    }
+}
+
+void StockAlertMonitor::finishChanges(bool eventsAdded)
+{
+    if (m_alertsChanged) {
+        m_alertsChanged = false;
+        emit alertsChanged(m_alerts.size());
+    }
+    if (eventsAdded) {
+        emit feedChanged();
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef STOCKALERTMONITOR_H
+#define STOCKALERTMONITOR_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <set>
+#include <utility>
+#include "../../database/changenotifier.h"
+
+class DatabaseManager;
+struct Material;
+
+// A material at or below its reorder point
+struct StockAlert
+{
+    int materialId = 0;
+    QString name;
+    QString unit;
+    int quantity = 0;
+    int reorderPoint = 0;
+
+    int shortfall() const { return reorderPoint - quantity; }   // 0 right at the threshold
+};
+
+// One entry of the notification feed
+struct StockAlertEvent
+{
+    enum Kind {
+        Raised,     // the material fell to or below its reorder point
+        Cleared     // it was restocked above it, or deleted
+    };
+
+    Kind kind = Raised;
+    StockAlert alert;
+    QDateTime time;
+};
+
+/**
+ * @brief The StockAlertMonitor class - Keeps the set of materials at or below their reorder point
+ *
+ * The set is ordered by shortfall, most urgent first, and updated one
+ * material at a time: from ChangeNotifier's committed row changes of the
+ * materials table when a database is attached, otherwise from the model's
+ * change path. A material crossing its threshold raises alertRaised() or
+ * alertCleared() as soon as the write commits, whichever path made it -
+ * edits, ledger movements, batch updates or imports. The initial load is
+ * one query on the low-stock partial index and raises nothing.
+ *
+ * count() and mostUrgent() are O(1); alerts() costs the number returned.
+ * The FEED_CAPACITY latest transitions are kept for the notification feed.
+ */
+class StockAlertMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int FEED_CAPACITY;
+
+    explicit StockAlertMonitor(QObject *parent = nullptr);
+
+    void setDatabaseManager(DatabaseManager *databaseManager);
+    bool isWatchingDatabase() const;
+    bool reload();
+
+    // Model change path, for materials not backed by a database
+    void resetMaterials(const QList<Material> &materials);
+    void updateMaterial(const Material &material);
+    void removeMaterial(int materialId);
+
+    int count() const;
+    bool isLowStock(int materialId) const;
+    StockAlert mostUrgent() const;                  // default-constructed when empty
+    QList<StockAlert> alerts(int limit = -1) const; // most urgent first
+    QList<StockAlertEvent> feed() const;            // newest first
+
+signals:
+    void alertRaised(const StockAlert &alert);
+    void alertCleared(const StockAlert &alert);
+    void alertsChanged(int count);  // the set or the order of its alerts changed
+    void feedChanged();
+
+private slots:
+    void onTableChanged(const QString &databaseName, const QString &table,
+                        const QList<ChangeNotifier::RowChange> &rows, bool allRows);
+
+private:
+    // (-shortfall, id): the most urgent alert sorts first
+    using OrderKey = std::pair<int, int>;
+
+    static OrderKey orderKey(const StockAlert &alert);
+    void replaceAll(const QHash<int, StockAlert> &alerts, bool raiseEvents);
+    bool apply(const StockAlert &material, bool raiseEvents);
+    bool remove(int materialId, const StockAlert *current, bool raiseEvents);
+    void addEvent(StockAlertEvent::Kind kind, const StockAlert &alert);
+    void finishChanges(bool eventsAdded);
+
+    DatabaseManager *m_databaseManager;
+    QHash<int, StockAlert> m_alerts;
+    std::set<OrderKey> m_order;
+    QList<StockAlertEvent> m_feed;
+    bool m_loaded;          // transitions raise alerts once the first load is in
+    bool m_alertsChanged;   // since the last alertsChanged()
+};
+
+Q_DECLARE_METATYPE(StockAlert)
+
+#endif // STOCKALERTMONITOR_H
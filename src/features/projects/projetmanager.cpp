@@ -1,11 +1,34 @@
 #include "projetmanager.h"
 #include "database/databasemanager.h"
+#include "database/fulltextsearch.h"
+#include "database/auditlogger.h"
 #include <QSqlRecord>
 #include <QDebug>
 
+namespace {
+
+const FullTextSearch::IndexDefinition PROJETS_SEARCH_INDEX = {
+    "project", "projets", "id", true,
+    {"nom", "description", "client", "architecte"},
+    "t.nom"
+};
+
+const KeysetPagination PROJETS_PAGINATION(
+    "projets", "id",
+    {
+        {"date_creation", {"IFNULL(date_creation, '')"}},
+        {"nom", {"nom"}},
+        {"budget", {"IFNULL(budget, 0)"}},
+        {"progression", {"IFNULL(progression, 0)"}}
+    },
+    "date_creation", Qt::DescendingOrder);
+
+} // namespace
+
 ProjetManager::ProjetManager(DatabaseManager *databaseManager, QObject *parent)
     : QObject(parent)
     , m_databaseManager(databaseManager)
+    , m_fullTextSearch(false)
 {
     Q_ASSERT(m_databaseManager);
 }
@@ -154,10 +177,10 @@ Projet ProjetManager::getProjet(int id)
     }
 
     QString selectQuery = "SELECT * FROM projets WHERE id = ?";
-    QSqlQuery query = executeQuery(selectQuery, {id});
+    CachedQuery query = executeQuery(selectQuery, {id});
     
-    if (query.next()) {
-        return projetFromQuery(query);
+    if (query->next()) {
+        return projetFromQuery(*query);
     }
     
     return Projet();
@@ -172,16 +195,68 @@ QList<Projet> ProjetManager::getAllProjets()
     }
 
     QString selectQuery = "SELECT * FROM projets ORDER BY date_creation DESC";
-    QSqlQuery query = executeQuery(selectQuery);
+    CachedQuery query = executeQuery(selectQuery);
     
-    while (query.next()) {
-        projets.append(projetFromQuery(query));
+    while (query->next()) {
+        projets.append(projetFromQuery(*query));
     }
     
     qDebug() << "Loaded" << projets.size() << "projects from database";
     return projets;
 }
 
+Page<Projet> ProjetManager::getProjetsPage(const PageRequest &request)
+{
+    Page<Projet> page;
+    
+    if (!m_databaseManager || !m_databaseManager->isConnected()) {
+        page.error = "Database not connected";
+        return page;
+    }
+
+    QString sql;
+    QVariantList params;
+    if (!PROJETS_PAGINATION.buildQuery(request, &sql, &params, &page.error)) {
+        emit error(page.error);
+        return page;
+    }
+
+    CachedQuery query = executeQuery(sql, params);
+    if (query->lastError().isValid()) {
+        page.error = query->lastError().text();
+        return page;
+    }
+
+    return PROJETS_PAGINATION.readPage<Projet>(*query, request, [this](const QSqlQuery &row) {
+        return projetFromQuery(row);
+    });
+}
+
+QFuture<QList<Projet>> ProjetManager::getAllProjetsAsync()
+{
+    if (!m_databaseManager || !m_databaseManager->isConnected()) {
+        return QtFuture::makeReadyFuture(QList<Projet>());
+    }
+
+    // Rows are mapped on the database worker thread as well
+    return m_databaseManager->executeQueryAsync("SELECT * FROM projets ORDER BY date_creation DESC")
+        .then([](const DatabaseRowSet &rows) {
+            QList<Projet> projets;
+            if (!rows.isValid()) {
+                qWarning() << "Failed to load projects:" << rows.error;
+                return projets;
+            }
+
+            projets.reserve(rows.rowCount());
+            for (int row = 0; row < rows.rowCount(); ++row) {
+                projets.append(projetFromRecord(rows.record(row)));
+            }
+
+            qDebug() << "Loaded" << projets.size() << "projects from database";
+            return projets;
+        });
+}
+
 QList<Projet> ProjetManager::rechercherProjets(const QString &terme, const QString &categorie, const QString &statut)
 {
     QList<Projet> projets;
@@ -190,6 +265,28 @@ QList<Projet> ProjetManager::rechercherProjets(const QString &terme, const QStri
         return projets;
     }
 
+    const QString matchExpression = FullTextSearch::matchExpression(terme);
+    if (m_fullTextSearch && !matchExpression.isEmpty()) {
+        QStringList conditions;
+        QVariantList params = {matchExpression};
+        if (!categorie.isEmpty()) {
+            conditions << "t.categorie = ?";
+            params << categorie;
+        }
+        if (!statut.isEmpty()) {
+            conditions << "t.statut = ?";
+            params << statut;
+        }
+
+        // Ranked by relevance instead of creation date
+        const DatabaseRowSet rows = m_databaseManager->fetchRows(
+            FullTextSearch::searchSql(PROJETS_SEARCH_INDEX, conditions.join(" AND ")), params);
+        for (int row = 0; row < rows.rowCount(); ++row) {
+            projets.append(projetFromRecord(rows.record(row)));
+        }
+        return projets;
+    }
+
     QString whereClause = "WHERE 1=1";
     QVariantList params;
 
@@ -210,10 +307,10 @@ QList<Projet> ProjetManager::rechercherProjets(const QString &terme, const QStri
     }
 
     QString selectQuery = QString("SELECT * FROM projets %1 ORDER BY date_creation DESC").arg(whereClause);
-    QSqlQuery query = executeQuery(selectQuery, params);
+    CachedQuery query = executeQuery(selectQuery, params);
     
-    while (query.next()) {
-        projets.append(projetFromQuery(query));
+    while (query->next()) {
+        projets.append(projetFromQuery(*query));
     }
     
     return projets;
@@ -243,10 +340,10 @@ QList<Projet> ProjetManager::getProjetsByDateRange(const QDate &dateDebut, const
         ORDER BY date_debut ASC
     )";
     
-    QSqlQuery query = executeQuery(selectQuery, {dateDebut, dateFin});
+    CachedQuery query = executeQuery(selectQuery, {dateDebut, dateFin});
     
-    while (query.next()) {
-        projets.append(projetFromQuery(query));
+    while (query->next()) {
+        projets.append(projetFromQuery(*query));
     }
     
     return projets;
@@ -261,10 +358,10 @@ QList<Projet> ProjetManager::getProjetsByClient(const QString &client)
     }
 
     QString selectQuery = "SELECT * FROM projets WHERE client LIKE ? ORDER BY date_creation DESC";
-    QSqlQuery query = executeQuery(selectQuery, {"%" + client + "%"});
+    CachedQuery query = executeQuery(selectQuery, {"%" + client + "%"});
     
-    while (query.next()) {
-        projets.append(projetFromQuery(query));
+    while (query->next()) {
+        projets.append(projetFromQuery(*query));
     }
     
     return projets;
@@ -279,10 +376,10 @@ QList<Projet> ProjetManager::getProjetsByArchitecte(const QString &architecte)
     }
 
     QString selectQuery = "SELECT * FROM projets WHERE architecte LIKE ? ORDER BY date_creation DESC";
-    QSqlQuery query = executeQuery(selectQuery, {"%" + architecte + "%"});
+    CachedQuery query = executeQuery(selectQuery, {"%" + architecte + "%"});
     
-    while (query.next()) {
-        projets.append(projetFromQuery(query));
+    while (query->next()) {
+        projets.append(projetFromQuery(*query));
     }
     
     return projets;
@@ -324,10 +421,10 @@ QStringList ProjetManager::getAllClients()
     }
 
     QString selectQuery = "SELECT DISTINCT client FROM projets WHERE client IS NOT NULL AND client != '' ORDER BY client";
-    QSqlQuery query = executeQuery(selectQuery);
+    CachedQuery query = executeQuery(selectQuery);
     
-    while (query.next()) {
-        clients.append(query.value(0).toString());
+    while (query->next()) {
+        clients.append(query->value(0).toString());
     }
     
     return clients;
@@ -342,10 +439,10 @@ QStringList ProjetManager::getAllArchitectes()
     }
 
     QString selectQuery = "SELECT DISTINCT architecte FROM projets WHERE architecte IS NOT NULL AND architecte != '' ORDER BY architecte";
-    QSqlQuery query = executeQuery(selectQuery);
+    CachedQuery query = executeQuery(selectQuery);
     
-    while (query.next()) {
-        architectes.append(query.value(0).toString());
+    while (query->next()) {
+        architectes.append(query->value(0).toString());
     }
     
     return architectes;
@@ -360,10 +457,10 @@ QStringList ProjetManager::getAllCategories()
     }
 
     QString selectQuery = "SELECT DISTINCT categorie FROM projets WHERE categorie IS NOT NULL AND categorie != '' ORDER BY categorie";
-    QSqlQuery query = executeQuery(selectQuery);
+    CachedQuery query = executeQuery(selectQuery);
     
-    while (query.next()) {
-        categories.append(query.value(0).toString());
+    while (query->next()) {
+        categories.append(query->value(0).toString());
     }
     
     return categories;
@@ -376,10 +473,10 @@ int ProjetManager::getTotalProjets()
     }
 
     QString selectQuery = "SELECT COUNT(*) FROM projets";
-    QSqlQuery query = executeQuery(selectQuery);
+    CachedQuery query = executeQuery(selectQuery);
     
-    if (query.next()) {
-        return query.value(0).toInt();
+    if (query->next()) {
+        return query->value(0).toInt();
     }
     
     return 0;
@@ -392,10 +489,10 @@ int ProjetManager::getProjetsByStatutCount(const QString &statut)
     }
 
     QString selectQuery = "SELECT COUNT(*) FROM projets WHERE statut = ?";
-    QSqlQuery query = executeQuery(selectQuery, {statut});
+    CachedQuery query = executeQuery(selectQuery, {statut});
     
-    if (query.next()) {
-        return query.value(0).toInt();
+    if (query->next()) {
+        return query->value(0).toInt();
     }
     
     return 0;
@@ -408,10 +505,10 @@ double ProjetManager::getTotalBudget()
     }
 
     QString selectQuery = "SELECT SUM(budget) FROM projets";
-    QSqlQuery query = executeQuery(selectQuery);
+    CachedQuery query = executeQuery(selectQuery);
     
-    if (query.next()) {
-        return query.value(0).toDouble();
+    if (query->next()) {
+        return query->value(0).toDouble();
     }
     
     return 0.0;
@@ -424,10 +521,10 @@ double ProjetManager::getBudgetByCategorie(const QString &categorie)
     }
 
     QString selectQuery = "SELECT SUM(budget) FROM projets WHERE categorie = ?";
-    QSqlQuery query = executeQuery(selectQuery, {categorie});
+    CachedQuery query = executeQuery(selectQuery, {categorie});
     
-    if (query.next()) {
-        return query.value(0).toDouble();
+    if (query->next()) {
+        return query->value(0).toDouble();
     }
     
     return 0.0;
@@ -501,10 +598,10 @@ bool ProjetManager::projetExists(const QString &nom, int excludeId)
         params.append(excludeId);
     }
     
-    QSqlQuery query = executeQuery(selectQuery, params);
+    CachedQuery query = executeQuery(selectQuery, params);
     
-    if (query.next()) {
-        return query.value(0).toInt() > 0;
+    if (query->next()) {
+        return query->value(0).toInt() > 0;
     }
     
     return false;
@@ -544,12 +641,24 @@ bool ProjetManager::createTables()
     
     if (success) {
         // Create indexes for better performance
-        executeNonQuery("CREATE INDEX IF NOT EXISTS idx_projets_nom ON projets(nom)");
+        // Replaced by idx_projets_page_nom
+        executeNonQuery("DROP INDEX IF EXISTS idx_projets_nom");
         executeNonQuery("CREATE INDEX IF NOT EXISTS idx_projets_categorie ON projets(categorie)");
         executeNonQuery("CREATE INDEX IF NOT EXISTS idx_projets_statut ON projets(statut)");
         executeNonQuery("CREATE INDEX IF NOT EXISTS idx_projets_client ON projets(client)");
         executeNonQuery("CREATE INDEX IF NOT EXISTS idx_projets_architecte ON projets(architecte)");
         executeNonQuery("CREATE INDEX IF NOT EXISTS idx_projets_date_creation ON projets(date_creation)");
+        for (const QString &indexSql : PROJETS_PAGINATION.indexStatements()) {
+            executeNonQuery(indexSql);
+        }
+        
+        // Optional; rechercherProjets() falls back to LIKE without it
+        m_fullTextSearch = FullTextSearch::createIndex(m_databaseManager->database(), PROJETS_SEARCH_INDEX);
+        if (m_fullTextSearch) {
+            FullTextSearch::instance()->registerIndex(m_databaseManager->connectionName(), PROJETS_SEARCH_INDEX);
+        }
+        
+        AuditLogger::instance()->attach(m_databaseManager->database(), "archiflow", {"projets"});
     }
     
     return success;
@@ -568,38 +677,44 @@ bool ProjetManager::executeNonQuery(const QString &query, const QVariantList &pa
     return m_databaseManager->executeNonQuery(query, params);
 }
 
-QSqlQuery ProjetManager::executeQuery(const QString &query, const QVariantList &params)
+CachedQuery ProjetManager::executeQuery(const QString &query, const QVariantList &params)
 {
-    return m_databaseManager->executeQuery(query, params);
+    // Back to the statement cache when the caller's query goes out of scope
+    return m_databaseManager->executeCached(query, params);
 }
 
 Projet ProjetManager::projetFromQuery(const QSqlQuery &query)
+{
+    return projetFromRecord(query.record());
+}
+
+Projet ProjetManager::projetFromRecord(const QSqlRecord &record)
 {
     Projet projet;
     
-    projet.setId(query.value("id").toInt());
-    projet.setNom(query.value("nom").toString());
-    projet.setDescription(query.value("description").toString());
-    projet.setCategorie(query.value("categorie").toString());
-    projet.setStatut(query.value("statut").toString());
+    projet.setId(record.value("id").toInt());
+    projet.setNom(record.value("nom").toString());
+    projet.setDescription(record.value("description").toString());
+    projet.setCategorie(record.value("categorie").toString());
+    projet.setStatut(record.value("statut").toString());
     
-    double lat = query.value("latitude").toDouble();
-    double lon = query.value("longitude").toDouble();
-    QString addr = query.value("adresse").toString();
+    double lat = record.value("latitude").toDouble();
+    double lon = record.value("longitude").toDouble();
+    QString addr = record.value("adresse").toString();
     projet.setLocation(lat, lon, addr);
     
-    projet.setDateCreation(query.value("date_creation").toDateTime());
-    projet.setDateModification(query.value("date_modification").toDateTime());
-    projet.setDateDebut(query.value("date_debut").toDate());
-    projet.setDateFinEstimee(query.value("date_fin_estimee").toDate());
-    
-    projet.setBudget(query.value("budget").toDouble());
-    projet.setClient(query.value("client").toString());
-    projet.setArchitecte(query.value("architecte").toString());
-    projet.setSurface(query.value("surface").toDouble());
-    projet.setEtage(query.value("etage").toInt());
-    projet.setMateriauPrincipal(query.value("materiau_principal").toString());
-    projet.setProgression(query.value("progression").toInt());
+    projet.setDateCreation(record.value("date_creation").toDateTime());
+    projet.setDateModification(record.value("date_modification").toDateTime());
+    projet.setDateDebut(record.value("date_debut").toDate());
+    projet.setDateFinEstimee(record.value("date_fin_estimee").toDate());
+    
+    projet.setBudget(record.value("budget").toDouble());
+    projet.setClient(record.value("client").toString());
+    projet.setArchitecte(record.value("architecte").toString());
+    projet.setSurface(record.value("surface").toDouble());
+    projet.setEtage(record.value("etage").toInt());
+    projet.setMateriauPrincipal(record.value("materiau_principal").toString());
+    projet.setProgression(record.value("progression").toInt());
     
     return projet;
 }
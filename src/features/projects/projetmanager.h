@@ -8,11 +8,15 @@
 #include <QStringList>
 #include <QVariantList>
 #include <QDebug>
+#include <QFuture>
+#include <QSqlRecord>
 #include <memory>
 
 #include "projet.h"
+#include "database/keysetpagination.h"
 
 class DatabaseManager;
+class CachedQuery;
 
 /**
  * @brief The ProjetManager class - Data Access Layer for project management
@@ -34,6 +38,9 @@ public:
     bool supprimerProjet(int id);
     Projet getProjet(int id);
     QList<Projet> getAllProjets();
+    QFuture<QList<Projet>> getAllProjetsAsync();
+    // Sort keys: date_creation (default, newest first), nom, budget, progression
+    Page<Projet> getProjetsPage(const PageRequest &request);
 
     // Search and filter operations
     QList<Projet> rechercherProjets(const QString &terme, const QString &categorie = QString(), 
@@ -74,13 +81,15 @@ signals:
 
 private:
     bool executeNonQuery(const QString &query, const QVariantList &params = QVariantList());
-    QSqlQuery executeQuery(const QString &query, const QVariantList &params = QVariantList());
+    CachedQuery executeQuery(const QString &query, const QVariantList &params = QVariantList());
     Projet projetFromQuery(const QSqlQuery &query);
+    static Projet projetFromRecord(const QSqlRecord &record);
     void logError(const QString &operation, const QSqlError &error);
 
 private:
     DatabaseManager *m_databaseManager;
     QString m_lastError;
+    bool m_fullTextSearch;
 };
 
 #endif // PROJETMANAGER_H
@@ -6,6 +6,58 @@
 #include <QVariantList>
 #include <QSqlQuery>
 #include <QSqlDatabase>
+#include <QSqlRecord>
+#include <QSqlField>
+#include <QStringList>
+#include <QFuture>
+
+/**
+ * @brief Fully materialized result of a query
+ *
+ * Unlike QSqlQuery, a row set owns its data and holds no connection or
+ * statement, so it can be produced on a worker thread and consumed on the
+ * GUI thread.
+ */
+struct DatabaseRowSet
+{
+    QStringList columns;
+    QList<QVariantList> rows;
+    int numRowsAffected = -1;
+    QVariant lastInsertId;
+    QString error;
+
+    bool isValid() const { return error.isEmpty(); }
+    int rowCount() const { return rows.size(); }
+    int columnIndex(const QString &column) const { return columns.indexOf(column); }
+
+    QVariant value(int row, int column) const
+    {
+        if (row < 0 || row >= rows.size() || column < 0 || column >= rows.at(row).size()) {
+            return QVariant();
+        }
+        return rows.at(row).at(column);
+    }
+
+    QVariant value(int row, const QString &column) const
+    {
+        return value(row, columnIndex(column));
+    }
+
+    // Row as a record, for code written against QSqlQuery::record()
+    QSqlRecord record(int row) const
+    {
+        QSqlRecord result;
+        for (int i = 0; i < columns.size(); ++i) {
+            const QVariant fieldValue = value(row, i);
+            QSqlField field(columns.at(i), fieldValue.metaType());
+            field.setValue(fieldValue);
+            result.append(field);
+        }
+        return result;
+    }
+};
+
+Q_DECLARE_METATYPE(DatabaseRowSet)
 
 /**
  * @brief Interface for database management operations
@@ -30,6 +82,10 @@ public:
     virtual QSqlQuery executeQuery(const QString &query, const QVariantList &params = QVariantList()) = 0;
     virtual bool executeNonQuery(const QString &query, const QVariantList &params = QVariantList()) = 0;
 
+    // Asynchronous query execution on the database worker thread
+    virtual QFuture<DatabaseRowSet> executeQueryAsync(const QString &query, const QVariantList &params = QVariantList()) = 0;
+    virtual QFuture<bool> executeNonQueryAsync(const QString &query, const QVariantList &params = QVariantList()) = 0;
+
     // Transaction management
     virtual bool beginTransaction() = 0;
     virtual bool commitTransaction() = 0;
@@ -480,23 +480,33 @@ void ProjetWidget::refreshProjects()
     m_projectsTable->setEnabled(false);
     emit statusMessage("Chargement des projets...");
     
-    // Load projects from database
-    m_allProjects = m_projetManager->getAllProjets();
-    
-    // Apply current filters
-    applyFilters();
-    
-    // Update table
-    populateTable();
-    
-    // Update status
-    updateStatusBar();
-    
-    // Re-enable table
-    m_projectsTable->setEnabled(true);
-    
-    emit statusMessage("Projets chargés avec succès");
-    emit projectCountChanged(m_filteredProjects.size());
+    // Load projects on the database worker thread; the table is updated
+    // back on the GUI thread (skipped if the widget is gone by then, or if
+    // a newer refresh has been started meanwhile)
+    const int generation = ++m_refreshGeneration;
+    m_projetManager->getAllProjetsAsync()
+        .then(this, [this, generation](const QList<Projet> &projets) {
+            if (generation != m_refreshGeneration) {
+                return;
+            }
+            
+            m_allProjects = projets;
+            
+            // Apply current filters
+            applyFilters();
+            
+            // Update table
+            populateTable();
+            
+            // Update status
+            updateStatusBar();
+            
+            // Re-enable table
+            m_projectsTable->setEnabled(true);
+            
+            emit statusMessage("Projets chargés avec succès");
+            emit projectCountChanged(m_filteredProjects.size());
+        });
 }
 
 void ProjetWidget::populateTable()
@@ -140,6 +140,7 @@ private:
     QList<Projet> m_allProjects;
     QList<Projet> m_filteredProjects;
     Projet m_selectedProject;
+    int m_refreshGeneration = 0;
     
     // Main layout
     QVBoxLayout *m_mainLayout;
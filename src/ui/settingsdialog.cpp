@@ -1,5 +1,7 @@
 #include "settingsdialog.h"
 #include "utils/stylemanager.h"
+#include "database/queryprofiler.h"
+#include <QHeaderView>
 #include <QSettings>
 #include <QStandardPaths>
 #include <QApplication>
@@ -18,7 +20,7 @@ void SettingsDialog::setupUI()
 {
     setWindowTitle("Settings");
     setModal(true);
-    resize(600, 500);
+    resize(760, 680);
     
     m_mainLayout = new QVBoxLayout(this);
     m_mainLayout->setContentsMargins(20, 20, 20, 20);
@@ -208,11 +210,76 @@ void SettingsDialog::setupDatabaseTab()
     backupLayout->addLayout(backupPathLayout, 2, 1);
     
     layout->addWidget(backupGroup);
-    layout->addStretch();
+    layout->addWidget(createDiagnosticsGroup(), 1);
     
     m_tabWidget->addTab(m_databaseTab, "Database");
 }
 
+QGroupBox *SettingsDialog::createDiagnosticsGroup()
+{
+    QGroupBox *diagnosticsGroup = new QGroupBox("Query Diagnostics");
+    QVBoxLayout *diagnosticsLayout = new QVBoxLayout(diagnosticsGroup);
+    diagnosticsLayout->setSpacing(10);
+    
+    QHBoxLayout *profilerLayout = new QHBoxLayout();
+    m_profilerEnabledCheck = new QCheckBox("Enable query profiler");
+    m_slowQueryThresholdSpin = new QSpinBox();
+    m_slowQueryThresholdSpin->setRange(1, 60000);
+    m_slowQueryThresholdSpin->setSuffix(" ms");
+    m_slowQueryThresholdSpin->setValue(QueryProfiler::DEFAULT_SLOW_THRESHOLD_MS);
+    profilerLayout->addWidget(m_profilerEnabledCheck);
+    profilerLayout->addStretch();
+    profilerLayout->addWidget(new QLabel("Slow query threshold:"));
+    profilerLayout->addWidget(m_slowQueryThresholdSpin);
+    diagnosticsLayout->addLayout(profilerLayout);
+    
+    // Per-statement statistics
+    m_queryStatsTable = new QTableWidget(0, 7);
+    m_queryStatsTable->setHorizontalHeaderLabels({"Statement", "Source", "Calls", "Avg (ms)", "P95 (ms)", "Max (ms)", "Rows"});
+    m_queryStatsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_queryStatsTable->verticalHeader()->setVisible(false);
+    m_queryStatsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_queryStatsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    diagnosticsLayout->addWidget(m_queryStatsTable, 2);
+    
+    // Slow-query log with the plan of the selected entry
+    m_slowQueryTable = new QTableWidget(0, 5);
+    m_slowQueryTable->setHorizontalHeaderLabels({"Time", "Source", "Duration (ms)", "Rows", "Statement"});
+    m_slowQueryTable->horizontalHeader()->setSectionResizeMode(4, QHeaderView::Stretch);
+    m_slowQueryTable->verticalHeader()->setVisible(false);
+    m_slowQueryTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_slowQueryTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_slowQueryTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    connect(m_slowQueryTable, &QTableWidget::itemSelectionChanged, this, &SettingsDialog::onSlowQuerySelectionChanged);
+    diagnosticsLayout->addWidget(m_slowQueryTable, 1);
+    
+    m_queryPlanView = new QPlainTextEdit();
+    m_queryPlanView->setReadOnly(true);
+    m_queryPlanView->setPlaceholderText("Select a slow query to see its query plan");
+    m_queryPlanView->setMaximumHeight(90);
+    diagnosticsLayout->addWidget(m_queryPlanView);
+    
+    QHBoxLayout *actionsLayout = new QHBoxLayout();
+    m_refreshDiagnosticsButton = new QPushButton("Refresh");
+    m_resetDiagnosticsButton = new QPushButton("Clear Statistics");
+    m_exportDiagnosticsButton = new QPushButton("Export JSON...");
+    m_refreshDiagnosticsButton->setObjectName("secondaryButton");
+    m_resetDiagnosticsButton->setObjectName("secondaryButton");
+    m_exportDiagnosticsButton->setObjectName("secondaryButton");
+    connect(m_refreshDiagnosticsButton, &QPushButton::clicked, this, &SettingsDialog::onRefreshDiagnosticsClicked);
+    connect(m_resetDiagnosticsButton, &QPushButton::clicked, this, &SettingsDialog::onResetDiagnosticsClicked);
+    connect(m_exportDiagnosticsButton, &QPushButton::clicked, this, &SettingsDialog::onExportDiagnosticsClicked);
+    actionsLayout->addStretch();
+    actionsLayout->addWidget(m_refreshDiagnosticsButton);
+    actionsLayout->addWidget(m_resetDiagnosticsButton);
+    actionsLayout->addWidget(m_exportDiagnosticsButton);
+    diagnosticsLayout->addLayout(actionsLayout);
+    
+    onRefreshDiagnosticsClicked();
+    
+    return diagnosticsGroup;
+}
+
 void SettingsDialog::setupMaterialsTab()
 {
     m_materialsTab = new QWidget();
@@ -292,6 +359,9 @@ void SettingsDialog::loadSettings()
     m_backupIntervalSpin->setValue(settings.value("backup/interval", 7).toInt());
     QString defaultBackupPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/ArchiFlow Backups";
     m_backupPathEdit->setText(settings.value("backup/path", defaultBackupPath).toString());
+    m_profilerEnabledCheck->setChecked(settings.value("database/profilerEnabled", false).toBool());
+    m_slowQueryThresholdSpin->setValue(settings.value("database/slowQueryThreshold",
+                                                      QueryProfiler::DEFAULT_SLOW_THRESHOLD_MS).toInt());
     
     // Materials settings
     m_defaultMinStockSpin->setValue(settings.value("materials/defaultMinStock", 10).toInt());
@@ -324,6 +394,12 @@ void SettingsDialog::saveSettings()
     settings.setValue("backup/enabled", m_autoBackupCheck->isChecked());
     settings.setValue("backup/interval", m_backupIntervalSpin->value());
     settings.setValue("backup/path", m_backupPathEdit->text());
+    settings.setValue("database/profilerEnabled", m_profilerEnabledCheck->isChecked());
+    settings.setValue("database/slowQueryThreshold", m_slowQueryThresholdSpin->value());
+    
+    // The profiler applies immediately, without a restart
+    QueryProfiler::instance()->setSlowQueryThreshold(m_slowQueryThresholdSpin->value());
+    QueryProfiler::instance()->setEnabled(m_profilerEnabledCheck->isChecked());
     
     // Materials settings
     settings.setValue("materials/defaultMinStock", m_defaultMinStockSpin->value());
@@ -383,6 +459,74 @@ void SettingsDialog::onColorClicked()
     }
 }
 
+void SettingsDialog::onRefreshDiagnosticsClicked()
+{
+    QueryProfiler *profiler = QueryProfiler::instance();
+    
+    const QList<QueryProfiler::StatementStats> statistics = profiler->statistics();
+    m_queryStatsTable->setRowCount(statistics.size());
+    for (int row = 0; row < statistics.size(); ++row) {
+        const QueryProfiler::StatementStats &stats = statistics.at(row);
+        QTableWidgetItem *statementItem = new QTableWidgetItem(stats.normalizedSql);
+        statementItem->setToolTip(stats.normalizedSql);
+        m_queryStatsTable->setItem(row, 0, statementItem);
+        m_queryStatsTable->setItem(row, 1, new QTableWidgetItem(stats.sources.join(", ")));
+        m_queryStatsTable->setItem(row, 2, new QTableWidgetItem(QString::number(stats.executions)));
+        m_queryStatsTable->setItem(row, 3, new QTableWidgetItem(QString::number(stats.averageMs(), 'f', 2)));
+        m_queryStatsTable->setItem(row, 4, new QTableWidgetItem(QString::number(stats.percentileMs(0.95), 'f', 2)));
+        m_queryStatsTable->setItem(row, 5, new QTableWidgetItem(QString::number(stats.maxMs, 'f', 2)));
+        m_queryStatsTable->setItem(row, 6, new QTableWidgetItem(QString::number(stats.rowsReturned)));
+    }
+    
+    // Newest first
+    const QList<QueryProfiler::SlowQuery> slowQueries = profiler->slowQueries();
+    m_slowQueryTable->setRowCount(slowQueries.size());
+    for (int i = 0; i < slowQueries.size(); ++i) {
+        const QueryProfiler::SlowQuery &query = slowQueries.at(slowQueries.size() - 1 - i);
+        QTableWidgetItem *timeItem = new QTableWidgetItem(query.timestamp.toString("HH:mm:ss"));
+        timeItem->setData(Qt::UserRole, query.queryPlan);
+        m_slowQueryTable->setItem(i, 0, timeItem);
+        m_slowQueryTable->setItem(i, 1, new QTableWidgetItem(query.source));
+        m_slowQueryTable->setItem(i, 2, new QTableWidgetItem(QString::number(query.elapsedMs, 'f', 1)));
+        m_slowQueryTable->setItem(i, 3, new QTableWidgetItem(query.rows >= 0 ? QString::number(query.rows) : "-"));
+        QTableWidgetItem *statementItem = new QTableWidgetItem(query.sql);
+        statementItem->setToolTip(query.sql);
+        m_slowQueryTable->setItem(i, 4, statementItem);
+    }
+    
+    m_queryPlanView->clear();
+}
+
+void SettingsDialog::onResetDiagnosticsClicked()
+{
+    QueryProfiler::instance()->reset();
+    onRefreshDiagnosticsClicked();
+}
+
+void SettingsDialog::onExportDiagnosticsClicked()
+{
+    QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/archiflow_query_profile.json";
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Query Profile", defaultPath,
+                                                    "JSON Files (*.json)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    
+    QString errorMessage;
+    if (QueryProfiler::instance()->exportToJson(fileName, &errorMessage)) {
+        QMessageBox::information(this, "Export", "Query profile exported successfully.");
+    } else {
+        QMessageBox::warning(this, "Export", "Failed to export query profile: " + errorMessage);
+    }
+}
+
+void SettingsDialog::onSlowQuerySelectionChanged()
+{
+    const int row = m_slowQueryTable->currentRow();
+    QTableWidgetItem *item = row >= 0 ? m_slowQueryTable->item(row, 0) : nullptr;
+    m_queryPlanView->setPlainText(item ? item->data(Qt::UserRole).toString() : QString());
+}
+
 void SettingsDialog::applyStyles()
 {
     StyleManager::applyMaterialDesign(this);
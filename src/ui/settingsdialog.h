@@ -15,6 +15,8 @@
 #include <QPushButton>
 #include <QColorDialog>
 #include <QFileDialog>
+#include <QTableWidget>
+#include <QPlainTextEdit>
 
 class SettingsDialog : public QDialog
 {
@@ -28,12 +30,17 @@ private slots:
     void onResetClicked();
     void onBrowseClicked();
     void onColorClicked();
+    void onRefreshDiagnosticsClicked();
+    void onResetDiagnosticsClicked();
+    void onExportDiagnosticsClicked();
+    void onSlowQuerySelectionChanged();
 
 private:
     void setupUI();
     void setupGeneralTab();
     void setupAppearanceTab();
     void setupDatabaseTab();
+    QGroupBox *createDiagnosticsGroup();
     void setupMaterialsTab();
     void loadSettings();
     void saveSettings();
@@ -68,6 +75,16 @@ private:
     QLineEdit *m_backupPathEdit;
     QPushButton *m_browseBackupButton;
     
+    // Query diagnostics
+    QCheckBox *m_profilerEnabledCheck;
+    QSpinBox *m_slowQueryThresholdSpin;
+    QTableWidget *m_queryStatsTable;
+    QTableWidget *m_slowQueryTable;
+    QPlainTextEdit *m_queryPlanView;
+    QPushButton *m_refreshDiagnosticsButton;
+    QPushButton *m_resetDiagnosticsButton;
+    QPushButton *m_exportDiagnosticsButton;
+    
     // Materials Tab
     QWidget *m_materialsTab;
     QSpinBox *m_defaultMinStockSpin;
@@ -6,10 +6,15 @@
 #include <QDebug>
 #include <QElapsedTimer>
 #include <QRandomGenerator>
+#include <QSet>
+#include <QSqlQuery>
+#include <algorithm>
 
 #include "src/features/contracts/contract.h"
 #include "src/features/contracts/contractdatabasemanager.h"
 #include "src/features/contracts/contractwidget.h"
+#include "src/database/reportsession.h"
+#include "src/database/maintenancescheduler.h"
 
 /**
  * @brief Comprehensive test suite for enhanced Contract CRUD operations
@@ -50,11 +55,13 @@ private slots:
     void testFilterByStatus();
     void testFilterByDateRange();
     void testFilterByClient();
+    void testContractsPagination();
 
     // Statistics and analytics tests
     void testContractStatistics();
     void testStatusDistribution();
     void testMonthlyContractCounts();
+    void testReportSessionSnapshot();
 
     // Database management tests
     void testDatabaseSynchronization();
@@ -501,6 +508,81 @@ void TestContractCRUD::testFilterByClient()
     qDeleteAll(clientContracts);
 }
 
+void TestContractCRUD::testContractsPagination()
+{
+    createTestContracts();
+    
+    QList<Contract*> allContracts = m_dbManager->getAllContracts();
+    QSet<QString> expectedIds;
+    for (Contract *contract : allContracts) {
+        expectedIds.insert(contract->id());
+    }
+    qDeleteAll(allContracts);
+    
+    // Walk every page by client name; each row appears once, in order
+    PageRequest request;
+    request.sortKey = "client_name";
+    request.pageSize = 2;
+    
+    QStringList seenIds;
+    QString previousClient;
+    int pages = 0;
+    do {
+        Page<Contract*> page = m_dbManager->getContractsPage(request);
+        QVERIFY2(page.isValid(), qPrintable(page.error));
+        QVERIFY(page.items.size() <= 2);
+        
+        for (Contract *contract : page.items) {
+            QVERIFY(contract->clientName() >= previousClient);
+            previousClient = contract->clientName();
+            seenIds.append(contract->id());
+        }
+        qDeleteAll(page.items);
+        
+        request.continuationToken = page.continuationToken;
+        ++pages;
+    } while (!request.continuationToken.isEmpty() && pages < 100);
+    
+    QCOMPARE(seenIds.size(), expectedIds.size());
+    QCOMPARE(QSet<QString>(seenIds.begin(), seenIds.end()), expectedIds);
+    
+    // A token only continues the listing it was issued for
+    Page<Contract*> firstPage = m_dbManager->getContractsPage(PageRequest{"client_name", Qt::AscendingOrder, 1, QString()});
+    QVERIFY(firstPage.hasMore());
+    qDeleteAll(firstPage.items);
+    
+    Page<Contract*> mismatched = m_dbManager->getContractsPage(
+        PageRequest{"value", Qt::AscendingOrder, 1, firstPage.continuationToken});
+    QVERIFY(!mismatched.isValid());
+    QVERIFY(mismatched.items.isEmpty());
+    
+    Page<Contract*> unknownKey = m_dbManager->getContractsPage(PageRequest{"description", Qt::AscendingOrder, 1, QString()});
+    QVERIFY(!unknownKey.isValid());
+}
+
+void TestContractCRUD::testReportSessionSnapshot()
+{
+    createTestContracts();
+    
+    std::shared_ptr<ReportSession> session = m_dbManager->beginReportSession();
+    QVERIFY2(session->isActive(), qPrintable(session->lastError()));
+    const int countAtSnapshot = session->scalar("SELECT COUNT(*) FROM contracts").toInt();
+    QVERIFY(countAtSnapshot > 0);
+    
+    // Writers are not blocked and the open session keeps its view
+    QString contractId = m_dbManager->addContract(createTestContract("Snapshot Client"));
+    QVERIFY(!contractId.isEmpty());
+    QCOMPARE(m_dbManager->getContractCount(), countAtSnapshot + 1);
+    QCOMPARE(session->scalar("SELECT COUNT(*) FROM contracts").toInt(), countAtSnapshot);
+    
+    session->end();
+    QVERIFY(!session->isActive());
+    
+    std::shared_ptr<ReportSession> next = m_dbManager->beginReportSession();
+    QVERIFY(next->isActive());
+    QCOMPARE(next->scalar("SELECT COUNT(*) FROM contracts").toInt(), countAtSnapshot + 1);
+}
+
 void TestContractCRUD::testContractStatistics()
 {
     createTestContracts();
@@ -538,8 +620,33 @@ void TestContractCRUD::testMonthlyContractCounts()
 
 void TestContractCRUD::testDatabaseOptimization()
 {
-    bool result = m_dbManager->optimizeDatabase();
-    QVERIFY(result);
+    // Leave a few megabytes of free pages behind
+    QSqlDatabase database = QSqlDatabase::database("contracts_connection", false);
+    QSqlQuery query(database);
+    QVERIFY(query.exec("WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 2000) "
+                       "INSERT INTO contracts (id, client_name, start_date, end_date, description) "
+                       "SELECT 'bulk_' || i, 'Bulk Client', 1, 2, hex(randomblob(2000)) FROM n"));
+    QVERIFY(query.exec("DELETE FROM contracts WHERE id LIKE 'bulk_%'"));
+    
+    // Optimizing no longer blocks; the report arrives when the pass is done
+    QSignalSpy spy(MaintenanceScheduler::instance(), &MaintenanceScheduler::maintenanceFinished);
+    QVERIFY(m_dbManager->optimizeDatabase());
+    
+    MaintenanceScheduler::Report report;
+    QTRY_VERIFY_WITH_TIMEOUT(std::any_of(spy.cbegin(), spy.cend(), [&report](const QList<QVariant> &arguments) {
+        report = arguments.first().value<MaintenanceScheduler::Report>();
+        return report.connectionName == "contracts_connection";
+    }), 30000);
+    
+    QVERIFY2(report.error.isEmpty(), qPrintable(report.error));
+    QVERIFY(report.steps.contains("vacuum") || report.steps.contains("incremental_vacuum"));
+    QVERIFY(report.bytesReclaimed > 0);
+    
+    // The search index survives the VACUUM
+    createTestContracts();
+    QList<Contract*> found = m_dbManager->searchContracts("Client");
+    QVERIFY(!found.isEmpty());
+    qDeleteAll(found);
 }
 
 void TestContractCRUD::testDatabaseBackupRestore()
@@ -0,0 +1,146 @@
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <QByteArray>
+
+#include "src/database/csvreader.h"
+
+/**
+ * @brief Tests for the CSV reader behind the materials import
+ *
+ * Covers the RFC 4180 cases the import depends on: quoted separators and
+ * quotes, line breaks inside quoted fields, CRLF line ends, a leading byte
+ * order mark, records longer than the read buffer and unterminated quotes.
+ */
+class TestCsvReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testQuotedFields();
+    void testLineBreakInQuotedField();
+    void testCrlfLineEnds();
+    void testByteOrderMark();
+    void testLastRecordWithoutLineEnd();
+    void testFieldLongerThanBuffer();
+    void testUnterminatedQuote();
+
+private:
+    static QList<QStringList> readAll(const QByteArray &data, QString *errorString = nullptr);
+};
+
+QList<QStringList> TestCsvReader::readAll(const QByteArray &data, QString *errorString)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    CsvReader reader(&buffer);
+
+    QList<QStringList> records;
+    QStringList fields;
+    while (reader.readRecord(&fields)) {
+        records.append(fields);
+    }
+    if (errorString) {
+        *errorString = reader.errorString();
+    }
+    return records;
+}
+
+void TestCsvReader::testQuotedFields()
+{
+    QString error;
+    const QList<QStringList> records = readAll("a,\"b,c\",\"say \"\"hi\"\"\",\"\"\n", &error);
+
+    QVERIFY(error.isEmpty());
+    QCOMPARE(records.size(), 1);
+    QCOMPARE(records.first(), QStringList({"a", "b,c", "say \"hi\"", ""}));
+}
+
+void TestCsvReader::testLineBreakInQuotedField()
+{
+    QBuffer buffer;
+    buffer.setData("\"one\ntwo\",x\nnext,y\n");
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    CsvReader reader(&buffer);
+
+    QStringList fields;
+    QVERIFY(reader.readRecord(&fields));
+    QCOMPARE(fields, QStringList({"one\ntwo", "x"}));
+    QCOMPARE(reader.lineNumber(), 1);
+
+    // Line numbers count the break inside the quotes
+    QVERIFY(reader.readRecord(&fields));
+    QCOMPARE(fields, QStringList({"next", "y"}));
+    QCOMPARE(reader.lineNumber(), 3);
+
+    QVERIFY(!reader.readRecord(&fields));
+    QVERIFY(!reader.hasError());
+}
+
+void TestCsvReader::testCrlfLineEnds()
+{
+    QString error;
+    const QList<QStringList> records = readAll("a,b\r\n\"c\r\nd\",e\r\n", &error);
+
+    QVERIFY(error.isEmpty());
+    QCOMPARE(records.size(), 2);
+    QCOMPARE(records.at(0), QStringList({"a", "b"}));
+    // Inside quotes the line end is data and kept as written
+    QCOMPARE(records.at(1), QStringList({"c\r\nd", "e"}));
+}
+
+void TestCsvReader::testByteOrderMark()
+{
+    const QList<QStringList> records = readAll("\xEF\xBB\xBFname,quantity\nBrick,5\n");
+
+    QCOMPARE(records.size(), 2);
+    QCOMPARE(records.at(0), QStringList({"name", "quantity"}));
+    QCOMPARE(records.at(1), QStringList({"Brick", "5"}));
+}
+
+void TestCsvReader::testLastRecordWithoutLineEnd()
+{
+    const QList<QStringList> records = readAll("a,b\nc,\"d\"");
+
+    QCOMPARE(records.size(), 2);
+    QCOMPARE(records.at(1), QStringList({"c", "d"}));
+    QVERIFY(readAll(QByteArray()).isEmpty());
+}
+
+void TestCsvReader::testFieldLongerThanBuffer()
+{
+    // The doubled quote straddles the 64 KiB read boundary: after the
+    // opening quote and 65534 bytes it sits at offsets 65535 and 65536
+    const QByteArray data = "\"" + QByteArray(65534, 'x') + "\"\"" + QByteArray(5000, 'z') + "\",end\nnext\n";
+    const QList<QStringList> records = readAll(data);
+
+    QCOMPARE(records.size(), 2);
+    QCOMPARE(records.at(0).size(), 2);
+    QCOMPARE(records.at(0).at(0), QString(65534, 'x') + "\"" + QString(5000, 'z'));
+    QCOMPARE(records.at(0).at(1), QString("end"));
+    QCOMPARE(records.at(1), QStringList({"next"}));
+}
+
+void TestCsvReader::testUnterminatedQuote()
+{
+    QBuffer buffer;
+    buffer.setData("a,b\n\"open,c\nd,e\n");
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    CsvReader reader(&buffer);
+
+    QStringList fields;
+    QVERIFY(reader.readRecord(&fields));
+    QCOMPARE(fields, QStringList({"a", "b"}));
+
+    // The rest of the input is one bad record, reported on the line it began
+    QVERIFY(!reader.readRecord(&fields));
+    QVERIFY(reader.hasError());
+    QVERIFY(reader.errorString().contains("line 2"));
+
+    // and the reader stays stopped
+    QVERIFY(!reader.readRecord(&fields));
+    QVERIFY(fields.isEmpty());
+}
+
+QTEST_MAIN(TestCsvReader)
+#include "test_csvreader.moc"
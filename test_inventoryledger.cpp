@@ -0,0 +1,156 @@
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QSqlQuery>
+#include <QTimeZone>
+
+#include "src/database/databasemanager.h"
+#include "src/database/inventoryledger.h"
+
+/**
+ * @brief Tests for the inventory ledger's stock checkpoints
+ *
+ * Compares stockAt() and flowBetween() with a full replay of the movements,
+ * with checkpoints in place, after a backdated movement has dropped some of
+ * them, and once they are written again. The queries must not write.
+ */
+class TestInventoryLedger : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void testMatchesFullReplay();
+    void testBackdatedMovement();
+
+private:
+    struct Entry {
+        QDateTime date;
+        int effect = 0;
+    };
+
+    void insertMovement(const QString &type, int quantity, const QDateTime &date);
+    int checkpointCount();
+    void compareWithReplay(InventoryLedger &ledger);
+
+    DatabaseManager m_manager;
+    int m_materialId = 0;
+    QDateTime m_start;
+    QList<Entry> m_entries;
+};
+
+void TestInventoryLedger::initTestCase()
+{
+    QVERIFY(m_manager.initialize(":memory:"));
+    QVERIFY(m_manager.executeNonQuery(
+        "INSERT INTO materials (name, category, quantity) VALUES ('Ledger test', 'Test', 0)"));
+    QSqlQuery query = m_manager.executeQuery("SELECT id FROM materials WHERE name = 'Ledger test'");
+    QVERIFY(query.next());
+    m_materialId = query.value(0).toInt();
+    query.finish();
+
+    // Hourly movements spanning a few checkpoints
+    m_start = QDateTime(QDate(2024, 1, 1), QTime(0, 0), QTimeZone::utc());
+    const int movements = InventoryLedger::CHECKPOINT_INTERVAL * 3 + 40;
+    QList<QVariantList> values(4);
+    for (int i = 0; i < movements; ++i) {
+        const QString type = i % 3 == 0 ? "out" : (i % 5 == 0 ? "adjustment" : "in");
+        const int quantity = type == "adjustment" ? (i % 2 ? 4 : -3) : 1 + i % 7;
+        const QDateTime date = m_start.addSecs(3600LL * (i + 1));
+        values[0] << m_materialId;
+        values[1] << type;
+        values[2] << quantity;
+        values[3] << InventoryLedger::sqlTime(date);
+        m_entries.append({date, type == "out" ? -quantity : quantity});
+    }
+    const BatchResult batch = m_manager.executeBatch(
+        "INSERT INTO material_movements (material_id, movement_type, quantity, movement_date) "
+        "VALUES (?, ?, ?, ?)", values);
+    QVERIFY2(batch.isValid() && !batch.hasFailures(), qPrintable(batch.error));
+}
+
+void TestInventoryLedger::testMatchesFullReplay()
+{
+    InventoryLedger ledger(&m_manager);
+    QVERIFY2(ledger.updateCheckpoints(m_materialId), qPrintable(ledger.lastError()));
+    QCOMPARE(checkpointCount(), 3);
+
+    compareWithReplay(ledger);
+}
+
+void TestInventoryLedger::testBackdatedMovement()
+{
+    InventoryLedger ledger(&m_manager);
+    QVERIFY2(ledger.updateCheckpoints(m_materialId), qPrintable(ledger.lastError()));
+
+    // Half an hour after the first movement: every checkpoint comes after it
+    const QDateTime backdated = m_start.addSecs(3600 + 1800);
+    insertMovement("in", 50, backdated);
+    m_entries.append({backdated, 50});
+    QCOMPARE(checkpointCount(), 0);
+
+    // Still right without checkpoints, and reading writes none
+    compareWithReplay(ledger);
+    QCOMPARE(checkpointCount(), 0);
+
+    QVERIFY2(ledger.updateCheckpoints(m_materialId), qPrintable(ledger.lastError()));
+    QCOMPARE(checkpointCount(), 3);
+    compareWithReplay(ledger);
+}
+
+void TestInventoryLedger::insertMovement(const QString &type, int quantity, const QDateTime &date)
+{
+    QVERIFY(m_manager.executeNonQuery(
+        "INSERT INTO material_movements (material_id, movement_type, quantity, movement_date) "
+        "VALUES (?, ?, ?, ?)", {m_materialId, type, quantity, InventoryLedger::sqlTime(date)}));
+}
+
+int TestInventoryLedger::checkpointCount()
+{
+    QSqlQuery query = m_manager.executeQuery(
+        "SELECT COUNT(*) FROM material_stock_checkpoints WHERE material_id = ?", {m_materialId});
+    const int count = query.next() ? query.value(0).toInt() : -1;
+    query.finish();
+    return count;
+}
+
+void TestInventoryLedger::compareWithReplay(InventoryLedger &ledger)
+{
+    // Balances replayed from every movement, at times on, between, before
+    // and after the movements
+    auto replay = [this](const QDateTime &at) {
+        InventoryLedger::Balance balance;
+        for (const Entry &entry : std::as_const(m_entries)) {
+            if (entry.date <= at) {
+                balance.quantity += entry.effect;
+                if (entry.effect > 0) {
+                    balance.received += entry.effect;
+                } else {
+                    balance.consumed -= entry.effect;
+                }
+            }
+        }
+        return balance;
+    };
+
+    const qint64 hours = m_entries.size() + 2;
+    for (qint64 hour = 0; hour <= hours; hour += 37) {
+        const QDateTime from = m_start.addSecs(3600 * hour);
+        const QDateTime to = from.addSecs(3600 * 100 + 1800);
+
+        bool ok = false;
+        QCOMPARE(ledger.stockAt(m_materialId, from, &ok), replay(from).quantity);
+        QVERIFY2(ok, qPrintable(ledger.lastError()));
+
+        const InventoryLedger::Balance opening = replay(from);
+        const InventoryLedger::Balance closing = replay(to);
+        const InventoryLedger::Flow flow = ledger.flowBetween(m_materialId, from, to, &ok);
+        QVERIFY2(ok, qPrintable(ledger.lastError()));
+        QCOMPARE(flow.openingQuantity, opening.quantity);
+        QCOMPARE(flow.closingQuantity, closing.quantity);
+        QCOMPARE(flow.received, closing.received - opening.received);
+        QCOMPARE(flow.consumed, closing.consumed - opening.consumed);
+    }
+}
+
+QTEST_MAIN(TestInventoryLedger)
+#include "test_inventoryledger.moc"